@@ -39,6 +39,7 @@
 #include <CommCtrl.h>
 #include <gdiplus.h>
 #include <shellapi.h>
+#include <ShlObj.h>
 #include <ShObjIdl_core.h>
 #include <strsafe.h>
 #include <tchar.h>
@@ -76,9 +77,15 @@ public:
     {
         addProvider(quicker_sfv::createSfvProvider());
         addProvider(quicker_sfv::createMD5Provider());
+        addProvider(quicker_sfv::createMD5SumProvider());
+        addProvider(quicker_sfv::createBsdTagMD5Provider());
+        addProvider(quicker_sfv::createBinarySfvProvider());
+        addProvider(quicker_sfv::createBinaryMD5Provider());
     }
 
     ChecksumProvider* getMatchingProviderFor(std::u8string_view filename, bool supports_create) {
+        // compressed checksum files can only be read, never written
+        if (!supports_create) { filename = stripCompressionExtension(filename); }
         for (auto const& p: m_providers) {
             std::u8string_view exts = p->fileExtensions();
             // split extensions
@@ -173,6 +180,7 @@ private:
         uint32_t ok;
         uint32_t bad;
         uint32_t missing;
+        uint32_t audited;
         uint32_t bandwidth;
     } m_stats;
 
@@ -181,6 +189,7 @@ private:
         std::u16string checksum;
         enum Status {
             Ok,
+            Audited,
             FailedMismatch,
             FailedMissing,
             Information,
@@ -217,6 +226,16 @@ private:
     };
 
     bool m_saveConfigToRegistry;
+    bool m_createDirectoryDigests;
+    bool m_useVerifiedDatabase;
+    bool m_recheckVerifiedFiles;
+    uint32_t m_verifiedDatabaseMaxAgeDays;
+    bool m_useDigestCache;
+    bool m_resumeAppendedFiles;
+    bool m_createBlockDigests;
+    bool m_quickAudit;
+    uint32_t m_auditSampleBlocks;
+    uint32_t m_filesInFlight;
 public:
     explicit MainWindow(FileProviders& file_providers, OperationScheduler& scheduler);
 
@@ -234,10 +253,16 @@ public:
 
     HWND getHwnd() const;
     HasherOptions getOptions() const;
+    std::u16string getVerifiedDatabasePath() const;
+    VerifiedDatabasePolicy getVerifiedDatabasePolicy() const;
+    bool getUseDigestCache() const;
+    uint32_t getBlockAuditSamples() const;
+    uint32_t getFilesInFlight() const;
 
     void onOperationStarted(uint32_t n_files) override;
     void onFileStarted(std::u8string_view file, std::u8string_view absolute_file_path) override;
     void onProgress(uint32_t percentage, uint32_t bandwidth_mib_s) override;
+    void onDamagedRanges(std::u8string_view file, std::span<BlockRange const> ranges) override;
     void onFileCompleted(std::u8string_view file, Digest const& checksum, std::u8string_view absolute_file_path, CompletionStatus status) override;
     void onOperationCompleted(Result r) override;
     void onCanceled() override;
@@ -248,6 +273,13 @@ public:
 
     void setOptionUseAvx512(bool use_avx512);
     void setOptionSaveConfiguration(bool save_config);
+    void setOptionCreateDirectoryDigests(bool create_directory_digests);
+    void setOptionUseVerifiedDatabase(bool use_verified_database);
+    void setOptionRecheckVerifiedFiles(bool recheck_verified_files);
+    void setOptionUseDigestCache(bool use_digest_cache);
+    void setOptionResumeAppendedFiles(bool resume_appended_files);
+    void setOptionCreateBlockDigests(bool create_block_digests);
+    void setOptionQuickAudit(bool quick_audit);
 
     void loadConfigurationFromRegistry();
     void saveConfigurationToRegistry();
@@ -280,7 +312,11 @@ MainWindow::MainWindow(FileProviders& file_providers, OperationScheduler& schedu
      m_hTextFieldRight(nullptr), m_hListView(nullptr), m_imageList(nullptr), m_hPopupMenu(nullptr),
      m_stats{}, m_listSort{ .sort_column = 0, .order = ListViewSort::Order::Original },
      m_options{ .has_sse42 = quicker_sfv::supportsSse42(), .has_avx512 = false},
-     m_fileProviders(&file_providers), m_scheduler(&scheduler), m_saveConfigToRegistry(false)
+     m_fileProviders(&file_providers), m_scheduler(&scheduler), m_saveConfigToRegistry(false),
+     m_createDirectoryDigests(false), m_useVerifiedDatabase(false), m_recheckVerifiedFiles(false),
+     m_verifiedDatabaseMaxAgeDays(30), m_useDigestCache(false),
+     m_resumeAppendedFiles(false), m_createBlockDigests(false), m_quickAudit(false), m_auditSampleBlocks(16),
+     m_filesInFlight(1)
 {
 }
 
@@ -453,7 +489,12 @@ LRESULT MainWindow::WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                             .event_handler = this,
                             .options = m_options,
                             .source_file = source_file_path,
-                            .provider = checksum_provider
+                            .provider = checksum_provider,
+                            .verified_database_path = getVerifiedDatabasePath(),
+                            .verified_database_policy = getVerifiedDatabasePolicy(),
+                            .use_digest_cache = m_useDigestCache,
+                            .block_audit_samples = getBlockAuditSamples(),
+                            .files_in_flight = m_filesInFlight
                         });
                     }
                 }
@@ -462,6 +503,20 @@ LRESULT MainWindow::WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                 setOptionUseAvx512(!m_options.has_avx512);
             } else if (LOWORD(wParam) == ID_OPTIONS_SAVECONFIGURATION) {
                 setOptionSaveConfiguration(!m_saveConfigToRegistry);
+            } else if (LOWORD(wParam) == ID_OPTIONS_CREATEDIRECTORYDIGESTS) {
+                setOptionCreateDirectoryDigests(!m_createDirectoryDigests);
+            } else if (LOWORD(wParam) == ID_OPTIONS_UPDATEDB) {
+                setOptionUseVerifiedDatabase(!m_useVerifiedDatabase);
+            } else if (LOWORD(wParam) == ID_OPTIONS_RECHECKVERIFIEDFILES) {
+                setOptionRecheckVerifiedFiles(!m_recheckVerifiedFiles);
+            } else if (LOWORD(wParam) == ID_OPTIONS_USEDIGESTCACHE) {
+                setOptionUseDigestCache(!m_useDigestCache);
+            } else if (LOWORD(wParam) == ID_OPTIONS_RESUMEAPPENDEDFILES) {
+                setOptionResumeAppendedFiles(!m_resumeAppendedFiles);
+            } else if (LOWORD(wParam) == ID_OPTIONS_CREATEBLOCKDIGESTS) {
+                setOptionCreateBlockDigests(!m_createBlockDigests);
+            } else if (LOWORD(wParam) == ID_OPTIONS_QUICKAUDIT) {
+                setOptionQuickAudit(!m_quickAudit);
             } else if (LOWORD(wParam) == ID_CREATE_FROM_FOLDER) {
                 if (auto const opt = OpenFolder(hWnd); opt) {
                     auto const& [folder_path, _] = *opt;
@@ -477,6 +532,32 @@ LRESULT MainWindow::WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                             .target_file = target_file_path,
                             .folder_path = folder_path,
                             .provider = checksum_provider,
+                            .create_directory_digests = m_createDirectoryDigests,
+                            .use_digest_cache = m_useDigestCache,
+                            .create_block_digests = m_createBlockDigests,
+                            .files_in_flight = m_filesInFlight,
+                        });
+                    }
+                }
+                return 0;
+            } else if (LOWORD(wParam) == ID_CREATE_UPDATE_EXISTING) {
+                if (auto const opt = OpenFolder(hWnd); opt) {
+                    auto const& [folder_path, _] = *opt;
+                    if (auto const opt_s = SaveFile(hWnd, *m_fileProviders); opt_s) {
+                        auto const& [target_file_path, selected_provider] = *opt_s;
+                        ChecksumProvider* checksum_provider =
+                            (selected_provider >= m_fileProviders->fileTypesCreate().size()) ?
+                            m_fileProviders->getMatchingProviderFor(convertToUtf8(target_file_path), true) :
+                            m_fileProviders->getProviderFromIndex(m_fileProviders->fileTypesCreate()[selected_provider].provider_index);
+                        m_scheduler->post(Operation::UpdateFromFolder{
+                            .event_handler = this,
+                            .options = m_options,
+                            .target_file = target_file_path,
+                            .folder_path = folder_path,
+                            .provider = checksum_provider,
+                            .create_directory_digests = m_createDirectoryDigests,
+                            .use_digest_cache = m_useDigestCache,
+                            .resume_appended_files = m_resumeAppendedFiles,
                         });
                     }
                 }
@@ -509,6 +590,8 @@ TCHAR const* MainWindow::getStatusTextForStatus(ListViewEntry::Status s, std::u1
     switch (s) {
     case ListViewEntry::Ok:
         return TEXT("OK");
+    case ListViewEntry::Audited:
+        return TEXT("OK. Sampled blocks match");
     case ListViewEntry::FailedMismatch:
         if (checksum.empty()) {
             return TEXT("FAILED. Unable to read file");
@@ -545,7 +628,8 @@ LRESULT MainWindow::populateListView(NMHDR* nmh) {
         if (disp_info->item.mask & LVIF_IMAGE) {
             if (disp_info->item.iSubItem == 0) {
                 switch (entry.status) {
-                case ListViewEntry::Status::Ok:
+                case ListViewEntry::Status::Ok: [[fallthrough]];
+                case ListViewEntry::Status::Audited:
                     disp_info->item.iImage = 0;
                     break;
                 case ListViewEntry::Status::FailedMismatch:
@@ -744,6 +828,7 @@ std::vector<MainWindow::ListViewEntry const*> MainWindow::getMarkedFilesForDelet
     selected_items.erase(
         std::remove_if(begin(selected_items), end(selected_items), [](ListViewEntry const* e) {
                 return (e->status != ListViewEntry::Status::Ok) &&
+                       (e->status != ListViewEntry::Status::Audited) &&
                        (e->status != ListViewEntry::Status::FailedMismatch);
             }), end(selected_items));
     return selected_items;
@@ -955,6 +1040,42 @@ HasherOptions MainWindow::getOptions() const {
     return m_options;
 }
 
+std::u16string MainWindow::getVerifiedDatabasePath() const {
+    if (!m_useVerifiedDatabase) { return {}; }
+    PWSTR app_data_path = nullptr;
+    if (SHGetKnownFolderPath(FOLDERID_LocalAppData, KF_FLAG_CREATE, nullptr, &app_data_path) != S_OK) {
+        CoTaskMemFree(app_data_path);
+        return {};
+    }
+    ResourceGuard guard_app_data_path(app_data_path, CoTaskMemFree);
+    std::u16string ret = assumeUtf16(app_data_path);
+    ret.append(u"\\QuickerSFV");
+    if (!CreateDirectory(toWcharStr(ret), nullptr) && (GetLastError() != ERROR_ALREADY_EXISTS)) {
+        return {};
+    }
+    ret.append(u"\\verified.qsfvdb");
+    return ret;
+}
+
+VerifiedDatabasePolicy MainWindow::getVerifiedDatabasePolicy() const {
+    return VerifiedDatabasePolicy{
+        .skip_verified = !m_recheckVerifiedFiles,
+        .max_age = std::chrono::days{ m_verifiedDatabaseMaxAgeDays }
+    };
+}
+
+bool MainWindow::getUseDigestCache() const {
+    return m_useDigestCache;
+}
+
+uint32_t MainWindow::getBlockAuditSamples() const {
+    return (m_quickAudit) ? m_auditSampleBlocks : 0;
+}
+
+uint32_t MainWindow::getFilesInFlight() const {
+    return m_filesInFlight;
+}
+
 void MainWindow::onOperationStarted(uint32_t n_files) {
     ListView_DeleteAllItems(m_hListView);
     m_listEntries.clear();
@@ -975,6 +1096,19 @@ void MainWindow::onProgress(uint32_t percentage, uint32_t bandwidth_mib_s) {
     UpdateStats();
 }
 
+void MainWindow::onDamagedRanges(std::u8string_view file, std::span<BlockRange const> ranges) {
+    for (BlockRange const& r : ranges) {
+        if (r.size == 0) {
+            addListEntry(formatString(255, TEXT("%s: unexpected data after byte %llu"),
+                                      convertToUtf16(file).c_str(), r.offset), {}, ListViewEntry::MessageBad);
+        } else {
+            addListEntry(formatString(255, TEXT("%s: damaged bytes %llu to %llu"),
+                                      convertToUtf16(file).c_str(), r.offset, r.offset + r.size - 1),
+                         {}, ListViewEntry::MessageBad);
+        }
+    }
+}
+
 void MainWindow::onFileCompleted(std::u8string_view file, Digest const& checksum, std::u8string_view absolute_file_path, CompletionStatus status) {
     ++m_stats.completed;
     m_stats.progress = 0;
@@ -992,6 +1126,10 @@ void MainWindow::onFileCompleted(std::u8string_view file, Digest const& checksum
         addListEntry(convertToUtf16(file), convertToUtf16(checksum.toString()), ListViewEntry::Status::FailedMismatch, convertToUtf16(absolute_file_path));
         ++m_stats.bad;
         break;
+    case CompletionStatus::Audited:
+        addListEntry(convertToUtf16(file), {}, ListViewEntry::Status::Audited, convertToUtf16(absolute_file_path));
+        ++m_stats.audited;
+        break;
     }
     ListView_EnsureVisible(m_hListView, m_listEntries.size() - 1, FALSE);
     UpdateStats();
@@ -1001,12 +1139,17 @@ void MainWindow::onOperationCompleted(Result r) {
     m_stats.ok = r.ok;
     m_stats.bad = r.bad;
     m_stats.missing = r.missing;
-    m_stats.completed = r.ok + r.bad + r.missing;
+    m_stats.audited = r.audited;
+    m_stats.completed = r.ok + r.bad + r.missing + r.audited;
     m_stats.progress = 0;
     m_stats.bandwidth = 0;
     addListEntry(formatString(30, TEXT("%d files checked"), m_stats.completed));
-    if ((m_stats.missing == 0) && (m_stats.bad == 0)) {
+    if ((m_stats.missing == 0) && (m_stats.bad == 0) && (m_stats.audited == 0)) {
         addListEntry(u"All files OK", {}, ListViewEntry::Status::MessageOk);
+    } else if ((m_stats.missing == 0) && (m_stats.bad == 0)) {
+        addListEntry(formatString(80, TEXT("All files OK; %d file%s only checked by sampling blocks"), m_stats.audited,
+                                  ((m_stats.audited == 1) ? TEXT(" was") : TEXT("s were"))),
+                     {}, ListViewEntry::Status::MessageOk);
     } else {
         std::u16string msg;
         if (m_stats.bad > 0) {
@@ -1055,6 +1198,7 @@ void MainWindow::writeResultsToFile() const {
     for (auto const& e : m_listEntries) {
         std::u8string msg;
         if ((e.status == ListViewEntry::Status::Ok) ||
+            (e.status == ListViewEntry::Status::Audited) ||
             (e.status == ListViewEntry::Status::FailedMissing) ||
             (e.status == ListViewEntry::Status::FailedMismatch))
         {
@@ -1078,7 +1222,12 @@ void MainWindow::UpdateStats() {
     } else {
         Static_SetText(m_hTextFieldLeft, formatString(buffer, buffer_size, TEXT("Completed files: %d/%d (File: %d%% %dMiB/s)\nOk: %d"), m_stats.completed, m_stats.total, m_stats.progress, m_stats.bandwidth, m_stats.ok));
     }
-    Static_SetText(m_hTextFieldRight, formatString(buffer, buffer_size, TEXT("Bad: %d\nMissing: %d"), m_stats.bad, m_stats.missing));
+    if (m_stats.audited == 0) {
+        Static_SetText(m_hTextFieldRight, formatString(buffer, buffer_size, TEXT("Bad: %d\nMissing: %d"), m_stats.bad, m_stats.missing));
+    } else {
+        Static_SetText(m_hTextFieldRight, formatString(buffer, buffer_size, TEXT("Bad: %d\nMissing: %d  Audited: %d"),
+                                                       m_stats.bad, m_stats.missing, m_stats.audited));
+    }
 }
 
 void MainWindow::setOptionUseAvx512(bool use_avx512) {
@@ -1115,6 +1264,90 @@ void MainWindow::setOptionSaveConfiguration(bool save_config) {
     m_saveConfigToRegistry = save_config;
 }
 
+void MainWindow::setOptionCreateDirectoryDigests(bool create_directory_digests) {
+    MENUITEMINFO mii{ .cbSize = sizeof(MENUITEMINFO), .fMask = MIIM_STATE };
+    GetMenuItemInfo(m_hMenu, ID_OPTIONS_CREATEDIRECTORYDIGESTS, FALSE, &mii);
+    if (create_directory_digests) {
+        mii.fState |= MFS_CHECKED;
+    } else {
+        mii.fState &= ~MFS_CHECKED;
+    }
+    SetMenuItemInfo(m_hMenu, ID_OPTIONS_CREATEDIRECTORYDIGESTS, FALSE, &mii);
+    m_createDirectoryDigests = create_directory_digests;
+}
+
+void MainWindow::setOptionUseVerifiedDatabase(bool use_verified_database) {
+    MENUITEMINFO mii{ .cbSize = sizeof(MENUITEMINFO), .fMask = MIIM_STATE };
+    GetMenuItemInfo(m_hMenu, ID_OPTIONS_UPDATEDB, FALSE, &mii);
+    if (use_verified_database) {
+        mii.fState |= MFS_CHECKED;
+    } else {
+        mii.fState &= ~MFS_CHECKED;
+    }
+    SetMenuItemInfo(m_hMenu, ID_OPTIONS_UPDATEDB, FALSE, &mii);
+    m_useVerifiedDatabase = use_verified_database;
+}
+
+void MainWindow::setOptionRecheckVerifiedFiles(bool recheck_verified_files) {
+    MENUITEMINFO mii{ .cbSize = sizeof(MENUITEMINFO), .fMask = MIIM_STATE };
+    GetMenuItemInfo(m_hMenu, ID_OPTIONS_RECHECKVERIFIEDFILES, FALSE, &mii);
+    if (recheck_verified_files) {
+        mii.fState |= MFS_CHECKED;
+    } else {
+        mii.fState &= ~MFS_CHECKED;
+    }
+    SetMenuItemInfo(m_hMenu, ID_OPTIONS_RECHECKVERIFIEDFILES, FALSE, &mii);
+    m_recheckVerifiedFiles = recheck_verified_files;
+}
+
+void MainWindow::setOptionUseDigestCache(bool use_digest_cache) {
+    MENUITEMINFO mii{ .cbSize = sizeof(MENUITEMINFO), .fMask = MIIM_STATE };
+    GetMenuItemInfo(m_hMenu, ID_OPTIONS_USEDIGESTCACHE, FALSE, &mii);
+    if (use_digest_cache) {
+        mii.fState |= MFS_CHECKED;
+    } else {
+        mii.fState &= ~MFS_CHECKED;
+    }
+    SetMenuItemInfo(m_hMenu, ID_OPTIONS_USEDIGESTCACHE, FALSE, &mii);
+    m_useDigestCache = use_digest_cache;
+}
+
+void MainWindow::setOptionResumeAppendedFiles(bool resume_appended_files) {
+    MENUITEMINFO mii{ .cbSize = sizeof(MENUITEMINFO), .fMask = MIIM_STATE };
+    GetMenuItemInfo(m_hMenu, ID_OPTIONS_RESUMEAPPENDEDFILES, FALSE, &mii);
+    if (resume_appended_files) {
+        mii.fState |= MFS_CHECKED;
+    } else {
+        mii.fState &= ~MFS_CHECKED;
+    }
+    SetMenuItemInfo(m_hMenu, ID_OPTIONS_RESUMEAPPENDEDFILES, FALSE, &mii);
+    m_resumeAppendedFiles = resume_appended_files;
+}
+
+void MainWindow::setOptionCreateBlockDigests(bool create_block_digests) {
+    MENUITEMINFO mii{ .cbSize = sizeof(MENUITEMINFO), .fMask = MIIM_STATE };
+    GetMenuItemInfo(m_hMenu, ID_OPTIONS_CREATEBLOCKDIGESTS, FALSE, &mii);
+    if (create_block_digests) {
+        mii.fState |= MFS_CHECKED;
+    } else {
+        mii.fState &= ~MFS_CHECKED;
+    }
+    SetMenuItemInfo(m_hMenu, ID_OPTIONS_CREATEBLOCKDIGESTS, FALSE, &mii);
+    m_createBlockDigests = create_block_digests;
+}
+
+void MainWindow::setOptionQuickAudit(bool quick_audit) {
+    MENUITEMINFO mii{ .cbSize = sizeof(MENUITEMINFO), .fMask = MIIM_STATE };
+    GetMenuItemInfo(m_hMenu, ID_OPTIONS_QUICKAUDIT, FALSE, &mii);
+    if (quick_audit) {
+        mii.fState |= MFS_CHECKED;
+    } else {
+        mii.fState &= ~MFS_CHECKED;
+    }
+    SetMenuItemInfo(m_hMenu, ID_OPTIONS_QUICKAUDIT, FALSE, &mii);
+    m_quickAudit = quick_audit;
+}
+
 void MainWindow::loadConfigurationFromRegistry() {
     HKEY reg_key;
     if (RegOpenKeyEx(HKEY_CURRENT_USER, TEXT("Software\\QuickerSFV"), 0, KEY_WRITE | KEY_READ, &reg_key) != ERROR_SUCCESS) {
@@ -1144,6 +1377,66 @@ void MainWindow::loadConfigurationFromRegistry() {
             }
         }
     }
+    DWORD create_directory_digests;
+    size = sizeof(DWORD);
+    if ((RegGetValue(reg_key, nullptr, TEXT("CreateDirectoryDigests"), RRF_RT_REG_DWORD, nullptr, &create_directory_digests, &size) == ERROR_SUCCESS) &&
+        (size == sizeof(DWORD))) {
+        setOptionCreateDirectoryDigests(create_directory_digests == 1);
+    }
+    DWORD use_verified_database;
+    size = sizeof(DWORD);
+    if ((RegGetValue(reg_key, nullptr, TEXT("UseVerifiedDatabase"), RRF_RT_REG_DWORD, nullptr, &use_verified_database, &size) == ERROR_SUCCESS) &&
+        (size == sizeof(DWORD))) {
+        setOptionUseVerifiedDatabase(use_verified_database == 1);
+    }
+    DWORD recheck_verified_files;
+    size = sizeof(DWORD);
+    if ((RegGetValue(reg_key, nullptr, TEXT("RecheckVerifiedFiles"), RRF_RT_REG_DWORD, nullptr, &recheck_verified_files, &size) == ERROR_SUCCESS) &&
+        (size == sizeof(DWORD))) {
+        setOptionRecheckVerifiedFiles(recheck_verified_files == 1);
+    }
+    DWORD use_digest_cache;
+    size = sizeof(DWORD);
+    if ((RegGetValue(reg_key, nullptr, TEXT("UseDigestCache"), RRF_RT_REG_DWORD, nullptr, &use_digest_cache, &size) == ERROR_SUCCESS) &&
+        (size == sizeof(DWORD))) {
+        setOptionUseDigestCache(use_digest_cache == 1);
+    }
+    DWORD resume_appended_files;
+    size = sizeof(DWORD);
+    if ((RegGetValue(reg_key, nullptr, TEXT("ResumeAppendedFiles"), RRF_RT_REG_DWORD, nullptr, &resume_appended_files, &size) == ERROR_SUCCESS) &&
+        (size == sizeof(DWORD))) {
+        setOptionResumeAppendedFiles(resume_appended_files == 1);
+    }
+    DWORD create_block_digests;
+    size = sizeof(DWORD);
+    if ((RegGetValue(reg_key, nullptr, TEXT("CreateBlockDigests"), RRF_RT_REG_DWORD, nullptr, &create_block_digests, &size) == ERROR_SUCCESS) &&
+        (size == sizeof(DWORD))) {
+        setOptionCreateBlockDigests(create_block_digests == 1);
+    }
+    DWORD quick_audit;
+    size = sizeof(DWORD);
+    if ((RegGetValue(reg_key, nullptr, TEXT("QuickAudit"), RRF_RT_REG_DWORD, nullptr, &quick_audit, &size) == ERROR_SUCCESS) &&
+        (size == sizeof(DWORD))) {
+        setOptionQuickAudit(quick_audit == 1);
+    }
+    DWORD audit_sample_blocks;
+    size = sizeof(DWORD);
+    if ((RegGetValue(reg_key, nullptr, TEXT("AuditSampleBlocks"), RRF_RT_REG_DWORD, nullptr, &audit_sample_blocks, &size) == ERROR_SUCCESS) &&
+        (size == sizeof(DWORD)) && (audit_sample_blocks != 0)) {
+        m_auditSampleBlocks = audit_sample_blocks;
+    }
+    DWORD files_in_flight;
+    size = sizeof(DWORD);
+    if ((RegGetValue(reg_key, nullptr, TEXT("FilesInFlight"), RRF_RT_REG_DWORD, nullptr, &files_in_flight, &size) == ERROR_SUCCESS) &&
+        (size == sizeof(DWORD)) && (files_in_flight != 0)) {
+        m_filesInFlight = files_in_flight;
+    }
+    DWORD max_age_days;
+    size = sizeof(DWORD);
+    if ((RegGetValue(reg_key, nullptr, TEXT("VerifiedDatabaseMaxAgeDays"), RRF_RT_REG_DWORD, nullptr, &max_age_days, &size) == ERROR_SUCCESS) &&
+        (size == sizeof(DWORD))) {
+        m_verifiedDatabaseMaxAgeDays = max_age_days;
+    }
 }
 
 void MainWindow::saveConfigurationToRegistry() {
@@ -1166,6 +1459,26 @@ void MainWindow::saveConfigurationToRegistry() {
     }
     DWORD use_avx = (m_options.has_avx512) ? 1 : 0;
     RegSetValueEx(reg_key, TEXT("UseAvx"), 0, REG_DWORD, reinterpret_cast<BYTE const*>(&use_avx), sizeof(DWORD));
+    DWORD create_directory_digests = (m_createDirectoryDigests) ? 1 : 0;
+    RegSetValueEx(reg_key, TEXT("CreateDirectoryDigests"), 0, REG_DWORD, reinterpret_cast<BYTE const*>(&create_directory_digests), sizeof(DWORD));
+    DWORD use_verified_database = (m_useVerifiedDatabase) ? 1 : 0;
+    RegSetValueEx(reg_key, TEXT("UseVerifiedDatabase"), 0, REG_DWORD, reinterpret_cast<BYTE const*>(&use_verified_database), sizeof(DWORD));
+    DWORD recheck_verified_files = (m_recheckVerifiedFiles) ? 1 : 0;
+    RegSetValueEx(reg_key, TEXT("RecheckVerifiedFiles"), 0, REG_DWORD, reinterpret_cast<BYTE const*>(&recheck_verified_files), sizeof(DWORD));
+    DWORD use_digest_cache = (m_useDigestCache) ? 1 : 0;
+    RegSetValueEx(reg_key, TEXT("UseDigestCache"), 0, REG_DWORD, reinterpret_cast<BYTE const*>(&use_digest_cache), sizeof(DWORD));
+    DWORD resume_appended_files = (m_resumeAppendedFiles) ? 1 : 0;
+    RegSetValueEx(reg_key, TEXT("ResumeAppendedFiles"), 0, REG_DWORD, reinterpret_cast<BYTE const*>(&resume_appended_files), sizeof(DWORD));
+    DWORD create_block_digests = (m_createBlockDigests) ? 1 : 0;
+    RegSetValueEx(reg_key, TEXT("CreateBlockDigests"), 0, REG_DWORD, reinterpret_cast<BYTE const*>(&create_block_digests), sizeof(DWORD));
+    DWORD quick_audit = (m_quickAudit) ? 1 : 0;
+    RegSetValueEx(reg_key, TEXT("QuickAudit"), 0, REG_DWORD, reinterpret_cast<BYTE const*>(&quick_audit), sizeof(DWORD));
+    DWORD audit_sample_blocks = m_auditSampleBlocks;
+    RegSetValueEx(reg_key, TEXT("AuditSampleBlocks"), 0, REG_DWORD, reinterpret_cast<BYTE const*>(&audit_sample_blocks), sizeof(DWORD));
+    DWORD files_in_flight = m_filesInFlight;
+    RegSetValueEx(reg_key, TEXT("FilesInFlight"), 0, REG_DWORD, reinterpret_cast<BYTE const*>(&files_in_flight), sizeof(DWORD));
+    DWORD max_age_days = m_verifiedDatabaseMaxAgeDays;
+    RegSetValueEx(reg_key, TEXT("VerifiedDatabaseMaxAgeDays"), 0, REG_DWORD, reinterpret_cast<BYTE const*>(&max_age_days), sizeof(DWORD));
 }
 
 LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
@@ -1257,7 +1570,12 @@ int WinMainImpl(HINSTANCE hInstance, LPSTR lpCmdLine, int nCmdShow)
             .event_handler = &main_window,
             .options = main_window.getOptions(),
             .source_file = f,
-            .provider = p
+            .provider = p,
+            .verified_database_path = main_window.getVerifiedDatabasePath(),
+            .verified_database_policy = main_window.getVerifiedDatabasePolicy(),
+            .use_digest_cache = main_window.getUseDigestCache(),
+            .block_audit_samples = main_window.getBlockAuditSamples(),
+            .files_in_flight = main_window.getFilesInFlight()
         });
     }
 
@@ -0,0 +1,56 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/aligned_buffer_pool.hpp>
+
+#include <quicker_sfv/error.hpp>
+
+#include <sys/mman.h>
+
+namespace quicker_sfv::gui {
+
+AlignedBufferPool::AlignedBufferPool(uint32_t n_buffers, std::size_t buffer_size)
+    :m_memory(nullptr), m_bufferSize(static_cast<std::size_t>(alignUp(static_cast<int64_t>(buffer_size)))),
+     m_numberOfBuffers(n_buffers)
+{
+    if ((n_buffers == 0) || (buffer_size == 0)) { throwException(Error::Failed); }
+    // anonymous mappings are always page-aligned
+    void* const p = mmap(nullptr, m_numberOfBuffers * m_bufferSize, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) { throwException(Error::SystemError); }
+    m_memory = static_cast<std::byte*>(p);
+}
+
+AlignedBufferPool::~AlignedBufferPool() {
+    munmap(m_memory, m_numberOfBuffers * m_bufferSize);
+}
+
+uint32_t AlignedBufferPool::numberOfBuffers() const noexcept {
+    return m_numberOfBuffers;
+}
+
+std::size_t AlignedBufferPool::bufferSize() const noexcept {
+    return m_bufferSize;
+}
+
+std::span<std::byte> AlignedBufferPool::buffer(uint32_t index) const noexcept {
+    return std::span<std::byte>(m_memory + index * m_bufferSize, m_bufferSize);
+}
+
+}
@@ -0,0 +1,80 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_GUI_UI_ALIGNED_BUFFER_POOL_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_GUI_UI_ALIGNED_BUFFER_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace quicker_sfv::gui {
+
+/** A fixed number of equally sized, page-aligned I/O buffers.
+ * All buffers are carved from a single anonymous memory mapping, so that they can
+ * be registered with the kernel in one go. Both the start and the size of every
+ * buffer are multiples of ALIGNMENT, as required for direct I/O.
+ */
+class AlignedBufferPool {
+public:
+    /// Alignment of buffer addresses and sizes. Sufficient for the logical block
+    /// size of all common block devices.
+    static constexpr std::size_t const ALIGNMENT = 4096;
+private:
+    std::byte* m_memory;
+    std::size_t m_bufferSize;
+    uint32_t m_numberOfBuffers;
+public:
+    /** Constructor.
+     * @param[in] n_buffers Number of buffers.
+     * @param[in] buffer_size Minimum size of each buffer in bytes. Will be rounded up
+     *                        to a multiple of ALIGNMENT.
+     * @throw Exception Error::Failed if either argument is 0.
+     *                  Error::SystemError if the memory cannot be allocated.
+     */
+    AlignedBufferPool(uint32_t n_buffers, std::size_t buffer_size);
+    ~AlignedBufferPool();
+    AlignedBufferPool& operator=(AlignedBufferPool&&) = delete;
+
+    /** Number of buffers in the pool.
+     */
+    [[nodiscard]] uint32_t numberOfBuffers() const noexcept;
+    /** Size of each buffer in bytes.
+     */
+    [[nodiscard]] std::size_t bufferSize() const noexcept;
+    /** Retrieves the buffer with the given index.
+     * @pre index < numberOfBuffers().
+     */
+    [[nodiscard]] std::span<std::byte> buffer(uint32_t index) const noexcept;
+
+    /** Rounds a size or offset down to a multiple of ALIGNMENT.
+     */
+    [[nodiscard]] static constexpr int64_t alignDown(int64_t i) noexcept {
+        return i & ~static_cast<int64_t>(ALIGNMENT - 1);
+    }
+    /** Rounds a size or offset up to a multiple of ALIGNMENT.
+     */
+    [[nodiscard]] static constexpr int64_t alignUp(int64_t i) noexcept {
+        return alignDown(i + static_cast<int64_t>(ALIGNMENT - 1));
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/digest_cache_win32.hpp>
+
+#include <quicker_sfv/ui/resource_guard.hpp>
+#include <quicker_sfv/ui/string_helper.hpp>
+
+#include <quicker_sfv/string_utilities.hpp>
+
+#include <Windows.h>
+
+namespace quicker_sfv::gui {
+
+namespace {
+std::u16string streamPath(std::u8string_view file, std::u8string_view attribute_name) {
+    std::u8string ret{ file };
+    ret.push_back(u8':');
+    ret.append(attribute_name);
+    return convertToUtf16(ret);
+}
+}
+
+DigestCacheWin32::~DigestCacheWin32() = default;
+
+std::optional<std::vector<std::byte>> DigestCacheWin32::readAttribute(std::u8string_view file,
+                                                                      std::u8string_view attribute_name)
+{
+    HANDLE hstream = CreateFile(toWcharStr(streamPath(file, attribute_name)), GENERIC_READ,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hstream == INVALID_HANDLE_VALUE) { return std::nullopt; }
+    HandleGuard guard_hstream(hstream);
+    // entries are small, so a single fixed-size read avoids querying the size first
+    std::vector<std::byte> ret(512);
+    DWORD bytes_read = 0;
+    if (!ReadFile(hstream, ret.data(), static_cast<DWORD>(ret.size()), &bytes_read, nullptr)) {
+        return std::nullopt;
+    }
+    ret.resize(bytes_read);
+    return ret;
+}
+
+bool DigestCacheWin32::writeAttribute(std::u8string_view file, std::u8string_view attribute_name,
+                                      std::span<std::byte const> data)
+{
+    // creating or writing a stream updates the last write time of the file, so
+    // the original time has to be restored afterwards
+    HANDLE hfile = CreateFile(toWcharStr(convertToUtf16(file)), FILE_READ_ATTRIBUTES | FILE_WRITE_ATTRIBUTES,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hfile == INVALID_HANDLE_VALUE) { return false; }
+    HandleGuard guard_hfile(hfile);
+    FILETIME last_write_time;
+    if (!GetFileTime(hfile, nullptr, nullptr, &last_write_time)) { return false; }
+    bool success = false;
+    {
+        HANDLE hstream = CreateFile(toWcharStr(streamPath(file, attribute_name)), GENERIC_WRITE,
+                                    FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (hstream == INVALID_HANDLE_VALUE) { return false; }
+        HandleGuard guard_hstream(hstream);
+        DWORD bytes_written = 0;
+        success = WriteFile(hstream, data.data(), static_cast<DWORD>(data.size()), &bytes_written, nullptr) &&
+                  (bytes_written == data.size());
+    }
+    return SetFileTime(hfile, nullptr, nullptr, &last_write_time) && success;
+}
+
+}
@@ -0,0 +1,44 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_GUI_UI_DIGEST_CACHE_WIN32_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_GUI_UI_DIGEST_CACHE_WIN32_HPP
+
+#include <quicker_sfv/digest_cache.hpp>
+
+namespace quicker_sfv::gui {
+
+/** DigestCache storing its entries in NTFS alternate data streams.
+ * Each attribute is stored in a stream `<file>:<attribute_name>`. Writes to the
+ * stream are performed without updating the last write time of the file, so the
+ * modification time recorded in the FileStamp remains valid.
+ * File systems without alternate data streams behave like an empty cache.
+ */
+class DigestCacheWin32 : public DigestCache {
+public:
+    ~DigestCacheWin32() override;
+    [[nodiscard]] std::optional<std::vector<std::byte>> readAttribute(std::u8string_view file,
+                                                                      std::u8string_view attribute_name) override;
+    bool writeAttribute(std::u8string_view file, std::u8string_view attribute_name,
+                        std::span<std::byte const> data) override;
+};
+
+}
+
+#endif
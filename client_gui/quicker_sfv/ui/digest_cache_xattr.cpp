@@ -0,0 +1,57 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/digest_cache_xattr.hpp>
+
+#include <string>
+
+#include <sys/xattr.h>
+
+namespace quicker_sfv::gui {
+
+namespace {
+std::string toNativeString(std::u8string_view str) {
+    return std::string(reinterpret_cast<char const*>(str.data()), str.size());
+}
+}
+
+DigestCacheXattr::~DigestCacheXattr() = default;
+
+std::optional<std::vector<std::byte>> DigestCacheXattr::readAttribute(std::u8string_view file,
+                                                                      std::u8string_view attribute_name)
+{
+    std::string const path = toNativeString(file);
+    std::string const name = toNativeString(attribute_name);
+    // entries are small, so a single fixed-size read avoids querying the size first
+    std::vector<std::byte> ret(512);
+    ssize_t const res = getxattr(path.c_str(), name.c_str(), ret.data(), ret.size());
+    if (res < 0) { return std::nullopt; }
+    ret.resize(static_cast<std::size_t>(res));
+    return ret;
+}
+
+bool DigestCacheXattr::writeAttribute(std::u8string_view file, std::u8string_view attribute_name,
+                                      std::span<std::byte const> data)
+{
+    std::string const path = toNativeString(file);
+    std::string const name = toNativeString(attribute_name);
+    return setxattr(path.c_str(), name.c_str(), data.data(), data.size(), 0) == 0;
+}
+
+}
@@ -20,10 +20,12 @@
 #ifndef INCLUDE_GUARD_QUICKER_SFV_GUI_UI_EVENT_HANDLER_HPP
 #define INCLUDE_GUARD_QUICKER_SFV_GUI_UI_EVENT_HANDLER_HPP
 
+#include <quicker_sfv/block_digests.hpp>
 #include <quicker_sfv/error.hpp>
 #include <quicker_sfv/digest.hpp>
 
 #include <cstdint>
+#include <span>
 #include <string_view>
 
 /** Client support library.
@@ -41,6 +43,8 @@ struct EventHandler {
         Ok,         ///< File was verified with the expected checksum.
         Missing,    ///< File was not found or could not be opened.
         Bad,        ///< File could not be checked or checked to a wrong checksum.
+        Audited,    ///< File was not read in full, but a random sample of its blocks
+                    ///  matched the recorded BlockDigests.
     };
     /** Overall result of a verify or create operation.
      */
@@ -49,6 +53,7 @@ struct EventHandler {
         uint32_t ok;        ///< Number of files that with CompletionStatus::Ok.
         uint32_t bad;       ///< Number of files that with CompletionStatus::Bad.
         uint32_t missing;   ///< Number of files that with CompletionStatus::Missing.
+        uint32_t audited;   ///< Number of files that with CompletionStatus::Audited.
         bool was_canceled;  ///< True if the operation was canceled before completion.
     };
 
@@ -89,6 +94,10 @@ struct EventHandler {
      *    argument will be the empty Digest. If a file completes checking, but the
      *    checksum does not match in a verify operation, the checksum argument will
      *    contain the computed Digest for the file.
+     *  - CompletionStatus::Audited - Only a random sample of blocks of the file was
+     *    read and all of them matched the recorded BlockDigests. The file was not
+     *    hashed in full, so the checksum argument will be the empty Digest. This
+     *    can only occur for verify operations.
      *
      * @param[in] file Relative path to the file as it appears in the checksum file.
      *                 This is the same value that was sent in an earlier
@@ -102,6 +111,16 @@ struct EventHandler {
      */
     virtual void onFileCompleted(std::u8string_view file, Digest const& checksum, std::u8string_view absolute_file_path,
         CompletionStatus status) = 0;
+    /** Damaged ranges were located in a file during a verify operation.
+     * This event can only occur if BlockDigests are available for the file. It
+     * precedes the onFileCompleted() event for the file, which will always have
+     * CompletionStatus::Bad.
+     * @param[in] file Relative path to the file as it appears in the checksum file.
+     * @param[in] ranges The damaged ranges, sorted by offset. A range of size 0
+     *                   indicates unexpected data following the recorded end of file.
+     *                   When auditing, only the sampled blocks are reported.
+     */
+    virtual void onDamagedRanges(std::u8string_view file, std::span<BlockRange const> ranges) = 0;
     /** A verify or create operation has completed.
      * @param[in] r A summary of the results of the operation.
      *
@@ -0,0 +1,129 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/file_hashing_linux.hpp>
+
+#include <quicker_sfv/error.hpp>
+
+#include <algorithm>
+#include <cerrno>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace quicker_sfv::gui {
+
+CancelEvent::CancelEvent()
+    :m_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+{
+    if (m_fd < 0) { throwException(Error::SystemError); }
+}
+
+CancelEvent::~CancelEvent() {
+    ::close(m_fd);
+}
+
+void CancelEvent::signal() noexcept {
+    uint64_t const one = 1;
+    // the counter only ever grows to a small value, so this write cannot block
+    [[maybe_unused]] ssize_t const res = ::write(m_fd, &one, sizeof(one));
+}
+
+void CancelEvent::reset() noexcept {
+    uint64_t value;
+    // the eventfd is non-blocking, so this fails with EAGAIN if not signaled
+    [[maybe_unused]] ssize_t const res = ::read(m_fd, &value, sizeof(value));
+}
+
+bool CancelEvent::isSignaled() const noexcept {
+    pollfd p{ .fd = m_fd, .events = POLLIN, .revents = 0 };
+    int res;
+    do {
+        res = ::poll(&p, 1, 0);
+    } while ((res < 0) && (errno == EINTR));
+    return (res > 0) && ((p.revents & POLLIN) != 0);
+}
+
+int CancelEvent::fd() const noexcept {
+    return m_fd;
+}
+
+HashProgressTracker::HashProgressTracker(int64_t data_size, HashProgressCallback const& callback)
+    :m_callback(&callback), m_dataSize(data_size), m_bytesHashed(0), m_lastProgress(0),
+     m_lastCompletion(std::chrono::steady_clock::now())
+{}
+
+void HashProgressTracker::addChunk(size_t bytes) {
+    auto const now = std::chrono::steady_clock::now();
+    m_chunkBytes.push(static_cast<int64_t>(bytes));
+    m_chunkTimes.push(now - m_lastCompletion);
+    m_lastCompletion = now;
+    m_bytesHashed += static_cast<int64_t>(bytes);
+    if ((m_bytesHashed >= m_dataSize) || (!*m_callback)) { return; }
+    uint32_t const current_progress = static_cast<uint32_t>(m_bytesHashed * 100 / m_dataSize);
+    if (current_progress != m_lastProgress) {
+        (*m_callback)(current_progress, bandwidthMiBs());
+        m_lastProgress = current_progress;
+    }
+}
+
+int64_t HashProgressTracker::bytesHashed() const noexcept {
+    return m_bytesHashed;
+}
+
+uint32_t HashProgressTracker::bandwidthMiBs() const noexcept {
+    // the ratio of the averages is the ratio of the sums over the window
+    int64_t const t_avg = m_chunkTimes.rollingAverage().count();
+    if (t_avg <= 0) { return 0; }
+    return static_cast<uint32_t>((m_chunkBytes.rollingAverage() * 1'000'000'000ll) / (t_avg * 1'048'576ll));
+}
+
+HashResult hashFileWithReads(HashProgressCallback const& on_progress, Hasher& hasher,
+                             int fd, int64_t data_offset, int64_t data_size, CancelEvent const& cancel,
+                             std::span<std::byte> buffer,
+                             std::span<std::byte const> resume_state,
+                             BlockDigestBuilder* block_builder) {
+    if (resume_state.empty()) {
+        hasher.reset();
+    } else {
+        hasher.restoreState(resume_state);
+    }
+    HashProgressTracker progress(data_size, on_progress);
+    int64_t const data_end = data_offset + data_size;
+    for (int64_t offset = data_offset; offset < data_end;) {
+        if (cancel.isSignaled()) { return HashResult::Canceled; }
+        std::size_t const bytes_to_read = static_cast<std::size_t>(std::min<int64_t>(buffer.size(), data_end - offset));
+        ssize_t const res = ::pread(fd, buffer.data(), bytes_to_read, offset);
+        if (res < 0) {
+            if (errno == EINTR) { continue; }
+            return HashResult::Error;
+        }
+        // file ended before the end of the data segment
+        if (res == 0) { break; }
+        std::span<std::byte const> const data(buffer.data(), static_cast<std::size_t>(res));
+        hasher.addData(data);
+        if (block_builder) { block_builder->addData(data); }
+        progress.addChunk(data.size());
+        offset += res;
+    }
+    return HashResult::DigestReady;
+}
+
+}
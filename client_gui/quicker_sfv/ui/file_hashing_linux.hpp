@@ -0,0 +1,128 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_GUI_UI_FILE_HASHING_LINUX_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_GUI_UI_FILE_HASHING_LINUX_HPP
+
+#include <quicker_sfv/ui/sliding_window.hpp>
+
+#include <quicker_sfv/block_digests.hpp>
+#include <quicker_sfv/hasher.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+namespace quicker_sfv::gui {
+
+/** Outcome of hashing a single file.
+ */
+enum class HashResult {
+    DigestReady,        ///< A checksum Digest was computed successfully.
+    Canceled,           ///< The computation was canceled.
+    Error,              ///< The computation failed due to an error.
+};
+
+/** Receives progress updates while hashing a file.
+ * The arguments are the same as for EventHandler::onProgress().
+ */
+using HashProgressCallback = std::function<void(uint32_t percentage, uint32_t bandwidth_mib_s)>;
+
+/** Cancellation signal for file hashing on Linux.
+ * The event is backed by an `eventfd`, which becomes readable once the event is
+ * signaled. This allows waiting for cancellation together with completions of
+ * asynchronous I/O. Once signaled, the event stays signaled until it is reset.
+ */
+class CancelEvent {
+private:
+    int m_fd;
+public:
+    /** Constructor.
+     * @throw Exception Error::SystemError if the eventfd cannot be created.
+     */
+    CancelEvent();
+    ~CancelEvent();
+    CancelEvent& operator=(CancelEvent&&) = delete;
+
+    /** Signals the event. May be called from any thread.
+     */
+    void signal() noexcept;
+    /** Resets the event to the non-signaled state.
+     */
+    void reset() noexcept;
+    /** Checks whether the event is currently signaled without blocking.
+     */
+    [[nodiscard]] bool isSignaled() const noexcept;
+    /** The file descriptor of the eventfd; readable while the event is signaled.
+     */
+    [[nodiscard]] int fd() const noexcept;
+};
+
+/** Keeps track of the progress of hashing a single file.
+ * Bandwidth is measured from the time between consecutive completed chunks,
+ * averaged over the last few chunks. This gives the effective throughput of the
+ * hashing regardless of how many reads are in flight concurrently.
+ * Progress is only reported when the percentage changes.
+ */
+class HashProgressTracker {
+private:
+    HashProgressCallback const* m_callback;
+    int64_t m_dataSize;
+    int64_t m_bytesHashed;
+    uint32_t m_lastProgress;
+    std::chrono::steady_clock::time_point m_lastCompletion;
+    SlidingWindow<int64_t, 10> m_chunkBytes;
+    SlidingWindow<std::chrono::nanoseconds, 10> m_chunkTimes;
+public:
+    /** Constructor.
+     * @param[in] data_size Total number of bytes that will be hashed.
+     * @param[in] callback Callback for reporting progress. May be empty.
+     *                     Must outlive the tracker.
+     */
+    HashProgressTracker(int64_t data_size, HashProgressCallback const& callback);
+    /** Records a completed chunk and reports progress if the percentage changed.
+     * @param[in] bytes Number of bytes that were hashed for the chunk.
+     */
+    void addChunk(size_t bytes);
+    /** Total number of bytes hashed so far.
+     */
+    [[nodiscard]] int64_t bytesHashed() const noexcept;
+    /** Current bandwidth estimate in MiB/s; 0 if no measurements are available.
+     */
+    [[nodiscard]] uint32_t bandwidthMiBs() const noexcept;
+};
+
+/** Computes the checksum for a data segment of a file with plain blocking reads.
+ * This is meant for files whose data is in the page cache, where reads never wait
+ * for storage, and as a fallback where io_uring is not available. The parameters
+ * and semantics are the same as for IoUringHasher::hashFile().
+ * @param[in] buffer Buffer for reading the file. Must not be empty.
+ * @throw Exception Any exception raised by the hasher.
+ */
+HashResult hashFileWithReads(HashProgressCallback const& on_progress, Hasher& hasher,
+                             int fd, int64_t data_offset, int64_t data_size, CancelEvent const& cancel,
+                             std::span<std::byte> buffer,
+                             std::span<std::byte const> resume_state = {},
+                             BlockDigestBuilder* block_builder = nullptr);
+
+}
+
+#endif
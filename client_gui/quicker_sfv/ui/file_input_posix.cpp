@@ -0,0 +1,189 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/file_input_posix.hpp>
+
+#include <quicker_sfv/error.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <optional>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace quicker_sfv::gui {
+
+namespace {
+std::string toNativeString(std::u8string_view str) {
+    return std::string(reinterpret_cast<char const*>(str.data()), str.size());
+}
+
+struct OpenedFile {
+    int fd;
+    std::byte const* mapping;
+    uint64_t size;
+    bool is_mapped;
+};
+
+std::optional<OpenedFile> openFile(std::u8string_view path) {
+    int const fd = ::open(toNativeString(path).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) { return std::nullopt; }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+    OpenedFile ret{ .fd = fd, .mapping = nullptr, .size = 0, .is_mapped = false };
+    if (S_ISREG(st.st_mode)) {
+        if (st.st_size == 0) {
+            // mmap rejects empty mappings; an empty view is all there is to map
+            ret.is_mapped = true;
+        } else {
+            void* const p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            // if mapping fails, fall back to reading the file
+            if (p != MAP_FAILED) {
+                madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+                ret.mapping = static_cast<std::byte const*>(p);
+                ret.size = static_cast<uint64_t>(st.st_size);
+                ret.is_mapped = true;
+            }
+        }
+    }
+    return ret;
+}
+}
+
+FileInputPosix::FileInputPosix(std::u8string_view path)
+    :m_fd(-1), m_mapping(nullptr), m_size(0), m_isMapped(false), m_position(0), m_eof(false)
+{
+    std::optional<OpenedFile> const f = openFile(path);
+    if (!f) { throwException(Error::FileIO); }
+    m_fd = f->fd;
+    m_mapping = f->mapping;
+    m_size = f->size;
+    m_isMapped = f->is_mapped;
+    size_t const last_separator = path.rfind(u8'/');
+    if (last_separator == std::u8string_view::npos) {
+        m_filename = path;
+    } else {
+        m_filename = path.substr(last_separator + 1);
+        m_basePath = path.substr(0, last_separator + 1);
+    }
+}
+
+FileInputPosix::~FileInputPosix() {
+    close();
+}
+
+void FileInputPosix::close() noexcept {
+    if (m_mapping) { munmap(const_cast<std::byte*>(m_mapping), m_size); }
+    if (m_fd >= 0) { ::close(m_fd); }
+}
+
+size_t FileInputPosix::read(std::span<std::byte> read_buffer) {
+    if (m_isMapped) {
+        if (m_position >= m_size) { return FileInput::RESULT_END_OF_FILE; }
+        size_t const bytes_to_read = static_cast<size_t>(std::min<uint64_t>(read_buffer.size(), m_size - m_position));
+        std::memcpy(read_buffer.data(), m_mapping + m_position, bytes_to_read);
+        m_position += bytes_to_read;
+        return bytes_to_read;
+    }
+    if (m_eof) { return FileInput::RESULT_END_OF_FILE; }
+    // pipes return partial reads, but callers treat a short read as end of file
+    size_t bytes_read = 0;
+    while (bytes_read < read_buffer.size()) {
+        ssize_t const res = ::read(m_fd, read_buffer.data() + bytes_read, read_buffer.size() - bytes_read);
+        if (res < 0) {
+            if (errno == EINTR) { continue; }
+            throwException(Error::FileIO);
+        }
+        if (res == 0) {
+            m_eof = true;
+            break;
+        }
+        bytes_read += static_cast<size_t>(res);
+    }
+    m_position += bytes_read;
+    if ((bytes_read == 0) && (!read_buffer.empty())) { return FileInput::RESULT_END_OF_FILE; }
+    return bytes_read;
+}
+
+int64_t FileInputPosix::seek(int64_t offset, SeekStart seek_start) {
+    if (m_isMapped) {
+        int64_t const base = (seek_start == SeekStart::CurrentPosition) ? static_cast<int64_t>(m_position) :
+                             ((seek_start == SeekStart::FileEnd) ? static_cast<int64_t>(m_size) : 0);
+        int64_t const new_position = base + offset;
+        if ((new_position < 0) || (new_position > static_cast<int64_t>(m_size))) { throwException(Error::FileIO); }
+        m_position = static_cast<uint64_t>(new_position);
+        return new_position;
+    }
+    int const whence = (seek_start == SeekStart::CurrentPosition) ? SEEK_CUR :
+                       ((seek_start == SeekStart::FileEnd) ? SEEK_END : SEEK_SET);
+    off_t const res = lseek(m_fd, static_cast<off_t>(offset), whence);
+    if (res < 0) { throwException(Error::FileIO); }
+    m_position = static_cast<uint64_t>(res);
+    m_eof = false;
+    return res;
+}
+
+int64_t FileInputPosix::tell() {
+    return static_cast<int64_t>(m_position);
+}
+
+std::u8string_view FileInputPosix::current_file() const {
+    return m_filename;
+}
+
+bool FileInputPosix::open(std::u8string_view new_file) {
+    std::u8string new_file_full_path = m_basePath + std::u8string(new_file);
+    std::optional<OpenedFile> const f = openFile(new_file_full_path);
+    if (!f) { return false; }
+    close();
+    m_fd = f->fd;
+    m_mapping = f->mapping;
+    m_size = f->size;
+    m_isMapped = f->is_mapped;
+    m_position = 0;
+    m_eof = false;
+    m_filename = new_file;
+    return true;
+}
+
+uint64_t FileInputPosix::file_size() {
+    if (m_isMapped) { return m_size; }
+    struct stat st;
+    if (fstat(m_fd, &st) != 0) { throwException(Error::FileIO); }
+    return static_cast<uint64_t>(st.st_size);
+}
+
+std::optional<std::span<std::byte const>> FileInputPosix::mappedContents() noexcept {
+    if (!m_isMapped) { return std::nullopt; }
+    if (!m_mapping) { return std::span<std::byte const>{}; }
+    return std::span<std::byte const>(m_mapping + m_position, static_cast<size_t>(m_size - m_position));
+}
+
+bool FileInputPosix::isMapped() const noexcept {
+    return m_isMapped;
+}
+
+}
@@ -0,0 +1,75 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_GUI_UI_FILE_INPUT_POSIX_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_GUI_UI_FILE_INPUT_POSIX_HPP
+
+#include <quicker_sfv/file_io.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace quicker_sfv::gui {
+
+/** FileInput for POSIX systems that maps regular files into memory.
+ * Regular files are mapped read-only with `mmap` and advised for sequential access,
+ * so that their contents are available through mappedContents() without copying.
+ * Pipes, character devices and other files that cannot be mapped are read with
+ * plain `read` calls instead. For those, seek() is only supported if the underlying
+ * file supports it and file_size() reports the size given by `fstat`.
+ */
+class FileInputPosix : public FileInput {
+private:
+    int m_fd;
+    std::byte const* m_mapping;     ///< Start of the mapped file contents; nullptr if not mapped.
+    uint64_t m_size;                ///< Size of the mapped file contents.
+    bool m_isMapped;                ///< Regular files are mapped, even if they are empty.
+    uint64_t m_position;            ///< Current value of the file read pointer.
+    bool m_eof;
+    std::u8string m_filename;
+    std::u8string m_basePath;
+public:
+    /** Constructor.
+     * @param[in] path Path to the file to be opened.
+     * @throw Exception Error::FileIO if the file cannot be opened.
+     */
+    explicit FileInputPosix(std::u8string_view path);
+    ~FileInputPosix() override;
+    FileInputPosix& operator=(FileInputPosix&&) = delete;
+
+    size_t read(std::span<std::byte> read_buffer) override;
+    int64_t seek(int64_t offset, SeekStart seek_start) override;
+    int64_t tell() override;
+    std::u8string_view current_file() const override;
+    bool open(std::u8string_view new_file) override;
+    uint64_t file_size() override;
+    std::optional<std::span<std::byte const>> mappedContents() noexcept override;
+
+    /** Checks whether the current file is mapped into memory.
+     */
+    [[nodiscard]] bool isMapped() const noexcept;
+private:
+    void close() noexcept;
+};
+
+}
+
+#endif
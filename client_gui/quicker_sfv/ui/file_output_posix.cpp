@@ -0,0 +1,84 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/file_output_posix.hpp>
+
+#include <quicker_sfv/error.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace quicker_sfv::gui {
+
+namespace {
+/// Maximum number of buffers passed to a single writev call; IOV_MAX is at least 16.
+constexpr std::size_t const MAX_BUFFERS_PER_CALL = 16;
+}
+
+FileOutputPosix::FileOutputPosix(std::u8string_view path)
+    :m_fd(-1)
+{
+    std::string const native_path(reinterpret_cast<char const*>(path.data()), path.size());
+    m_fd = ::open(native_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (m_fd < 0) { throwException(Error::FileIO); }
+}
+
+FileOutputPosix::~FileOutputPosix() {
+    ::close(m_fd);
+}
+
+void FileOutputPosix::write(std::span<std::byte const> bytes_to_write) {
+    std::span<std::byte const> const buffers[] = { bytes_to_write };
+    writeVectored(buffers);
+}
+
+void FileOutputPosix::writeVectored(std::span<std::span<std::byte const> const> buffers) {
+    std::array<iovec, MAX_BUFFERS_PER_CALL> iov;
+    // the first buffer may have been written partially by the previous call
+    size_t first_buffer_offset = 0;
+    while (!buffers.empty()) {
+        size_t const n_buffers = std::min(buffers.size(), iov.size());
+        for (size_t i = 0; i < n_buffers; ++i) {
+            size_t const offset = (i == 0) ? first_buffer_offset : 0;
+            iov[i].iov_base = const_cast<std::byte*>(buffers[i].data() + offset);
+            iov[i].iov_len = buffers[i].size() - offset;
+        }
+        ssize_t const res = ::writev(m_fd, iov.data(), static_cast<int>(n_buffers));
+        if (res < 0) {
+            if (errno == EINTR) { continue; }
+            throwException(Error::FileIO);
+        }
+        // skip over all buffers that were written completely
+        size_t bytes_written = static_cast<size_t>(res);
+        while (!buffers.empty() && (bytes_written >= buffers.front().size() - first_buffer_offset)) {
+            bytes_written -= buffers.front().size() - first_buffer_offset;
+            first_buffer_offset = 0;
+            buffers = buffers.subspan(1);
+        }
+        first_buffer_offset += bytes_written;
+    }
+}
+
+}
@@ -0,0 +1,53 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_GUI_UI_FILE_OUTPUT_POSIX_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_GUI_UI_FILE_OUTPUT_POSIX_HPP
+
+#include <quicker_sfv/file_io.hpp>
+
+#include <string_view>
+
+namespace quicker_sfv::gui {
+
+/** FileOutput for POSIX systems.
+ * Vectored writes are issued as `writev` calls, so that a BufferedFileOutput
+ * passing on a large write together with its buffered data only needs a single
+ * system call.
+ */
+class FileOutputPosix : public FileOutput {
+private:
+    int m_fd;
+public:
+    /** Constructor.
+     * Creates the file if it does not exist and truncates it otherwise.
+     * @param[in] path Path to the file to be written.
+     * @throw Exception Error::FileIO if the file cannot be opened.
+     */
+    explicit FileOutputPosix(std::u8string_view path);
+    ~FileOutputPosix() override;
+    FileOutputPosix& operator=(FileOutputPosix&&) = delete;
+
+    void write(std::span<std::byte const> bytes_to_write) override;
+    void writeVectored(std::span<std::span<std::byte const> const> buffers) override;
+};
+
+}
+
+#endif
@@ -0,0 +1,273 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/hash_scheduler_linux.hpp>
+
+#include <quicker_sfv/ui/reorder_buffer.hpp>
+
+#include <quicker_sfv/error.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace quicker_sfv::gui {
+
+namespace {
+/// Buffer size for hashing with plain reads.
+constexpr std::size_t const READ_BUFFER_SIZE = 1 << 20;
+
+class FileDescriptorGuard {
+private:
+    int m_fd;
+public:
+    explicit FileDescriptorGuard(int fd) :m_fd(fd) {}
+    ~FileDescriptorGuard() { if (m_fd >= 0) { ::close(m_fd); } }
+    FileDescriptorGuard& operator=(FileDescriptorGuard&&) = delete;
+};
+
+std::string toNativeString(std::u8string_view str) {
+    return std::string(reinterpret_cast<char const*>(str.data()), str.size());
+}
+
+/** A DataPortion with its size resolved against the size of the file.
+ */
+struct ScheduledJob {
+    std::size_t index;
+    int64_t data_size;
+    CacheResidency residency;
+    PhysicalLocation location;  ///< Only determined for cold data when ordering by location.
+};
+
+/** The jobs reading data from a single storage device, in manifest order.
+ */
+struct DeviceQueue {
+    dev_t device;
+    std::vector<ScheduledJob> jobs;
+};
+
+/** Opens the file of a job and resolves its data size.
+ * @return The file descriptor, or a negative value on error with errno set.
+ */
+int openJobFile(ChecksumFile::DataPortion const& job, int64_t& data_size) {
+    int const fd = ::open(toNativeString(job.path).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) { return fd; }
+    if (job.data_size >= 0) {
+        data_size = job.data_size;
+    } else {
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            int const err = errno;
+            ::close(fd);
+            errno = err;
+            return -1;
+        }
+        data_size = std::max<int64_t>(static_cast<int64_t>(st.st_size) - job.data_offset, 0);
+    }
+    return fd;
+}
+
+HashJobResult::Status openErrorStatus(int err) {
+    return ((err == ENOENT) || (err == ENOTDIR)) ? HashJobResult::Status::Missing : HashJobResult::Status::Error;
+}
+}
+
+HashScheduler::HashScheduler(ChecksumProvider const& provider, HasherOptions const& hasher_options,
+                             HashSchedulerOptions const& opts)
+    :m_provider(&provider), m_hasherOptions(hasher_options), m_options(opts)
+{}
+
+void HashScheduler::run(std::span<ChecksumFile::DataPortion const> jobs, CancelEvent const& cancel,
+                        ResultCallback const& on_result) {
+    std::mutex mtx_results;
+    ReorderBuffer<HashJobResult> held_back_results;
+    auto const report = [&](std::size_t job_index, HashJobResult const& r) {
+        std::scoped_lock lk(mtx_results);
+        if (!m_options.ordered_results) {
+            on_result(job_index, r);
+            return;
+        }
+        held_back_results.insert(job_index, r);
+        while (std::optional<HashJobResult> const next = held_back_results.pop()) {
+            on_result(held_back_results.nextIndex() - 1, *next);
+        }
+    };
+    // results behind a job that was never started due to cancellation are still delivered
+    auto const flushResults = [&]() {
+        while (std::optional<HashJobResult> const next = held_back_results.popSkippingGaps()) {
+            on_result(held_back_results.nextIndex() - 1, *next);
+        }
+    };
+
+    // classify all jobs by the residency of their data, and cold data by its device
+    std::vector<ScheduledJob> resident_jobs;
+    std::vector<DeviceQueue> device_queues;
+    std::map<dev_t, std::size_t> device_queue_indices;
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        if (cancel.isSignaled()) {
+            flushResults();
+            return;
+        }
+        int64_t data_size = 0;
+        int const fd = openJobFile(jobs[i], data_size);
+        if (fd < 0) {
+            report(i, HashJobResult{ .status = openErrorStatus(errno), .digest = {}, .residency = CacheResidency::Cold });
+            continue;
+        }
+        FileDescriptorGuard guard_fd(fd);
+        CacheResidency const residency = m_options.probe_residency ?
+            probeResidency(fd, jobs[i].data_offset, data_size) : CacheResidency::Cold;
+        ScheduledJob scheduled{ .index = i, .data_size = data_size, .residency = residency,
+                                .location = PhysicalLocation{ .source = PhysicalLocation::Source::Inode, .position = 0 } };
+        if (residency == CacheResidency::Resident) {
+            resident_jobs.push_back(scheduled);
+            continue;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            report(i, HashJobResult{ .status = HashJobResult::Status::Error, .digest = {}, .residency = residency });
+            continue;
+        }
+        if (m_options.order_by_location) { scheduled.location = queryPhysicalLocation(fd, jobs[i].data_offset); }
+        auto const [it, is_new_device] = device_queue_indices.try_emplace(st.st_dev, device_queues.size());
+        if (is_new_device) { device_queues.push_back(DeviceQueue{ .device = st.st_dev, .jobs = {} }); }
+        device_queues[it->second].jobs.push_back(scheduled);
+    }
+    if (m_options.order_by_location) {
+        for (DeviceQueue& q : device_queues) {
+            std::ranges::stable_sort(q.jobs, {}, &ScheduledJob::location);
+        }
+    }
+
+    std::atomic<bool> abort = false;
+    std::exception_ptr error;
+    auto const fail = [&](std::exception_ptr e) {
+        std::scoped_lock lk(mtx_results);
+        if (!error) { error = e; }
+        abort = true;
+    };
+    auto const hashJob = [&](ScheduledJob const& job, Hasher& hasher, auto const& hash_func) {
+        ChecksumFile::DataPortion const& portion = jobs[job.index];
+        HashJobResult ret{ .status = HashJobResult::Status::Error, .digest = {}, .residency = job.residency };
+        int64_t data_size = 0;
+        int const fd = openJobFile(portion, data_size);
+        if (fd < 0) {
+            // the file may have been removed since it was classified
+            ret.status = openErrorStatus(errno);
+            return ret;
+        }
+        FileDescriptorGuard guard_fd(fd);
+        HashResult const res = hash_func(hasher, fd, portion.data_offset, job.data_size);
+        if (res == HashResult::DigestReady) {
+            ret.status = HashJobResult::Status::DigestReady;
+            ret.digest = hasher.finalize();
+        } else if (res == HashResult::Canceled) {
+            ret.status = HashJobResult::Status::Canceled;
+        }
+        return ret;
+    };
+
+    std::atomic<std::size_t> next_resident_job = 0;
+    auto const hashResident = [&]() {
+        try {
+            HasherPtr const hasher = m_provider->createHasher(m_hasherOptions);
+            std::vector<std::byte> buffer(READ_BUFFER_SIZE);
+            std::optional<MmapHasher> mmap_hasher;
+            if (m_options.map_resident_data) { mmap_hasher.emplace(m_options.mmap); }
+            auto const hash_func = [&](Hasher& h, int fd, int64_t data_offset, int64_t data_size) {
+                // data that fits into a single read is not worth the cost of setting up a mapping
+                return (mmap_hasher && (data_size > static_cast<int64_t>(READ_BUFFER_SIZE))) ?
+                    mmap_hasher->hashFile({}, h, fd, data_offset, data_size, cancel) :
+                    hashFileWithReads({}, h, fd, data_offset, data_size, cancel, buffer);
+            };
+            for (;;) {
+                if (abort || cancel.isSignaled()) { return; }
+                std::size_t const i = next_resident_job.fetch_add(1);
+                if (i >= resident_jobs.size()) { return; }
+                HashJobResult const r = hashJob(resident_jobs[i], *hasher, hash_func);
+                report(resident_jobs[i].index, r);
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    };
+    std::atomic<std::size_t> next_device_queue = 0;
+    auto const hashCold = [&]() {
+        try {
+            HasherPtr const hasher = m_provider->createHasher(m_hasherOptions);
+            std::vector<std::byte> buffer;
+            for (;;) {
+                if (abort || cancel.isSignaled()) { return; }
+                std::size_t const i = next_device_queue.fetch_add(1);
+                if (i >= device_queues.size()) { return; }
+                // a fresh hasher for every device, so that autotuning starts over
+                std::optional<IoUringHasher> io_uring_hasher;
+                if (IoUringHasher::isSupported()) {
+                    io_uring_hasher.emplace(m_options.io);
+                } else {
+                    buffer.resize(READ_BUFFER_SIZE);
+                }
+                auto const hash_func = [&](Hasher& h, int fd, int64_t data_offset, int64_t data_size) {
+                    return io_uring_hasher ?
+                        io_uring_hasher->hashFile({}, h, fd, data_offset, data_size, cancel) :
+                        hashFileWithReads({}, h, fd, data_offset, data_size, cancel, buffer);
+                };
+                for (ScheduledJob const& job : device_queues[i].jobs) {
+                    if (abort || cancel.isSignaled()) { return; }
+                    HashJobResult const r = hashJob(job, *hasher, hash_func);
+                    report(job.index, r);
+                }
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    };
+    auto const readThenHash = [&]() {
+        hashCold();
+        // storage is done; help with whatever resident data is left
+        hashResident();
+    };
+
+    {
+        std::size_t const n_cpu_threads = std::min<std::size_t>(m_options.n_cpu_threads, resident_jobs.size());
+        // the calling thread is one of the readers
+        std::size_t const n_readers = std::min<std::size_t>(std::max(m_options.max_device_readers, 1u),
+                                                            std::max<std::size_t>(device_queues.size(), 1));
+        std::vector<std::jthread> threads;
+        threads.reserve(n_cpu_threads + n_readers - 1);
+        for (std::size_t i = 0; i < n_cpu_threads; ++i) { threads.emplace_back(hashResident); }
+        for (std::size_t i = 1; i < n_readers; ++i) { threads.emplace_back(readThenHash); }
+        readThenHash();
+    }
+    flushResults();
+    if (error) { std::rethrow_exception(error); }
+}
+
+}
@@ -0,0 +1,144 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_GUI_UI_HASH_SCHEDULER_LINUX_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_GUI_UI_HASH_SCHEDULER_LINUX_HPP
+
+#include <quicker_sfv/ui/file_hashing_linux.hpp>
+#include <quicker_sfv/ui/io_uring_hasher.hpp>
+#include <quicker_sfv/ui/mmap_hasher.hpp>
+#include <quicker_sfv/ui/page_cache_residency.hpp>
+#include <quicker_sfv/ui/physical_layout.hpp>
+
+#include <quicker_sfv/checksum_file.hpp>
+#include <quicker_sfv/checksum_provider.hpp>
+#include <quicker_sfv/digest.hpp>
+#include <quicker_sfv/hasher.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+namespace quicker_sfv::gui {
+
+/** Options for HashScheduler.
+ */
+struct HashSchedulerOptions {
+    uint32_t n_cpu_threads;         ///< Number of threads hashing data that is resident
+                                    ///  in the page cache.
+    IoUringOptions io;              ///< Options for reading data from storage.
+    uint32_t max_device_readers;    ///< Maximum number of storage devices that are read
+                                    ///  concurrently, each by a thread of its own. 0 is
+                                    ///  treated as 1.
+    bool order_by_location;         ///< Read the files of each device in the order of
+                                    ///  their physical location instead of manifest order.
+                                    ///  Requires FIEMAP; see queryPhysicalLocation().
+    bool ordered_results;           ///< Deliver the results in the order of the jobs. Results
+                                    ///  that complete ahead of an earlier job are held back.
+    bool probe_residency;           ///< Split the work by page cache residency. If
+                                    ///  false, all data is read as if from storage.
+    bool map_resident_data;         ///< Hash resident data from memory mappings instead
+                                    ///  of reading it. Small files are always read.
+    MmapHasherOptions mmap;         ///< Options for hashing from memory mappings.
+};
+
+/** Outcome of hashing a single DataPortion.
+ */
+struct HashJobResult {
+    enum class Status {
+        DigestReady,        ///< The Digest was computed.
+        Missing,            ///< The file does not exist.
+        Error,              ///< The file could not be opened or read.
+        Canceled,           ///< Hashing was canceled while the file was in progress.
+    };
+    Status status;
+    Digest digest;                  ///< The computed Digest; empty unless the status
+                                    ///  is Status::DigestReady.
+    CacheResidency residency;       ///< Residency of the data when it was scheduled.
+};
+
+/** Hashes the data of many files concurrently on Linux.
+ * This is a library component of the Linux client support only. The Win32
+ * OperationScheduler behind the GUI does not use it, and does not group its reads
+ * by volume either.
+ *
+ * Before hashing, the data of every file is classified by whether it is resident in
+ * the page cache. Resident data does not have to wait for storage and is hashed on a
+ * pool of CPU threads right away, directly from a memory mapping unless it is small
+ * enough to fit into a single read. At the same time, the data that has to come from
+ * storage is read through IoUringHashers. When verifying right after copying, the
+ * total time thus approaches the larger of the time needed for hashing and the time
+ * needed for reading, instead of their sum.
+ *
+ * Data from storage is grouped by the device that holds the file, as reported by
+ * st_dev. Each device is read by a reader of its own, so that a manifest spanning
+ * several disks keeps all of them busy, while every disk still sees the files one
+ * after another, without seeking back and forth between concurrent reads. The
+ * calling thread is one of the readers. Readers that run out of devices join the
+ * pool of CPU threads for the remaining resident data. Each device gets its own
+ * IoUringHasher, so that autotuning adapts to each device separately. Optionally,
+ * the files of a device are read in the order of their PhysicalLocation, which
+ * avoids seeking back and forth on hard disks when the manifest order does not
+ * match the order in which the files were written. The order in which the results
+ * arrive changes accordingly, but their job indices remain those of the manifest.
+ * When results are ordered, they are passed through a ReorderBuffer and arrive in
+ * the order of the jobs instead, as required for writing a manifest or reporting
+ * results deterministically. Results may then be held back until all earlier jobs
+ * have completed. Note that
+ * file systems spanning multiple disks, such as RAID arrays or btrfs, show up as a
+ * single device.
+ */
+class HashScheduler {
+public:
+    /** Receives the result for the DataPortion with the given index.
+     * Calls are serialized, but may come from any thread. Unless results are ordered,
+     * they arrive in any order.
+     */
+    using ResultCallback = std::function<void(std::size_t job_index, HashJobResult const& result)>;
+private:
+    ChecksumProvider const* m_provider;
+    HasherOptions m_hasherOptions;
+    HashSchedulerOptions m_options;
+public:
+    /** Constructor.
+     * @param[in] provider Provider for the Hashers used for computing the Digests.
+     *                     Must outlive the scheduler.
+     * @param[in] hasher_options Options for creating the Hashers.
+     * @param[in] opts Options for the scheduler.
+     */
+    HashScheduler(ChecksumProvider const& provider, HasherOptions const& hasher_options,
+                  HashSchedulerOptions const& opts);
+
+    /** Hashes all jobs and blocks until done.
+     * @param[in] jobs The data to be hashed. Paths must be absolute or relative to the
+     *                 current working directory.
+     * @param[in] cancel Once signaled, no more jobs are started. Jobs that are in
+     *                   progress complete with HashJobResult::Status::Canceled.
+     * @param[in] on_result Receives the result for every job that was started.
+     * @throw Exception Any exception raised by a Hasher or by the I/O backends. All
+     *                  threads have been joined by the time the exception propagates.
+     */
+    void run(std::span<ChecksumFile::DataPortion const> jobs, CancelEvent const& cancel,
+             ResultCallback const& on_result);
+};
+
+}
+
+#endif
@@ -0,0 +1,222 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/io_autotuner.hpp>
+
+#include <quicker_sfv/error.hpp>
+
+#include <algorithm>
+
+namespace quicker_sfv::gui {
+
+namespace {
+/// Minimum number of completions measured in an epoch. Epochs span at least two
+/// times the queue depth, so that every read in flight contributes.
+constexpr uint32_t const EPOCH_MIN_COMPLETIONS = 8;
+/// Relative throughput gain required for keeping a setting that uses more resources.
+constexpr double const GAIN_THRESHOLD = 0.05;
+/// Relative throughput loss tolerated for keeping a setting that uses fewer resources.
+constexpr double const LOSS_TOLERANCE = 0.02;
+/// Relative throughput drop that ends Phase::Settled early.
+constexpr double const DROP_THRESHOLD = 0.25;
+/// Number of epochs to keep a settled setting before probing again.
+constexpr uint32_t const SETTLED_EPOCHS = 32;
+/// Average read latency above which the chunk size gets reduced.
+constexpr std::chrono::nanoseconds const LATENCY_LIMIT = std::chrono::milliseconds(200);
+
+enum Probe : uint32_t {
+    ChunkUp,
+    DepthUp,
+    ChunkDown,
+    DepthDown,
+    NumberOfProbes
+};
+}
+
+IoAutotuner::IoAutotuner(IoAutotunerOptions const& bounds, std::size_t initial_chunk_size, uint32_t initial_queue_depth)
+    :m_bounds(bounds), m_current{}, m_accepted{}, m_phase(Phase::Baseline), m_nextProbe(Probe::ChunkUp),
+     m_failedProbes(0), m_settledEpochs(0), m_baselineThroughput(0.0), m_lastThroughput(0.0),
+     m_warmupCompletions(0), m_epochCompletions(0), m_epochBytes(0), m_epochStart()
+{
+    if ((bounds.min_chunk_size == 0) || (bounds.min_chunk_size > bounds.max_chunk_size) ||
+        (bounds.min_queue_depth == 0) || (bounds.min_queue_depth > bounds.max_queue_depth) ||
+        (bounds.max_bytes_in_flight / bounds.min_queue_depth < bounds.min_chunk_size))
+    {
+        throwException(Error::Failed);
+    }
+    std::size_t const chunk_size = std::clamp(initial_chunk_size, bounds.min_chunk_size, bounds.max_chunk_size);
+    // give up reads in flight before giving up chunk size to fit into the memory budget
+    uint32_t const queue_depth = static_cast<uint32_t>(std::clamp<std::size_t>(
+        std::min<std::size_t>(initial_queue_depth, bounds.max_bytes_in_flight / chunk_size),
+        bounds.min_queue_depth, bounds.max_queue_depth));
+    m_current = Setting{
+        .chunk_size = std::min(chunk_size, bounds.max_bytes_in_flight / queue_depth),
+        .queue_depth = queue_depth
+    };
+    m_accepted = m_current;
+}
+
+void IoAutotuner::addCompletion(std::size_t bytes, std::chrono::nanoseconds latency, Clock::time_point t) {
+    if (m_warmupCompletions > 0) {
+        --m_warmupCompletions;
+        return;
+    }
+    m_latency.push(latency);
+    if (m_epochCompletions == 0) {
+        // the first completion only marks the start of the epoch
+        m_epochStart = t;
+        m_epochCompletions = 1;
+        return;
+    }
+    m_epochBytes += static_cast<int64_t>(bytes);
+    ++m_epochCompletions;
+    if ((m_latency.rollingAverage() > LATENCY_LIMIT) && (m_current.chunk_size > m_bounds.min_chunk_size)) {
+        // reads take too long to keep the hashing responsive; this overrides everything else
+        m_accepted = Setting{ .chunk_size = std::max(m_current.chunk_size / 2, m_bounds.min_chunk_size),
+                              .queue_depth = m_current.queue_depth };
+        m_failedProbes = 0;
+        m_phase = Phase::Baseline;
+        changeSetting(m_accepted);
+        return;
+    }
+    if (m_epochCompletions > std::max(EPOCH_MIN_COMPLETIONS, 2 * m_current.queue_depth)) {
+        double const seconds = std::max(std::chrono::duration<double>(t - m_epochStart).count(), 1e-9);
+        double const throughput = static_cast<double>(m_epochBytes) / seconds;
+        m_epochStart = t;
+        m_epochCompletions = 1;
+        m_epochBytes = 0;
+        finishEpoch(throughput);
+    }
+}
+
+void IoAutotuner::restartMeasurement() {
+    m_warmupCompletions = 0;
+    m_epochCompletions = 0;
+    m_epochBytes = 0;
+}
+
+std::size_t IoAutotuner::chunkSize() const noexcept {
+    return m_current.chunk_size;
+}
+
+uint32_t IoAutotuner::queueDepth() const noexcept {
+    return m_current.queue_depth;
+}
+
+uint32_t IoAutotuner::bandwidthMiBs() const noexcept {
+    return static_cast<uint32_t>(m_lastThroughput / 1'048'576.0);
+}
+
+std::chrono::nanoseconds IoAutotuner::averageLatency() const {
+    return m_latency.rollingAverage();
+}
+
+void IoAutotuner::finishEpoch(double throughput) {
+    m_lastThroughput = throughput;
+    switch (m_phase) {
+    case Phase::Baseline:
+        m_baselineThroughput = throughput;
+        startProbe();
+        break;
+    case Phase::Probe: {
+        bool const is_reduction = (m_current.chunk_size <= m_accepted.chunk_size) &&
+                                  (m_current.queue_depth <= m_accepted.queue_depth);
+        if ((throughput > m_baselineThroughput * (1.0 + GAIN_THRESHOLD)) ||
+            (is_reduction && (throughput >= m_baselineThroughput * (1.0 - LOSS_TOLERANCE))))
+        {
+            // keep going in the same direction; the baseline is not lowered by
+            // reductions, so that small losses cannot add up over several steps
+            m_accepted = m_current;
+            m_baselineThroughput = std::max(m_baselineThroughput, throughput);
+            m_failedProbes = 0;
+            startProbe();
+        } else {
+            ++m_failedProbes;
+            m_nextProbe = (m_nextProbe + 1) % Probe::NumberOfProbes;
+            // measure the accepted setting again, in case the storage has changed
+            m_phase = Phase::Baseline;
+            changeSetting(m_accepted);
+        }
+    } break;
+    case Phase::Settled:
+        ++m_settledEpochs;
+        if ((throughput < m_baselineThroughput * (1.0 - DROP_THRESHOLD)) || (m_settledEpochs >= SETTLED_EPOCHS)) {
+            m_baselineThroughput = throughput;
+            m_failedProbes = 0;
+            startProbe();
+        }
+        break;
+    }
+}
+
+void IoAutotuner::startProbe() {
+    while (m_failedProbes < Probe::NumberOfProbes) {
+        Setting s = m_accepted;
+        switch (m_nextProbe) {
+        case Probe::ChunkUp:
+            // larger reads would only push the latency over the limit
+            if (m_latency.rollingAverage() * 2 <= LATENCY_LIMIT) {
+                s.chunk_size = std::min(s.chunk_size * 2, m_bounds.max_chunk_size);
+                if (s.chunk_size * s.queue_depth > m_bounds.max_bytes_in_flight) {
+                    // trade reads in flight for larger reads
+                    s.queue_depth = std::max(s.queue_depth / 2, m_bounds.min_queue_depth);
+                }
+            }
+            break;
+        case Probe::DepthUp:
+            s.queue_depth = std::min(s.queue_depth * 2, m_bounds.max_queue_depth);
+            if (s.chunk_size * s.queue_depth > m_bounds.max_bytes_in_flight) {
+                // trade read size for more reads in flight
+                s.chunk_size = std::max(s.chunk_size / 2, m_bounds.min_chunk_size);
+            }
+            break;
+        case Probe::ChunkDown:
+            s.chunk_size = std::max(s.chunk_size / 2, m_bounds.min_chunk_size);
+            break;
+        case Probe::DepthDown:
+            s.queue_depth = std::max(s.queue_depth / 2, m_bounds.min_queue_depth);
+            break;
+        }
+        if (s.chunk_size * s.queue_depth > m_bounds.max_bytes_in_flight) {
+            // no way to fit the memory budget in this direction
+            s = m_accepted;
+        }
+        if ((s.chunk_size != m_accepted.chunk_size) || (s.queue_depth != m_accepted.queue_depth)) {
+            m_phase = Phase::Probe;
+            changeSetting(s);
+            return;
+        }
+        // already at the bound in this direction
+        ++m_failedProbes;
+        m_nextProbe = (m_nextProbe + 1) % Probe::NumberOfProbes;
+    }
+    m_phase = Phase::Settled;
+    m_settledEpochs = 0;
+}
+
+void IoAutotuner::changeSetting(Setting const& s) {
+    // the reads in flight were issued with the previous setting
+    m_warmupCompletions = std::max(m_current.queue_depth, s.queue_depth);
+    m_current = s;
+    m_epochCompletions = 0;
+    m_epochBytes = 0;
+    m_latency = {};
+}
+
+}
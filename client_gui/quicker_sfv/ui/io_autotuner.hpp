@@ -0,0 +1,146 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_GUI_UI_IO_AUTOTUNER_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_GUI_UI_IO_AUTOTUNER_HPP
+
+#include <quicker_sfv/ui/sliding_window.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace quicker_sfv::gui {
+
+/** Bounds within which an IoAutotuner may adjust the file reads.
+ */
+struct IoAutotunerOptions {
+    static constexpr std::size_t const DEFAULT_MIN_CHUNK_SIZE = 64 << 10;
+    static constexpr std::size_t const DEFAULT_MAX_CHUNK_SIZE = 8 << 20;
+    static constexpr uint32_t const DEFAULT_MIN_QUEUE_DEPTH = 1;
+    static constexpr uint32_t const DEFAULT_MAX_QUEUE_DEPTH = 16;
+    static constexpr std::size_t const DEFAULT_MAX_BYTES_IN_FLIGHT = 32 << 20;
+
+    std::size_t min_chunk_size;     ///< Smallest size in bytes of an individual read.
+    std::size_t max_chunk_size;     ///< Largest size in bytes of an individual read.
+    uint32_t min_queue_depth;       ///< Smallest number of reads in flight.
+    uint32_t max_queue_depth;       ///< Largest number of reads in flight.
+    std::size_t max_bytes_in_flight;    ///< Largest product of chunk size and queue depth.
+                                        ///  Bounds the memory needed for the read buffers.
+};
+
+/** Feedback controller for the size and the number of outstanding reads when hashing files.
+ * No single setting works well for all kinds of storage: A hard disk wants few large
+ * reads, an NVMe drive only reaches its bandwidth with many reads in flight, and a
+ * network share needs enough data in flight to cover its latency. The IoAutotuner
+ * finds a good setting at runtime, by hill climbing on the throughput achieved by
+ * the reads reported to it.
+ *
+ * The completions are measured in epochs. After each epoch, the controller tries
+ * doubling or halving either the chunk size or the queue depth, and keeps the change
+ * if it improves throughput noticeably. Where an increase would exceed the memory
+ * budget, the other dimension is halved in exchange. Changes that reduce the
+ * resources in use are kept as long as throughput does not drop. Once no change yields an improvement,
+ * the setting is kept for a while before probing resumes, unless throughput drops
+ * significantly in the meantime. The chunk size is reduced whenever the average
+ * latency of a read exceeds a limit, so that progress and cancellation stay responsive
+ * on slow storage.
+ *
+ * Readers query chunkSize() and queueDepth() whenever they issue new reads. As the
+ * state carries over from one file to the next, a single IoAutotuner should be used
+ * for all files on the same storage device.
+ */
+class IoAutotuner {
+public:
+    using Clock = std::chrono::steady_clock;
+private:
+    struct Setting {
+        std::size_t chunk_size;
+        uint32_t queue_depth;
+    };
+    enum class Phase {
+        Baseline,           ///< Measuring the accepted setting.
+        Probe,              ///< Measuring a modification of the accepted setting.
+        Settled,            ///< No modification improved on the accepted setting.
+    };
+    IoAutotunerOptions m_bounds;
+    Setting m_current;                  ///< Setting in use.
+    Setting m_accepted;                 ///< Best setting known.
+    Phase m_phase;
+    uint32_t m_nextProbe;               ///< Index of the next modification to try.
+    uint32_t m_failedProbes;            ///< Number of modifications rejected in a row.
+    uint32_t m_settledEpochs;           ///< Number of epochs spent in Phase::Settled.
+    double m_baselineThroughput;        ///< Throughput of m_accepted in bytes per second.
+    double m_lastThroughput;            ///< Throughput of the last epoch in bytes per second.
+    uint32_t m_warmupCompletions;       ///< Completions to skip before measuring, as
+                                        ///  they were issued with the previous setting.
+    uint32_t m_epochCompletions;
+    int64_t m_epochBytes;
+    Clock::time_point m_epochStart;
+    SlidingWindow<std::chrono::nanoseconds, 16> m_latency;
+public:
+    /** Constructor.
+     * @param[in] bounds Bounds for adjusting the reads.
+     * @param[in] initial_chunk_size Chunk size to start out with. Clamped to the bounds.
+     * @param[in] initial_queue_depth Queue depth to start out with. Clamped to the bounds;
+     *                                reduced first if the setting exceeds max_bytes_in_flight.
+     * @throw Exception Error::Failed if the bounds are empty or contain 0, or if
+     *                  max_bytes_in_flight is less than min_chunk_size * min_queue_depth.
+     */
+    IoAutotuner(IoAutotunerOptions const& bounds, std::size_t initial_chunk_size, uint32_t initial_queue_depth);
+
+    /** Reports a completed read.
+     * Only reads that returned all requested bytes should be reported, as short reads
+     * at the end of a file do not tell anything about the storage.
+     * @param[in] bytes Size of the read in bytes.
+     * @param[in] latency Time between issuing the read and its completion.
+     * @param[in] t Time point of the completion.
+     */
+    void addCompletion(std::size_t bytes, std::chrono::nanoseconds latency, Clock::time_point t);
+
+    /** Discards the measurements of the current epoch.
+     * To be called before reading a new file, as the time spent between files would
+     * otherwise count against the throughput of the storage.
+     */
+    void restartMeasurement();
+
+    /** Size in bytes to use for new reads.
+     */
+    [[nodiscard]] std::size_t chunkSize() const noexcept;
+
+    /** Number of reads to keep in flight.
+     */
+    [[nodiscard]] uint32_t queueDepth() const noexcept;
+
+    /** Throughput measured over the last epoch in MiB/s, or 0 if no epoch has completed yet.
+     */
+    [[nodiscard]] uint32_t bandwidthMiBs() const noexcept;
+
+    /** Average latency of the most recent reads.
+     */
+    [[nodiscard]] std::chrono::nanoseconds averageLatency() const;
+private:
+    void finishEpoch(double throughput);
+    void startProbe();
+    void changeSetting(Setting const& s);
+};
+
+}
+
+#endif
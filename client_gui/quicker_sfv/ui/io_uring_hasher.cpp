@@ -0,0 +1,505 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/io_uring_hasher.hpp>
+
+#include <quicker_sfv/error.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <optional>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace quicker_sfv::gui {
+
+namespace {
+/// user_data of the poll request waiting for the CancelEvent.
+constexpr uint64_t const CANCEL_POLL_TAG = std::numeric_limits<uint64_t>::max();
+/// user_data of the request removing the cancel poll.
+constexpr uint64_t const CANCEL_REMOVE_TAG = CANCEL_POLL_TAG - 1;
+
+int sysIoUringSetup(unsigned entries, io_uring_params* p) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sysIoUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int sysIoUringRegister(int fd, unsigned opcode, void const* arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+}
+
+/** Minimal io_uring without SQ polling.
+ * The ring memory is shared with the kernel; the head and tail indices are
+ * accessed with acquire/release semantics as required by the io_uring ABI.
+ */
+struct IoUringHasher::Ring {
+    int fd = -1;
+    void* sq_ring = MAP_FAILED;
+    std::size_t sq_ring_size = 0;
+    void* cq_ring = MAP_FAILED;
+    std::size_t cq_ring_size = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    std::size_t sqes_size = 0;
+
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned cq_mask;
+    io_uring_cqe* cqes;
+    unsigned to_submit = 0;
+
+    explicit Ring(unsigned entries) {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        fd = sysIoUringSetup(entries, &p);
+        if (fd < 0) { throwException(Error::SystemError); }
+        sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        bool const single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) { sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size); }
+        sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sq_ring == MAP_FAILED) { release(); throwException(Error::SystemError); }
+        if (single_mmap) {
+            cq_ring = sq_ring;
+        } else {
+            cq_ring = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cq_ring == MAP_FAILED) { release(); throwException(Error::SystemError); }
+        }
+        sqes_size = p.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) { release(); throwException(Error::SystemError); }
+
+        auto const sq_field = [this](uint32_t offset) { return reinterpret_cast<unsigned*>(static_cast<char*>(sq_ring) + offset); };
+        auto const cq_field = [this](uint32_t offset) { return reinterpret_cast<unsigned*>(static_cast<char*>(cq_ring) + offset); };
+        sq_head = sq_field(p.sq_off.head);
+        sq_tail = sq_field(p.sq_off.tail);
+        sq_mask = *sq_field(p.sq_off.ring_mask);
+        sq_entries = p.sq_entries;
+        sq_array = sq_field(p.sq_off.array);
+        cq_head = cq_field(p.cq_off.head);
+        cq_tail = cq_field(p.cq_off.tail);
+        cq_mask = *cq_field(p.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(static_cast<char*>(cq_ring) + p.cq_off.cqes);
+    }
+
+    ~Ring() {
+        release();
+    }
+
+    Ring& operator=(Ring&&) = delete;
+
+    void release() noexcept {
+        if (sqes != MAP_FAILED) { munmap(sqes, sqes_size); }
+        if ((cq_ring != MAP_FAILED) && (cq_ring != sq_ring)) { munmap(cq_ring, cq_ring_size); }
+        if (sq_ring != MAP_FAILED) { munmap(sq_ring, sq_ring_size); }
+        if (fd >= 0) { ::close(fd); }
+    }
+
+    /** Retrieves the next free submission queue entry.
+     * Callers must never have more requests in flight than the ring has entries.
+     */
+    io_uring_sqe* nextSqe() noexcept {
+        unsigned const tail = *sq_tail;
+        unsigned const head = std::atomic_ref<unsigned>(*sq_head).load(std::memory_order_acquire);
+        if (tail - head >= sq_entries) { return nullptr; }
+        unsigned const index = tail & sq_mask;
+        io_uring_sqe* const sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(io_uring_sqe));
+        sq_array[index] = index;
+        std::atomic_ref<unsigned>(*sq_tail).store(tail + 1, std::memory_order_release);
+        ++to_submit;
+        return sqe;
+    }
+
+    /** Submits all queued entries and waits for at least min_complete completions.
+     * @throw Exception Error::SystemError if the kernel rejects the request.
+     */
+    void submitAndWait(unsigned min_complete) {
+        for (;;) {
+            int const res = sysIoUringEnter(fd, to_submit, min_complete, IORING_ENTER_GETEVENTS);
+            if (res >= 0) {
+                to_submit -= std::min(to_submit, static_cast<unsigned>(res));
+                return;
+            }
+            if (errno != EINTR) { throwException(Error::SystemError); }
+        }
+    }
+
+    struct Completion {
+        uint64_t user_data;
+        int32_t res;
+    };
+    /** Removes the next completion from the completion queue, if there is one.
+     */
+    std::optional<Completion> popCqe() noexcept {
+        unsigned const head = *cq_head;
+        if (head == std::atomic_ref<unsigned>(*cq_tail).load(std::memory_order_acquire)) { return std::nullopt; }
+        io_uring_cqe const& cqe = cqes[head & cq_mask];
+        Completion const ret{ .user_data = cqe.user_data, .res = cqe.res };
+        std::atomic_ref<unsigned>(*cq_head).store(head + 1, std::memory_order_release);
+        return ret;
+    }
+};
+
+/** State of one read buffer.
+ * Slots are used round-robin, so that the file order of the data is the order of
+ * the slots, starting at the oldest slot.
+ */
+struct IoUringHasher::Slot {
+    int64_t offset;         ///< File offset of the chunk.
+    uint32_t length;        ///< Size of the chunk in bytes.
+    uint32_t filled;        ///< Number of bytes of the chunk already read.
+    int32_t result;         ///< Result of the last completed read.
+    bool active;            ///< The slot holds a chunk that has not been hashed completely.
+    bool pending;           ///< A read for the slot is in flight.
+    bool measured;          ///< The chunk has the full chunk size, so its completion is
+                            ///  reported to the autotuner.
+    std::chrono::steady_clock::time_point issued;   ///< Time point of the first read.
+};
+
+/** Recipients of the data read from the file.
+ */
+struct IoUringHasher::HashTarget {
+    Hasher& hasher;
+    BlockDigestBuilder* block_builder;
+    HashProgressTracker& progress;
+};
+
+enum class IoUringHasher::ReadOutcome {
+    Completed,              ///< The entire range was read and hashed.
+    EndOfFile,              ///< The file ended before the end of the range.
+    Canceled,               ///< The CancelEvent was signaled.
+    Error,                  ///< A read failed.
+    DirectIoRejected,       ///< A direct read was rejected by the file system.
+};
+
+namespace {
+/** Sets O_DIRECT on a file for the lifetime of the object.
+ */
+class DirectIoMode {
+private:
+    int m_fd;
+    int m_originalFlags;
+    bool m_enabled;
+public:
+    explicit DirectIoMode(int fd) noexcept
+        :m_fd(fd), m_originalFlags(fcntl(fd, F_GETFL)), m_enabled(false)
+    {
+        // file systems without support for direct I/O reject the flag with EINVAL
+        m_enabled = (m_originalFlags >= 0) && (fcntl(fd, F_SETFL, m_originalFlags | O_DIRECT) == 0);
+    }
+
+    ~DirectIoMode() {
+        disable();
+    }
+
+    DirectIoMode& operator=(DirectIoMode&&) = delete;
+
+    [[nodiscard]] bool isEnabled() const noexcept {
+        return m_enabled;
+    }
+
+    void disable() noexcept {
+        if (m_enabled) {
+            fcntl(m_fd, F_SETFL, m_originalFlags);
+            m_enabled = false;
+        }
+    }
+};
+
+/** Maximum number of reads in flight; with autotuning, the upper bound of the tuner.
+ */
+uint32_t checkedQueueDepth(IoUringOptions const& opts) {
+    uint32_t const queue_depth = opts.autotune ? opts.autotune->max_queue_depth : opts.queue_depth;
+    std::size_t const chunk_size = opts.autotune ? opts.autotune->max_chunk_size : opts.chunk_size;
+    if ((queue_depth == 0) || (queue_depth > IoUringOptions::MAX_QUEUE_DEPTH) ||
+        (chunk_size > std::numeric_limits<int32_t>::max() - AlignedBufferPool::ALIGNMENT))
+    {
+        throwException(Error::Failed);
+    }
+    return queue_depth;
+}
+}
+
+IoUringHasher::IoUringHasher(IoUringOptions const& opts)
+    :m_queueDepth(checkedQueueDepth(opts)),
+     m_buffers(m_queueDepth, opts.autotune ? opts.autotune->max_chunk_size : opts.chunk_size),
+     m_fixedBuffers(false), m_directIo(opts.direct_io), m_usedDirectIo(false)
+{
+    if (opts.autotune) { m_autotuner.emplace(*opts.autotune, opts.chunk_size, opts.queue_depth); }
+    // one entry per read, plus the cancel poll and its removal
+    m_ring = std::make_unique<Ring>(m_queueDepth + 2);
+    std::vector<iovec> iovecs(m_queueDepth);
+    for (uint32_t i = 0; i < m_queueDepth; ++i) {
+        std::span<std::byte> const b = m_buffers.buffer(i);
+        iovecs[i] = iovec{ .iov_base = b.data(), .iov_len = b.size() };
+    }
+    // registration may fail if the buffers exceed the locked memory limit;
+    // plain reads work just as well, only with a little more overhead per read
+    m_fixedBuffers = (sysIoUringRegister(m_ring->fd, IORING_REGISTER_BUFFERS, iovecs.data(), m_queueDepth) == 0);
+    m_slots.resize(m_queueDepth);
+}
+
+IoUringHasher::~IoUringHasher() = default;
+
+bool IoUringHasher::isSupported() noexcept {
+    static bool const is_supported = []() {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        int const fd = sysIoUringSetup(1, &p);
+        if (fd < 0) { return false; }
+        ::close(fd);
+        return true;
+    }();
+    return is_supported;
+}
+
+bool IoUringHasher::hasFixedBuffers() const noexcept {
+    return m_fixedBuffers;
+}
+
+bool IoUringHasher::usedDirectIo() const noexcept {
+    return m_usedDirectIo;
+}
+
+IoAutotuner const* IoUringHasher::autotuner() const noexcept {
+    return m_autotuner ? &(*m_autotuner) : nullptr;
+}
+
+HashResult IoUringHasher::hashFile(HashProgressCallback const& on_progress, Hasher& hasher,
+                                   int fd, int64_t data_offset, int64_t data_size, CancelEvent const& cancel,
+                                   std::span<std::byte const> resume_state,
+                                   BlockDigestBuilder* block_builder) {
+    m_usedDirectIo = false;
+    if (resume_state.empty()) {
+        hasher.reset();
+    } else {
+        hasher.restoreState(resume_state);
+    }
+    if (data_size <= 0) { return HashResult::DigestReady; }
+    if (m_autotuner) { m_autotuner->restartMeasurement(); }
+
+    HashProgressTracker progress(data_size, on_progress);
+    HashTarget target{ .hasher = hasher, .block_builder = block_builder, .progress = progress };
+    int64_t const data_end = data_offset + data_size;
+    int64_t position = data_offset;
+    auto const toHashResult = [](ReadOutcome o) {
+        return (o == ReadOutcome::Canceled) ? HashResult::Canceled : HashResult::Error;
+    };
+
+    int64_t const direct_end = AlignedBufferPool::alignDown(data_end);
+    if (m_directIo && (AlignedBufferPool::alignDown(data_offset) < direct_end)) {
+        DirectIoMode direct(fd);
+        if (direct.isEnabled()) {
+            m_usedDirectIo = true;
+            ReadOutcome const res = readRange(target, fd, AlignedBufferPool::alignDown(position), direct_end,
+                                              true, cancel, position);
+            if (res == ReadOutcome::EndOfFile) { return HashResult::DigestReady; }
+            if (res == ReadOutcome::DirectIoRejected) {
+                // continue through the page cache from where the direct reads stopped
+                m_usedDirectIo = false;
+            } else if (res != ReadOutcome::Completed) {
+                return toHashResult(res);
+            }
+        }
+    }
+    // everything that was not read directly, including the unaligned tail
+    if (position < data_end) {
+        ReadOutcome const res = readRange(target, fd, position, data_end, false, cancel, position);
+        if ((res != ReadOutcome::Completed) && (res != ReadOutcome::EndOfFile)) { return toHashResult(res); }
+    }
+    return HashResult::DigestReady;
+}
+
+IoUringHasher::ReadOutcome IoUringHasher::readRange(HashTarget& target, int fd, int64_t read_begin, int64_t read_end,
+                                                    bool direct, CancelEvent const& cancel, int64_t& position) {
+    Ring& ring = *m_ring;
+    int64_t next_offset = read_begin;
+    uint32_t in_flight = 0;
+    uint32_t head = 0;          // slot of the oldest active chunk
+    uint32_t tail = 0;          // slot for the next chunk
+    uint32_t active = 0;        // number of active slots
+    bool cancel_poll_pending = false;
+    bool cancel_remove_pending = false;
+
+    auto const issueRead = [&](uint32_t slot_index) {
+        Slot& s = m_slots[slot_index];
+        io_uring_sqe* const sqe = ring.nextSqe();
+        sqe->opcode = m_fixedBuffers ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe->fd = fd;
+        sqe->off = static_cast<uint64_t>(s.offset + s.filled);
+        sqe->addr = reinterpret_cast<uint64_t>(m_buffers.buffer(slot_index).data() + s.filled);
+        sqe->len = s.length - s.filled;
+        sqe->buf_index = static_cast<uint16_t>(m_fixedBuffers ? slot_index : 0);
+        sqe->user_data = slot_index;
+        s.pending = true;
+        ++in_flight;
+    };
+    auto const startChunk = [&](uint32_t slot_index) {
+        // the buffer size is aligned, so aligning the tuned size never exceeds it
+        int64_t const chunk_size = m_autotuner ?
+            AlignedBufferPool::alignUp(static_cast<int64_t>(std::min(m_autotuner->chunkSize(), m_buffers.bufferSize()))) :
+            static_cast<int64_t>(m_buffers.bufferSize());
+        uint32_t const length = static_cast<uint32_t>(std::min(chunk_size, read_end - next_offset));
+        m_slots[slot_index] = Slot{ .offset = next_offset, .length = length, .filled = 0, .result = 0,
+                                    .active = true, .pending = false, .measured = (length == chunk_size),
+                                    .issued = std::chrono::steady_clock::now() };
+        next_offset += length;
+        issueRead(slot_index);
+    };
+    auto const fillQueue = [&]() {
+        uint32_t const queue_depth = m_autotuner ? m_autotuner->queueDepth() : m_queueDepth;
+        // the queue depth never exceeds the number of slots, so the tail slot is always free
+        while ((active < queue_depth) && (next_offset < read_end)) {
+            startChunk(tail);
+            tail = (tail + 1) % m_queueDepth;
+            ++active;
+        }
+    };
+    auto const reapCompletions = [&]() -> bool {
+        bool canceled = false;
+        while (std::optional<Ring::Completion> const cqe = ring.popCqe()) {
+            if (cqe->user_data == CANCEL_POLL_TAG) {
+                cancel_poll_pending = false;
+                // a removed poll completes with -ECANCELED or -ENOENT
+                if (cqe->res >= 0) { canceled = true; }
+            } else if (cqe->user_data == CANCEL_REMOVE_TAG) {
+                cancel_remove_pending = false;
+            } else {
+                Slot& s = m_slots[cqe->user_data];
+                s.pending = false;
+                s.result = cqe->res;
+                --in_flight;
+            }
+        }
+        return canceled;
+    };
+    // outstanding reads write into our buffers, so they have to complete before returning
+    auto const drain = [&]() {
+        if (cancel_poll_pending && !cancel_remove_pending) {
+            io_uring_sqe* const sqe = ring.nextSqe();
+            sqe->opcode = IORING_OP_POLL_REMOVE;
+            sqe->fd = -1;
+            sqe->addr = CANCEL_POLL_TAG;
+            sqe->user_data = CANCEL_REMOVE_TAG;
+            cancel_remove_pending = true;
+        }
+        while ((in_flight > 0) || cancel_poll_pending || cancel_remove_pending) {
+            ring.submitAndWait(1);
+            reapCompletions();
+        }
+        for (Slot& s : m_slots) { s.active = false; }
+    };
+
+    fillQueue();
+    {
+        io_uring_sqe* const sqe = ring.nextSqe();
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = cancel.fd();
+        sqe->poll32_events = POLLIN;
+        sqe->user_data = CANCEL_POLL_TAG;
+        cancel_poll_pending = true;
+    }
+
+    ReadOutcome ret = ReadOutcome::Completed;
+    try {
+        while ((ret == ReadOutcome::Completed) && m_slots[head].active) {
+            ring.submitAndWait(1);
+            // cancellation has to be checked first, or it will get starved by completing i/os
+            if (reapCompletions()) {
+                ret = ReadOutcome::Canceled;
+                break;
+            }
+            // hash all data that is available in file order
+            while (m_slots[head].active && !m_slots[head].pending) {
+                Slot& s = m_slots[head];
+                if (s.result < 0) {
+                    if ((s.result == -EAGAIN) || (s.result == -EINTR)) {
+                        issueRead(head);
+                    } else if (direct && (s.result == -EINVAL)) {
+                        ret = ReadOutcome::DirectIoRejected;
+                    } else {
+                        ret = ReadOutcome::Error;
+                    }
+                    break;
+                }
+                if (s.result == 0) {
+                    // file ended before the end of the range
+                    ret = ReadOutcome::EndOfFile;
+                    break;
+                }
+                int64_t const chunk_begin = s.offset + s.filled;
+                s.filled += static_cast<uint32_t>(s.result);
+                // only the first chunk of a widened direct range starts before position
+                int64_t const skip = std::clamp<int64_t>(position - chunk_begin, 0, s.result);
+                std::span<std::byte const> const data(m_buffers.buffer(head).data() + (chunk_begin - s.offset) + skip,
+                                                      static_cast<std::size_t>(s.result - skip));
+                if (!data.empty()) {
+                    target.hasher.addData(data);
+                    if (target.block_builder) { target.block_builder->addData(data); }
+                    target.progress.addChunk(data.size());
+                    position += static_cast<int64_t>(data.size());
+                }
+                if (s.filled < s.length) {
+                    if (direct && ((s.filled % AlignedBufferPool::ALIGNMENT) != 0)) {
+                        // direct reads only return short of a block at the end of the file
+                        ret = ReadOutcome::EndOfFile;
+                        break;
+                    }
+                    // short read; fetch the remainder of the chunk before moving on
+                    issueRead(head);
+                    break;
+                }
+                if (m_autotuner && s.measured) {
+                    auto const now = std::chrono::steady_clock::now();
+                    m_autotuner->addCompletion(s.length, now - s.issued, now);
+                }
+                s.active = false;
+                --active;
+                head = (head + 1) % m_queueDepth;
+                fillQueue();
+            }
+        }
+    } catch (...) {
+        drain();
+        throw;
+    }
+    drain();
+    return ret;
+}
+
+}
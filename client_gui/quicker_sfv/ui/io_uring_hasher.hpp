@@ -0,0 +1,164 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_GUI_UI_IO_URING_HASHER_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_GUI_UI_IO_URING_HASHER_HPP
+
+#include <quicker_sfv/ui/aligned_buffer_pool.hpp>
+#include <quicker_sfv/ui/file_hashing_linux.hpp>
+#include <quicker_sfv/ui/io_autotuner.hpp>
+
+#include <quicker_sfv/block_digests.hpp>
+#include <quicker_sfv/hasher.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace quicker_sfv::gui {
+
+/** Options for IoUringHasher.
+ */
+struct IoUringOptions {
+    static constexpr uint32_t const DEFAULT_QUEUE_DEPTH = 8;
+    static constexpr std::size_t const DEFAULT_CHUNK_SIZE = 1 << 20;
+    static constexpr uint32_t const MAX_QUEUE_DEPTH = 256;
+
+    uint32_t queue_depth;           ///< Maximum number of reads in flight for a file.
+                                    ///  Must be between 1 and MAX_QUEUE_DEPTH.
+    std::size_t chunk_size;         ///< Size in bytes of the individual reads. Rounded
+                                    ///  up to a multiple of AlignedBufferPool::ALIGNMENT.
+    bool direct_io;                 ///< Read files with O_DIRECT, bypassing the page cache.
+    std::optional<IoAutotunerOptions> autotune; ///< If set, the queue depth and chunk size
+                                    ///  are adjusted at runtime within these bounds,
+                                    ///  starting out from queue_depth and chunk_size.
+                                    ///  max_queue_depth must not exceed MAX_QUEUE_DEPTH.
+};
+
+/** Hashes files on Linux by reading them through an io_uring.
+ * All reads for a file are issued to the kernel ahead of time, up to the configured
+ * queue depth, so that fast storage is kept busy while the Hasher is consuming the
+ * data. Each read targets its own buffer. The buffers are registered with the ring
+ * as fixed buffers if the kernel permits this, which saves mapping them for every
+ * single read. Completions may arrive in any order, but the data is always passed
+ * to the Hasher in file order.
+ *
+ * Cancellation is waited for on the same ring as the reads, so that a signaled
+ * CancelEvent interrupts the hashing promptly even while reads are outstanding.
+ *
+ * In direct I/O mode, files are read with O_DIRECT, so that hashing large amounts
+ * of data does not evict everything else from the page cache and no copy through
+ * the cache is made. Direct reads must be aligned, so the data segment is widened
+ * to block boundaries at its start and the surplus bytes are skipped. The unaligned
+ * tail at the end of the segment is read through the page cache. Files on file
+ * systems that do not support O_DIRECT are read through the page cache entirely.
+ *
+ * With autotuning, an IoAutotuner adjusts the queue depth and chunk size based on
+ * the throughput of the completed reads. Buffers are set up for the upper bounds,
+ * but as they are only backed by memory once touched, unused buffers are cheap.
+ *
+ * An IoUringHasher is meant to be reused for all files hashed by a single worker
+ * thread. It must not be used from multiple threads concurrently.
+ */
+class IoUringHasher {
+private:
+    struct Ring;
+    struct Slot;
+    struct HashTarget;
+    enum class ReadOutcome;
+    uint32_t m_queueDepth;          ///< Maximum number of reads in flight.
+    AlignedBufferPool m_buffers;    ///< One buffer for each read in flight.
+    std::unique_ptr<Ring> m_ring;   ///< Declared after m_buffers, as the buffers
+                                    ///  must outlive their registration.
+    bool m_fixedBuffers;
+    bool m_directIo;
+    bool m_usedDirectIo;
+    std::vector<Slot> m_slots;
+    std::optional<IoAutotuner> m_autotuner;
+public:
+    /** Constructor.
+     * @param[in] opts Options for the hasher.
+     * @throw Exception Error::Failed if the options are out of range.
+     *                  Error::SystemError if the io_uring cannot be set up.
+     */
+    explicit IoUringHasher(IoUringOptions const& opts);
+    ~IoUringHasher();
+    IoUringHasher& operator=(IoUringHasher&&) = delete;
+
+    /** Checks whether the running kernel supports io_uring.
+     * io_uring can be unavailable on old kernels or be blocked by a sandbox.
+     */
+    [[nodiscard]] static bool isSupported() noexcept;
+
+    /** Checks whether the read buffers could be registered with the kernel.
+     */
+    [[nodiscard]] bool hasFixedBuffers() const noexcept;
+
+    /** Checks whether the last call to hashFile() bypassed the page cache.
+     * This is only ever true in direct I/O mode and if the file system of the last
+     * hashed file supports O_DIRECT.
+     */
+    [[nodiscard]] bool usedDirectIo() const noexcept;
+
+    /** The IoAutotuner adjusting the reads, or null if autotuning is disabled.
+     */
+    [[nodiscard]] IoAutotuner const* autotuner() const noexcept;
+
+    /** Computes the checksum for a data segment of a file.
+     * The semantics match those of the Win32 OperationScheduler::hashFile():
+     * Progress is reported whenever the percentage changes. A file that ends before
+     * the end of the segment is hashed up to its end.
+     * @param[in] on_progress Receives progress updates. May be empty.
+     * @param[in] hasher Hasher to carry out the computation of the checksum.
+     * @param[in] fd File descriptor of the file to be hashed, opened for reading
+     *               without O_DIRECT. In direct I/O mode, O_DIRECT is set on the
+     *               file for the duration of the call.
+     * @param[in] data_offset The offset in bytes from the start of the file where
+     *                        the relevant data segment starts.
+     * @param[in] data_size The size of the data segment in bytes.
+     * @param[in] cancel Hashing stops with HashResult::Canceled once this event is
+     *                   signaled.
+     * @param[in] resume_state If not empty, the hasher is restored to this state
+     *                         obtained from Hasher::saveState() instead of being
+     *                         reset before hashing.
+     * @param[in] block_builder If not null, all hashed data is also passed to this
+     *                          BlockDigestBuilder.
+     * @return HashResult::Error if a read failed.
+     * @throw Exception Error::SystemError if waiting on the io_uring fails.
+     *                  Any exception raised by the hasher.
+     */
+    HashResult hashFile(HashProgressCallback const& on_progress, Hasher& hasher,
+                        int fd, int64_t data_offset, int64_t data_size, CancelEvent const& cancel,
+                        std::span<std::byte const> resume_state = {},
+                        BlockDigestBuilder* block_builder = nullptr);
+private:
+    /** Reads and hashes the file range [read_begin, read_end).
+     * Data before position is read, but not hashed.
+     * @param[in,out] position The offset of the next byte to be hashed.
+     */
+    ReadOutcome readRange(HashTarget& target, int fd, int64_t read_begin, int64_t read_end,
+                          bool direct, CancelEvent const& cancel, int64_t& position);
+};
+
+}
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/mmap_hasher.hpp>
+
+#include <quicker_sfv/error.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace quicker_sfv::gui {
+
+namespace {
+/// Size of the slices in which mapped data is passed to the hasher. Bounds the
+/// delay for noticing cancellation and the granularity of progress updates.
+constexpr std::size_t const HASH_SLICE_SIZE = 1 << 20;
+/// Mappings aligned to this size may be backed by transparent huge pages.
+constexpr int64_t const HUGE_PAGE_SIZE = 2 << 20;
+
+int64_t pageSize() noexcept {
+    static int64_t const page_size = sysconf(_SC_PAGESIZE);
+    return page_size;
+}
+
+/** Unmaps a mapped window when going out of scope.
+ */
+struct MappingGuard {
+    void* address;
+    std::size_t size;
+    ~MappingGuard() {
+        munmap(address, size);
+    }
+    MappingGuard& operator=(MappingGuard&&) = delete;
+};
+
+/** Outcome of passing a mapped window to the hasher.
+ */
+enum class WindowResult {
+    Done,
+    Canceled,
+    Shrunk,         ///< The file no longer covers the rest of the window.
+    Error,          ///< The size of the file could not be retrieved.
+};
+
+/** Passes mapped data to the hasher in slices.
+ * Before each slice, the size of the file is checked, so that a slice is never read
+ * from a part of the mapping that lies beyond the end of the file.
+ * @param[in] data_file_offset Offset of the first byte of data in the file.
+ */
+WindowResult hashMappedData(std::span<std::byte const> data, int fd, int64_t data_file_offset, Hasher& hasher,
+                            BlockDigestBuilder* block_builder, HashProgressTracker& progress, CancelEvent const& cancel)
+{
+    for (std::size_t offset = 0; offset < data.size(); offset += HASH_SLICE_SIZE) {
+        if (cancel.isSignaled()) { return WindowResult::Canceled; }
+        std::span<std::byte const> const slice = data.subspan(offset, std::min(HASH_SLICE_SIZE, data.size() - offset));
+        struct stat st;
+        if (fstat(fd, &st) != 0) { return WindowResult::Error; }
+        if (st.st_size < data_file_offset + static_cast<int64_t>(offset + slice.size())) { return WindowResult::Shrunk; }
+        hasher.addData(slice);
+        if (block_builder) { block_builder->addData(slice); }
+        progress.addChunk(slice.size());
+    }
+    return WindowResult::Done;
+}
+}
+
+MmapHasher::MmapHasher(MmapHasherOptions const& opts)
+    :m_windowSize(opts.window_size), m_populate(opts.populate)
+{
+    if (m_windowSize == 0) { throwException(Error::Failed); }
+    std::size_t const page_size = static_cast<std::size_t>(pageSize());
+    m_windowSize = (m_windowSize + page_size - 1) / page_size * page_size;
+}
+
+HashResult MmapHasher::hashFile(HashProgressCallback const& on_progress, Hasher& hasher,
+                                int fd, int64_t data_offset, int64_t data_size, CancelEvent const& cancel,
+                                std::span<std::byte const> resume_state,
+                                BlockDigestBuilder* block_builder) {
+    if (resume_state.empty()) {
+        hasher.reset();
+    } else {
+        hasher.restoreState(resume_state);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) { return HashResult::Error; }
+    // a file that ends before the end of the data segment is hashed up to its end
+    int64_t const data_end = std::min(data_offset + data_size, static_cast<int64_t>(st.st_size));
+    HashProgressTracker progress(data_size, on_progress);
+    int const map_flags = MAP_SHARED | (m_populate ? MAP_POPULATE : 0);
+    for (int64_t position = data_offset; position < data_end;) {
+        if (cancel.isSignaled()) { return HashResult::Canceled; }
+        // mappings have to start on a page boundary
+        int64_t const window_begin = position - (position % pageSize());
+        std::size_t const window_size = static_cast<std::size_t>(std::min(static_cast<int64_t>(m_windowSize), data_end - window_begin));
+        void* const p = mmap(nullptr, window_size, PROT_READ, map_flags, fd, window_begin);
+        if (p == MAP_FAILED) { return HashResult::Error; }
+        MappingGuard const guard{ .address = p, .size = window_size };
+        madvise(p, window_size, MADV_SEQUENTIAL);
+        if (window_size >= static_cast<std::size_t>(HUGE_PAGE_SIZE)) { madvise(p, window_size, MADV_HUGEPAGE); }
+        std::span<std::byte const> const window(static_cast<std::byte const*>(p), window_size);
+        WindowResult const res = hashMappedData(window.subspan(static_cast<std::size_t>(position - window_begin)),
+                                                fd, position, hasher, block_builder, progress, cancel);
+        if (res == WindowResult::Error) { return HashResult::Error; }
+        if (res == WindowResult::Canceled) { return HashResult::Canceled; }
+        if (res == WindowResult::Shrunk) {
+            // the file was truncated while it was being hashed; the mapping can no longer
+            // be accessed safely, so the data segment is hashed again with reads
+            if (block_builder) { static_cast<void>(block_builder->finalize()); }
+            std::vector<std::byte> buffer(HASH_SLICE_SIZE);
+            return hashFileWithReads(on_progress, hasher, fd, data_offset, data_size, cancel, buffer,
+                                     resume_state, block_builder);
+        }
+        position = window_begin + static_cast<int64_t>(window_size);
+    }
+    return HashResult::DigestReady;
+}
+
+}
@@ -0,0 +1,85 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_GUI_UI_MMAP_HASHER_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_GUI_UI_MMAP_HASHER_HPP
+
+#include <quicker_sfv/ui/file_hashing_linux.hpp>
+
+#include <quicker_sfv/block_digests.hpp>
+#include <quicker_sfv/hasher.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace quicker_sfv::gui {
+
+/** Options for MmapHasher.
+ */
+struct MmapHasherOptions {
+    static constexpr std::size_t const DEFAULT_WINDOW_SIZE = 256 << 20;
+
+    std::size_t window_size;        ///< Maximum number of bytes of a file that are mapped
+                                    ///  at once. Larger files are mapped window by window.
+    bool populate;                  ///< Map each window with MAP_POPULATE, so that all of its
+                                    ///  pages are mapped up front instead of on first access.
+};
+
+/** Hashes files on Linux by passing a memory mapping of their data to the Hasher.
+ * For data that is already in the page cache, this avoids copying every byte into
+ * a read buffer first. The data segment is mapped in windows of a bounded size, so
+ * that arbitrarily large files can be hashed within a fixed address space budget.
+ * Windows are advised for sequential access and for transparent huge pages, which
+ * reduces the number of page faults where the kernel supports huge pages for the
+ * page cache of the file.
+ *
+ * Accessing a mapping beyond the end of a file raises SIGBUS, which happens if the
+ * file is truncated while it is being hashed. The size of the file is therefore
+ * checked before each slice of mapped data is passed to the Hasher. If the file has
+ * shrunk into the data segment, the mapping is abandoned and the data segment is
+ * hashed again from its start with hashFileWithReads(). A file that is truncated in
+ * the short time while a single slice is being hashed will still raise SIGBUS, so
+ * the MmapHasher should only be used for files that are not expected to shrink.
+ */
+class MmapHasher {
+private:
+    std::size_t m_windowSize;
+    bool m_populate;
+public:
+    /** Constructor.
+     * @param[in] opts Options for the hasher.
+     * @throw Exception Error::Failed if the window size is 0.
+     */
+    explicit MmapHasher(MmapHasherOptions const& opts);
+
+    /** Computes the checksum for a data segment of a file.
+     * The parameters and semantics are the same as for IoUringHasher::hashFile().
+     * @return HashResult::Error if the file cannot be mapped.
+     * @throw Exception Any exception raised by the hasher.
+     */
+    HashResult hashFile(HashProgressCallback const& on_progress, Hasher& hasher,
+                        int fd, int64_t data_offset, int64_t data_size, CancelEvent const& cancel,
+                        std::span<std::byte const> resume_state = {},
+                        BlockDigestBuilder* block_builder = nullptr);
+};
+
+}
+
+#endif
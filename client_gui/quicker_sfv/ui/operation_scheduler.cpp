@@ -19,20 +19,60 @@
  */
 #include <quicker_sfv/ui/operation_scheduler.hpp>
 
+#include <quicker_sfv/ui/digest_cache_win32.hpp>
+#include <quicker_sfv/ui/ordered_task_pool.hpp>
+#include <quicker_sfv/ui/reorder_buffer.hpp>
 #include <quicker_sfv/ui/resource_guard.hpp>
 #include <quicker_sfv/ui/string_helper.hpp>
 #include <quicker_sfv/ui/user_messages.hpp>
 
+#include <quicker_sfv/checksum_file_update.hpp>
+#include <quicker_sfv/decompressing_file_input.hpp>
+#include <quicker_sfv/directory_digests.hpp>
+#include <quicker_sfv/hash_checkpoint.hpp>
+#include <quicker_sfv/stamp_file.hpp>
 #include <quicker_sfv/string_utilities.hpp>
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <expected>
 #include <generator>
+#include <memory>
 #include <numeric>
+#include <optional>
+#include <random>
+#include <thread>
+#include <utility>
 
 namespace quicker_sfv::gui {
 
+/// Chunk size and queue depth for the first reads, before the IoAutotuner has measured anything.
 static constexpr DWORD const HASH_FILE_BUFFER_SIZE = 4 << 20;
+static constexpr uint32_t const HASH_FILE_QUEUE_DEPTH = 2;
+/// Number of bytes before the end of a checkpoint that are hashed for its prefix guard.
+static constexpr uint64_t const CHECKPOINT_GUARD_SIZE = 64 << 10;
+
+/// Memory for the read buffers of all files hashed concurrently by an operation.
+static constexpr std::size_t const HASH_FILE_BUFFER_BUDGET = 64 << 20;
+
+/** Bounds for the IoAutotuner of each of n_workers threads hashing files concurrently.
+ * The threads share HASH_FILE_BUFFER_BUDGET evenly, but each gets at least enough for
+ * a single read of the smallest chunk size.
+ */
+static constexpr IoAutotunerOptions hashFileAutotuneBounds(uint32_t n_workers) {
+    std::size_t const budget = std::max(HASH_FILE_BUFFER_BUDGET / std::max(n_workers, 1u),
+                                        IoAutotunerOptions::DEFAULT_MIN_CHUNK_SIZE *
+                                            IoAutotunerOptions::DEFAULT_MIN_QUEUE_DEPTH);
+    return IoAutotunerOptions{
+        .min_chunk_size = IoAutotunerOptions::DEFAULT_MIN_CHUNK_SIZE,
+        .max_chunk_size = IoAutotunerOptions::DEFAULT_MAX_CHUNK_SIZE,
+        .min_queue_depth = IoAutotunerOptions::DEFAULT_MIN_QUEUE_DEPTH,
+        .max_queue_depth = static_cast<uint32_t>(std::min<std::size_t>(
+            budget / IoAutotunerOptions::DEFAULT_MIN_CHUNK_SIZE, IoAutotunerOptions::DEFAULT_MAX_QUEUE_DEPTH)),
+        .max_bytes_in_flight = budget,
+    };
+}
 
 namespace {
 class FileInputWin32 : public FileInput {
@@ -129,10 +169,18 @@ class FileOutputWin32 : public FileOutput {
 private:
     HANDLE m_fout;
 public:
-    FileOutputWin32(std::u16string const& filename)
+    enum class Mode {
+        Overwrite,
+        Append
+    };
+
+    FileOutputWin32(std::u16string const& filename, Mode mode = Mode::Overwrite)
     {
-        m_fout = CreateFile(toWcharStr(filename), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
-                            CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        m_fout = (mode == Mode::Append) ?
+            CreateFile(toWcharStr(filename), FILE_APPEND_DATA, FILE_SHARE_READ, nullptr,
+                       OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) :
+            CreateFile(toWcharStr(filename), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                       CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
         if (m_fout == INVALID_HANDLE_VALUE) {
             throwException(Error::FileIO);
         }
@@ -155,6 +203,7 @@ struct FileInfo {
     LPCWSTR absolute_path;
     std::u16string_view relative_path;
     uint64_t size;
+    int64_t modification_time;
 };
 
 std::generator<FileInfo> iterateFiles(std::u16string const& base_path) {
@@ -194,22 +243,129 @@ std::generator<FileInfo> iterateFiles(std::u16string const& base_path) {
             p.pop_back();   // pop '*' wildcard
             p.append(assumeUtf16(find_data.cFileName));
             uint64_t filesize = (static_cast<uint64_t>(find_data.nFileSizeHigh) << 32ull) | static_cast<uint64_t>(find_data.nFileSizeLow);
+            int64_t const mtime = static_cast<int64_t>((static_cast<uint64_t>(find_data.ftLastWriteTime.dwHighDateTime) << 32ull) |
+                                                       static_cast<uint64_t>(find_data.ftLastWriteTime.dwLowDateTime));
             if ((find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
                 appendWildcard(p);
                 directories.emplace_back(std::move(p));
             } else {
-                co_yield FileInfo{ .absolute_path = toWcharStr(p), .relative_path = relativePathTo(p, base_path), .size = filesize };
+                co_yield FileInfo{ .absolute_path = toWcharStr(p), .relative_path = relativePathTo(p, base_path),
+                                   .size = filesize, .modification_time = mtime };
             }
         } while (FindNextFile(hsearch, &find_data) != FALSE);
         if (GetLastError() != ERROR_NO_MORE_FILES) { throwException(Error::FileIO); }
     }
 }
 
+bool fileExists(std::u16string const& path) {
+    DWORD const attributes = GetFileAttributes(toWcharStr(path));
+    return (attributes != INVALID_FILE_ATTRIBUTES) && ((attributes & FILE_ATTRIBUTE_DIRECTORY) == 0);
+}
+
+std::u16string stampFilePath(std::u16string const& checksum_path) {
+    return checksum_path + u".stamps";
+}
+
+std::u16string directoryDigestsFilePath(std::u16string const& checksum_path) {
+    return checksum_path + u".dirdigests";
+}
+
+std::u16string checkpointFilePath(std::u16string const& checksum_path) {
+    return checksum_path + u".checkpoints";
+}
+
+std::u16string blockDigestsFilePath(std::u16string const& checksum_path) {
+    return checksum_path + u".blocks";
+}
+
+/** Checks whether a file found in the folder is the checksum file or one of its sidecars.
+ * Those are not part of the checksummed contents.
+ */
+bool isChecksumFileOrSidecar(std::u16string_view path, std::u16string const& checksum_path) {
+    return (path == checksum_path) || (path == stampFilePath(checksum_path)) ||
+        (path == directoryDigestsFilePath(checksum_path)) || (path == checkpointFilePath(checksum_path)) ||
+        (path == blockDigestsFilePath(checksum_path));
+}
+
+/** Reads a checksum file, parsing it on all available cores if it is large.
+ * @return The parsed file; or the diagnostic for the first invalid line.
+ */
+std::expected<ChecksumFile, LineDiagnostic> readChecksumFile(ChecksumProvider const& provider, FileInput& reader) {
+    return provider.tryReadFromFileParallel(reader, ParallelParseOptions{
+            .n_threads = std::max(std::thread::hardware_concurrency(), 1u),
+            .min_chunk_size = ParallelParseOptions::DEFAULT_MIN_CHUNK_SIZE
+        });
+}
+
+/** Error message for a checksum file that failed to parse.
+ */
+std::u8string parserErrorMessage(LineDiagnostic const& diagnostic) {
+    return u8"Invalid checksum file: Error in line " + assumeUtf8(std::to_string(diagnostic.line_number));
+}
+
+/** Loads the verified database and opens its journal for appending.
+ * If the existing journal cannot be read or needs compaction, it is replaced by a
+ * compacted copy first.
+ */
+VerifiedDatabase openVerifiedDatabase(std::u16string const& path, std::unique_ptr<FileOutputWin32>& journal) {
+    VerifiedDatabase ret;
+    bool needs_rewrite = true;
+    if (fileExists(path)) {
+        try {
+            FileInputWin32 reader(path);
+            ret = VerifiedDatabase::readFromFile(reader);
+            needs_rewrite = ret.needsCompaction();
+        } catch (Exception&) {
+            // the database is only a cache; start over with an empty one
+            ret = VerifiedDatabase{};
+        }
+    }
+    if (needs_rewrite) {
+        std::u16string const tmp_path = path + u".tmp";
+        {
+            FileOutputWin32 writer(tmp_path);
+            ret.writeToFile(writer);
+        }
+        if (!MoveFileEx(toWcharStr(tmp_path), toWcharStr(path), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+            throwException(Error::FileIO);
+        }
+    }
+    journal = std::make_unique<FileOutputWin32>(path, FileOutputWin32::Mode::Append);
+    return ret;
+}
+
+std::optional<VerifiedFileKey> getVerifiedFileKey(HANDLE fin, std::u8string_view algorithm) {
+    BY_HANDLE_FILE_INFORMATION info;
+    if (!GetFileInformationByHandle(fin, &info)) { return std::nullopt; }
+    auto const combine = [](DWORD high, DWORD low) -> uint64_t {
+        return (static_cast<uint64_t>(high) << 32ull) | static_cast<uint64_t>(low);
+    };
+    return VerifiedFileKey{
+        .device = info.dwVolumeSerialNumber,
+        .file_id = combine(info.nFileIndexHigh, info.nFileIndexLow),
+        .size = combine(info.nFileSizeHigh, info.nFileSizeLow),
+        .modification_time = static_cast<int64_t>(combine(info.ftLastWriteTime.dwHighDateTime, info.ftLastWriteTime.dwLowDateTime)),
+        .algorithm = std::u8string(algorithm)
+    };
+}
+
+std::optional<FileStamp> getFileStamp(HANDLE fin) {
+    BY_HANDLE_FILE_INFORMATION info;
+    if (!GetFileInformationByHandle(fin, &info)) { return std::nullopt; }
+    auto const combine = [](DWORD high, DWORD low) -> uint64_t {
+        return (static_cast<uint64_t>(high) << 32ull) | static_cast<uint64_t>(low);
+    };
+    return FileStamp{
+        .size = combine(info.nFileSizeHigh, info.nFileSizeLow),
+        .modification_time = static_cast<int64_t>(combine(info.ftLastWriteTime.dwHighDateTime, info.ftLastWriteTime.dwLowDateTime))
+    };
+}
+
 } // anonymous namespace
 
 
 OperationScheduler::OperationScheduler()
-    :m_shutdownRequested(false), m_cancelEvent(nullptr)
+    :m_shutdownRequested(false), m_cancelEvent(nullptr), m_digestCache(std::make_unique<DigestCacheWin32>())
 {
 }
 
@@ -256,7 +412,16 @@ void OperationScheduler::post(Operation::Verify op) {
         .kind = OperationState::Op::Verify,
         .checksum_file = ChecksumFile{},
         .checksum_path = std::move(op.source_file),
-        .hasher = op.provider->createHasher(op.options)
+        .hasher_options = op.options,
+        .hasher = nullptr,
+        .create_directory_digests = false,
+        .verified_database_path = std::move(op.verified_database_path),
+        .verified_database_policy = op.verified_database_policy,
+        .digest_cache_attribute = (op.use_digest_cache) ? digestCacheAttributeName(*op.provider) : std::u8string{},
+        .resume_appended_files = false,
+        .create_block_digests = false,
+        .block_audit_samples = op.block_audit_samples,
+        .files_in_flight = op.files_in_flight
         });
     m_cvOps.notify_one();
 }
@@ -274,7 +439,39 @@ void OperationScheduler::post(Operation::CreateFromFolder op) {
         .checksum_file = ChecksumFile{},
         .checksum_path = op.target_file,
         .folder_path = op.folder_path,
-        .hasher = op.provider->createHasher(op.options)
+        .hasher_options = op.options,
+        .hasher = nullptr,
+        .create_directory_digests = op.create_directory_digests,
+        .verified_database_path = {},
+        .verified_database_policy = {},
+        .digest_cache_attribute = (op.use_digest_cache) ? digestCacheAttributeName(*op.provider) : std::u8string{},
+        .resume_appended_files = false,
+        .create_block_digests = op.create_block_digests,
+        .block_audit_samples = 0,
+        .files_in_flight = op.files_in_flight
+        });
+    m_cvOps.notify_one();
+}
+
+void OperationScheduler::post(Operation::UpdateFromFolder op) {
+    std::scoped_lock lk(m_mtxOps);
+    m_opsQueue.push_back(OperationState{
+        .event_handler = op.event_handler,
+        .checksum_provider = op.provider,
+        .kind = OperationState::Op::Update,
+        .checksum_file = ChecksumFile{},
+        .checksum_path = op.target_file,
+        .folder_path = op.folder_path,
+        .hasher_options = op.options,
+        .hasher = op.provider->createHasher(op.options),
+        .create_directory_digests = op.create_directory_digests,
+        .verified_database_path = {},
+        .verified_database_policy = {},
+        .digest_cache_attribute = (op.use_digest_cache) ? digestCacheAttributeName(*op.provider) : std::u8string{},
+        .resume_appended_files = op.resume_appended_files,
+        .create_block_digests = false,
+        .block_audit_samples = 0,
+        .files_in_flight = 1
         });
     m_cvOps.notify_one();
 }
@@ -298,6 +495,9 @@ void OperationScheduler::worker() {
                 case OperationState::Op::Create:
                     doCreate(op);
                     break;
+                case OperationState::Op::Update:
+                    doUpdate(op);
+                    break;
                 }
             } catch (Exception& e) {
                 signalError(op.event_handler, e.code(), e.what8());
@@ -306,108 +506,150 @@ void OperationScheduler::worker() {
     }
 }
 
-namespace {
-
-template<typename T, size_t N>
-class SlidingWindow {
-private:
-    std::array<T, N> m_elements;
-    size_t m_numberOfElements = 0;
-    size_t m_nextElement = 0;
-public:
-    void push(T&& e) {
-        m_elements[m_nextElement] = std::move(e);
-        m_nextElement = (m_nextElement + 1) % N;
-        m_numberOfElements = std::min(m_numberOfElements + 1, N);
+OperationScheduler::HashReadStates::HashReadStates(IoAutotunerOptions const& bounds)
+    :m_autotuner(bounds, HASH_FILE_BUFFER_SIZE, HASH_FILE_QUEUE_DEPTH)
+{
+    m_states.reserve(bounds.max_queue_depth);
+    for (uint32_t i = 0; i < bounds.max_queue_depth; ++i) {
+        HANDLE const event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        if (!event) {
+            for (auto& rs : m_states) { CloseHandle(rs.event); }
+            throwException(Error::SystemError);
+        }
+        m_states.push_back(HashReadState{
+            .buffer = {},
+            .event = event,
+            .overlapped = {},
+            .bytes_requested = 0,
+            .pending = false,
+            .t = {}
+        });
     }
+}
+
+OperationScheduler::HashReadStates::~HashReadStates() {
+    for (auto& rs : m_states) { CloseHandle(rs.event); }
+}
+
+std::span<OperationScheduler::HashReadState> OperationScheduler::HashReadStates::states() noexcept {
+    return m_states;
+}
+
+IoAutotuner& OperationScheduler::HashReadStates::autotuner() noexcept {
+    return m_autotuner;
+}
 
-    void push(T const& e) {
-        m_elements[m_nextElement] = e;
-        m_nextElement = (m_nextElement + 1) % N;
-        m_numberOfElements = std::min(m_numberOfElements + 1, N);
+std::vector<std::byte> OperationScheduler::HashReadStates::acquireBuffer() {
+    std::size_t const chunk_size = m_autotuner.chunkSize();
+    while (!m_spareBuffers.empty()) {
+        std::vector<std::byte> ret = std::move(m_spareBuffers.back());
+        m_spareBuffers.pop_back();
+        // buffers of a previous chunk size are dropped
+        if (ret.size() == chunk_size) { return ret; }
     }
+    return std::vector<std::byte>(chunk_size);
+}
 
-    T rollingAverage() const {
-        if (m_numberOfElements == 0) { return T{}; }
-        return std::accumulate(begin(m_elements), begin(m_elements) + m_numberOfElements, T{}) / m_numberOfElements;
+void OperationScheduler::HashReadStates::releaseBuffer(std::vector<std::byte>&& buffer, std::size_t n_in_flight) {
+    if ((buffer.size() == m_autotuner.chunkSize()) && (n_in_flight + m_spareBuffers.size() < m_autotuner.queueDepth())) {
+        m_spareBuffers.push_back(std::move(buffer));
     }
-};
+}
 
-} // anonymous namespace
+std::vector<std::unique_ptr<OperationScheduler::HashWorkerState>>
+OperationScheduler::createHashWorkerStates(OperationState const& op, uint32_t n_workers, bool use_block_digests) {
+    std::vector<std::unique_ptr<HashWorkerState>> ret;
+    ret.reserve(n_workers);
+    for (uint32_t i = 0; i < n_workers; ++i) {
+        // HashReadStates cannot be moved, so it has to be constructed in place
+        ret.emplace_back(new HashWorkerState{
+            .hasher = op.checksum_provider->createHasher(op.hasher_options),
+            .block_hasher = (use_block_digests) ? op.checksum_provider->createHasher(op.hasher_options) : nullptr,
+            .read_states = HashReadStates(hashFileAutotuneBounds(n_workers))
+        });
+    }
+    return ret;
+}
 
 OperationScheduler::HashResult OperationScheduler::hashFile(EventHandler* event_handler, Hasher& hasher,
                                                             HANDLE fin, int64_t data_offset, int64_t data_size,
-                                                            std::span<HashReadState, 2> read_states) {
+                                                            HashReadStates& read_state_storage,
+                                                            std::span<std::byte const> resume_state,
+                                                            BlockDigestBuilder* block_builder) {
     auto const offsetLow = [](int64_t i) -> DWORD { return static_cast<DWORD>(i & 0xffffffffull); };
     auto const offsetHigh = [](int64_t i) -> DWORD { return static_cast<DWORD>((i >> 32ull) & 0xffffffffull); };
 
-    SlidingWindow<std::chrono::nanoseconds, 10> bandwidth_track;
-    hasher.reset();
+    if (resume_state.empty()) {
+        hasher.reset();
+    } else {
+        hasher.restoreState(resume_state);
+    }
+    std::span<HashReadState> const read_states = read_state_storage.states();
+    IoAutotuner& autotuner = read_state_storage.autotuner();
+    autotuner.restartMeasurement();
 
+    int64_t const data_end = data_offset + data_size;
     int64_t read_offset = data_offset;
-    int64_t bytes_read_pending = 0;
     int64_t bytes_hashed = 0;
     bool is_eof = false;
+    bool is_past_eof = false;       // a read could not be issued as it started past the end of the file
     bool is_canceled = false;
     bool is_error = false;
 
+    // reads are issued to the states in ring order, so the oldest read is always at head
+    std::size_t const n_states = read_states.size();
+    std::size_t head = 0;
+    std::size_t tail = 0;
+    std::size_t in_flight = 0;
     for (auto& rs : read_states) { rs.pending = false; }
-    size_t front = 0;
-    size_t back = 1;
-    read_states[front].overlapped = OVERLAPPED{
-        .Offset = offsetLow(read_offset),
-        .OffsetHigh = offsetHigh(read_offset),
-        .hEvent = read_states[front].event
-    };
-    read_states[front].t = std::chrono::steady_clock::now();
-    DWORD bytes_to_read = static_cast<DWORD>(std::min(static_cast<int64_t>(HASH_FILE_BUFFER_SIZE), data_size - bytes_read_pending));
-    if (!ReadFile(fin, read_states[front].buffer.data(), bytes_to_read, nullptr, &read_states[front].overlapped)) {
-        DWORD const err = GetLastError();
-        if (err == ERROR_HANDLE_EOF) {
-            // eof before async
-            is_eof = true;
-        } else if (err == ERROR_IO_PENDING) {
-            read_states[front].pending = true;
-        } else {
-            // file read error
-            is_error = true;
-        }
-    }
-    bytes_read_pending += bytes_to_read;
-    read_offset += bytes_to_read;
-    uint32_t last_progress = 0;
-    while (!is_eof && !is_canceled && !is_error) {
-        read_states[back].overlapped = OVERLAPPED{
+    auto const issueReads = [&]() {
+        std::size_t const queue_depth = std::min<std::size_t>(autotuner.queueDepth(), n_states);
+        while (!is_past_eof && (in_flight < queue_depth) && (read_offset < data_end)) {
+            HashReadState& rs = read_states[tail];
+            DWORD const bytes_to_read = static_cast<DWORD>(std::min(static_cast<int64_t>(autotuner.chunkSize()),
+                                                                    data_end - read_offset));
+            rs.buffer = read_state_storage.acquireBuffer();
+            rs.overlapped = OVERLAPPED{
                 .Offset = offsetLow(read_offset),
                 .OffsetHigh = offsetHigh(read_offset),
-                .hEvent = read_states[back].event
-        };
-        read_states[back].t = std::chrono::steady_clock::now();
-        bytes_to_read = static_cast<DWORD>(std::min(static_cast<int64_t>(HASH_FILE_BUFFER_SIZE), data_size - bytes_read_pending));
-        if (!ReadFile(fin, read_states[back].buffer.data(), HASH_FILE_BUFFER_SIZE, nullptr, &read_states[back].overlapped)) {
-            DWORD const err = GetLastError();
-            if (err == ERROR_HANDLE_EOF) {
-                // eof before async
-                is_eof = true;
-            } else if (err == ERROR_IO_PENDING) {
-                read_states[back].pending = true;
-            } else {
-                // file read error
-                is_error = true;
-                break;
+                .hEvent = rs.event
+            };
+            rs.bytes_requested = bytes_to_read;
+            rs.t = std::chrono::steady_clock::now();
+            if (!ReadFile(fin, rs.buffer.data(), bytes_to_read, nullptr, &rs.overlapped)) {
+                DWORD const err = GetLastError();
+                if (err == ERROR_HANDLE_EOF) {
+                    // eof before async; the reads already in flight still get hashed
+                    is_past_eof = true;
+                    break;
+                } else if (err != ERROR_IO_PENDING) {
+                    // file read error
+                    is_error = true;
+                    break;
+                }
             }
+            // reads that complete synchronously signal their event all the same
+            rs.pending = true;
+            read_offset += bytes_to_read;
+            tail = (tail + 1) % n_states;
+            ++in_flight;
         }
-        bytes_read_pending += bytes_to_read;
-        read_offset += bytes_to_read;
+    };
 
+    issueReads();
+    uint32_t last_progress = 0;
+    while ((in_flight > 0) && !is_canceled && !is_error) {
+        HashReadState& rs = read_states[head];
         DWORD bytes_read = 0;
         // cancel event has to go first, or it will get starved by completing i/os
-        HANDLE event_handles[] = { m_cancelEvent, read_states[front].event };
+        HANDLE event_handles[] = { m_cancelEvent, rs.event };
         DWORD const wait_ret = WaitForMultipleObjects(2, event_handles, FALSE, INFINITE);
         if (wait_ret == WAIT_OBJECT_0 + 1) {
             // read successful
-            read_states[front].pending = false;
-            if (!GetOverlappedResult(fin, &read_states[front].overlapped, &bytes_read, FALSE)) {
+            rs.pending = false;
+            head = (head + 1) % n_states;
+            --in_flight;
+            if (!GetOverlappedResult(fin, &rs.overlapped, &bytes_read, FALSE)) {
                 if (GetLastError() == ERROR_HANDLE_EOF) {
                     // eof
                     is_eof = true;
@@ -416,8 +658,12 @@ OperationScheduler::HashResult OperationScheduler::hashFile(EventHandler* event_
                     is_error = true;
                     break;
                 }
+            } else if (bytes_read == rs.bytes_requested) {
+                auto const now = std::chrono::steady_clock::now();
+                autotuner.addCompletion(bytes_read, now - rs.t, now);
             } else {
-                if (bytes_read == HASH_FILE_BUFFER_SIZE) { bandwidth_track.push(std::chrono::steady_clock::now() - read_states[front].t); }
+                // short read at the end of the file
+                is_eof = true;
             }
         } else if (wait_ret == WAIT_OBJECT_0) {
             // cancel
@@ -429,21 +675,24 @@ OperationScheduler::HashResult OperationScheduler::hashFile(EventHandler* event_
             throwException(Error::SystemError);
         }
 
-        hasher.addData(std::span<std::byte const>(read_states[front].buffer.data(), bytes_read));
+        hasher.addData(std::span<std::byte const>(rs.buffer.data(), bytes_read));
+        if (block_builder) { block_builder->addData(std::span<std::byte const>(rs.buffer.data(), bytes_read)); }
         bytes_hashed += bytes_read;
-        if (bytes_hashed == data_size) { break; }
+        read_state_storage.releaseBuffer(std::exchange(rs.buffer, {}), in_flight);
+        if (is_eof) {
+            // anything still in flight lies beyond the end of the file
+            break;
+        }
         uint32_t current_progress = (data_size == 0) ? 0u : static_cast<uint32_t>(bytes_hashed * 100 / data_size);
-        if (current_progress != last_progress) {
-            int64_t const t_avg = bandwidth_track.rollingAverage().count();
-            uint32_t const bandwidth_mib_s = static_cast<uint32_t>((t_avg) ? ((static_cast<int64_t>(HASH_FILE_BUFFER_SIZE) * 1'000'000'000ll) / (t_avg * 1'048'576ll)) : 0);
-            signalProgress(event_handler, current_progress, bandwidth_mib_s);
+        if (event_handler && (current_progress != last_progress) && (bytes_hashed != data_size)) {
+            signalProgress(event_handler, current_progress, autotuner.bandwidthMiBs());
             last_progress = current_progress;
         }
-
-        std::swap(front, back);
+        issueReads();
     }
     for (auto& rs : read_states) {
-        if (rs.pending) { WaitForSingleObject(rs.event, INFINITE); DWORD b; GetOverlappedResult(fin, &rs.overlapped, &b, TRUE); }
+        if (rs.pending) { WaitForSingleObject(rs.event, INFINITE); DWORD b; GetOverlappedResult(fin, &rs.overlapped, &b, TRUE); rs.pending = false; }
+        if (!rs.buffer.empty()) { read_state_storage.releaseBuffer(std::exchange(rs.buffer, {}), 0); }
     }
     if (is_canceled) {
         return HashResult::Canceled;
@@ -454,57 +703,173 @@ OperationScheduler::HashResult OperationScheduler::hashFile(EventHandler* event_
     return HashResult::DigestReady;
 }
 
+OperationScheduler::HashResult OperationScheduler::auditBlocks(OperationState const& op, EventHandler* event_handler,
+                                                               Hasher& block_hasher, HANDLE fin,
+                                                               BlockDigests const& block_digests,
+                                                               BlockDigests::File const& expected,
+                                                               HashReadStates& read_states,
+                                                               uint64_t seed, std::vector<uint64_t>& damaged_blocks)
+{
+    std::vector<uint64_t> const sampled_blocks = selectAuditBlocks(expected.blocks.size(), op.block_audit_samples, seed);
+    uint32_t last_progress = 0;
+    for (std::size_t i = 0; i < sampled_blocks.size(); ++i) {
+        uint64_t const index = sampled_blocks[i];
+        BlockRange const range = block_digests.blockRange(expected.file_size, index);
+        // progress counts sampled blocks instead of the bytes of each individual block
+        HashResult const res = hashFile(nullptr, block_hasher, fin, static_cast<int64_t>(range.offset),
+                                        static_cast<int64_t>(range.size), read_states);
+        if (res != HashResult::DigestReady) { return res; }
+        if (!(block_hasher.finalize() == expected.blocks[index])) {
+            damaged_blocks.push_back(index);
+        }
+        uint32_t const current_progress = static_cast<uint32_t>((i + 1) * 100 / sampled_blocks.size());
+        if (event_handler && (current_progress != last_progress) && (i + 1 != sampled_blocks.size())) {
+            signalProgress(event_handler, current_progress, read_states.autotuner().bandwidthMiBs());
+            last_progress = current_progress;
+        }
+    }
+    return HashResult::DigestReady;
+}
+
 void OperationScheduler::doVerify(OperationState& op) {
-    FileInputWin32 reader(op.checksum_path);
-    op.checksum_file = op.checksum_provider->readFromFile(reader);
-
-    HANDLE event_front = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-    if (!event_front) { throwException(Error::SystemError); }
-    HandleGuard guard_event_front(event_front);
-    HANDLE event_back = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-    if (!event_back) { throwException(Error::SystemError); }
-    HandleGuard guard_event_back(event_back);
-
-    HashReadState read_states[] = {
-        HashReadState{
-            .buffer = std::vector<std::byte>(HASH_FILE_BUFFER_SIZE),
-            .event = event_front,
-            .overlapped = {},
-            .pending = false,
-            .t = {}
-        },
-        HashReadState{
-            .buffer = std::vector<std::byte>(HASH_FILE_BUFFER_SIZE),
-            .event = event_back,
-            .overlapped = {},
-            .pending = false,
-            .t = {}
-        },
-    };
+    FileInputWin32 file_reader(op.checksum_path);
+    DecompressingFileInput reader(file_reader);
+    // compressed checksum files are parsed sequentially, so that they never have to be
+    // held in memory in their entirety
+    if (reader.compression() == Compression::None) {
+        std::expected<ChecksumFile, LineDiagnostic> parsed = readChecksumFile(*op.checksum_provider, reader);
+        if (!parsed) {
+            signalError(op.event_handler, Error::ParserError, parserErrorMessage(parsed.error()));
+            return;
+        }
+        op.checksum_file = std::move(*parsed);
+    } else {
+        op.checksum_file = op.checksum_provider->readFromFile(reader);
+    }
+
+    std::optional<VerifiedDatabase> verified_database;
+    std::unique_ptr<FileOutputWin32> verified_database_journal;
+    if (!op.verified_database_path.empty()) {
+        verified_database = openVerifiedDatabase(op.verified_database_path, verified_database_journal);
+    }
+    // lookups from the hashing threads race with the recording of new results
+    std::mutex mtx_verified_database;
+    std::chrono::sys_seconds const now = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+
+    std::optional<BlockDigests> block_digests;
+    if (std::u16string const block_digests_path = blockDigestsFilePath(op.checksum_path); fileExists(block_digests_path)) {
+        try {
+            FileInputWin32 block_reader(block_digests_path);
+            block_digests = BlockDigests::readFromFile(block_reader, *op.checksum_provider);
+        } catch (Exception&) {
+            // block digests are optional; verification works without them
+        }
+    }
+    std::mt19937_64 audit_rng(std::random_device{}());
 
     EventHandler::Result result{};
     result.total = static_cast<uint32_t>(op.checksum_file.getEntries().size());
     signalOperationStarted(op.event_handler, result.total);
 
-    for (auto const& f : op.checksum_file.getEntries()) {
+    /// Outcome of checking a single entry, reported in the order of the checksum file.
+    struct FileOutcome {
+        std::size_t entry_index;
+        std::u8string absolute_file_path;
+        HashResult hash_result;                         ///< Canceled and Error end the operation.
+        EventHandler::CompletionStatus status;
+        Digest digest;
+        std::vector<BlockRange> damaged_ranges;
+        std::optional<VerifiedFileKey> verified_key;    ///< Set if the result is to be recorded.
+        bool was_started;                               ///< The file was already reported as started.
+    };
+    // results are reported in the order of the checksum file, no matter in which order
+    // the files were checked
+    ReorderBuffer<FileOutcome> pending_outcomes;
+
+    // files that do not match the size recorded in the checksum file are found from a
+    // single stat without being read; the remaining files are hashed from smallest to
+    // largest, with files of unknown size last
+    std::span<ChecksumFile::Entry const> const entries = op.checksum_file.getEntries();
+    std::vector<std::size_t> const schedule = op.checksum_file.getEntryOrderByExpectedSize();
+    std::vector<bool> size_mismatch(entries.size(), false);
+    for (std::size_t const i : schedule) {
+        auto const& f = entries[i];
+        if (f.expected_size == -1) { break; }
         std::u16string const absolute_file_path = resolvePath(op.checksum_path, f.data.front().path);
-        std::u8string const utf8_absolute_file_path = convertToUtf8(absolute_file_path);
-        signalFileStarted(op.event_handler, f.display, utf8_absolute_file_path);
+        WIN32_FILE_ATTRIBUTE_DATA attributes;
+        // files that cannot be accessed are reported by the main loop
+        if (!GetFileAttributesEx(toWcharStr(absolute_file_path), GetFileExInfoStandard, &attributes)) { continue; }
+        uint64_t const file_size =
+            (static_cast<uint64_t>(attributes.nFileSizeHigh) << 32ull) | static_cast<uint64_t>(attributes.nFileSizeLow);
+        if (file_size == static_cast<uint64_t>(f.expected_size)) { continue; }
+        pending_outcomes.insert(i, FileOutcome{
+            .entry_index = i,
+            .absolute_file_path = convertToUtf8(absolute_file_path),
+            .hash_result = HashResult::DigestReady,
+            .status = EventHandler::CompletionStatus::Bad,
+            .digest = Digest{},
+            .damaged_ranges = {},
+            .verified_key = std::nullopt,
+            .was_started = false
+        });
+        size_mismatch[i] = true;
+    }
+
+    uint32_t const n_workers = (op.files_in_flight > 1) ? op.files_in_flight : 0;
+    std::vector<std::unique_ptr<HashWorkerState>> const worker_states =
+        createHashWorkerStates(op, std::max(n_workers, 1u), block_digests.has_value());
+    // with a single file in flight, everything happens on this thread, so each file is
+    // reported as started right before it is hashed and its progress follows; only the
+    // completions wait for the entries before them in the checksum file
+    bool const is_sequential = (n_workers == 0);
+    EventHandler* const progress_handler = (is_sequential) ? op.event_handler : nullptr;
+
+    auto const verifyFile = [&](std::size_t entry_index, uint64_t audit_seed, HashWorkerState& ws) {
+        auto const& f = entries[entry_index];
+        std::u16string const absolute_file_path = resolvePath(op.checksum_path, f.data.front().path);
+        FileOutcome ret{
+            .entry_index = entry_index,
+            .absolute_file_path = convertToUtf8(absolute_file_path),
+            .hash_result = HashResult::DigestReady,
+            .status = EventHandler::CompletionStatus::Bad,
+            .digest = Digest{},
+            .damaged_ranges = {},
+            .verified_key = std::nullopt,
+            .was_started = is_sequential
+        };
+        if (ret.was_started) { signalFileStarted(op.event_handler, f.display, ret.absolute_file_path); }
         HANDLE fin = CreateFile(toWcharStr(absolute_file_path), GENERIC_READ, FILE_SHARE_READ, nullptr,
                                 OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN | FILE_FLAG_OVERLAPPED, nullptr);
         if (fin == INVALID_HANDLE_VALUE) {
-            if (GetLastError() == ERROR_FILE_NOT_FOUND) {
-                signalFileCompleted(op.event_handler, f.display, Digest{}, utf8_absolute_file_path,
-                                    EventHandler::CompletionStatus::Missing);
-                ++result.missing;
-            } else {
-                signalFileCompleted(op.event_handler, f.display, Digest{}, utf8_absolute_file_path,
-                                    EventHandler::CompletionStatus::Bad);
-                ++result.bad;
-            }
-            continue;
+            if (GetLastError() == ERROR_FILE_NOT_FOUND) { ret.status = EventHandler::CompletionStatus::Missing; }
+            return ret;
         }
         HandleGuard guard_fin(fin);
+        bool const is_whole_file = (f.data.size() == 1) &&
+            (f.data.front().data_offset == 0) && (f.data.front().data_size == -1);
+        std::optional<VerifiedFileKey> verified_key;
+        if (verified_database && is_whole_file) {
+            verified_key = getVerifiedFileKey(fin, op.checksum_provider->fileDescription());
+            std::scoped_lock lk(mtx_verified_database);
+            if (verified_key && verified_database->canSkip(*verified_key, f.digest, now, op.verified_database_policy)) {
+                ret.status = EventHandler::CompletionStatus::Ok;
+                ret.digest = f.digest;
+                return ret;
+            }
+        }
+        std::optional<FileStamp> cache_stamp;
+        if (!op.digest_cache_attribute.empty() && is_whole_file) {
+            cache_stamp = getFileStamp(fin);
+            if (cache_stamp) {
+                std::optional<Digest> const cached_digest = lookupCachedDigest(op, ret.absolute_file_path, *cache_stamp);
+                // a mismatch is only reported after actually reading the file
+                if (cached_digest && (*cached_digest == f.digest)) {
+                    ret.status = EventHandler::CompletionStatus::Ok;
+                    ret.digest = f.digest;
+                    return ret;
+                }
+            }
+        }
         int64_t file_size = f.data.front().data_size;
         if (file_size == -1) {
             LARGE_INTEGER l_file_size;
@@ -512,64 +877,340 @@ void OperationScheduler::doVerify(OperationState& op) {
                 file_size = l_file_size.QuadPart;
             }
         }
-        HashResult const res = (file_size != -1) ?
-            hashFile(op.event_handler, *op.hasher, fin, f.data.front().data_offset, file_size, read_states) :
-            HashResult::Error;
-        if (res == HashResult::DigestReady) {
-            auto digest = op.hasher->finalize();
-            if (digest == f.digest) {
-                signalFileCompleted(op.event_handler, f.display, std::move(digest), utf8_absolute_file_path,
-                                    EventHandler::CompletionStatus::Ok);
-                ++result.ok;
+        BlockDigests::File const* const expected_blocks =
+            (block_digests && is_whole_file) ? block_digests->getFile(f.data.front().path) : nullptr;
+        if (expected_blocks && (op.block_audit_samples != 0) && (file_size >= 0) &&
+            (static_cast<uint64_t>(file_size) == expected_blocks->file_size))
+        {
+            std::vector<uint64_t> damaged_blocks;
+            HashResult const audit_res = auditBlocks(op, progress_handler, *ws.block_hasher, fin, *block_digests,
+                                                     *expected_blocks, ws.read_states, audit_seed, damaged_blocks);
+            if ((audit_res == HashResult::Canceled) || (audit_res == HashResult::Error)) {
+                // read errors end the verification, as when hashing the entire file
+                ret.hash_result = audit_res;
+            } else if (damaged_blocks.empty()) {
+                ret.status = EventHandler::CompletionStatus::Audited;
             } else {
-                signalFileCompleted(op.event_handler, f.display, std::move(digest), utf8_absolute_file_path,
-                                    EventHandler::CompletionStatus::Bad);
-                ++result.bad;
+                ret.damaged_ranges = block_digests->toRanges(expected_blocks->file_size, damaged_blocks);
             }
-        } else if (res == HashResult::Error) {
-            signalFileCompleted(op.event_handler, f.display, Digest{}, utf8_absolute_file_path,
-                                EventHandler::CompletionStatus::Bad);
-            return;
-        } else if (res == HashResult::Canceled) {
+            return ret;
+        }
+        ret.hash_result = (file_size != -1) ?
+            hashFile(progress_handler, *ws.hasher, fin, f.data.front().data_offset, file_size, ws.read_states) :
+            HashResult::Error;
+        if (ret.hash_result != HashResult::DigestReady) { return ret; }
+        ret.digest = ws.hasher->finalize();
+        if (cache_stamp) { storeCachedDigest(op, ret.absolute_file_path, *cache_stamp, ret.digest); }
+        if (ret.digest == f.digest) {
+            ret.status = EventHandler::CompletionStatus::Ok;
+            ret.verified_key = std::move(verified_key);
+        } else if (expected_blocks) {
+            // block digests are only needed for locating the damage, so they are computed
+            // by reading the file a second time only once the file is known to be bad
+            BlockDigestBuilder block_builder(*ws.block_hasher, block_digests->getBlockSize());
+            HashResult const locate_res = hashFile(progress_handler, *ws.hasher, fin, 0, file_size,
+                                                   ws.read_states, {}, &block_builder);
+            if (locate_res == HashResult::Canceled) {
+                ret.hash_result = HashResult::Canceled;
+            } else if (locate_res == HashResult::DigestReady) {
+                ret.damaged_ranges = block_digests->findDamagedRanges(*expected_blocks, block_builder.finalize());
+            }
+        }
+        return ret;
+    };
+
+    bool is_stopped = false;
+    bool is_aborted = false;
+    auto const reportFile = [&](FileOutcome&& o) {
+        if (is_stopped) { return; }
+        auto const& f = entries[o.entry_index];
+        if (o.hash_result == HashResult::Canceled) {
             signalCanceled(op.event_handler);
             result.was_canceled = true;
-            break;
+            is_stopped = true;
+            return;
+        }
+        if (!o.was_started) { signalFileStarted(op.event_handler, f.display, o.absolute_file_path); }
+        if (!o.damaged_ranges.empty()) { signalDamagedRanges(op.event_handler, f.display, std::move(o.damaged_ranges)); }
+        if (o.verified_key) {
+            VerifiedRecord record{ .digest = o.digest.toString(), .verified_time = now };
+            VerifiedDatabase::appendRecord(*verified_database_journal, *o.verified_key, record);
+            std::scoped_lock lk(mtx_verified_database);
+            verified_database->insert(std::move(*o.verified_key), std::move(record));
         }
+        signalFileCompleted(op.event_handler, f.display, std::move(o.digest), std::move(o.absolute_file_path), o.status);
+        if (o.hash_result == HashResult::Error) {
+            // a file that could not be read ends the verification
+            is_stopped = true;
+            is_aborted = true;
+        } else if (o.status == EventHandler::CompletionStatus::Ok) {
+            ++result.ok;
+        } else if (o.status == EventHandler::CompletionStatus::Missing) {
+            ++result.missing;
+        } else if (o.status == EventHandler::CompletionStatus::Audited) {
+            ++result.audited;
+        } else {
+            ++result.bad;
+        }
+    };
+
+    {
+        // the pool delivers results in the order of the schedule, which are then held
+        // back until all entries before them in the checksum file have been reported
+        OrderedTaskPool<FileOutcome> pool(n_workers, 2 * n_workers, [&](FileOutcome&& o) {
+            std::size_t const entry_index = o.entry_index;
+            pending_outcomes.insert(entry_index, std::move(o));
+            while (std::optional<FileOutcome> next = pending_outcomes.pop()) { reportFile(std::move(*next)); }
+        });
+        for (std::size_t const entry_index : schedule) {
+            if (is_stopped) { break; }
+            if (size_mismatch[entry_index]) { continue; }
+            uint64_t const audit_seed = audit_rng();
+            pool.submit([&, entry_index, audit_seed](uint32_t worker_index) {
+                return verifyFile(entry_index, audit_seed, *worker_states[worker_index]);
+            });
+        }
+        pool.finish();
+        while (std::optional<FileOutcome> next = pending_outcomes.popSkippingGaps()) { reportFile(std::move(*next)); }
     }
+    if (is_aborted) { return; }
     signalOperationCompleted(op.event_handler, result);
 }
 
 void OperationScheduler::doCreate(OperationState& op) {
-    HANDLE event_front = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-    if (!event_front) { throwException(Error::SystemError); }
-    HandleGuard guard_event_front(event_front);
-    HANDLE event_back = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-    if (!event_back) { throwException(Error::SystemError); }
-    HandleGuard guard_event_back(event_back);
-
-    HashReadState read_states[] = {
-        HashReadState{
-            .buffer = std::vector<std::byte>(HASH_FILE_BUFFER_SIZE),
-            .event = event_front,
-            .overlapped = {},
-            .pending = false,
-            .t = {}
-        },
-        HashReadState{
-            .buffer = std::vector<std::byte>(HASH_FILE_BUFFER_SIZE),
-            .event = event_back,
-            .overlapped = {},
-            .pending = false,
-            .t = {}
-        },
+    BlockDigests block_digests;
+    uint64_t const block_size = block_digests.getBlockSize();
+    uint32_t const n_workers = (op.files_in_flight > 1) ? op.files_in_flight : 0;
+    std::vector<std::unique_ptr<HashWorkerState>> const worker_states =
+        createHashWorkerStates(op, std::max(n_workers, 1u), op.create_block_digests);
+    // with a single file in flight, everything happens on this thread in order, so
+    // files can be reported as started before they are hashed and progress is reported
+    bool const is_sequential = (n_workers == 0);
+    EventHandler* const progress_handler = (is_sequential) ? op.event_handler : nullptr;
+
+    /// Outcome of hashing a single file, reported in the order in which the files were found.
+    struct FileOutcome {
+        std::u8string relative_path;
+        std::u8string absolute_path;
+        FileStamp stamp;                                ///< Stamp of the file when it was found.
+        HashResult hash_result;
+        Digest digest;
+        std::optional<BlockDigests::File> blocks;       ///< Set if BlockDigests were computed.
+    };
+    auto const hashFoundFile = [&](std::u16string const& absolute_path, FileOutcome ret, HashWorkerState& ws) {
+        if (is_sequential) { signalFileStarted(op.event_handler, ret.relative_path, ret.absolute_path); }
+        // block digests require reading the file, so they bypass the digest cache
+        if (std::optional<Digest> cached_digest = (ws.block_hasher) ? std::nullopt : lookupCachedDigest(op, ret.absolute_path, ret.stamp);
+            cached_digest)
+        {
+            ret.digest = std::move(*cached_digest);
+            return ret;
+        }
+        HANDLE fin = CreateFile(toWcharStr(absolute_path), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN | FILE_FLAG_OVERLAPPED, nullptr);
+        if (fin == INVALID_HANDLE_VALUE) {
+            ret.hash_result = HashResult::Error;
+            return ret;
+        }
+        HandleGuard guard_fin(fin);
+        std::optional<BlockDigestBuilder> block_builder;
+        if (ws.block_hasher) { block_builder.emplace(*ws.block_hasher, block_size); }
+        LARGE_INTEGER l_file_size;
+        ret.hash_result = (GetFileSizeEx(fin, &l_file_size)) ?
+            hashFile(progress_handler, *ws.hasher, fin, 0, l_file_size.QuadPart, ws.read_states, {},
+                     (block_builder) ? &(*block_builder) : nullptr) :
+            HashResult::Error;
+        if (ret.hash_result != HashResult::DigestReady) { return ret; }
+        ret.digest = ws.hasher->finalize();
+        storeCachedDigest(op, ret.absolute_path, ret.stamp, ret.digest);
+        if (block_builder) {
+            ret.blocks = BlockDigests::File{ .file_size = static_cast<uint64_t>(l_file_size.QuadPart),
+                                             .blocks = block_builder->finalize() };
+        }
+        return ret;
     };
 
     signalOperationStarted(op.event_handler, 0);
     EventHandler::Result result = {};
-    for (auto const& [absolute_path, relative_path, size] : iterateFiles(op.folder_path)) {
+    // stamps of all files in the checksum file, so that a later update only reads changed files
+    StampFile stamps;
+    bool is_canceled = false;
+    auto const reportFile = [&](FileOutcome&& o) {
+        if (is_canceled) { return; }
+        if (o.hash_result == HashResult::Canceled) {
+            signalCanceled(op.event_handler);
+            result.was_canceled = true;
+            is_canceled = true;
+            return;
+        }
+        if (!is_sequential) { signalFileStarted(op.event_handler, o.relative_path, o.absolute_path); }
+        if (o.hash_result == HashResult::Error) {
+            signalFileCompleted(op.event_handler, o.relative_path, {}, o.absolute_path,
+                                EventHandler::CompletionStatus::Bad);
+            ++result.bad;
+            return;
+        }
+        if (o.blocks && (o.blocks->blocks.size() == block_digests.blockCount(o.blocks->file_size))) {
+            block_digests.setFile(o.relative_path, o.blocks->file_size, std::move(o.blocks->blocks));
+        }
+        signalFileCompleted(op.event_handler, o.relative_path, o.digest, o.absolute_path,
+                            EventHandler::CompletionStatus::Ok);
+        stamps.setStamp(o.relative_path, o.stamp);
+        op.checksum_file.addEntry(o.relative_path, std::move(o.digest));
+        ++result.ok;
+    };
+
+    {
+        // entries of files hashed concurrently are added in the order in which the files were found
+        OrderedTaskPool<FileOutcome> pool(n_workers, 2 * n_workers, reportFile);
+        for (auto const& [absolute_path, relative_path, size, modification_time] : iterateFiles(op.folder_path)) {
+            if (is_canceled) { break; }
+            if (isChecksumFileOrSidecar(assumeUtf16(absolute_path), op.checksum_path)) { continue; }
+            ++result.total;
+            // the FileInfo is only valid until the next file is found, so the task gets copies
+            std::u16string file_path(assumeUtf16(absolute_path));
+            FileOutcome outcome{
+                .relative_path = convertToUtf8(relative_path),
+                .absolute_path = convertToUtf8(file_path),
+                .stamp = FileStamp{ .size = size, .modification_time = modification_time },
+                .hash_result = HashResult::DigestReady,
+                .digest = Digest{},
+                .blocks = std::nullopt
+            };
+            pool.submit([&, file_path = std::move(file_path), outcome = std::move(outcome)](uint32_t worker_index) {
+                return hashFoundFile(file_path, outcome, *worker_states[worker_index]);
+            });
+        }
+        pool.finish();
+    }
+    if (is_canceled) { return; }
+    {
+        FileOutputWin32 writer(op.checksum_path);
+        op.checksum_provider->writeNewFile(writer, op.checksum_file);
+    }
+    {
+        FileOutputWin32 stamp_writer(stampFilePath(op.checksum_path));
+        stamps.writeToFile(stamp_writer);
+    }
+    if (op.create_block_digests) {
+        FileOutputWin32 block_writer(blockDigestsFilePath(op.checksum_path));
+        block_digests.writeToFile(block_writer);
+    }
+    if (op.create_directory_digests) { writeDirectoryDigests(op); }
+    signalOperationCompleted(op.event_handler, result);
+}
+
+void OperationScheduler::doUpdate(OperationState& op) {
+    std::u16string const stamp_path = stampFilePath(op.checksum_path);
+    std::u16string const checkpoint_path = checkpointFilePath(op.checksum_path);
+    std::u16string const block_digests_path = blockDigestsFilePath(op.checksum_path);
+    bool const use_checkpoints = op.resume_appended_files && op.hasher->supportsSavedState();
+    ChecksumFile previous;
+    StampFile previous_stamps;
+    CheckpointFile previous_checkpoints;
+    if (fileExists(op.checksum_path)) {
+        FileInputWin32 reader(op.checksum_path);
+        std::expected<ChecksumFile, LineDiagnostic> parsed = readChecksumFile(*op.checksum_provider, reader);
+        if (!parsed) {
+            signalError(op.event_handler, Error::ParserError, parserErrorMessage(parsed.error()));
+            return;
+        }
+        previous = std::move(*parsed);
+        if (fileExists(stamp_path)) {
+            FileInputWin32 stamp_reader(stamp_path);
+            previous_stamps = StampFile::readFromFile(stamp_reader);
+        }
+        if (use_checkpoints && fileExists(checkpoint_path)) {
+            try {
+                FileInputWin32 checkpoint_reader(checkpoint_path);
+                previous_checkpoints = CheckpointFile::readFromFile(checkpoint_reader);
+            } catch (Exception&) {
+                // checkpoints are optional; without them, files are hashed from the start
+            }
+        }
+    }
+    ChecksumFileUpdate update(std::move(previous), std::move(previous_stamps));
+    CheckpointFile checkpoints;
+    // a checkpoint for a file that has not shrunk remains valid for appending later
+    auto const keepCheckpoint = [&](std::u8string_view path, uint64_t size) {
+        if (!use_checkpoints) { return; }
+        if (auto c = previous_checkpoints.getCheckpoint(path); c && (c->covered_length <= size)) {
+            checkpoints.setCheckpoint(path, std::move(*c));
+        }
+    };
+
+    // an existing BlockDigests sidecar is kept up to date: the blocks of unchanged files
+    // are carried over and those of all files that get hashed are recomputed
+    bool const maintain_block_digests = fileExists(block_digests_path);
+    BlockDigests previous_block_digests;
+    if (maintain_block_digests) {
+        try {
+            FileInputWin32 block_reader(block_digests_path);
+            previous_block_digests = BlockDigests::readFromFile(block_reader, *op.checksum_provider);
+        } catch (Exception&) {
+            // an unreadable sidecar is replaced by one for the hashed files only
+        }
+    }
+    BlockDigests block_digests(previous_block_digests.getBlockSize());
+    HasherPtr const block_hasher =
+        (maintain_block_digests) ? op.checksum_provider->createHasher(op.hasher_options) : nullptr;
+    auto const keepBlockDigests = [&](std::u8string_view path, uint64_t size) {
+        if (!maintain_block_digests) { return; }
+        if (BlockDigests::File const* b = previous_block_digests.getFile(path); b && (b->file_size == size)) {
+            block_digests.setFile(path, b->file_size, b->blocks);
+        }
+    };
+
+    HashReadStates read_states(hashFileAutotuneBounds(1));
+
+    // a file that was replaced or rewritten instead of appended to may still have grown,
+    // so checkpoints record a digest of the last bytes they cover and are only resumed
+    // from if the file still has the same bytes there
+    HasherPtr const guard_hasher = (use_checkpoints) ? op.checksum_provider->createHasher(op.hasher_options) : nullptr;
+    auto const computePrefixGuard = [&](HANDLE fin, uint64_t covered_length) -> std::optional<std::vector<std::byte>> {
+        uint64_t const guard_size = std::min(covered_length, CHECKPOINT_GUARD_SIZE);
+        if (hashFile(nullptr, *guard_hasher, fin, static_cast<int64_t>(covered_length - guard_size),
+                     static_cast<int64_t>(guard_size), read_states) != HashResult::DigestReady)
+        {
+            return std::nullopt;
+        }
+        std::u8string const guard = guard_hasher->finalize().toString();
+        return std::vector<std::byte>(reinterpret_cast<std::byte const*>(guard.data()),
+                                      reinterpret_cast<std::byte const*>(guard.data() + guard.size()));
+    };
+
+    signalOperationStarted(op.event_handler, 0);
+    EventHandler::Result result = {};
+    for (auto const& [absolute_path, relative_path, size, modification_time] : iterateFiles(op.folder_path)) {
+        std::u16string_view const absolute_path_view = assumeUtf16(absolute_path);
+        if (isChecksumFileOrSidecar(absolute_path_view, op.checksum_path)) { continue; }
         std::u8string const utf8_relative_path = convertToUtf8(relative_path);
-        std::u8string const utf8_absolute_path = convertToUtf8(assumeUtf16(absolute_path));
+        std::u8string const utf8_absolute_path = convertToUtf8(absolute_path_view);
+        FileStamp const stamp{ .size = size, .modification_time = modification_time };
         signalFileStarted(op.event_handler, utf8_relative_path, utf8_absolute_path);
+        ++result.total;
+        if (Digest const* unchanged_digest = update.findUnchanged(utf8_relative_path, stamp); unchanged_digest) {
+            Digest d = *unchanged_digest;
+            signalFileCompleted(op.event_handler, utf8_relative_path, d, utf8_absolute_path,
+                                EventHandler::CompletionStatus::Ok);
+            update.addEntry(utf8_relative_path, stamp, std::move(d));
+            keepCheckpoint(utf8_relative_path, size);
+            keepBlockDigests(utf8_relative_path, size);
+            ++result.ok;
+            continue;
+        }
+        // block digests require reading the file, so they bypass the digest cache
+        if (std::optional<Digest> cached_digest =
+                (maintain_block_digests) ? std::nullopt : lookupCachedDigest(op, utf8_absolute_path, stamp);
+            cached_digest)
+        {
+            signalFileCompleted(op.event_handler, utf8_relative_path, *cached_digest, utf8_absolute_path,
+                                EventHandler::CompletionStatus::Ok);
+            update.addEntry(utf8_relative_path, stamp, std::move(*cached_digest));
+            keepCheckpoint(utf8_relative_path, size);
+            ++result.ok;
+            continue;
+        }
         HANDLE fin = CreateFile(absolute_path, GENERIC_READ, FILE_SHARE_READ, nullptr,
                                 OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN | FILE_FLAG_OVERLAPPED, nullptr);
         if (fin == INVALID_HANDLE_VALUE) {
@@ -580,14 +1221,64 @@ void OperationScheduler::doCreate(OperationState& op) {
         }
         HandleGuard guard_fin(fin);
         LARGE_INTEGER l_file_size;
-        HashResult const res = (GetFileSizeEx(fin, &l_file_size)) ?
-            hashFile(op.event_handler, *op.hasher, fin, 0, l_file_size.QuadPart, read_states) :
-            HashResult::Error;
+        if (!GetFileSizeEx(fin, &l_file_size)) {
+            signalFileCompleted(op.event_handler, utf8_relative_path, Digest{}, utf8_absolute_path,
+                                EventHandler::CompletionStatus::Bad);
+            ++result.bad;
+            continue;
+        }
+        int64_t const file_size = l_file_size.QuadPart;
+        std::optional<HashCheckpoint> checkpoint;
+        if (use_checkpoints) {
+            checkpoint = previous_checkpoints.getCheckpoint(utf8_relative_path);
+            // only resume if data was actually appended; anything else is hashed from the start
+            if (checkpoint && (checkpoint->covered_length >= static_cast<uint64_t>(file_size))) { checkpoint.reset(); }
+            if (checkpoint && (computePrefixGuard(fin, checkpoint->covered_length) != checkpoint->prefix_guard)) {
+                checkpoint.reset();
+            }
+        }
+        int64_t const hash_offset = (checkpoint) ? static_cast<int64_t>(checkpoint->covered_length) : 0;
+        // files resumed from a checkpoint only have their appended data read, so their
+        // blocks cannot be recomputed and are dropped from the sidecar
+        std::optional<BlockDigestBuilder> block_builder;
+        if (block_hasher && !checkpoint) { block_builder.emplace(*block_hasher, block_digests.getBlockSize()); }
+        HashResult res;
+        try {
+            res = hashFile(op.event_handler, *op.hasher, fin, hash_offset, file_size - hash_offset, read_states,
+                           (checkpoint) ? std::span<std::byte const>(checkpoint->state) : std::span<std::byte const>{},
+                           (block_builder) ? &(*block_builder) : nullptr);
+        } catch (Exception& e) {
+            // a checkpoint that the hasher rejects is ignored and the file is hashed from the start
+            if (!checkpoint || (e.code() != Error::HasherFailure)) { throw; }
+            if (block_hasher) { block_builder.emplace(*block_hasher, block_digests.getBlockSize()); }
+            res = hashFile(op.event_handler, *op.hasher, fin, 0, file_size, read_states, {},
+                           (block_builder) ? &(*block_builder) : nullptr);
+        }
         if (res == HashResult::DigestReady) {
+            if (block_builder) {
+                // the file may have changed size while it was being read
+                std::vector<Digest> blocks = block_builder->finalize();
+                if (blocks.size() == block_digests.blockCount(static_cast<uint64_t>(file_size))) {
+                    block_digests.setFile(utf8_relative_path, static_cast<uint64_t>(file_size), std::move(blocks));
+                }
+            }
+            if (use_checkpoints) {
+                if (std::optional<std::vector<std::byte>> prefix_guard =
+                        computePrefixGuard(fin, static_cast<uint64_t>(file_size));
+                    prefix_guard)
+                {
+                    checkpoints.setCheckpoint(utf8_relative_path, HashCheckpoint{
+                        .covered_length = static_cast<uint64_t>(file_size),
+                        .prefix_guard = std::move(*prefix_guard),
+                        .state = op.hasher->saveState()
+                    });
+                }
+            }
             Digest d = op.hasher->finalize();
+            storeCachedDigest(op, utf8_absolute_path, stamp, d);
             signalFileCompleted(op.event_handler, utf8_relative_path, d, utf8_absolute_path,
                                 EventHandler::CompletionStatus::Ok);
-            op.checksum_file.addEntry(utf8_relative_path, std::move(d));
+            update.addEntry(utf8_relative_path, stamp, std::move(d));
             ++result.ok;
         } else if (res == HashResult::Error) {
             signalFileCompleted(op.event_handler, utf8_relative_path, {}, utf8_absolute_path,
@@ -598,13 +1289,58 @@ void OperationScheduler::doCreate(OperationState& op) {
             result.was_canceled = true;
             return;
         }
-        ++result.total;
     }
-    FileOutputWin32 writer(op.checksum_path);
-    op.checksum_provider->writeNewFile(writer, op.checksum_file);
+    {
+        FileOutputWin32 writer(op.checksum_path);
+        op.checksum_provider->writeNewFile(writer, update.getChecksumFile());
+    }
+    {
+        FileOutputWin32 stamp_writer(stamp_path);
+        update.getStampFile().writeToFile(stamp_writer);
+    }
+    if (use_checkpoints) {
+        FileOutputWin32 checkpoint_writer(checkpoint_path);
+        checkpoints.writeToFile(checkpoint_writer);
+    }
+    if (maintain_block_digests) {
+        FileOutputWin32 block_writer(block_digests_path);
+        block_digests.writeToFile(block_writer);
+    }
+    op.checksum_file = update.getChecksumFile();
+    if (op.create_directory_digests) { writeDirectoryDigests(op); }
     signalOperationCompleted(op.event_handler, result);
 }
 
+void OperationScheduler::writeDirectoryDigests(OperationState& op) {
+    // create operations hash on per-worker Hashers and leave op.hasher empty, so the
+    // directory digests always get a Hasher of their own
+    HasherPtr const hasher = op.checksum_provider->createHasher(op.hasher_options);
+    DirectoryDigests const directory_digests = DirectoryDigests::fromChecksumFile(op.checksum_file, *hasher);
+    FileOutputWin32 writer(directoryDigestsFilePath(op.checksum_path));
+    directory_digests.writeToFile(writer);
+}
+
+std::optional<Digest> OperationScheduler::lookupCachedDigest(OperationState const& op, std::u8string_view absolute_path,
+                                                           FileStamp const& stamp)
+{
+    if (op.digest_cache_attribute.empty()) { return std::nullopt; }
+    std::optional<std::u8string> const cached = m_digestCache->lookup(absolute_path, op.digest_cache_attribute, stamp);
+    if (!cached) { return std::nullopt; }
+    try {
+        return op.checksum_provider->digestFromString(*cached);
+    } catch (Exception&) {
+        // entry was written by a different provider using the same attribute name
+        return std::nullopt;
+    }
+}
+
+void OperationScheduler::storeCachedDigest(OperationState const& op, std::u8string_view absolute_path,
+                                           FileStamp const& stamp, Digest const& digest)
+{
+    if (op.digest_cache_attribute.empty()) { return; }
+    m_digestCache->store(absolute_path, op.digest_cache_attribute, stamp, digest.toString());
+}
+
 void OperationScheduler::signalOperationStarted(EventHandler* recipient, uint32_t n_files) {
     std::scoped_lock lk(m_mtxEvents);
     m_eventsQueue.emplace_back(Event{
@@ -639,6 +1375,18 @@ void OperationScheduler::signalProgress(EventHandler* recipient, uint32_t percen
     PostThreadMessage(m_startingThreadId, WM_SCHEDULER_WAKEUP, 0, 0);
 }
 
+void OperationScheduler::signalDamagedRanges(EventHandler* recipient, std::u8string file, std::vector<BlockRange> ranges) {
+    std::scoped_lock lk(m_mtxEvents);
+    m_eventsQueue.emplace_back(Event{
+        .recipient = recipient,
+        .event = Event::EDamagedRanges {
+            .file = std::move(file),
+            .ranges = std::move(ranges)
+        }
+    });
+    PostThreadMessage(m_startingThreadId, WM_SCHEDULER_WAKEUP, 0, 0);
+}
+
 void OperationScheduler::signalFileCompleted(EventHandler* recipient, std::u8string file, Digest checksum,
                                              std::u8string absolute_file_path, EventHandler::CompletionStatus status) {
     std::scoped_lock lk(m_mtxEvents);
@@ -699,6 +1447,10 @@ void OperationScheduler::dispatchEvent(EventHandler* recipient, Event::EProgress
     recipient->onProgress(e.percentage, e.bandwidth_mib_s);
 }
 
+void OperationScheduler::dispatchEvent(EventHandler* recipient, Event::EDamagedRanges const& e) {
+    recipient->onDamagedRanges(e.file, e.ranges);
+}
+
 void OperationScheduler::dispatchEvent(EventHandler* recipient, Event::EFileCompleted const& e) {
     recipient->onFileCompleted(e.file, e.checksum, e.absolute_file_path, e.status);
 }
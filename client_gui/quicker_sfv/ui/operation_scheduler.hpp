@@ -20,15 +20,21 @@
 #ifndef INCLUDE_GUARD_QUICKER_SFV_GUI_UI_OPERATION_SCHEDULER_HPP
 #define INCLUDE_GUARD_QUICKER_SFV_GUI_UI_OPERATION_SCHEDULER_HPP
 
+#include <quicker_sfv/block_digests.hpp>
 #include <quicker_sfv/checksum_file.hpp>
 #include <quicker_sfv/checksum_provider.hpp>
+#include <quicker_sfv/digest_cache.hpp>
 #include <quicker_sfv/hasher.hpp>
+#include <quicker_sfv/verified_database.hpp>
 
 #include <quicker_sfv/ui/event_handler.hpp>
+#include <quicker_sfv/ui/io_autotuner.hpp>
 
 #include <chrono>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <span>
 #include <variant>
 #include <vector>
@@ -43,17 +49,54 @@ namespace Operation {
 
 /** Verify operation.
  * This operation verifies an existing checksum file on disk.
+ * If a verified database is given, files that have not changed since their last
+ * successful verification may be skipped according to the policy, and all
+ * successful verifications will be recorded in the database.
+ * If the digest cache is used, files whose cached digest matches the expected one
+ * are not read, and digests of all hashed files are written to the cache.
+ * If BlockDigests exist next to the checksum file, damaged ranges are reported for
+ * all files that fail verification, by reading those files a second time. If a
+ * block audit is requested, files with BlockDigests are only checked by reading a
+ * random sample of their blocks and are reported as CompletionStatus::Audited if
+ * all sampled blocks match.
+ * Files are checked from smallest to largest expected size, but their completions are
+ * reported in the order of the checksum file. With a single file in flight, files are
+ * reported as started, and their progress is reported, in the order they are checked.
+ * If more than one file is to be in flight, files are verified concurrently on a
+ * pool of threads. Results are still reported in the order of the checksum file, but
+ * files are only reported as started once their result is available, and no progress
+ * is reported for individual files. Files are not grouped by volume, so the files in
+ * flight may well compete for the same disk.
  */
 struct Verify {
     EventHandler* event_handler;
     HasherOptions options;
     std::u16string source_file;
     ChecksumProvider* provider;
+    std::u16string verified_database_path;      ///< Empty if no database is to be used.
+    VerifiedDatabasePolicy verified_database_policy;
+    bool use_digest_cache;
+    uint32_t block_audit_samples;               ///< Number of blocks to check per file.
+                                                ///  0 to verify entire files.
+    uint32_t files_in_flight;                   ///< Number of files hashed concurrently.
+                                                ///  0 and 1 hash one file after another.
 };
 
 /** Create from folder operation.
  * This operation creates a new checksum file by checking all files in a folder and
  * all of its subfolders.
+ * If requested, the per-directory aggregate DirectoryDigests will be written to a
+ * sidecar file next to the checksum file.
+ * If the digest cache is used, files with a valid cached digest are not read, and
+ * digests of all hashed files are written to the cache.
+ * If requested, BlockDigests for all files that were read will be written to a
+ * sidecar file next to the checksum file.
+ * The FileStamps of all files are written to a StampFile next to the checksum file,
+ * so that a subsequent update only needs to read the files that have changed since.
+ * If more than one file is to be in flight, files are hashed concurrently on a pool of
+ * threads. Results are still reported, and entries are written to the checksum file,
+ * in the order in which the files were found, but files are only reported as started
+ * once their result is available, and no progress is reported for individual files.
  */
 struct CreateFromFolder {
     EventHandler* event_handler;
@@ -61,6 +104,42 @@ struct CreateFromFolder {
     std::u16string target_file;
     std::u16string folder_path;
     ChecksumProvider* provider;
+    bool create_directory_digests;
+    bool use_digest_cache;
+    bool create_block_digests;
+    uint32_t files_in_flight;                   ///< Number of files hashed concurrently.
+                                                ///  0 and 1 hash one file after another.
+};
+
+/** Update from folder operation.
+ * This operation updates an existing checksum file to reflect the current contents
+ * of a folder and all of its subfolders. Files whose size and modification time
+ * match the StampFile stored alongside the existing checksum file are not hashed
+ * again. Entries for files that no longer exist are dropped. If no checksum file
+ * exists at the target location yet, this behaves like CreateFromFolder.
+ * The digest cache is consulted for files that are not covered by the StampFile.
+ * If resuming of appended files is requested, the Hasher state after each file is
+ * stored in a CheckpointFile next to the checksum file. Files that have grown since
+ * then are assumed to have only been appended to, and hashing continues from the
+ * checkpoint, reading only the appended data. Checkpoints whose last covered bytes
+ * no longer match, as for files that were replaced, are discarded. Still, this is
+ * only correct for files that are never modified other than by appending and
+ * requires a Hasher that supports saving its state.
+ * If a BlockDigests sidecar exists, it is rewritten for the updated checksum file.
+ * The block digests of files that are unchanged according to the StampFile are
+ * kept, those of all files that are read are recomputed, and all others are
+ * dropped. Files with block digests are always read instead of using the digest
+ * cache.
+ */
+struct UpdateFromFolder {
+    EventHandler* event_handler;
+    HasherOptions options;
+    std::u16string target_file;
+    std::u16string folder_path;
+    ChecksumProvider* provider;
+    bool create_directory_digests;
+    bool use_digest_cache;
+    bool resume_appended_files;
 };
 
 /** Cancel the currently running operation.
@@ -95,12 +174,23 @@ private:
         ChecksumProvider* checksum_provider;
         enum Op {
             Create,
-            Verify
+            Verify,
+            Update
         } kind;
         ChecksumFile checksum_file;
         std::u16string checksum_path;
         std::u16string folder_path;
-        HasherPtr hasher;
+        HasherOptions hasher_options;
+        HasherPtr hasher;                       ///< Hasher for update operations. Verify and
+                                                ///  create operations use one per worker.
+        bool create_directory_digests;
+        std::u16string verified_database_path;
+        VerifiedDatabasePolicy verified_database_policy;
+        std::u8string digest_cache_attribute;   ///< Empty if the digest cache is not used.
+        bool resume_appended_files;
+        bool create_block_digests;
+        uint32_t block_audit_samples;
+        uint32_t files_in_flight;
     };
     std::vector<OperationState> m_opsQueue;     ///< Queue of posted Operations.
     std::mutex m_mtxOps;
@@ -122,6 +212,10 @@ private:
             uint32_t percentage;
             uint32_t bandwidth_mib_s;
         };
+        struct EDamagedRanges {
+            std::u8string file;
+            std::vector<BlockRange> ranges;
+        };
         struct EFileCompleted {
             std::u8string file;
             Digest checksum;
@@ -138,7 +232,7 @@ private:
             std::u8string msg;
         };
         EventHandler* recipient;
-        std::variant<EOperationStarted, EFileStarted, EProgress, EFileCompleted,
+        std::variant<EOperationStarted, EFileStarted, EProgress, EDamagedRanges, EFileCompleted,
                      EOperationCompleted, ECanceled, EError> event;
     };
     std::vector<Event> m_eventsQueue;           ///< Queue of outstanding events.
@@ -146,6 +240,7 @@ private:
 
     std::thread m_worker;
     DWORD m_startingThreadId;
+    std::unique_ptr<DigestCache> m_digestCache;
 public:
     /** Constructor.
      * OperationScheduler is constructed in an inactive state. A call to start() is
@@ -189,6 +284,9 @@ public:
     /** Post a create operation.
      */
     void post(Operation::CreateFromFolder op);
+    /** Post an update operation.
+     */
+    void post(Operation::UpdateFromFolder op);
     /// @}
 private:
     /** Main function for the worker thread.
@@ -200,6 +298,23 @@ private:
     /** Carries out a create operation.
      */
     void doCreate(OperationState& op);
+    /** Carries out an update operation.
+     */
+    void doUpdate(OperationState& op);
+    /** Writes the DirectoryDigests sidecar for a completed create or update operation.
+     * Does not use op.hasher, which is null for create operations.
+     */
+    void writeDirectoryDigests(OperationState& op);
+    /** Retrieves a digest from the digest cache.
+     * @return The cached Digest if the operation uses the digest cache and a valid
+     *         entry for the current stamp of the file exists. An empty optional otherwise.
+     */
+    std::optional<Digest> lookupCachedDigest(OperationState const& op, std::u8string_view absolute_path,
+                                             FileStamp const& stamp);
+    /** Stores a computed digest in the digest cache, if the operation uses the digest cache.
+     */
+    void storeCachedDigest(OperationState const& op, std::u8string_view absolute_path,
+                           FileStamp const& stamp, Digest const& digest);
 
     enum class HashResult {
         DigestReady,        ///< A checksum Digest was computed successfully.
@@ -207,17 +322,62 @@ private:
         Error,              ///< The computation failed due to an error.
     };
     struct HashReadState {
-        std::vector<std::byte> buffer;              ///< Buffer for file I/O.
+        std::vector<std::byte> buffer;              ///< Buffer for file I/O. Taken from
+                                                    ///  HashReadStates::acquireBuffer()
+                                                    ///  for each read.
         HANDLE event;                               ///< Event for async file I/O.
         OVERLAPPED overlapped;                      ///< Async file I/O.
+        DWORD bytes_requested;                      ///< Size of the pending read.
         bool pending;                               ///< The state has pending
                                                     ///  async operations.
         std::chrono::steady_clock::time_point t;    ///< Time point for performance
                                                     ///  measurements.
     };
+    /** Owns one HashReadState for each read that may be in flight, and the IoAutotuner
+     * picking the number and size of the reads.
+     * The tuner carries its state from file to file, so that it does not have to
+     * start over for each file of an operation.
+     * Buffers are only allocated as the tuner raises the queue depth, and only as many
+     * are kept around between reads as the current setting needs, so the memory held
+     * stays within the max_bytes_in_flight of the tuner's bounds.
+     */
+    class HashReadStates {
+    private:
+        std::vector<HashReadState> m_states;
+        std::vector<std::vector<std::byte>> m_spareBuffers;
+        IoAutotuner m_autotuner;
+    public:
+        /** Constructor.
+         * @param[in] bounds Bounds for the IoAutotuner. One HashReadState is created
+         *                   for each read up to bounds.max_queue_depth.
+         * @throw Exception Error::SystemError if the events cannot be created.
+         */
+        explicit HashReadStates(IoAutotunerOptions const& bounds);
+        ~HashReadStates();
+        HashReadStates& operator=(HashReadStates&&) = delete;
+        std::span<HashReadState> states() noexcept;
+        IoAutotuner& autotuner() noexcept;
+        /** Buffer of the current chunk size for a new read.
+         */
+        std::vector<std::byte> acquireBuffer();
+        /** Returns a buffer obtained from acquireBuffer() once its data has been hashed.
+         * The buffer is kept for reuse only if it still has the current chunk size and
+         * the current queue depth has room for it next to the n_in_flight pending reads.
+         */
+        void releaseBuffer(std::vector<std::byte>&& buffer, std::size_t n_in_flight);
+    };
+    /** State of a thread hashing files for a verify or create operation.
+     */
+    struct HashWorkerState {
+        HasherPtr hasher;
+        HasherPtr block_hasher;                 ///< Separate Hasher for BlockDigests.
+                                                ///  Null if no BlockDigests are used.
+        HashReadStates read_states;
+    };
     /** Computes the checksum for a single file.
      * @param[in] event_handler EventHandler associated with the operation which this
-     *                          hashing is part of.
+     *                          hashing is part of. May be null if no progress is to
+     *                          be reported.
      * @param[in] hasher Hasher to carry out the computation of the checksum.
      * @param[in] fin An opened Win32 file handle to the file that is to be hashed.
      *                The handle must point to the start of the data portion that is
@@ -226,15 +386,49 @@ private:
      *                        the relevant data segment starts.
      * @param[in] data_size The size of the data segments to read from the file for
      *                      computing the hash in bytes.
-     * @param[in] read_states Double-buffered structs containing the state for
-     *                        carrying out the hashing. The sole reason this is
-     *                        included here is to allow reusing the same state for
-     *                        all hashings carried out by a single Operation as a
+     * @param[in] read_states Structs containing the state for carrying out the
+     *                        hashing, one for each read that may be in flight. The
+     *                        number of reads in flight and their size are picked
+     *                        by its IoAutotuner. The sole reason this is included
+     *                        here is to allow reusing the same state for all
+     *                        hashings carried out by a single Operation as a
      *                        performance optimisation.
+     * @param[in] resume_state If not empty, the hasher is restored to this state
+     *                         obtained from Hasher::saveState() instead of being
+     *                         reset before hashing.
+     * @param[in] block_builder If not null, all hashed data is also passed to this
+     *                          BlockDigestBuilder.
      */
     HashResult hashFile(EventHandler* event_handler, Hasher& hasher,
                         HANDLE fin, int64_t data_offset, int64_t data_size,
-                        std::span<HashReadState, 2> read_states);
+                        HashReadStates& read_states,
+                        std::span<std::byte const> resume_state = {},
+                        BlockDigestBuilder* block_builder = nullptr);
+    /** Checks a random sample of blocks of a file against its BlockDigests.
+     * @param[in] op The verify operation.
+     * @param[in] event_handler As for hashFile(). Progress is reported as the share
+     *                          of sampled blocks checked.
+     * @param[in] block_hasher Hasher for computing the block digests.
+     * @param[in] fin An opened Win32 file handle to the file that is to be audited.
+     * @param[in] block_digests The BlockDigests for the checksum file.
+     * @param[in] expected The recorded block digests of the file.
+     * @param[in] read_states As for hashFile().
+     * @param[in] seed Seed for selecting the sampled blocks.
+     * @param[out] damaged_blocks Receives the indices of all sampled blocks that
+     *                            did not match.
+     * @return HashResult::DigestReady if all sampled blocks were checked.
+     */
+    HashResult auditBlocks(OperationState const& op, EventHandler* event_handler, Hasher& block_hasher, HANDLE fin,
+                           BlockDigests const& block_digests, BlockDigests::File const& expected,
+                           HashReadStates& read_states, uint64_t seed, std::vector<uint64_t>& damaged_blocks);
+    /** Creates the state for each thread hashing files for a verify or create operation.
+     * @param[in] op The operation.
+     * @param[in] n_workers Number of hashing threads.
+     * @param[in] use_block_digests Whether each thread needs a Hasher for BlockDigests.
+     */
+    static std::vector<std::unique_ptr<HashWorkerState>> createHashWorkerStates(OperationState const& op,
+                                                                                uint32_t n_workers,
+                                                                                bool use_block_digests);
 
     /** @name Functions for posting events to the event queue.
      * These must only be called from the worker thread.
@@ -243,6 +437,7 @@ private:
     void signalOperationStarted(EventHandler* recipient, uint32_t n_files);
     void signalFileStarted(EventHandler* recipient, std::u8string file, std::u8string absolute_file_path);
     void signalProgress(EventHandler* recipient, uint32_t percentage, uint32_t bandwidth_mib_s);
+    void signalDamagedRanges(EventHandler* recipient, std::u8string file, std::vector<BlockRange> ranges);
     void signalFileCompleted(EventHandler* recipient, std::u8string file, Digest checksum,
         std::u8string absolute_file_path, EventHandler::CompletionStatus status);
     void signalOperationCompleted(EventHandler* recipient, EventHandler::Result r);
@@ -257,6 +452,7 @@ private:
     static void dispatchEvent(EventHandler* recipient, Event::EOperationStarted const& e);
     static void dispatchEvent(EventHandler* recipient, Event::EFileStarted const& e);
     static void dispatchEvent(EventHandler* recipient, Event::EProgress const& e);
+    static void dispatchEvent(EventHandler* recipient, Event::EDamagedRanges const& e);
     static void dispatchEvent(EventHandler* recipient, Event::EFileCompleted const& e);
     static void dispatchEvent(EventHandler* recipient, Event::EOperationCompleted const& e);
     static void dispatchEvent(EventHandler* recipient, Event::ECanceled const& e);
@@ -0,0 +1,213 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_GUI_UI_ORDERED_TASK_POOL_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_GUI_UI_ORDERED_TASK_POOL_HPP
+
+#include <quicker_sfv/ui/enforce.hpp>
+#include <quicker_sfv/ui/reorder_buffer.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace quicker_sfv::gui {
+
+/** Pool of worker threads that runs tasks concurrently, but delivers their results in order.
+ * Tasks are submitted one after another and are carried out by the first free worker.
+ * The result of each task is passed to the sink in the order in which the tasks were
+ * submitted, regardless of the order in which they complete. The sink is only ever
+ * invoked on the thread calling submit() and finish(), so it does not need any
+ * synchronization of its own.
+ *
+ * At most max_in_flight tasks are submitted but not yet delivered at any time. Once
+ * that limit is reached, submit() blocks until the oldest task completes. This bounds
+ * the number of results held back behind a slow task, while still allowing the other
+ * workers to go ahead of it.
+ *
+ * If a task throws, no further tasks are started and the exception is rethrown from
+ * the next call to submit() or finish(). Results of tasks that were submitted before
+ * the failed one may get lost in that case.
+ */
+template<typename Result>
+class OrderedTaskPool {
+public:
+    /** A task. Receives the index of the worker carrying it out, in the range
+     * [0, max(n_workers, 1)). Tasks running concurrently always have different worker
+     * indices, so state owned by a worker can be used without synchronization.
+     */
+    using Task = std::function<Result(uint32_t worker_index)>;
+    /** Receives the result of each task, in the order of submission.
+     */
+    using Sink = std::function<void(Result&& result)>;
+private:
+    struct QueuedTask {
+        std::size_t index;
+        Task task;
+    };
+    Sink m_sink;
+    std::size_t m_maxInFlight;
+    std::mutex m_mtx;
+    std::condition_variable m_cvTasks;          ///< Signaled when a task was queued or on shutdown.
+    std::condition_variable m_cvResults;        ///< Signaled when a task has completed.
+    std::deque<QueuedTask> m_tasks;
+    ReorderBuffer<Result> m_results;
+    std::size_t m_nSubmitted;
+    std::exception_ptr m_error;
+    bool m_shutdownRequested;
+    std::vector<std::jthread> m_workers;
+public:
+    /** Constructor.
+     * @param[in] n_workers Number of worker threads. If 0, each task is carried out
+     *                      by submit() on the calling thread.
+     * @param[in] max_in_flight Maximum number of tasks submitted but not yet delivered.
+     * @param[in] sink Receives the results.
+     * @pre max_in_flight >= n_workers.
+     */
+    OrderedTaskPool(uint32_t n_workers, std::size_t max_in_flight, Sink sink)
+        :m_sink(std::move(sink)), m_maxInFlight(max_in_flight), m_nSubmitted(0), m_shutdownRequested(false)
+    {
+        enforce(max_in_flight >= n_workers);
+        m_workers.reserve(n_workers);
+        try {
+            for (uint32_t i = 0; i < n_workers; ++i) {
+                m_workers.emplace_back([this, i]() { worker(i); });
+            }
+        } catch (...) {
+            shutdown();
+            throw;
+        }
+    }
+
+    /** Destructor.
+     * Tasks that have not started yet are discarded and their results are not
+     * delivered. Blocks until all tasks in progress have completed.
+     */
+    ~OrderedTaskPool() {
+        shutdown();
+    }
+
+    OrderedTaskPool& operator=(OrderedTaskPool&&) = delete;
+
+    /** Submits a task.
+     * Delivers all results that are available. Blocks while max_in_flight tasks are
+     * outstanding.
+     * @throw Any exception thrown by a task or by the sink.
+     */
+    void submit(Task task) {
+        if (m_workers.empty()) {
+            m_sink(task(0));
+            return;
+        }
+        std::unique_lock lk(m_mtx);
+        for (;;) {
+            deliverResults(lk);
+            if (m_error) { std::rethrow_exception(m_error); }
+            if (m_nSubmitted - m_results.nextIndex() < m_maxInFlight) { break; }
+            m_cvResults.wait(lk);
+        }
+        m_tasks.push_back(QueuedTask{ .index = m_nSubmitted, .task = std::move(task) });
+        ++m_nSubmitted;
+        lk.unlock();
+        m_cvTasks.notify_one();
+    }
+
+    /** Blocks until all submitted tasks have completed and their results were delivered.
+     * @throw Any exception thrown by a task or by the sink.
+     */
+    void finish() {
+        if (m_workers.empty()) { return; }
+        std::unique_lock lk(m_mtx);
+        for (;;) {
+            deliverResults(lk);
+            if (m_error) { std::rethrow_exception(m_error); }
+            if (m_results.nextIndex() == m_nSubmitted) { return; }
+            m_cvResults.wait(lk);
+        }
+    }
+
+    /** Number of worker threads.
+     */
+    uint32_t workerCount() const noexcept {
+        return static_cast<uint32_t>(m_workers.size());
+    }
+private:
+    /** Passes all results that are next in order to the sink.
+     * The lock is released while the sink runs.
+     */
+    void deliverResults(std::unique_lock<std::mutex>& lk) {
+        while (std::optional<Result> r = m_results.pop()) {
+            lk.unlock();
+            m_sink(std::move(*r));
+            lk.lock();
+        }
+    }
+
+    void worker(uint32_t worker_index) {
+        for (;;) {
+            QueuedTask t;
+            {
+                std::unique_lock lk(m_mtx);
+                m_cvTasks.wait(lk, [this]() { return m_shutdownRequested || !m_tasks.empty(); });
+                if (m_tasks.empty()) { return; }
+                t = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            std::optional<Result> r;
+            std::exception_ptr e;
+            try {
+                r.emplace(t.task(worker_index));
+            } catch (...) {
+                e = std::current_exception();
+            }
+            {
+                std::scoped_lock lk(m_mtx);
+                if (r) {
+                    m_results.insert(t.index, std::move(*r));
+                } else {
+                    if (!m_error) { m_error = e; }
+                    m_tasks.clear();
+                }
+            }
+            m_cvResults.notify_one();
+        }
+    }
+
+    void shutdown() {
+        {
+            std::scoped_lock lk(m_mtx);
+            m_shutdownRequested = true;
+            m_tasks.clear();
+        }
+        m_cvTasks.notify_all();
+        m_workers.clear();
+    }
+};
+
+}
+
+#endif
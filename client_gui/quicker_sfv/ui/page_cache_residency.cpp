@@ -0,0 +1,98 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/page_cache_residency.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace quicker_sfv::gui {
+
+namespace {
+/// Number of pages mapped at once while probing; bounds address space and vector size.
+constexpr uint64_t const PROBE_WINDOW_PAGES = 1 << 16;
+/// Number of pages sampled by probeNoWaitReads().
+constexpr int64_t const NOWAIT_SAMPLES = 3;
+
+int64_t pageSize() noexcept {
+    static int64_t const page_size = sysconf(_SC_PAGESIZE);
+    return page_size;
+}
+}
+
+std::optional<PageResidency> queryPageResidency(int fd, int64_t offset, int64_t size) noexcept {
+    int64_t const page_size = pageSize();
+    int64_t const begin = offset - (offset % page_size);
+    int64_t const end = offset + size;
+    PageResidency ret{ .resident_pages = 0, .total_pages = 0 };
+    std::vector<unsigned char> residency;
+    for (int64_t window = begin; window < end;) {
+        std::size_t const window_size = static_cast<std::size_t>(std::min<int64_t>(PROBE_WINDOW_PAGES * page_size, end - window));
+        void* const p = mmap(nullptr, window_size, PROT_READ, MAP_SHARED, fd, window);
+        if (p == MAP_FAILED) { return std::nullopt; }
+        std::size_t const n_pages = static_cast<std::size_t>((window_size + page_size - 1) / page_size);
+        residency.resize(n_pages);
+        int const res = mincore(p, window_size, residency.data());
+        munmap(p, window_size);
+        if (res != 0) { return std::nullopt; }
+        ret.total_pages += n_pages;
+        ret.resident_pages += std::ranges::count_if(residency, [](unsigned char c) { return (c & 1) != 0; });
+        window += static_cast<int64_t>(window_size);
+    }
+    return ret;
+}
+
+std::optional<bool> probeNoWaitReads(int fd, int64_t offset, int64_t size) noexcept {
+    if (size <= 0) { return true; }
+    std::array<std::byte, 4096> buffer;
+    int64_t const sample_size = std::min<int64_t>(buffer.size(), size);
+    for (int64_t i = 0; i < NOWAIT_SAMPLES; ++i) {
+        // samples at the start, in the middle and at the end of the range
+        int64_t const sample_offset = offset + ((size - sample_size) * i) / (NOWAIT_SAMPLES - 1);
+        iovec iov{ .iov_base = buffer.data(), .iov_len = static_cast<std::size_t>(sample_size) };
+        ssize_t res;
+        do {
+            res = preadv2(fd, &iov, 1, sample_offset, RWF_NOWAIT);
+        } while ((res < 0) && (errno == EINTR));
+        if (res < 0) {
+            if (errno == EAGAIN) { return false; }
+            return std::nullopt;
+        }
+        // a partial read means that only part of the sample is cached
+        if (res < sample_size) { return false; }
+    }
+    return true;
+}
+
+CacheResidency probeResidency(int fd, int64_t offset, int64_t size) noexcept {
+    if (std::optional<PageResidency> const r = queryPageResidency(fd, offset, size); r) {
+        return (r->resident_pages == r->total_pages) ? CacheResidency::Resident : CacheResidency::Cold;
+    }
+    std::optional<bool> const resident = probeNoWaitReads(fd, offset, size);
+    return (resident && *resident) ? CacheResidency::Resident : CacheResidency::Cold;
+}
+
+}
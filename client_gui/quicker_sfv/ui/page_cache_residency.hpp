@@ -0,0 +1,72 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_GUI_UI_PAGE_CACHE_RESIDENCY_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_GUI_UI_PAGE_CACHE_RESIDENCY_HPP
+
+#include <cstdint>
+#include <optional>
+
+namespace quicker_sfv::gui {
+
+/** Whether the data of a file can be hashed without waiting for storage.
+ */
+enum class CacheResidency {
+    Resident,       ///< All of the data is in the page cache.
+    Cold,           ///< At least part of the data has to be read from storage.
+};
+
+/** Number of pages of a file range that are resident in the page cache.
+ */
+struct PageResidency {
+    uint64_t resident_pages;
+    uint64_t total_pages;
+};
+
+/** Determines which pages of a file range are in the page cache using `mincore`.
+ * The range is mapped into memory window by window, without faulting in any pages.
+ * Pages past the end of the file are never resident.
+ * @param[in] fd File descriptor of a file opened for reading.
+ * @param[in] offset Start of the range in bytes.
+ * @param[in] size Size of the range in bytes.
+ * @return std::nullopt if the file cannot be mapped.
+ */
+[[nodiscard]] std::optional<PageResidency> queryPageResidency(int fd, int64_t offset, int64_t size) noexcept;
+
+/** Checks whether a file range is in the page cache by sampling non-blocking reads.
+ * A few pages distributed over the range are read with `preadv2(RWF_NOWAIT)`, which
+ * fails instead of waiting for storage if the data is not cached. This is a cheaper,
+ * but less precise alternative to queryPageResidency() for files that cannot be mapped.
+ * @param[in] fd File descriptor of a file opened for reading.
+ * @param[in] offset Start of the range in bytes.
+ * @param[in] size Size of the range in bytes.
+ * @return true if all sampled pages are cached.
+ *         std::nullopt if the file system does not support non-blocking reads.
+ */
+[[nodiscard]] std::optional<bool> probeNoWaitReads(int fd, int64_t offset, int64_t size) noexcept;
+
+/** Classifies a file range by its page cache residency.
+ * Uses queryPageResidency() and falls back to probeNoWaitReads() for files that cannot
+ * be mapped. Ranges that cannot be probed at all are classified as cold.
+ */
+[[nodiscard]] CacheResidency probeResidency(int fd, int64_t offset, int64_t size) noexcept;
+
+}
+
+#endif
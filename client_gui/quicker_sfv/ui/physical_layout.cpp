@@ -0,0 +1,63 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/physical_layout.hpp>
+
+#include <cstddef>
+#include <cstring>
+
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+
+namespace quicker_sfv::gui {
+
+namespace {
+/// Extents without a meaningful physical offset.
+constexpr uint32_t const UNRELIABLE_EXTENT_FLAGS = FIEMAP_EXTENT_UNKNOWN | FIEMAP_EXTENT_DELALLOC |
+                                                   FIEMAP_EXTENT_ENCODED | FIEMAP_EXTENT_DATA_INLINE |
+                                                   FIEMAP_EXTENT_NOT_ALIGNED;
+}
+
+PhysicalLocation queryPhysicalLocation(int fd, int64_t data_offset) noexcept {
+    // room for a single extent
+    alignas(fiemap) std::byte buffer[sizeof(fiemap) + sizeof(fiemap_extent)];
+    std::memset(buffer, 0, sizeof(buffer));
+    fiemap* const request = reinterpret_cast<fiemap*>(buffer);
+    request->fm_start = static_cast<uint64_t>(data_offset);
+    request->fm_length = 1;
+    request->fm_flags = 0;
+    request->fm_extent_count = 1;
+    if ((ioctl(fd, FS_IOC_FIEMAP, request) == 0) && (request->fm_mapped_extents == 1)) {
+        fiemap_extent const& e = request->fm_extents[0];
+        if ((e.fe_flags & UNRELIABLE_EXTENT_FLAGS) == 0) {
+            // the extent may start before the data
+            uint64_t const skip = (e.fe_logical < request->fm_start) ? (request->fm_start - e.fe_logical) : 0;
+            return PhysicalLocation{ .source = PhysicalLocation::Source::Extent, .position = e.fe_physical + skip };
+        }
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        return PhysicalLocation{ .source = PhysicalLocation::Source::Inode, .position = 0 };
+    }
+    return PhysicalLocation{ .source = PhysicalLocation::Source::Inode, .position = static_cast<uint64_t>(st.st_ino) };
+}
+
+}
@@ -0,0 +1,60 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_GUI_UI_PHYSICAL_LAYOUT_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_GUI_UI_PHYSICAL_LAYOUT_HPP
+
+#include <compare>
+#include <cstdint>
+
+namespace quicker_sfv::gui {
+
+/** Approximate location of file data on its storage device, for ordering reads.
+ * Locations of files on the same device compare in the order in which the device
+ * can read them with the least seeking. Files with a known physical extent come
+ * first, ordered by the extent. All other files follow, ordered by inode number,
+ * which most file systems allocate close to the data of the file.
+ * Only the Linux HashScheduler orders its reads by location; the Win32
+ * OperationScheduler checks files from smallest to largest instead.
+ */
+struct PhysicalLocation {
+    enum class Source {
+        Extent,         ///< position is the physical byte offset of the data.
+        Inode,          ///< position is the inode number of the file.
+    };
+    Source source;
+    uint64_t position;
+
+    friend auto operator<=>(PhysicalLocation const&, PhysicalLocation const&) = default;
+};
+
+/** Determines where the data of a file starts on its device.
+ * Uses the FIEMAP ioctl to look up the extent holding the byte at data_offset. Falls
+ * back to the inode number if the file system does not support FIEMAP, if the data is
+ * not allocated yet, or if the extent has no reliable physical location, as is the
+ * case for data that has not been written back or that is stored inline or encoded.
+ * @param[in] fd File descriptor of a file opened for reading.
+ * @param[in] data_offset Offset in bytes of the data in the file.
+ * @return The location; the inode number is 0 if even fstat fails.
+ */
+[[nodiscard]] PhysicalLocation queryPhysicalLocation(int fd, int64_t data_offset) noexcept;
+
+}
+
+#endif
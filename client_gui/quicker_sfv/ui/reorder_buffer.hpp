@@ -0,0 +1,102 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_GUI_UI_REORDER_BUFFER_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_GUI_UI_REORDER_BUFFER_HPP
+
+#include <quicker_sfv/ui/enforce.hpp>
+
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <utility>
+
+namespace quicker_sfv::gui {
+
+/** Restores the order of items that are produced out of order.
+ * Each item carries the index of its position in the sequence. Items may be inserted
+ * in any order, but are only released in the order of their indices, starting at 0.
+ * An item is held back until all items with smaller indices have been released.
+ */
+template<typename T>
+class ReorderBuffer {
+private:
+    std::deque<std::optional<T>> m_pending;     ///< Slot i holds the item with index m_nextIndex + i.
+    std::size_t m_nextIndex = 0;
+    std::size_t m_size = 0;
+public:
+    /** Inserts the item with the given index.
+     * @pre No item with the same index has been inserted before.
+     */
+    void insert(std::size_t index, T item) {
+        enforce(index >= m_nextIndex);
+        std::size_t const slot = index - m_nextIndex;
+        if (slot >= m_pending.size()) { m_pending.resize(slot + 1); }
+        enforce(!m_pending[slot]);
+        m_pending[slot].emplace(std::move(item));
+        ++m_size;
+    }
+
+    /** Releases the next item in order.
+     * @return The item with index nextIndex(), if it has been inserted already;
+     *         std::nullopt otherwise.
+     */
+    std::optional<T> pop() {
+        if (m_pending.empty() || !m_pending.front()) { return std::nullopt; }
+        std::optional<T> ret = std::move(m_pending.front());
+        m_pending.pop_front();
+        ++m_nextIndex;
+        --m_size;
+        return ret;
+    }
+
+    /** Releases the next item that was inserted, skipping over any missing indices.
+     * Used for draining the buffer once no more items will arrive.
+     * @return The held back item with the smallest index; std::nullopt if empty.
+     */
+    std::optional<T> popSkippingGaps() {
+        while (!m_pending.empty() && !m_pending.front()) {
+            m_pending.pop_front();
+            ++m_nextIndex;
+        }
+        return pop();
+    }
+
+    /** Index of the next item to be released.
+     */
+    std::size_t nextIndex() const noexcept {
+        return m_nextIndex;
+    }
+
+    /** Number of items that are held back.
+     */
+    std::size_t size() const noexcept {
+        return m_size;
+    }
+
+    /** True if no items are held back.
+     */
+    bool empty() const noexcept {
+        return m_size == 0;
+    }
+};
+
+}
+
+#endif
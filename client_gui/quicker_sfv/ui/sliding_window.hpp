@@ -0,0 +1,61 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_GUI_UI_SLIDING_WINDOW_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_GUI_UI_SLIDING_WINDOW_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <numeric>
+#include <utility>
+
+namespace quicker_sfv::gui {
+
+/** Fixed-size window over the N most recently pushed values.
+ * Used for smoothing bandwidth measurements of file I/O.
+ */
+template<typename T, size_t N>
+class SlidingWindow {
+private:
+    std::array<T, N> m_elements;
+    size_t m_numberOfElements = 0;
+    size_t m_nextElement = 0;
+public:
+    void push(T&& e) {
+        m_elements[m_nextElement] = std::move(e);
+        m_nextElement = (m_nextElement + 1) % N;
+        m_numberOfElements = std::min(m_numberOfElements + 1, N);
+    }
+
+    void push(T const& e) {
+        m_elements[m_nextElement] = e;
+        m_nextElement = (m_nextElement + 1) % N;
+        m_numberOfElements = std::min(m_numberOfElements + 1, N);
+    }
+
+    T rollingAverage() const {
+        if (m_numberOfElements == 0) { return T{}; }
+        return std::accumulate(begin(m_elements), begin(m_elements) + m_numberOfElements, T{}) / m_numberOfElements;
+    }
+};
+
+}
+
+#endif
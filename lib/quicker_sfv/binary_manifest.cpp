@@ -0,0 +1,392 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/binary_manifest.hpp>
+
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/string_utilities.hpp>
+
+#include <quicker_sfv/detail/byte_order.hpp>
+#include <quicker_sfv/detail/crc32.hpp>
+#include <quicker_sfv/detail/md5.hpp>
+#include <quicker_sfv/detail/string_conversion.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace quicker_sfv {
+
+namespace {
+
+using byte_order::loadLittleEndian;
+using byte_order::storeLittleEndian;
+
+constexpr std::array<char, 8> const MAGIC = { 'Q', 'S', 'F', 'V', 'B', 'I', 'N', '\0' };
+constexpr uint32_t const FORMAT_VERSION = 2;
+/// Version 1 lacks the expected size table and its offset in the header.
+constexpr uint32_t const FORMAT_VERSION_1 = 1;
+constexpr uint32_t const FLAG_HAS_STAMPS = 0x01;
+constexpr uint32_t const FLAG_HAS_EXPECTED_SIZES = 0x02;
+constexpr std::size_t const HEADER_SIZE = 88;
+constexpr std::size_t const HEADER_SIZE_VERSION_1 = 80;
+constexpr std::size_t const PATH_TABLE_ENTRY_SIZE = 16;
+constexpr std::size_t const SORTED_INDEX_ENTRY_SIZE = 4;
+constexpr std::size_t const STAMP_TABLE_ENTRY_SIZE = 16;
+constexpr uint64_t const UNKNOWN_STAMP_SIZE = std::numeric_limits<uint64_t>::max();
+constexpr std::size_t const EXPECTED_SIZE_TABLE_ENTRY_SIZE = 8;
+constexpr uint64_t const UNKNOWN_EXPECTED_SIZE = std::numeric_limits<uint64_t>::max();
+
+uint32_t digestSizeFor(BinaryManifestAlgorithm algorithm) {
+    switch (algorithm) {
+    case BinaryManifestAlgorithm::Crc32: return 4;
+    case BinaryManifestAlgorithm::MD5: return 16;
+    }
+    throwException(Error::Failed);
+}
+
+bool isInBounds(uint64_t offset, uint64_t size, uint64_t total_size) {
+    return (offset <= total_size) && (size <= total_size - offset);
+}
+
+uint64_t alignTo8(uint64_t v) {
+    return (v + 7) & ~uint64_t{ 7 };
+}
+
+Digest digestFromBytes(BinaryManifestAlgorithm algorithm, std::span<std::byte const> bytes) {
+    std::u8string str;
+    str.reserve(bytes.size() * 2);
+    for (std::byte const b : bytes) {
+        auto const [higher, lower] = string_conversion::byte_to_hex_str(b);
+        str.push_back(higher);
+        str.push_back(lower);
+    }
+    if (algorithm == BinaryManifestAlgorithm::Crc32) {
+        return detail::Crc32Hasher::digestFromString(str);
+    } else {
+        return detail::MD5Hasher::digestFromString(str);
+    }
+}
+
+void appendDigestBytes(std::vector<std::byte>& out, std::u8string_view digest_str, uint32_t digest_size) {
+    if (digest_str.size() != 2 * digest_size) { throwException(Error::Failed); }
+    for (std::size_t i = 0; i < digest_str.size(); i += 2) {
+        out.push_back(string_conversion::hex_str_to_byte(digest_str[i], digest_str[i + 1]));
+    }
+}
+
+} // anonymous namespace
+
+BinaryManifestView::BinaryManifestView(std::span<std::byte const> data)
+    :m_data(data)
+{
+    if (data.size() < HEADER_SIZE_VERSION_1) { throwException(Error::ParserError); }
+    if (std::memcmp(data.data(), MAGIC.data(), MAGIC.size()) != 0) { throwException(Error::ParserError); }
+    std::byte const* p = data.data() + MAGIC.size();
+    uint32_t const version = loadLittleEndian<uint32_t>(p);
+    if ((version != FORMAT_VERSION) && (version != FORMAT_VERSION_1)) { throwException(Error::ParserError); }
+    if ((version == FORMAT_VERSION) && (data.size() < HEADER_SIZE)) { throwException(Error::ParserError); }
+    uint32_t const algorithm = loadLittleEndian<uint32_t>(p + 4);
+    m_digestSize = loadLittleEndian<uint32_t>(p + 8);
+    m_flags = loadLittleEndian<uint32_t>(p + 12);
+    uint64_t const entry_count = loadLittleEndian<uint64_t>(p + 16);
+    m_pathTableOffset = loadLittleEndian<uint64_t>(p + 24);
+    m_sortedIndexOffset = loadLittleEndian<uint64_t>(p + 32);
+    m_digestOffset = loadLittleEndian<uint64_t>(p + 40);
+    m_stampsOffset = loadLittleEndian<uint64_t>(p + 48);
+    if (version == FORMAT_VERSION_1) {
+        m_expectedSizesOffset = 0;
+        m_stringDataOffset = loadLittleEndian<uint64_t>(p + 56);
+        m_stringDataSize = loadLittleEndian<uint64_t>(p + 64);
+    } else {
+        m_expectedSizesOffset = loadLittleEndian<uint64_t>(p + 56);
+        m_stringDataOffset = loadLittleEndian<uint64_t>(p + 64);
+        m_stringDataSize = loadLittleEndian<uint64_t>(p + 72);
+    }
+
+    if ((algorithm != static_cast<uint32_t>(BinaryManifestAlgorithm::Crc32)) &&
+        (algorithm != static_cast<uint32_t>(BinaryManifestAlgorithm::MD5)))
+    {
+        throwException(Error::ParserError);
+    }
+    m_algorithm = static_cast<BinaryManifestAlgorithm>(algorithm);
+    if (m_digestSize != digestSizeFor(m_algorithm)) { throwException(Error::ParserError); }
+    uint32_t const known_flags = (version == FORMAT_VERSION_1) ? FLAG_HAS_STAMPS : (FLAG_HAS_STAMPS | FLAG_HAS_EXPECTED_SIZES);
+    if ((m_flags & ~known_flags) != 0) { throwException(Error::ParserError); }
+    if (entry_count > std::numeric_limits<uint32_t>::max()) { throwException(Error::ParserError); }
+    m_entryCount = static_cast<uint32_t>(entry_count);
+
+    uint64_t const total_size = data.size();
+    if (!isInBounds(m_pathTableOffset, entry_count * PATH_TABLE_ENTRY_SIZE, total_size) ||
+        !isInBounds(m_sortedIndexOffset, entry_count * SORTED_INDEX_ENTRY_SIZE, total_size) ||
+        !isInBounds(m_digestOffset, entry_count * m_digestSize, total_size) ||
+        !isInBounds(m_stringDataOffset, m_stringDataSize, total_size))
+    {
+        throwException(Error::ParserError);
+    }
+    if (hasStamps() && !isInBounds(m_stampsOffset, entry_count * STAMP_TABLE_ENTRY_SIZE, total_size)) {
+        throwException(Error::ParserError);
+    }
+    if (hasExpectedSizes() &&
+        !isInBounds(m_expectedSizesOffset, entry_count * EXPECTED_SIZE_TABLE_ENTRY_SIZE, total_size))
+    {
+        throwException(Error::ParserError);
+    }
+}
+
+BinaryManifestAlgorithm BinaryManifestView::algorithm() const noexcept {
+    return m_algorithm;
+}
+
+std::size_t BinaryManifestView::size() const noexcept {
+    return m_entryCount;
+}
+
+bool BinaryManifestView::hasStamps() const noexcept {
+    return (m_flags & FLAG_HAS_STAMPS) != 0;
+}
+
+bool BinaryManifestView::hasExpectedSizes() const noexcept {
+    return (m_flags & FLAG_HAS_EXPECTED_SIZES) != 0;
+}
+
+std::u8string_view BinaryManifestView::path(std::size_t index) const {
+    std::byte const* p = m_data.data() + m_pathTableOffset + index * PATH_TABLE_ENTRY_SIZE;
+    uint64_t const offset = loadLittleEndian<uint64_t>(p);
+    uint64_t const length = loadLittleEndian<uint64_t>(p + 8);
+    if ((length == 0) || !isInBounds(offset, length, m_stringDataSize)) { throwException(Error::ParserError); }
+    std::span<std::byte const> const path_bytes = m_data.subspan(m_stringDataOffset + offset, length);
+    if (!checkValidUtf8(path_bytes)) { throwException(Error::ParserError); }
+    return std::u8string_view(reinterpret_cast<char8_t const*>(path_bytes.data()), path_bytes.size());
+}
+
+std::span<std::byte const> BinaryManifestView::digestBytes(std::size_t index) const {
+    return m_data.subspan(m_digestOffset + index * m_digestSize, m_digestSize);
+}
+
+Digest BinaryManifestView::digest(std::size_t index) const {
+    return digestFromBytes(m_algorithm, digestBytes(index));
+}
+
+std::optional<FileStamp> BinaryManifestView::stamp(std::size_t index) const {
+    if (!hasStamps()) { return std::nullopt; }
+    std::byte const* p = m_data.data() + m_stampsOffset + index * STAMP_TABLE_ENTRY_SIZE;
+    uint64_t const size = loadLittleEndian<uint64_t>(p);
+    if (size == UNKNOWN_STAMP_SIZE) { return std::nullopt; }
+    return FileStamp{ .size = size, .modification_time = static_cast<int64_t>(loadLittleEndian<uint64_t>(p + 8)) };
+}
+
+int64_t BinaryManifestView::expectedSize(std::size_t index) const {
+    if (!hasExpectedSizes()) { return -1; }
+    uint64_t const size = loadLittleEndian<uint64_t>(m_data.data() + m_expectedSizesOffset +
+                                                     index * EXPECTED_SIZE_TABLE_ENTRY_SIZE);
+    if (size == UNKNOWN_EXPECTED_SIZE) { return -1; }
+    if (size > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) { throwException(Error::ParserError); }
+    return static_cast<int64_t>(size);
+}
+
+std::optional<std::size_t> BinaryManifestView::find(std::u8string_view path) const {
+    auto const entryAt = [this](std::size_t sorted_position) -> std::size_t {
+        uint32_t const index = loadLittleEndian<uint32_t>(m_data.data() + m_sortedIndexOffset + sorted_position * SORTED_INDEX_ENTRY_SIZE);
+        if (index >= m_entryCount) { throwException(Error::ParserError); }
+        return index;
+    };
+    std::size_t first = 0;
+    std::size_t count = m_entryCount;
+    while (count > 0) {
+        std::size_t const step = count / 2;
+        if (this->path(entryAt(first + step)) < path) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    if (first == m_entryCount) { return std::nullopt; }
+    std::size_t const index = entryAt(first);
+    if (this->path(index) != path) { return std::nullopt; }
+    return index;
+}
+
+ChecksumFile BinaryManifestView::toChecksumFile() const {
+    ChecksumFile ret;
+    for (std::size_t i = 0; i < size(); ++i) {
+        std::u8string_view const p = path(i);
+        ret.addEntry(p, digest(i));
+        if (int64_t const expected_size = expectedSize(i); expected_size != -1) {
+            ret.addExpectedSize(p, expected_size);
+        }
+    }
+    ret.resolveExpectedSizes();
+    return ret;
+}
+
+void writeBinaryManifest(FileOutput& file_output, ChecksumFile const& f, BinaryManifestAlgorithm algorithm,
+                         StampFile const* stamps)
+{
+    uint32_t const digest_size = digestSizeFor(algorithm);
+    auto const entries = f.getEntries();
+    uint64_t const entry_count = entries.size();
+    if (entry_count > std::numeric_limits<uint32_t>::max()) { throwException(Error::Failed); }
+    for (auto const& e : entries) {
+        if ((e.data.size() != 1) || (e.data.front().path != e.display) ||
+            (e.data.front().data_offset != 0) || (e.data.front().data_size != -1) || e.display.empty())
+        {
+            throwException(Error::Failed);
+        }
+    }
+
+    uint64_t const path_table_offset = HEADER_SIZE;
+    uint64_t const sorted_index_offset = alignTo8(path_table_offset + entry_count * PATH_TABLE_ENTRY_SIZE);
+    uint64_t const digest_offset = alignTo8(sorted_index_offset + entry_count * SORTED_INDEX_ENTRY_SIZE);
+    bool const has_expected_sizes = std::ranges::any_of(entries, [](ChecksumFile::Entry const& e) {
+        return e.expected_size != -1;
+    });
+    uint64_t const digest_table_end = alignTo8(digest_offset + entry_count * digest_size);
+    uint64_t const stamps_offset = (stamps) ? digest_table_end : 0;
+    uint64_t const stamp_table_end = (stamps) ? (stamps_offset + entry_count * STAMP_TABLE_ENTRY_SIZE) : digest_table_end;
+    uint64_t const expected_sizes_offset = (has_expected_sizes) ? stamp_table_end : 0;
+    uint64_t const string_data_offset = (has_expected_sizes) ?
+        (expected_sizes_offset + entry_count * EXPECTED_SIZE_TABLE_ENTRY_SIZE) :
+        stamp_table_end;
+    uint64_t const string_data_size = std::accumulate(entries.begin(), entries.end(), uint64_t{ 0 },
+        [](uint64_t acc, ChecksumFile::Entry const& e) { return acc + e.display.size(); });
+
+    std::vector<std::byte> out(string_data_offset);
+    out.reserve(string_data_offset + string_data_size);
+    std::memcpy(out.data(), MAGIC.data(), MAGIC.size());
+    std::byte* p = out.data() + MAGIC.size();
+    storeLittleEndian<uint32_t>(p, FORMAT_VERSION);
+    storeLittleEndian<uint32_t>(p + 4, static_cast<uint32_t>(algorithm));
+    storeLittleEndian<uint32_t>(p + 8, digest_size);
+    storeLittleEndian<uint32_t>(p + 12, ((stamps) ? FLAG_HAS_STAMPS : 0) |
+                                        ((has_expected_sizes) ? FLAG_HAS_EXPECTED_SIZES : 0));
+    storeLittleEndian<uint64_t>(p + 16, entry_count);
+    storeLittleEndian<uint64_t>(p + 24, path_table_offset);
+    storeLittleEndian<uint64_t>(p + 32, sorted_index_offset);
+    storeLittleEndian<uint64_t>(p + 40, digest_offset);
+    storeLittleEndian<uint64_t>(p + 48, stamps_offset);
+    storeLittleEndian<uint64_t>(p + 56, expected_sizes_offset);
+    storeLittleEndian<uint64_t>(p + 64, string_data_offset);
+    storeLittleEndian<uint64_t>(p + 72, string_data_size);
+
+    std::vector<uint32_t> sorted_index(entries.size());
+    std::iota(sorted_index.begin(), sorted_index.end(), uint32_t{ 0 });
+    std::ranges::stable_sort(sorted_index, std::less<>{}, [&entries](uint32_t i) -> std::u8string_view { return entries[i].display; });
+
+    std::vector<std::byte> digest_bytes;
+    digest_bytes.reserve(digest_size);
+    uint64_t string_offset = 0;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        auto const& e = entries[i];
+        storeLittleEndian<uint64_t>(out.data() + path_table_offset + i * PATH_TABLE_ENTRY_SIZE, string_offset);
+        storeLittleEndian<uint64_t>(out.data() + path_table_offset + i * PATH_TABLE_ENTRY_SIZE + 8, e.display.size());
+        string_offset += e.display.size();
+        storeLittleEndian<uint32_t>(out.data() + sorted_index_offset + i * SORTED_INDEX_ENTRY_SIZE, sorted_index[i]);
+        digest_bytes.clear();
+        appendDigestBytes(digest_bytes, e.digest.toString(), digest_size);
+        std::memcpy(out.data() + digest_offset + i * digest_size, digest_bytes.data(), digest_size);
+        if (stamps) {
+            std::optional<FileStamp> const stamp = stamps->getStamp(e.display);
+            storeLittleEndian<uint64_t>(out.data() + stamps_offset + i * STAMP_TABLE_ENTRY_SIZE,
+                              (stamp) ? stamp->size : UNKNOWN_STAMP_SIZE);
+            storeLittleEndian<uint64_t>(out.data() + stamps_offset + i * STAMP_TABLE_ENTRY_SIZE + 8,
+                              (stamp) ? static_cast<uint64_t>(stamp->modification_time) : 0);
+        }
+        if (has_expected_sizes) {
+            storeLittleEndian<uint64_t>(out.data() + expected_sizes_offset + i * EXPECTED_SIZE_TABLE_ENTRY_SIZE,
+                                        (e.expected_size >= 0) ? static_cast<uint64_t>(e.expected_size) :
+                                                                 UNKNOWN_EXPECTED_SIZE);
+        }
+    }
+    for (auto const& e : entries) {
+        std::byte const* path_bytes = reinterpret_cast<std::byte const*>(e.display.data());
+        out.insert(out.end(), path_bytes, path_bytes + e.display.size());
+    }
+    file_output.write(out);
+}
+
+ChecksumProviderPtr createBinarySfvProvider() {
+    return ChecksumProviderPtr(new BinaryManifestProvider(BinaryManifestAlgorithm::Crc32));
+}
+
+ChecksumProviderPtr createBinaryMD5Provider() {
+    return ChecksumProviderPtr(new BinaryManifestProvider(BinaryManifestAlgorithm::MD5));
+}
+
+BinaryManifestProvider::BinaryManifestProvider(BinaryManifestAlgorithm algorithm)
+    :m_algorithm(algorithm)
+{}
+
+BinaryManifestProvider::~BinaryManifestProvider() = default;
+
+ProviderCapabilities BinaryManifestProvider::getCapabilities() const noexcept {
+    return ProviderCapabilities::Full;
+}
+
+std::u8string_view BinaryManifestProvider::fileExtensions() const noexcept {
+    return (m_algorithm == BinaryManifestAlgorithm::Crc32) ? u8"*.sfvbin" : u8"*.md5bin";
+}
+
+std::u8string_view BinaryManifestProvider::fileDescription() const noexcept {
+    return (m_algorithm == BinaryManifestAlgorithm::Crc32) ? u8"Binary Sfv Manifest" : u8"Binary MD5 Manifest";
+}
+
+HasherPtr BinaryManifestProvider::createHasher(HasherOptions const& hasher_options) const {
+    if (m_algorithm == BinaryManifestAlgorithm::Crc32) {
+        return std::make_unique<detail::Crc32Hasher>(hasher_options);
+    } else {
+        return std::make_unique<detail::MD5Hasher>();
+    }
+}
+
+Digest BinaryManifestProvider::digestFromString(std::u8string_view str) const {
+    if (m_algorithm == BinaryManifestAlgorithm::Crc32) {
+        return detail::Crc32Hasher::digestFromString(str);
+    } else {
+        return detail::MD5Hasher::digestFromString(str);
+    }
+}
+
+ChecksumFile BinaryManifestProvider::readFromFile(FileInput& file_input) const {
+    uint64_t const file_size = file_input.file_size();
+    if (file_size > std::numeric_limits<std::size_t>::max()) { throwException(Error::ParserError); }
+    std::vector<std::byte> contents(static_cast<std::size_t>(file_size));
+    std::size_t bytes_read = 0;
+    while (bytes_read < contents.size()) {
+        std::size_t const res = file_input.read(std::span<std::byte>(contents).subspan(bytes_read));
+        if (res == FileInput::RESULT_END_OF_FILE) { break; }
+        bytes_read += res;
+    }
+    if (bytes_read != contents.size()) { throwException(Error::FileIO); }
+    BinaryManifestView const view(contents);
+    if (view.algorithm() != m_algorithm) { throwException(Error::ParserError); }
+    return view.toChecksumFile();
+}
+
+void BinaryManifestProvider::writeNewFile(FileOutput& file_output, ChecksumFile const& f) const {
+    writeBinaryManifest(file_output, f, m_algorithm, nullptr);
+}
+
+}
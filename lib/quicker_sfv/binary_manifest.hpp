@@ -0,0 +1,225 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_BINARY_MANIFEST_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_BINARY_MANIFEST_HPP
+
+#include <quicker_sfv/checksum_file.hpp>
+#include <quicker_sfv/checksum_provider.hpp>
+#include <quicker_sfv/digest.hpp>
+#include <quicker_sfv/file_io.hpp>
+#include <quicker_sfv/stamp_file.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace quicker_sfv {
+
+/** Checksum algorithms supported by the binary manifest format.
+ */
+enum class BinaryManifestAlgorithm : uint32_t {
+    Crc32 = 1,      ///< CRC32, as used by `*.sfv` files. 4 byte digests.
+    MD5 = 2,        ///< MD5, as used by `*.md5` files. 16 byte digests.
+};
+
+/** Read-only view of a binary manifest in memory.
+ * The binary manifest is a compact representation of a ChecksumFile that is designed
+ * to be queried in place, for example from a memory mapped file, without parsing
+ * the whole file first.
+ *
+ * All integers are stored little-endian. The file consists of the following parts:
+ *  - An 88 byte header: An 8 byte magic `QSFVBIN\0`, followed by four uint32 fields
+ *    for format version, BinaryManifestAlgorithm, digest size in bytes and flags,
+ *    followed by eight uint64 fields for the number of entries and the offsets of
+ *    the path table, the sorted index, the digest table, the stamp table, the
+ *    expected size table and the string data, and finally the size of the string
+ *    data.
+ *  - The path table, with one pair of uint64 offset into the string data and uint64
+ *    length per entry, in the original order of the entries.
+ *  - The sorted index, with one uint32 entry index per entry, ordered by the
+ *    byte-wise lexicographical order of the paths.
+ *  - The digest table, with one fixed-width raw digest per entry.
+ *  - The optional stamp table, with one pair of uint64 size and int64 modification
+ *    time per entry. Present only if bit 0 of the flags is set. Entries without a
+ *    known stamp store a size of `0xffffffffffffffff`.
+ *  - The optional expected size table, with one uint64 expected file size per entry.
+ *    Present only if bit 1 of the flags is set. Entries without a known expected
+ *    size store `0xffffffffffffffff`.
+ *  - The UTF-8 encoded path strings, without separators or terminators.
+ *
+ * Tables start at 8 byte aligned offsets. Version 1 of the format uses an 80 byte
+ * header without the expected size table offset and is still accepted for reading.
+ *
+ * Construction of the view only validates the header and the table bounds and
+ * takes constant time. Individual entries are validated on access.
+ */
+class BinaryManifestView {
+private:
+    std::span<std::byte const> m_data;
+    BinaryManifestAlgorithm m_algorithm;
+    uint32_t m_digestSize;
+    uint32_t m_flags;
+    uint32_t m_entryCount;
+    uint64_t m_pathTableOffset;
+    uint64_t m_sortedIndexOffset;
+    uint64_t m_digestOffset;
+    uint64_t m_stampsOffset;
+    uint64_t m_expectedSizesOffset;
+    uint64_t m_stringDataOffset;
+    uint64_t m_stringDataSize;
+public:
+    /** Constructor.
+     * @param[in] data The binary manifest contents. The view does not take ownership
+     *                 of the data, which must remain valid for the lifetime of the
+     *                 view.
+     * @throws Exception Error::ParserError if data does not contain a valid header or
+     *                   any of the tables exceeds the bounds of data.
+     */
+    explicit BinaryManifestView(std::span<std::byte const> data);
+
+    /** Retrieves the checksum algorithm of the manifest.
+     */
+    [[nodiscard]] BinaryManifestAlgorithm algorithm() const noexcept;
+
+    /** Retrieves the number of entries in the manifest.
+     */
+    [[nodiscard]] std::size_t size() const noexcept;
+
+    /** Checks whether the manifest contains the optional stamp table.
+     */
+    [[nodiscard]] bool hasStamps() const noexcept;
+
+    /** Checks whether the manifest contains the optional expected size table.
+     */
+    [[nodiscard]] bool hasExpectedSizes() const noexcept;
+
+    /** Retrieves the path of an entry.
+     * @param[in] index Index of the entry in the original order of entries.
+     * @pre index < size().
+     * @throws Exception Error::ParserError if the path exceeds the bounds of the
+     *                   string data or is not valid UTF-8.
+     */
+    [[nodiscard]] std::u8string_view path(std::size_t index) const;
+
+    /** Retrieves the raw digest of an entry.
+     * @param[in] index Index of the entry in the original order of entries.
+     * @pre index < size().
+     */
+    [[nodiscard]] std::span<std::byte const> digestBytes(std::size_t index) const;
+
+    /** Retrieves the digest of an entry.
+     * @param[in] index Index of the entry in the original order of entries.
+     * @pre index < size().
+     */
+    [[nodiscard]] Digest digest(std::size_t index) const;
+
+    /** Retrieves the stamp of an entry.
+     * @param[in] index Index of the entry in the original order of entries.
+     * @pre index < size().
+     * @return The FileStamp of the entry, or an empty optional if the manifest does
+     *         not contain a stamp table or the stamp of the entry is unknown.
+     */
+    [[nodiscard]] std::optional<FileStamp> stamp(std::size_t index) const;
+
+    /** Retrieves the expected file size of an entry.
+     * @param[in] index Index of the entry in the original order of entries.
+     * @pre index < size().
+     * @return The expected size in bytes, or -1 if the manifest does not contain an
+     *         expected size table or the expected size of the entry is unknown.
+     * @throws Exception Error::ParserError if the stored size is out of range.
+     */
+    [[nodiscard]] int64_t expectedSize(std::size_t index) const;
+
+    /** Looks up an entry by path.
+     * Lookup is a binary search through the sorted index and only accesses the
+     * entries along the search path.
+     * @param[in] path Path of the entry.
+     * @return The index of the entry in the original order of entries, or an empty
+     *         optional if no entry with that path exists. If multiple entries share
+     *         the same path, any one of them may be returned.
+     * @throws Exception Error::ParserError if the sorted index is corrupt.
+     */
+    [[nodiscard]] std::optional<std::size_t> find(std::u8string_view path) const;
+
+    /** Converts the manifest to a ChecksumFile.
+     * @throws Exception Error::ParserError if any of the entries is invalid.
+     */
+    [[nodiscard]] ChecksumFile toChecksumFile() const;
+};
+
+/** Writes a ChecksumFile in binary manifest format.
+ * @param[in] file_output A FileOutput object providing access to the file.
+ * @param[in] f The ChecksumFile. Each entry must consist of exactly one DataPortion
+ *              covering the whole file, with a path equal to the display string.
+ *              The Digests must have been created by a Hasher for the algorithm.
+ * @param[in] algorithm The checksum algorithm of the Digests.
+ * @param[in] stamps Optional FileStamps to be stored in the manifest. If this is
+ *                   nullptr, no stamp table is written.
+ * An expected size table is written only if at least one entry of f has a known
+ * ChecksumFile::Entry::expected_size.
+ * @throws Exception Error::Failed if the ChecksumFile cannot be represented in the
+ *                   binary manifest format.
+ *                   Error::FileIO if an error occurs while writing the file.
+ */
+void writeBinaryManifest(FileOutput& file_output, ChecksumFile const& f, BinaryManifestAlgorithm algorithm,
+                         StampFile const* stamps);
+
+/** Support for binary manifests.
+ * See BinaryManifestView for a description of the file format. Conversion from and
+ * to the text based formats is lossless with regard to the ChecksumFile contents.
+ * Each provider instance handles a single BinaryManifestAlgorithm.
+ */
+class BinaryManifestProvider : public ChecksumProvider {
+public:
+    friend ChecksumProviderPtr createBinarySfvProvider();
+    friend ChecksumProviderPtr createBinaryMD5Provider();
+private:
+    BinaryManifestAlgorithm m_algorithm;
+    explicit BinaryManifestProvider(BinaryManifestAlgorithm algorithm);
+public:
+    ~BinaryManifestProvider() override;
+    [[nodiscard]] ProviderCapabilities getCapabilities() const noexcept override;
+    [[nodiscard]] std::u8string_view fileExtensions() const noexcept override;
+    [[nodiscard]] std::u8string_view fileDescription() const noexcept override;
+    [[nodiscard]] HasherPtr createHasher(HasherOptions const& hasher_options) const override;
+    [[nodiscard]] Digest digestFromString(std::u8string_view str) const override;
+
+    /** Reads a binary manifest.
+     * @throws Exception Error::ParserError if the file is not a valid binary manifest
+     *                   or uses a different algorithm than the provider.
+     *                   Error::FileIO if an error occurs while reading the file.
+     */
+    [[nodiscard]] ChecksumFile readFromFile(FileInput& file_input) const override;
+    void writeNewFile(FileOutput& file_output, ChecksumFile const& f) const override;
+};
+
+/** Creates a BinaryManifestProvider for CRC32 digests.
+ */
+ChecksumProviderPtr createBinarySfvProvider();
+
+/** Creates a BinaryManifestProvider for MD5 digests.
+ */
+ChecksumProviderPtr createBinaryMD5Provider();
+
+}
+
+#endif
@@ -0,0 +1,244 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/block_digests.hpp>
+
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/line_reader.hpp>
+#include <quicker_sfv/string_utilities.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <set>
+#include <utility>
+#include <system_error>
+
+namespace quicker_sfv {
+
+namespace {
+
+constexpr std::u8string_view const BLOCK_SIZE_KEYWORD = u8"blocksize ";
+constexpr std::u8string_view const NO_BLOCKS = u8"-";
+
+uint64_t parseNumber(std::u8string_view str) {
+    char const* const first = reinterpret_cast<char const*>(str.data());
+    char const* const last = first + str.size();
+    uint64_t ret = 0;
+    auto const [ptr, ec] = std::from_chars(first, last, ret);
+    if ((ec != std::errc{}) || (ptr != last)) { throwException(Error::ParserError); }
+    return ret;
+}
+
+void appendNumber(std::u8string& out, uint64_t n) {
+    char buffer[24];
+    auto const [ptr, ec] = std::to_chars(std::begin(buffer), std::end(buffer), n);
+    if (ec != std::errc{}) { throwException(Error::Failed); }
+    out.append(reinterpret_cast<char8_t const*>(std::begin(buffer)), reinterpret_cast<char8_t const*>(ptr));
+}
+
+void writeString(FileOutput& file_output, std::u8string_view str) {
+    file_output.write(std::span<std::byte const>(reinterpret_cast<std::byte const*>(str.data()), str.size()));
+}
+
+} // anonymous namespace
+
+BlockDigestBuilder::BlockDigestBuilder(Hasher& hasher, uint64_t block_size)
+    :m_hasher(&hasher), m_blockSize(block_size), m_bytesInBlock(0)
+{
+    if (block_size == 0) { throwException(Error::Failed); }
+    m_hasher->reset();
+}
+
+void BlockDigestBuilder::addData(std::span<std::byte const> data) {
+    while (!data.empty()) {
+        uint64_t const bytes_to_add = std::min<uint64_t>(data.size(), m_blockSize - m_bytesInBlock);
+        m_hasher->addData(data.first(static_cast<std::size_t>(bytes_to_add)));
+        data = data.subspan(static_cast<std::size_t>(bytes_to_add));
+        m_bytesInBlock += bytes_to_add;
+        if (m_bytesInBlock == m_blockSize) {
+            m_digests.push_back(m_hasher->finalize());
+            m_hasher->reset();
+            m_bytesInBlock = 0;
+        }
+    }
+}
+
+std::vector<Digest> BlockDigestBuilder::finalize() {
+    if (m_bytesInBlock != 0) {
+        m_digests.push_back(m_hasher->finalize());
+        m_hasher->reset();
+        m_bytesInBlock = 0;
+    }
+    return std::exchange(m_digests, {});
+}
+
+BlockDigests::BlockDigests(uint64_t block_size)
+    :m_blockSize(block_size)
+{
+    if (block_size == 0) { throwException(Error::Failed); }
+}
+
+uint64_t BlockDigests::getBlockSize() const {
+    return m_blockSize;
+}
+
+void BlockDigests::setFile(std::u8string_view path, uint64_t file_size, std::vector<Digest> blocks) {
+    if (blocks.size() != blockCount(file_size)) { throwException(Error::Failed); }
+    File f{ .file_size = file_size, .blocks = std::move(blocks) };
+    if (auto it = m_files.find(path); it != m_files.end()) {
+        it->second = std::move(f);
+    } else {
+        m_files.emplace(std::u8string{ path }, std::move(f));
+    }
+}
+
+BlockDigests::File const* BlockDigests::getFile(std::u8string_view path) const {
+    auto const it = m_files.find(path);
+    return (it == m_files.end()) ? nullptr : &it->second;
+}
+
+std::size_t BlockDigests::size() const {
+    return m_files.size();
+}
+
+uint64_t BlockDigests::blockCount(uint64_t file_size) const {
+    return (file_size / m_blockSize) + (((file_size % m_blockSize) != 0) ? 1 : 0);
+}
+
+BlockRange BlockDigests::blockRange(uint64_t file_size, uint64_t index) const {
+    uint64_t const offset = index * m_blockSize;
+    return BlockRange{ .offset = offset, .size = std::min(m_blockSize, file_size - offset) };
+}
+
+std::vector<BlockRange> BlockDigests::findDamagedRanges(File const& expected, std::span<Digest const> actual) const {
+    std::vector<uint64_t> damaged;
+    for (std::size_t i = 0; i < expected.blocks.size(); ++i) {
+        if ((i >= actual.size()) || (!(actual[i] == expected.blocks[i]))) { damaged.push_back(i); }
+    }
+    std::vector<BlockRange> ret = toRanges(expected.file_size, damaged);
+    if (actual.size() > expected.blocks.size()) {
+        // the size of the excess data is unknown, so only its start can be reported
+        ret.push_back(BlockRange{ .offset = expected.file_size, .size = 0 });
+    }
+    return ret;
+}
+
+std::vector<BlockRange> BlockDigests::toRanges(uint64_t file_size, std::span<uint64_t const> block_indices) const {
+    std::vector<BlockRange> ret;
+    for (uint64_t const index : block_indices) {
+        BlockRange const r = blockRange(file_size, index);
+        if (!ret.empty() && (ret.back().offset + ret.back().size == r.offset)) {
+            ret.back().size += r.size;
+        } else {
+            ret.push_back(r);
+        }
+    }
+    return ret;
+}
+
+BlockDigests BlockDigests::readFromFile(FileInput& file_input, ChecksumProvider const& provider) {
+    LineReader reader(file_input);
+    std::optional<BlockDigests> ret;
+    for (;;) {
+        auto opt_line = reader.readLineView();
+        if (!opt_line) {
+            if (reader.done()) {
+                break;
+            }
+        }
+        std::u8string_view const line{ *opt_line };
+        if (trim(line).empty()) { continue; }
+        // skip comments
+        if (line.starts_with(u8";")) { continue; }
+        if (!ret) {
+            if (!line.starts_with(BLOCK_SIZE_KEYWORD)) { throwException(Error::ParserError); }
+            uint64_t const block_size = parseNumber(line.substr(BLOCK_SIZE_KEYWORD.size()));
+            if (block_size == 0) { throwException(Error::ParserError); }
+            ret.emplace(block_size);
+            continue;
+        }
+        std::size_t const size_end = line.find(u8' ');
+        if (size_end == std::u8string_view::npos) { throwException(Error::ParserError); }
+        std::size_t const digests_end = line.find(u8' ', size_end + 1);
+        if (digests_end == std::u8string_view::npos) { throwException(Error::ParserError); }
+        std::u8string_view const path = line.substr(digests_end + 1);
+        if (path.empty()) { throwException(Error::ParserError); }
+        uint64_t const file_size = parseNumber(line.substr(0, size_end));
+        std::u8string_view digests = line.substr(size_end + 1, digests_end - size_end - 1);
+        std::vector<Digest> blocks;
+        if (digests != NO_BLOCKS) {
+            for (;;) {
+                std::size_t const separator = digests.find(u8',');
+                blocks.push_back(provider.digestFromString(digests.substr(0, separator)));
+                if (separator == std::u8string_view::npos) { break; }
+                digests.remove_prefix(separator + 1);
+            }
+        }
+        if (blocks.size() != ret->blockCount(file_size)) { throwException(Error::ParserError); }
+        ret->setFile(path, file_size, std::move(blocks));
+    }
+    if (!ret) { throwException(Error::ParserError); }
+    return std::move(*ret);
+}
+
+void BlockDigests::writeToFile(FileOutput& file_output) const {
+    std::u8string out_str{ BLOCK_SIZE_KEYWORD };
+    appendNumber(out_str, m_blockSize);
+    out_str.push_back(u8'\n');
+    writeString(file_output, out_str);
+    for (auto const& [path, f] : m_files) {
+        out_str.clear();
+        appendNumber(out_str, f.file_size);
+        out_str.push_back(u8' ');
+        if (f.blocks.empty()) {
+            out_str.append(NO_BLOCKS);
+        }
+        for (std::size_t i = 0; i < f.blocks.size(); ++i) {
+            if (i != 0) { out_str.push_back(u8','); }
+            out_str.append(f.blocks[i].toString());
+        }
+        out_str.push_back(u8' ');
+        out_str.append(path);
+        out_str.push_back(u8'\n');
+        writeString(file_output, out_str);
+    }
+}
+
+std::vector<uint64_t> selectAuditBlocks(uint64_t block_count, uint64_t sample_size, uint64_t seed) {
+    std::vector<uint64_t> ret;
+    if (sample_size >= block_count) {
+        ret.resize(block_count);
+        std::iota(ret.begin(), ret.end(), uint64_t{ 0 });
+        return ret;
+    }
+    // Floyd's algorithm for sampling without replacement
+    std::mt19937_64 rng(seed);
+    std::set<uint64_t> selected;
+    for (uint64_t j = block_count - sample_size; j < block_count; ++j) {
+        uint64_t const t = std::uniform_int_distribution<uint64_t>(0, j)(rng);
+        if (!selected.insert(t).second) { selected.insert(j); }
+    }
+    ret.assign(selected.begin(), selected.end());
+    return ret;
+}
+
+}
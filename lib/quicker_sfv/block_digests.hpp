@@ -0,0 +1,187 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_BLOCK_DIGESTS_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_BLOCK_DIGESTS_HPP
+
+#include <quicker_sfv/checksum_provider.hpp>
+#include <quicker_sfv/digest.hpp>
+#include <quicker_sfv/file_io.hpp>
+#include <quicker_sfv/hasher.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace quicker_sfv {
+
+/** A contiguous range of bytes in a file.
+ */
+struct BlockRange {
+    uint64_t offset;        ///< Offset of the first byte from the start of the file.
+    uint64_t size;          ///< Number of bytes in the range.
+
+    friend bool operator==(BlockRange const&, BlockRange const&) = default;
+};
+
+/** Computes the digests of consecutive fixed-size blocks of a stream of data.
+ * Data is passed in arbitrary chunks through addData(); the builder splits it at
+ * block boundaries. The last block of a file may be shorter than the block size.
+ */
+class BlockDigestBuilder {
+private:
+    Hasher* m_hasher;
+    uint64_t m_blockSize;
+    uint64_t m_bytesInBlock;
+    std::vector<Digest> m_digests;
+public:
+    /** Constructor.
+     * @param[in] hasher Hasher used for computing the block digests. The hasher will
+     *                   be reset and must not be used by anyone else while the
+     *                   builder is in use.
+     * @param[in] block_size Size of a block in bytes.
+     * @throws Exception Error::Failed if block_size is 0.
+     */
+    BlockDigestBuilder(Hasher& hasher, uint64_t block_size);
+    /** Adds the next chunk of data.
+     */
+    void addData(std::span<std::byte const> data);
+    /** Finishes the last partial block and retrieves the digests of all blocks.
+     * The builder is reset and can be used for the next file afterwards.
+     */
+    [[nodiscard]] std::vector<Digest> finalize();
+};
+
+/** Digests of the fixed-size blocks of each entry of a ChecksumFile.
+ * A whole-file digest only tells whether a file is damaged. Block digests in
+ * addition allow locating the damaged ranges of a file, and checking a random
+ * sample of blocks as a fast probabilistic audit without reading the entire file.
+ * Block digests are computed with the same Hasher that was used for computing the
+ * digests of the entries of the ChecksumFile.
+ *
+ * BlockDigests are stored in a sidecar file next to the checksum file. The file
+ * format is line based. The first line is of the form `blocksize <n>`, followed by
+ * one line per file of the form `<file size> <digests> <path>`, where digests is
+ * the comma-separated list of block digests, or `-` for an empty file. Lines
+ * starting with `;` are comments.
+ * File encoding must be UTF-8. Line endings must be either CRLF or LF on read
+ * and will always be LF on write.
+ */
+class BlockDigests {
+public:
+    static constexpr uint64_t const DEFAULT_BLOCK_SIZE = 64ull << 20;
+
+    /** Block digests of a single file.
+     */
+    struct File {
+        uint64_t file_size;             ///< Size of the file in bytes.
+        std::vector<Digest> blocks;     ///< Digests of all blocks, in file order.
+    };
+private:
+    uint64_t m_blockSize;
+    std::map<std::u8string, File, std::less<>> m_files;
+public:
+    /** Constructor.
+     * @param[in] block_size Size of a block in bytes.
+     * @throws Exception Error::Failed if block_size is 0.
+     */
+    explicit BlockDigests(uint64_t block_size = DEFAULT_BLOCK_SIZE);
+
+    /** Retrieves the size of a block in bytes.
+     */
+    [[nodiscard]] uint64_t getBlockSize() const;
+
+    /** Sets the block digests for a file.
+     * If the BlockDigests already contain the file, its digests will be replaced.
+     * @param[in] path Path of the file as it appears in the ChecksumFile.
+     * @param[in] file_size Size of the file in bytes.
+     * @param[in] blocks Digests of all blocks of the file.
+     * @throws Exception Error::Failed if the number of blocks does not match the file size.
+     */
+    void setFile(std::u8string_view path, uint64_t file_size, std::vector<Digest> blocks);
+
+    /** Retrieves the block digests for a file.
+     * @return A pointer to the File, or nullptr if the file is not part of the BlockDigests.
+     */
+    [[nodiscard]] File const* getFile(std::u8string_view path) const;
+
+    /** Retrieves the number of files.
+     */
+    [[nodiscard]] std::size_t size() const;
+
+    /** Number of blocks for a file of the given size.
+     */
+    [[nodiscard]] uint64_t blockCount(uint64_t file_size) const;
+
+    /** The range of bytes covered by a block.
+     * @pre index < blockCount(file_size)
+     */
+    [[nodiscard]] BlockRange blockRange(uint64_t file_size, uint64_t index) const;
+
+    /** Computes the damaged ranges of a file.
+     * @param[in] expected The recorded block digests of the file.
+     * @param[in] actual The block digests computed from the current file contents.
+     * @return The ranges of all blocks whose digests differ, with adjacent blocks
+     *         merged into a single range. Blocks missing from actual are considered
+     *         damaged. If actual has more blocks than expected, the excess is reported
+     *         as a single range starting at the end of the expected file size.
+     */
+    [[nodiscard]] std::vector<BlockRange> findDamagedRanges(File const& expected, std::span<Digest const> actual) const;
+
+    /** Merges a list of block indices into ranges.
+     * @param[in] file_size Size of the file in bytes.
+     * @param[in] block_indices Sorted indices of blocks.
+     * @return The ranges of the blocks, with adjacent blocks merged into a single range.
+     */
+    [[nodiscard]] std::vector<BlockRange> toRanges(uint64_t file_size, std::span<uint64_t const> block_indices) const;
+
+    /** Reads BlockDigests from file.
+     * @param[in] file_input A FileInput object providing access to the file data.
+     * @param[in] provider The ChecksumProvider for the checksum file that the
+     *                     BlockDigests were created for. Used for parsing digests.
+     * @throws Exception Error::ParserError if the file format is invalid.
+     *                   Error::FileIO if an error occurs while reading the file.
+     */
+    [[nodiscard]] static BlockDigests readFromFile(FileInput& file_input, ChecksumProvider const& provider);
+
+    /** Writes the BlockDigests out to a file.
+     * Entries are written in lexicographical order of their paths.
+     * @param[in] file_output A FileOutput object providing access to the file.
+     * @throws Exception Error::FileIO if an error occurs while writing the file.
+     */
+    void writeToFile(FileOutput& file_output) const;
+};
+
+/** Selects a random sample of blocks for an audit.
+ * @param[in] block_count Number of blocks of the file.
+ * @param[in] sample_size Number of blocks to select. If this is not less than
+ *                        block_count, all blocks are selected.
+ * @param[in] seed Seed for the random selection. The same seed always selects the
+ *                 same blocks.
+ * @return The indices of the selected blocks in ascending order, without duplicates.
+ */
+[[nodiscard]] std::vector<uint64_t> selectAuditBlocks(uint64_t block_count, uint64_t sample_size, uint64_t seed);
+
+}
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/buffered_file_output.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+namespace quicker_sfv {
+
+BufferedFileOutput::BufferedFileOutput(FileOutput& file_output, size_t buffer_size)
+    :m_fileOut(&file_output), m_buffer(std::max<size_t>(buffer_size, 1)), m_bufferUsed(0)
+{}
+
+BufferedFileOutput::~BufferedFileOutput() = default;
+
+void BufferedFileOutput::write(std::span<std::byte const> bytes_to_write) {
+    if (bytes_to_write.size() > m_buffer.size() - m_bufferUsed) {
+        if (bytes_to_write.size() >= m_buffer.size()) {
+            std::array<std::span<std::byte const>, 2> const buffers{
+                std::span<std::byte const>(m_buffer).subspan(0, m_bufferUsed),
+                bytes_to_write
+            };
+            m_fileOut->writeVectored((m_bufferUsed > 0) ? std::span(buffers) : std::span(buffers).subspan(1));
+            m_bufferUsed = 0;
+            return;
+        }
+        flush();
+    }
+    std::ranges::copy(bytes_to_write, m_buffer.begin() + m_bufferUsed);
+    m_bufferUsed += bytes_to_write.size();
+}
+
+std::span<std::byte> BufferedFileOutput::reserve(size_t n) {
+    if (n > m_buffer.size() - m_bufferUsed) {
+        flush();
+        if (n > m_buffer.size()) { m_buffer.resize(n); }
+    }
+    return std::span<std::byte>(m_buffer).subspan(m_bufferUsed);
+}
+
+void BufferedFileOutput::commit(size_t n) noexcept {
+    assert(n <= m_buffer.size() - m_bufferUsed);
+    m_bufferUsed += n;
+}
+
+void BufferedFileOutput::flush() {
+    if (m_bufferUsed == 0) { return; }
+    m_fileOut->write(std::span<std::byte const>(m_buffer).subspan(0, m_bufferUsed));
+    m_bufferUsed = 0;
+}
+
+}
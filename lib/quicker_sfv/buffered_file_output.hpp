@@ -0,0 +1,82 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_BUFFERED_FILE_OUTPUT_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_BUFFERED_FILE_OUTPUT_HPP
+
+#include <quicker_sfv/file_io.hpp>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace quicker_sfv {
+
+/** FileOutput that coalesces small writes into large writes to another FileOutput.
+ * Data can either be written through write(), or formatted directly into the
+ * internal buffer through reserve() and commit().
+ * Data that is still buffered is not written on destruction; flush() has to be
+ * called explicitly once all data has been written.
+ */
+class BufferedFileOutput : public FileOutput {
+public:
+    static constexpr size_t const DEFAULT_BUFFER_SIZE = 4 << 20;
+private:
+    FileOutput* m_fileOut;
+    std::vector<std::byte> m_buffer;
+    size_t m_bufferUsed;
+public:
+    /** Constructor.
+     * @param[in] file_output Output that receives the coalesced writes.
+     * @param[in] buffer_size Size of the coalescing buffer in bytes.
+     */
+    explicit BufferedFileOutput(FileOutput& file_output, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+    ~BufferedFileOutput() override;
+    BufferedFileOutput& operator=(BufferedFileOutput&&) = delete;
+
+    /** Appends the supplied bytes to the buffer.
+     * Writes that do not fit in the buffer are passed on together with the buffered
+     * data as a single vectored write.
+     * @throws Exception Error::FileIO on error.
+     */
+    void write(std::span<std::byte const> bytes_to_write) override;
+
+    /** Provides space for at least n bytes at the end of the buffer.
+     * Data written to the returned span becomes part of the output with commit().
+     * @param[in] n Number of bytes requested.
+     * @return Writable space in the buffer of at least n bytes, which remains valid
+     *         until the next call to any other member function.
+     * @throws Exception Error::FileIO if buffered data has to be flushed and fails
+     *                   to be written.
+     */
+    [[nodiscard]] std::span<std::byte> reserve(size_t n);
+
+    /** Appends the first n bytes of the span returned by the last reserve() to the output.
+     * @pre n does not exceed the size of the span returned by reserve().
+     */
+    void commit(size_t n) noexcept;
+
+    /** Writes all buffered data to the underlying FileOutput.
+     * @throws Exception Error::FileIO on error.
+     */
+    void flush();
+};
+
+}
+#endif
@@ -22,6 +22,10 @@
 #include <quicker_sfv/error.hpp>
 
 #include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <string>
+#include <unordered_map>
 
 namespace quicker_sfv {
 
@@ -39,6 +43,36 @@ void ChecksumFile::addEntry(Digest digest, std::u8string_view display, std::vect
     m_entries.emplace_back(std::u8string{ display }, std::move(digest), std::move(data));
 }
 
+void ChecksumFile::append(ChecksumFile&& other) {
+    if (other.m_entries.size() > 4'294'967'295 - m_entries.size()) { throwException(Error::Failed); }
+    if (m_entries.empty()) {
+        m_entries = std::move(other.m_entries);
+    } else {
+        m_entries.insert(end(m_entries), std::make_move_iterator(begin(other.m_entries)),
+                         std::make_move_iterator(end(other.m_entries)));
+    }
+    other.m_entries.clear();
+    m_pendingSizes.insert(end(m_pendingSizes), std::make_move_iterator(begin(other.m_pendingSizes)),
+                          std::make_move_iterator(end(other.m_pendingSizes)));
+    other.m_pendingSizes.clear();
+}
+
+void ChecksumFile::addExpectedSize(std::u8string_view path, int64_t size) {
+    m_pendingSizes.emplace_back(std::u8string{ path }, size);
+}
+
+void ChecksumFile::resolveExpectedSizes() {
+    if (m_pendingSizes.empty()) { return; }
+    std::unordered_map<std::u8string_view, int64_t> sizes;
+    sizes.reserve(m_pendingSizes.size());
+    for (auto const& s : m_pendingSizes) { sizes.insert_or_assign(s.path, s.size); }
+    for (auto& e : m_entries) {
+        if ((e.data.size() != 1) || (e.data.front().data_offset != 0) || (e.data.front().data_size != -1)) { continue; }
+        if (auto const it = sizes.find(e.data.front().path); it != end(sizes)) { e.expected_size = it->second; }
+    }
+    m_pendingSizes.clear();
+}
+
 void ChecksumFile::sortEntries() {
     std::sort(begin(m_entries), end(m_entries),
         [](Entry const& lhs, Entry const& rhs) -> bool {
@@ -46,8 +80,22 @@ void ChecksumFile::sortEntries() {
         });
 }
 
+std::vector<std::size_t> ChecksumFile::getEntryOrderByExpectedSize() const {
+    std::vector<std::size_t> ret(m_entries.size());
+    std::iota(begin(ret), end(ret), std::size_t{ 0 });
+    std::stable_sort(begin(ret), end(ret),
+        [this](std::size_t lhs_index, std::size_t rhs_index) -> bool {
+            int64_t const lhs = m_entries[lhs_index].expected_size;
+            int64_t const rhs = m_entries[rhs_index].expected_size;
+            if (rhs == -1) { return lhs != -1; }
+            return (lhs != -1) && (lhs < rhs);
+        });
+    return ret;
+}
+
 void ChecksumFile::clear() {
     m_entries.clear();
+    m_pendingSizes.clear();
 }
 
 
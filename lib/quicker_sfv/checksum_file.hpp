@@ -57,9 +57,18 @@ public:
         Digest digest;          ///< Checksum digest for the entity to be checked.
         std::vector<DataPortion> data;
                                 ///< All data contributing to the checksum digest.
+        int64_t expected_size = -1;
+                                ///< Size of the file in bytes as recorded in the checksum
+                                ///  file; -1 if unknown. Only set for entries that hash
+                                ///  a single file in its entirety.
     };
 private:
+    struct ExpectedSize {
+        std::u8string path;
+        int64_t size;
+    };
     std::vector<Entry> m_entries;
+    std::vector<ExpectedSize> m_pendingSizes;
 public:
     /** Retrieves all entries.
      */
@@ -95,10 +104,43 @@ public:
      */
     void addEntry(Digest digest, std::u8string_view display, std::vector<DataPortion> data);
 
+    /** Appends all entries of another ChecksumFile.
+     * @param[in] other ChecksumFile whose entries will be moved to the end of the
+     *                  list of entries.
+     * @throw Exception Error::Failed if the combined number of entries would exceed
+     *                  the maximum number of entries.
+     */
+    void append(ChecksumFile&& other);
+
+    /** Records the expected size of a file.
+     * Checksum files may list file sizes separately from the entries, for example
+     * in comment lines. The size is assigned to the entry for path by the next
+     * call to resolveExpectedSizes(), regardless of the order in which entry and
+     * size were added.
+     * @param[in] path Path of the file, as given for the entry.
+     * @param[in] size Size of the file in bytes.
+     */
+    void addExpectedSize(std::u8string_view path, int64_t size);
+
+    /** Assigns all sizes recorded with addExpectedSize() to their entries.
+     * Sizes for paths that do not have an entry are discarded. If more than one
+     * size was recorded for the same path, the last one is used.
+     */
+    void resolveExpectedSizes();
+
     /** Sorts all entries lexicographically by their paths.
      */
     void sortEntries();
 
+    /** Orders the entries by ascending expected size, without changing their order
+     * in the ChecksumFile.
+     * Entries with unknown size come last. The order of entries of the same size
+     * is preserved.
+     * @return The indices of all entries into getEntries(), in order of their
+     *         expected size.
+     */
+    [[nodiscard]] std::vector<std::size_t> getEntryOrderByExpectedSize() const;
+
     /** Clears the checksum file, leaving it with no entries.
      */
     void clear();
@@ -0,0 +1,80 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/checksum_file_update.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace quicker_sfv {
+
+ChecksumFileUpdate::ChecksumFileUpdate(ChecksumFile previous, StampFile previous_stamps)
+    :m_previous(std::move(previous)), m_previousStamps(std::move(previous_stamps)), m_statistics{}
+{
+    auto const entries = m_previous.getEntries();
+    m_previousIndex.reserve(entries.size());
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        auto const& e = entries[i];
+        if ((e.data.size() != 1) || (e.data.front().data_offset != 0) || (e.data.front().data_size != -1)) {
+            continue;
+        }
+        m_previousIndex.emplace(e.data.front().path, i);
+    }
+    m_seen.resize(entries.size(), false);
+}
+
+Digest const* ChecksumFileUpdate::findUnchanged(std::u8string_view path, FileStamp const& stamp) const {
+    auto const it = m_previousIndex.find(path);
+    if (it == m_previousIndex.end()) { return nullptr; }
+    auto const previous_stamp = m_previousStamps.getStamp(path);
+    if (!previous_stamp || (*previous_stamp != stamp)) { return nullptr; }
+    return &m_previous.getEntries()[it->second].digest;
+}
+
+void ChecksumFileUpdate::addEntry(std::u8string_view path, FileStamp const& stamp, Digest digest) {
+    if (auto const it = m_previousIndex.find(path); it != m_previousIndex.end()) {
+        m_seen[it->second] = true;
+        auto const previous_stamp = m_previousStamps.getStamp(path);
+        if (previous_stamp && (*previous_stamp == stamp) && (m_previous.getEntries()[it->second].digest == digest)) {
+            ++m_statistics.unchanged;
+        } else {
+            ++m_statistics.modified;
+        }
+    } else {
+        ++m_statistics.added;
+    }
+    m_updated.addEntry(path, std::move(digest));
+    m_updatedStamps.setStamp(path, stamp);
+}
+
+ChecksumFile const& ChecksumFileUpdate::getChecksumFile() const {
+    return m_updated;
+}
+
+StampFile const& ChecksumFileUpdate::getStampFile() const {
+    return m_updatedStamps;
+}
+
+ChecksumFileUpdate::Statistics ChecksumFileUpdate::getStatistics() const {
+    Statistics ret = m_statistics;
+    ret.removed = static_cast<uint32_t>(m_previous.getEntries().size() - std::ranges::count(m_seen, true));
+    return ret;
+}
+
+}
@@ -0,0 +1,113 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_CHECKSUM_FILE_UPDATE_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_CHECKSUM_FILE_UPDATE_HPP
+
+#include <quicker_sfv/checksum_file.hpp>
+#include <quicker_sfv/digest.hpp>
+#include <quicker_sfv/stamp_file.hpp>
+
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace quicker_sfv {
+
+/** Incremental update of an existing ChecksumFile.
+ * Instead of hashing all files in a folder again, an update only hashes files that
+ * were added or modified since the ChecksumFile was last written. A file is
+ * considered unmodified if both the ChecksumFile and the accompanying StampFile
+ * contain an entry for it and the recorded FileStamp matches the current state of
+ * the file on disk.
+ *
+ * The client walks the folder and, for each file, first queries findUnchanged().
+ * If that yields a Digest, the file does not need to be hashed again. Either way,
+ * the file is then recorded with addEntry(). Files from the previous ChecksumFile
+ * that are never added are considered deleted and will be dropped from the result.
+ */
+class ChecksumFileUpdate {
+public:
+    /** Summary of the changes between the previous and the updated ChecksumFile.
+     */
+    struct Statistics {
+        uint32_t unchanged;     ///< Number of entries that were carried over unchanged.
+        uint32_t added;         ///< Number of entries that were not part of the
+                                ///  previous ChecksumFile.
+        uint32_t modified;      ///< Number of entries that were part of the previous
+                                ///  ChecksumFile but had to be hashed again.
+        uint32_t removed;       ///< Number of entries from the previous ChecksumFile
+                                ///  that were not added to the update.
+    };
+private:
+    ChecksumFile m_previous;
+    StampFile m_previousStamps;
+    std::unordered_map<std::u8string_view, std::size_t> m_previousIndex;
+    std::vector<bool> m_seen;
+    ChecksumFile m_updated;
+    StampFile m_updatedStamps;
+    Statistics m_statistics;
+public:
+    /** Constructor.
+     * @param[in] previous The ChecksumFile that is to be updated. Only entries that
+     *                     consist of a single DataPortion spanning an entire file
+     *                     are eligible for being carried over.
+     * @param[in] previous_stamps The StampFile that was written together with
+     *                            previous. If no StampFile is available, pass an
+     *                            empty StampFile; all files will then be hashed again.
+     */
+    ChecksumFileUpdate(ChecksumFile previous, StampFile previous_stamps);
+    ChecksumFileUpdate& operator=(ChecksumFileUpdate&&) = delete;
+
+    /** Checks whether a file is unchanged since the previous ChecksumFile was written.
+     * @param[in] path Relative path of the file.
+     * @param[in] stamp Current FileStamp of the file on disk.
+     * @return The Digest from the previous ChecksumFile if the file is unchanged.
+     *         nullptr if the file needs to be hashed.
+     */
+    [[nodiscard]] Digest const* findUnchanged(std::u8string_view path, FileStamp const& stamp) const;
+
+    /** Adds a file to the updated ChecksumFile.
+     * Entries are added to the updated ChecksumFile in the order of the calls to
+     * this function.
+     * @param[in] path Relative path of the file.
+     * @param[in] stamp FileStamp of the file at the time the Digest was computed.
+     * @param[in] digest Checksum Digest of the file.
+     * @throw Exception Error::Failed if the ChecksumFile already contains the
+     *                  maximum number of entries.
+     */
+    void addEntry(std::u8string_view path, FileStamp const& stamp, Digest digest);
+
+    /** Retrieves the updated ChecksumFile.
+     */
+    [[nodiscard]] ChecksumFile const& getChecksumFile() const;
+
+    /** Retrieves the StampFile for the updated ChecksumFile.
+     */
+    [[nodiscard]] StampFile const& getStampFile() const;
+
+    /** Retrieves a summary of the changes for all entries added so far.
+     */
+    [[nodiscard]] Statistics getStatistics() const;
+};
+
+}
+
+#endif
@@ -23,4 +23,20 @@ namespace quicker_sfv {
 
 ChecksumProvider::~ChecksumProvider() = default;
 
+ChecksumFile ChecksumProvider::readFromFileParallel(FileInput& file_input, ParallelParseOptions const&) const {
+    return readFromFile(file_input);
+}
+
+std::expected<ChecksumFile, LineDiagnostic> ChecksumProvider::tryReadFromFileParallel(FileInput& file_input,
+                                                                                     ParallelParseOptions const&) const
+{
+    LenientParseResult res = readFromFileLenient(file_input);
+    if (!res.diagnostics.empty()) { return std::unexpected(res.diagnostics.front()); }
+    return std::move(res.checksum_file);
+}
+
+LenientParseResult ChecksumProvider::readFromFileLenient(FileInput& file_input) const {
+    return LenientParseResult{ .checksum_file = readFromFile(file_input), .diagnostics = {} };
+}
+
 }
@@ -25,11 +25,52 @@
 #include <quicker_sfv/file_io.hpp>
 #include <quicker_sfv/hasher.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <expected>
 #include <memory>
 #include <string_view>
+#include <vector>
 
 namespace quicker_sfv {
 
+/** Options for ChecksumProvider::readFromFileParallel().
+ */
+struct ParallelParseOptions {
+    static constexpr std::size_t const DEFAULT_MIN_CHUNK_SIZE = 4 << 20;
+
+    uint32_t n_threads;             ///< Maximum number of threads used for parsing.
+    std::size_t min_chunk_size;     ///< Minimum number of bytes parsed as one unit of work.
+                                    ///  Files smaller than twice this size are parsed
+                                    ///  on the calling thread.
+};
+
+/** Reasons for rejecting a single line of a text-based checksum file.
+ */
+enum class LineError {
+    InvalidUtf8,        ///< The line is not a valid UTF-8 string.
+    InvalidFormat,      ///< The line does not have the structure required by the format.
+    MissingPath,        ///< The line does not contain a file path.
+    InvalidPath,        ///< The file path contains characters not allowed by the format.
+    InvalidDigest,      ///< The digest is not a valid digest for the format.
+};
+
+/** Diagnostic for a line that was skipped by ChecksumProvider::readFromFileLenient().
+ */
+struct LineDiagnostic {
+    uint64_t line_number;   ///< Number of the line in the file, starting from 1.
+    LineError error;        ///< Reason for rejecting the line.
+
+    friend bool operator==(LineDiagnostic const&, LineDiagnostic const&) = default;
+};
+
+/** Result of ChecksumProvider::readFromFileLenient().
+ */
+struct LenientParseResult {
+    ChecksumFile checksum_file;                 ///< Entries from all valid lines.
+    std::vector<LineDiagnostic> diagnostics;    ///< Diagnostics for all rejected lines, in file order.
+};
+
 /** Provides facilities for reading, writing, and checking a checksum file format.
  */
 class ChecksumProvider;
@@ -95,6 +136,42 @@ public:
      *                   Error::PluginError If a plugin failure occurs.
      */
     virtual ChecksumFile readFromFile(FileInput& file_input) const = 0;
+    /** Reads a ChecksumFile from file, using multiple threads for parsing.
+     * The result is the same as for readFromFile(). If the file contains more than
+     * one error, the error that readFromFile() would have reported is raised.
+     * The default implementation calls readFromFile().
+     * @param[in] file_input A FileInput object providing access to the file data.
+     * @param[in] options Options for parallel parsing.
+     * @return A ChecksumFile with the deserialized contents of file_input.
+     * @throws Exception As for readFromFile().
+     */
+    virtual ChecksumFile readFromFileParallel(FileInput& file_input, ParallelParseOptions const& options) const;
+    /** Reads a ChecksumFile from file, using multiple threads for parsing, and reports
+     * the location of a format error.
+     * Works like readFromFileParallel(), but if the file format is invalid, the
+     * diagnostic for the first invalid line is returned instead of raising an error.
+     * The default implementation calls readFromFileLenient().
+     * @param[in] file_input A FileInput object providing access to the file data.
+     * @param[in] options Options for parallel parsing.
+     * @return A ChecksumFile with the deserialized contents of file_input; or the
+     *         diagnostic for the first invalid line of the file.
+     * @throws Exception Error::FileIO if an error occurs while reading the file.
+     *                   Error::PluginError If a plugin failure occurs.
+     */
+    virtual std::expected<ChecksumFile, LineDiagnostic> tryReadFromFileParallel(FileInput& file_input,
+                                                                                ParallelParseOptions const& options) const;
+    /** Reads a ChecksumFile from file, skipping invalid lines.
+     * Instead of failing on the first invalid line, all valid entries are kept
+     * and a diagnostic is collected for each line that was rejected.
+     * The default implementation calls readFromFile() and thus still fails on
+     * invalid files.
+     * @param[in] file_input A FileInput object providing access to the file data.
+     * @return The entries of all valid lines and the diagnostics for all others.
+     * @throws Exception Error::FileIO if an error occurs while reading the file.
+     *                   Error::Failed if the file contains too many entries.
+     *                   Error::PluginError if a plugin failure occurs.
+     */
+    virtual LenientParseResult readFromFileLenient(FileInput& file_input) const;
     /** Writes a ChecksumFile out to a file.
      * The format of the file is determined by the ChecksumProvider.
      * @param[in] file_output A FileOutput object providing access to the file.
@@ -0,0 +1,337 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/decompressing_file_input.hpp>
+
+#include <quicker_sfv/error.hpp>
+
+#ifdef QUICKER_SFV_WITH_GZIP
+#   include <zlib.h>
+#endif
+#ifdef QUICKER_SFV_WITH_ZSTD
+#   include <zstd.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstring>
+
+namespace quicker_sfv {
+
+namespace detail {
+
+/** Interface to the streaming decompression of a single format.
+ */
+class StreamDecoder {
+public:
+    struct Step {
+        std::size_t consumed;   ///< Number of bytes consumed from the input.
+        std::size_t produced;   ///< Number of bytes written to the output.
+        bool frame_end;         ///< The end of a gzip member or zstd frame was reached.
+    };
+    virtual ~StreamDecoder() = default;
+    /** Decompresses from input to output until either is exhausted.
+     * @throw Exception Error::FileIO if the input is corrupted.
+     */
+    virtual Step decode(std::span<std::byte const> input, std::span<std::byte> output) = 0;
+    /** Prepares the decoder for the start of a new gzip member or zstd frame.
+     */
+    virtual void reset() = 0;
+};
+
+} // namespace detail
+
+namespace {
+
+constexpr std::array<std::byte, 2> const GZIP_MAGIC = { std::byte{ 0x1f }, std::byte{ 0x8b } };
+constexpr std::array<std::byte, 4> const ZSTD_MAGIC = { std::byte{ 0x28 }, std::byte{ 0xb5 }, std::byte{ 0x2f }, std::byte{ 0xfd } };
+constexpr std::size_t const MAX_MAGIC_SIZE = 4;
+
+/// Size of the buffer for discarding data when seeking forward in compressed files.
+constexpr std::size_t const SEEK_BUFFER_SIZE = 64 << 10;
+
+#ifdef QUICKER_SFV_WITH_GZIP
+class GzipDecoder : public detail::StreamDecoder {
+private:
+    z_stream m_stream;
+public:
+    GzipDecoder()
+        :m_stream{}
+    {
+        // adding 16 to the window bits selects the gzip format
+        if (inflateInit2(&m_stream, MAX_WBITS + 16) != Z_OK) { throwException(Error::SystemError); }
+    }
+
+    ~GzipDecoder() override {
+        inflateEnd(&m_stream);
+    }
+
+    Step decode(std::span<std::byte const> input, std::span<std::byte> output) override {
+        // zlib takes 32 bit sizes; the remainder is picked up by the next call
+        uInt const input_size = static_cast<uInt>(std::min<std::size_t>(input.size(), UINT_MAX));
+        uInt const output_size = static_cast<uInt>(std::min<std::size_t>(output.size(), UINT_MAX));
+        m_stream.next_in = const_cast<Bytef*>(reinterpret_cast<Bytef const*>(input.data()));
+        m_stream.avail_in = input_size;
+        m_stream.next_out = reinterpret_cast<Bytef*>(output.data());
+        m_stream.avail_out = output_size;
+        int const res = inflate(&m_stream, Z_NO_FLUSH);
+        if ((res != Z_OK) && (res != Z_STREAM_END) && (res != Z_BUF_ERROR)) { throwException(Error::FileIO); }
+        return Step{
+            .consumed = input_size - m_stream.avail_in,
+            .produced = output_size - m_stream.avail_out,
+            .frame_end = (res == Z_STREAM_END)
+        };
+    }
+
+    void reset() override {
+        if (inflateReset(&m_stream) != Z_OK) { throwException(Error::SystemError); }
+    }
+};
+#endif
+
+#ifdef QUICKER_SFV_WITH_ZSTD
+class ZstdDecoder : public detail::StreamDecoder {
+private:
+    ZSTD_DCtx* m_context;
+public:
+    ZstdDecoder()
+        :m_context(ZSTD_createDCtx())
+    {
+        if (!m_context) { throwException(Error::SystemError); }
+    }
+
+    ~ZstdDecoder() override {
+        ZSTD_freeDCtx(m_context);
+    }
+
+    Step decode(std::span<std::byte const> input, std::span<std::byte> output) override {
+        ZSTD_inBuffer in{ .src = input.data(), .size = input.size(), .pos = 0 };
+        ZSTD_outBuffer out{ .dst = output.data(), .size = output.size(), .pos = 0 };
+        std::size_t const res = ZSTD_decompressStream(m_context, &out, &in);
+        if (ZSTD_isError(res)) { throwException(Error::FileIO); }
+        // a return value of 0 indicates a completely decoded and flushed frame
+        return Step{ .consumed = in.pos, .produced = out.pos, .frame_end = (res == 0) };
+    }
+
+    void reset() override {
+        ZSTD_DCtx_reset(m_context, ZSTD_reset_session_only);
+    }
+};
+#endif
+
+std::unique_ptr<detail::StreamDecoder> createDecoder(Compression compression) {
+#ifdef QUICKER_SFV_WITH_GZIP
+    if (compression == Compression::Gzip) { return std::make_unique<GzipDecoder>(); }
+#endif
+#ifdef QUICKER_SFV_WITH_ZSTD
+    if (compression == Compression::Zstd) { return std::make_unique<ZstdDecoder>(); }
+#endif
+    static_cast<void>(compression);
+    throwException(Error::Failed);
+}
+
+} // anonymous namespace
+
+Compression detectCompression(std::span<std::byte const> header) noexcept {
+    auto const starts_with = [header](std::span<std::byte const> magic) -> bool {
+        return (header.size() >= magic.size()) && std::ranges::equal(header.first(magic.size()), magic);
+    };
+    if (starts_with(GZIP_MAGIC)) { return Compression::Gzip; }
+    if (starts_with(ZSTD_MAGIC)) { return Compression::Zstd; }
+    return Compression::None;
+}
+
+bool isCompressionSupported(Compression compression) noexcept {
+    switch (compression) {
+    case Compression::None: return true;
+#ifdef QUICKER_SFV_WITH_GZIP
+    case Compression::Gzip: return true;
+#endif
+#ifdef QUICKER_SFV_WITH_ZSTD
+    case Compression::Zstd: return true;
+#endif
+    default: return false;
+    }
+}
+
+std::u8string_view stripCompressionExtension(std::u8string_view filename) noexcept {
+    for (std::u8string_view const extension : { u8".gz", u8".zst" }) {
+        if (filename.ends_with(extension)) { return filename.substr(0, filename.size() - extension.size()); }
+    }
+    return filename;
+}
+
+DecompressingFileInput::DecompressingFileInput(FileInput& source)
+    :m_source(&source), m_compression(Compression::None), m_decoder(), m_inputBuffer(), m_mappedInput(),
+     m_inputBegin(0), m_inputEnd(0), m_sourceStart(0), m_position(0), m_sourceEof(false), m_done(false)
+{
+    detectFormat();
+}
+
+DecompressingFileInput::~DecompressingFileInput() = default;
+
+Compression DecompressingFileInput::compression() const noexcept {
+    return m_compression;
+}
+
+void DecompressingFileInput::detectFormat() {
+    m_decoder.reset();
+    m_mappedInput.reset();
+    m_inputBegin = 0;
+    m_inputEnd = 0;
+    m_position = 0;
+    m_sourceEof = false;
+    m_done = false;
+    m_sourceStart = m_source->tell();
+    if (std::optional<std::span<std::byte const>> const mapped = m_source->mappedContents(); mapped) {
+        m_compression = detectCompression(mapped->first(std::min(mapped->size(), MAX_MAGIC_SIZE)));
+        if (m_compression != Compression::None) {
+            // compressed data is decoded directly from the mapped contents
+            m_mappedInput = mapped;
+            m_inputEnd = mapped->size();
+            m_sourceEof = true;
+        }
+    } else {
+        // the data read for detecting the format remains buffered for decoding or passing through
+        m_inputBuffer.resize(INPUT_BUFFER_SIZE);
+        refillInput();
+        m_compression = detectCompression(std::span<std::byte const>(m_inputBuffer).subspan(0, m_inputEnd));
+    }
+    if (m_compression != Compression::None) {
+        m_decoder = createDecoder(m_compression);
+    }
+}
+
+bool DecompressingFileInput::refillInput() {
+    if (m_inputBegin != m_inputEnd) { return true; }
+    if (m_sourceEof) { return false; }
+    m_inputBegin = 0;
+    m_inputEnd = 0;
+    std::size_t const bytes_read = m_source->read(m_inputBuffer);
+    if (bytes_read == RESULT_END_OF_FILE) {
+        m_sourceEof = true;
+        return false;
+    }
+    if (bytes_read < m_inputBuffer.size()) { m_sourceEof = true; }
+    m_inputEnd = bytes_read;
+    return bytes_read != 0;
+}
+
+void DecompressingFileInput::restart() {
+    if (!m_mappedInput) {
+        m_source->seek(m_sourceStart, SeekStart::FileStart);
+        m_inputEnd = 0;
+        m_sourceEof = false;
+    }
+    m_inputBegin = 0;
+    m_decoder->reset();
+    m_position = 0;
+    m_done = false;
+}
+
+size_t DecompressingFileInput::readPassthrough(std::span<std::byte> read_buffer) {
+    std::size_t const buffered = std::min(read_buffer.size(), m_inputEnd - m_inputBegin);
+    if (buffered != 0) {
+        std::memcpy(read_buffer.data(), m_inputBuffer.data() + m_inputBegin, buffered);
+        m_inputBegin += buffered;
+        if (buffered == read_buffer.size()) { return buffered; }
+    }
+    std::size_t const bytes_read = (m_sourceEof) ? RESULT_END_OF_FILE : m_source->read(read_buffer.subspan(buffered));
+    if (bytes_read == RESULT_END_OF_FILE) { return (buffered == 0) ? RESULT_END_OF_FILE : buffered; }
+    return buffered + bytes_read;
+}
+
+size_t DecompressingFileInput::read(std::span<std::byte> read_buffer) {
+    if (m_compression == Compression::None) { return readPassthrough(read_buffer); }
+    std::size_t bytes_read = 0;
+    while ((bytes_read < read_buffer.size()) && !m_done) {
+        refillInput();
+        std::span<std::byte const> const input = (m_mappedInput) ?
+            m_mappedInput->subspan(m_inputBegin, m_inputEnd - m_inputBegin) :
+            std::span<std::byte const>(m_inputBuffer).subspan(m_inputBegin, m_inputEnd - m_inputBegin);
+        detail::StreamDecoder::Step const step = m_decoder->decode(input, read_buffer.subspan(bytes_read));
+        m_inputBegin += step.consumed;
+        bytes_read += step.produced;
+        if (step.frame_end) {
+            // further gzip members or zstd frames may follow
+            if (refillInput()) {
+                m_decoder->reset();
+            } else {
+                m_done = true;
+            }
+        } else if ((step.consumed == 0) && (step.produced == 0)) {
+            // the data ends in the middle of a frame, or the decoder is stuck on corrupted data
+            throwException(Error::FileIO);
+        }
+    }
+    m_position += bytes_read;
+    if ((bytes_read == 0) && m_done) { return RESULT_END_OF_FILE; }
+    return bytes_read;
+}
+
+int64_t DecompressingFileInput::seek(int64_t offset, SeekStart seek_start) {
+    if (m_compression == Compression::None) {
+        // data buffered for detecting the format is already read from the source
+        int64_t const buffered = static_cast<int64_t>(m_inputEnd - m_inputBegin);
+        m_inputBegin = 0;
+        m_inputEnd = 0;
+        m_sourceEof = false;
+        return m_source->seek((seek_start == SeekStart::CurrentPosition) ? (offset - buffered) : offset, seek_start);
+    }
+    if (seek_start == SeekStart::FileEnd) { throwException(Error::FileIO); }
+    int64_t const target = (seek_start == SeekStart::CurrentPosition) ? (static_cast<int64_t>(m_position) + offset) : offset;
+    if (target < 0) { throwException(Error::FileIO); }
+    if (static_cast<uint64_t>(target) < m_position) { restart(); }
+    std::vector<std::byte> discard;
+    while (m_position < static_cast<uint64_t>(target)) {
+        if (discard.empty()) { discard.resize(SEEK_BUFFER_SIZE); }
+        std::size_t const bytes_to_read = static_cast<std::size_t>(std::min<uint64_t>(discard.size(), target - m_position));
+        if (read(std::span<std::byte>(discard).first(bytes_to_read)) != bytes_to_read) { break; }
+    }
+    return static_cast<int64_t>(m_position);
+}
+
+int64_t DecompressingFileInput::tell() {
+    if (m_compression == Compression::None) {
+        return m_source->tell() - static_cast<int64_t>(m_inputEnd - m_inputBegin);
+    }
+    return static_cast<int64_t>(m_position);
+}
+
+std::u8string_view DecompressingFileInput::current_file() const {
+    return m_source->current_file();
+}
+
+bool DecompressingFileInput::open(std::u8string_view new_file) {
+    if (!m_source->open(new_file)) { return false; }
+    detectFormat();
+    return true;
+}
+
+uint64_t DecompressingFileInput::file_size() {
+    return m_source->file_size();
+}
+
+std::optional<std::span<std::byte const>> DecompressingFileInput::mappedContents() noexcept {
+    if ((m_compression != Compression::None) || (m_inputBegin != m_inputEnd)) { return std::nullopt; }
+    return m_source->mappedContents();
+}
+
+}
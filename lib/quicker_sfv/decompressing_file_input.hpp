@@ -0,0 +1,142 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_DECOMPRESSING_FILE_INPUT_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_DECOMPRESSING_FILE_INPUT_HPP
+
+#include <quicker_sfv/file_io.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace quicker_sfv {
+
+/** Compression formats recognized by DecompressingFileInput.
+ */
+enum class Compression {
+    None,   ///< Uncompressed data.
+    Gzip,   ///< gzip format; Requires building with QUICKER_SFV_WITH_GZIP.
+    Zstd,   ///< Zstandard format; Requires building with QUICKER_SFV_WITH_ZSTD.
+};
+
+/** Detects the compression format of a file from the magic bytes at its start.
+ * @param[in] header The first bytes of the file. Formats are only detected if the
+ *                   header contains the complete magic bytes, which are at most
+ *                   4 bytes in size.
+ * @return The detected format; Compression::None if the data is not compressed.
+ */
+[[nodiscard]] Compression detectCompression(std::span<std::byte const> header) noexcept;
+
+/** Checks whether this build is able to decompress the given format.
+ */
+[[nodiscard]] bool isCompressionSupported(Compression compression) noexcept;
+
+/** Removes the file extension of a compression format from a file name.
+ * This allows finding the checksum file format of a compressed file, which is given
+ * by the extension before the compression extension, eg. `*.sfv` for `files.sfv.gz`.
+ * @return filename without a trailing `.gz` or `.zst`; filename if it has neither.
+ */
+[[nodiscard]] std::u8string_view stripCompressionExtension(std::u8string_view filename) noexcept;
+
+namespace detail {
+class StreamDecoder;
+}
+
+/** FileInput decorator that decompresses compressed files transparently.
+ * The compression format is detected from the magic bytes at the start of the file.
+ * Uncompressed files are passed through unchanged, including their mapped contents.
+ * Decompression is streaming: Only a small part of the compressed and decompressed
+ * data is held in memory at any time. Files consisting of several concatenated gzip
+ * members or zstd frames are decompressed in their entirety.
+ */
+class DecompressingFileInput : public FileInput {
+public:
+    /** Size of a single read from the compressed file in bytes.
+     */
+    static constexpr std::size_t const INPUT_BUFFER_SIZE = 256 << 10;
+private:
+    FileInput* m_source;
+    Compression m_compression;
+    std::unique_ptr<detail::StreamDecoder> m_decoder;
+    std::vector<std::byte> m_inputBuffer;
+    std::optional<std::span<std::byte const>> m_mappedInput;   ///< Mapped contents of a compressed source, if available.
+    std::size_t m_inputBegin;       ///< Offset of the first byte in the input buffer that was not consumed yet.
+    std::size_t m_inputEnd;         ///< Offset one past the last byte read into the input buffer.
+    int64_t m_sourceStart;          ///< Position in the source file where the compressed data starts.
+    uint64_t m_position;            ///< Position in the decompressed data.
+    bool m_sourceEof;
+    bool m_done;
+public:
+    /** Constructor.
+     * Reads the start of source to detect its compression format.
+     * @param[in] source The file to be decompressed. Reading starts at its current
+     *                   read position.
+     * @throw Exception Error::FileIO if an error occurs while reading from source.
+     *                  Error::Failed if source is compressed in a format that is not
+     *                  supported by this build.
+     */
+    explicit DecompressingFileInput(FileInput& source);
+    ~DecompressingFileInput() override;
+    DecompressingFileInput(DecompressingFileInput const&) = delete;
+    DecompressingFileInput& operator=(DecompressingFileInput const&) = delete;
+
+    /** Compression format of the current file.
+     */
+    [[nodiscard]] Compression compression() const noexcept;
+
+    /** Reads decompressed data.
+     * @throw Exception Error::FileIO if an error occurs while reading from the source,
+     *                  or if the compressed data is corrupted or truncated.
+     */
+    size_t read(std::span<std::byte> read_buffer) override;
+    /** Sets the read position in the decompressed data.
+     * For compressed files, seeking forward decompresses and discards the data in
+     * between, while seeking backward restarts decompression from the start of the
+     * file. Seeking relative to the end of a compressed file is not supported.
+     * @throw Exception Error::FileIO on error, or if seek_start is SeekStart::FileEnd
+     *                  for a compressed file.
+     */
+    int64_t seek(int64_t offset, SeekStart seek_start) override;
+    int64_t tell() override;
+    std::u8string_view current_file() const override;
+    /** Opens a new file through the source and detects its compression format.
+     * @throw Exception As for the constructor.
+     */
+    bool open(std::u8string_view new_file) override;
+    /** Retrieves the size of the file.
+     * For compressed files, this is the size of the compressed data, as the size
+     * of the decompressed data is not known before decompressing it.
+     */
+    uint64_t file_size() override;
+    std::optional<std::span<std::byte const>> mappedContents() noexcept override;
+private:
+    void detectFormat();
+    void restart();
+    bool refillInput();
+    size_t readPassthrough(std::span<std::byte> read_buffer);
+};
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_BYTE_ORDER_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_BYTE_ORDER_HPP
+
+#include <concepts>
+#include <cstddef>
+
+/** Portable access to little-endian integers in binary file formats.
+ */
+namespace quicker_sfv::byte_order {
+
+/** Loads an unsigned little-endian integer from memory.
+ * @param[in] p Pointer to the first byte of the integer. No alignment is required.
+ */
+template<std::unsigned_integral T>
+[[nodiscard]] inline T loadLittleEndian(std::byte const* p) {
+    T ret = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        ret |= static_cast<T>(static_cast<T>(p[i]) << (8 * i));
+    }
+    return ret;
+}
+
+/** Stores an unsigned integer in little-endian byte order to memory.
+ * @param[out] p Pointer to the first byte of the destination. No alignment is required.
+ * @param[in] v The value to store.
+ */
+template<std::unsigned_integral T>
+inline void storeLittleEndian(std::byte* p, T v) {
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        p[i] = static_cast<std::byte>((v >> (8 * i)) & 0xff);
+    }
+}
+
+}
+#endif
@@ -21,10 +21,16 @@
 
 #include <quicker_sfv/error.hpp>
 #include <quicker_sfv/digest.hpp>
+#include <quicker_sfv/detail/byte_order.hpp>
 #include <quicker_sfv/detail/string_conversion.hpp>
 
 #include <fast_crc32/fast_crc32.hpp>
 
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <utility>
+
 namespace quicker_sfv::detail {
 
 namespace {
@@ -50,6 +56,9 @@ std::u8string CrcDigest::toString() const {
     return ret;
 }
 
+/// Tag identifying a saved Crc32Hasher state.
+constexpr std::byte const CRC32_STATE_TAG[] = { std::byte{ 'C' }, std::byte{ 'R' }, std::byte{ 'C' }, std::byte{ '1' } };
+
 } // anonymous namespace
 
 Crc32Hasher::Crc32Hasher(HasherOptions const& opt)
@@ -70,18 +79,41 @@ void Crc32Hasher::reset() {
     m_state = 0;
 }
 
+bool Crc32Hasher::supportsSavedState() const noexcept {
+    return true;
+}
+
+std::vector<std::byte> Crc32Hasher::saveState() const {
+    std::vector<std::byte> ret(sizeof(CRC32_STATE_TAG) + sizeof(uint32_t));
+    std::copy(std::begin(CRC32_STATE_TAG), std::end(CRC32_STATE_TAG), ret.begin());
+    byte_order::storeLittleEndian(ret.data() + sizeof(CRC32_STATE_TAG), m_state);
+    return ret;
+}
+
+void Crc32Hasher::restoreState(std::span<std::byte const> state) {
+    if ((state.size() != sizeof(CRC32_STATE_TAG) + sizeof(uint32_t)) ||
+        (!std::equal(std::begin(CRC32_STATE_TAG), std::end(CRC32_STATE_TAG), state.begin())))
+    {
+        throwException(Error::HasherFailure);
+    }
+    m_state = byte_order::loadLittleEndian<uint32_t>(state.data() + sizeof(CRC32_STATE_TAG));
+}
+
 /* static */
 Digest Crc32Hasher::digestFromString(std::u8string_view str) {
-    if (str.size() != 8) { throwException(Error::ParserError); }
-    auto conv = [](char8_t h, char8_t l) -> uint32_t {
-        using string_conversion::hex_str_to_byte;
-        return static_cast<uint32_t>(hex_str_to_byte(h, l));
-    };
-    uint32_t d =
-        (conv(str[0], str[1]) << 24) |
-        (conv(str[2], str[3]) << 16) |
-        (conv(str[4], str[5]) << 8) |
-        conv(str[6], str[7]);
+    std::expected<Digest, Error> ret = tryDigestFromString(str);
+    if (!ret) { throwException(ret.error()); }
+    return std::move(*ret);
+}
+
+std::expected<Digest, Error> Crc32Hasher::tryDigestFromString(std::u8string_view str) {
+    if (str.size() != 8) { return std::unexpected(Error::ParserError); }
+    uint32_t d = 0;
+    for (std::size_t i = 0; i < 8; i += 2) {
+        std::optional<std::byte> const b = string_conversion::try_hex_str_to_byte(str[i], str[i + 1]);
+        if (!b) { return std::unexpected(Error::ParserError); }
+        d = (d << 8) | static_cast<uint32_t>(*b);
+    }
     return CrcDigest{ d };
 }
 
@@ -20,9 +20,11 @@
 #ifndef INCLUDE_GUARD_QUICKER_SFV_CRC32_HPP
 #define INCLUDE_GUARD_QUICKER_SFV_CRC32_HPP
 
+#include <quicker_sfv/error.hpp>
 #include <quicker_sfv/hasher.hpp>
 
 #include <cstdint>
+#include <expected>
 
 namespace quicker_sfv::detail {
 
@@ -40,7 +42,14 @@ public:
     void addData(std::span<std::byte const> data) override;
     Digest finalize() override;
     void reset() override;
+    [[nodiscard]] bool supportsSavedState() const noexcept override;
+    [[nodiscard]] std::vector<std::byte> saveState() const override;
+    void restoreState(std::span<std::byte const> state) override;
     static Digest digestFromString(std::u8string_view str);
+    /** Parses a digest without throwing on invalid input.
+     * @return The parsed digest; Error::ParserError if str is not a valid digest.
+     */
+    static std::expected<Digest, Error> tryDigestFromString(std::u8string_view str);
     static Digest digestFromRaw(uint32_t d);
 };
 
@@ -20,11 +20,16 @@
 #include <quicker_sfv/detail/md5.hpp>
 
 #include <quicker_sfv/error.hpp>
+#include <quicker_sfv/detail/byte_order.hpp>
 #include <quicker_sfv/detail/string_conversion.hpp>
 
 #include <openssl/md5.h>
 
+#include <algorithm>
 #include <array>
+#include <cstring>
+#include <iterator>
+#include <optional>
 #include <stdexcept>
 
 #ifdef _MSC_VER
@@ -45,7 +50,7 @@ struct MD5Digest {
 
     MD5Digest();
 
-    static MD5Digest fromString(std::u8string_view str);
+    static std::optional<MD5Digest> tryFromString(std::u8string_view str) noexcept;
 
     std::u8string toString() const;
 
@@ -59,13 +64,15 @@ MD5Digest::MD5Digest()
 {
 }
 
-MD5Digest MD5Digest::fromString(std::u8string_view str) {
+std::optional<MD5Digest> MD5Digest::tryFromString(std::u8string_view str) noexcept {
     MD5Digest ret;
-    if (str.size() != 32) { throwException(Error::ParserError); }
+    if (str.size() != 32) { return std::nullopt; }
     for (int i = 0; i < 16; ++i) {
         char8_t const upper = str[i*2];
         char8_t const lower = str[i*2 + 1];
-        ret.data[i] = string_conversion::hex_str_to_byte(upper, lower);
+        std::optional<std::byte> const b = string_conversion::try_hex_str_to_byte(upper, lower);
+        if (!b) { return std::nullopt; }
+        ret.data[i] = *b;
     }
     return ret;
 }
@@ -81,6 +88,15 @@ std::u8string MD5Digest::toString() const {
     return ret;
 }
 
+/// Tag identifying a saved MD5Hasher state.
+constexpr std::byte const MD5_STATE_TAG[] = { std::byte{ 'M' }, std::byte{ 'D' }, std::byte{ '5' }, std::byte{ '2' } };
+/// The state is stored as the MD5_CTX fields A, B, C, D, Nl, Nh, and num as 32 bit
+/// little-endian integers, followed by the num bytes of input buffered in data. The
+/// buffer holds raw input bytes in native memory order, so it is stored byte by byte
+/// instead of as the integers it is declared as.
+constexpr std::size_t const MD5_STATE_FIELDS = 7;
+constexpr std::size_t const MD5_STATE_HEADER_SIZE = sizeof(MD5_STATE_TAG) + MD5_STATE_FIELDS * sizeof(uint32_t);
+
 } // anonymous namespace
 
 struct MD5Hasher::Pimpl {
@@ -118,9 +134,62 @@ void MD5Hasher::reset() {
     if (res != 1) { throwException(Error::HasherFailure); }
 }
 
+bool MD5Hasher::supportsSavedState() const noexcept {
+    return true;
+}
+
+std::vector<std::byte> MD5Hasher::saveState() const {
+    MD5_CTX const& ctx = m_impl->context;
+    std::vector<std::byte> ret(MD5_STATE_HEADER_SIZE + ctx.num);
+    std::copy(std::begin(MD5_STATE_TAG), std::end(MD5_STATE_TAG), ret.begin());
+    std::byte* out = ret.data() + sizeof(MD5_STATE_TAG);
+    auto const store = [&out](uint32_t v) {
+        byte_order::storeLittleEndian(out, v);
+        out += sizeof(uint32_t);
+    };
+    store(ctx.A); store(ctx.B); store(ctx.C); store(ctx.D);
+    store(ctx.Nl); store(ctx.Nh);
+    store(ctx.num);
+    std::memcpy(out, ctx.data, ctx.num);
+    return ret;
+}
+
+void MD5Hasher::restoreState(std::span<std::byte const> state) {
+    if ((state.size() < MD5_STATE_HEADER_SIZE) ||
+        (!std::equal(std::begin(MD5_STATE_TAG), std::end(MD5_STATE_TAG), state.begin())))
+    {
+        throwException(Error::HasherFailure);
+    }
+    std::byte const* in = state.data() + sizeof(MD5_STATE_TAG);
+    auto const load = [&in]() -> uint32_t {
+        uint32_t const ret = byte_order::loadLittleEndian<uint32_t>(in);
+        in += sizeof(uint32_t);
+        return ret;
+    };
+    MD5_CTX ctx{};
+    ctx.A = load(); ctx.B = load(); ctx.C = load(); ctx.D = load();
+    ctx.Nl = load(); ctx.Nh = load();
+    ctx.num = load();
+    // the number of buffered bytes has to be less than one block
+    if ((ctx.num >= MD5_CBLOCK) || (state.size() != MD5_STATE_HEADER_SIZE + ctx.num)) {
+        throwException(Error::HasherFailure);
+    }
+    std::memcpy(ctx.data, in, ctx.num);
+    m_impl->context = ctx;
+}
+
 /* static */
 Digest MD5Hasher::digestFromString(std::u8string_view str) {
-    return MD5Digest::fromString(str);
+    std::expected<Digest, Error> ret = tryDigestFromString(str);
+    if (!ret) { throwException(ret.error()); }
+    return std::move(*ret);
+}
+
+/* static */
+std::expected<Digest, Error> MD5Hasher::tryDigestFromString(std::u8string_view str) {
+    std::optional<MD5Digest> const d = MD5Digest::tryFromString(str);
+    if (!d) { return std::unexpected(Error::ParserError); }
+    return Digest(MD5Digest(*d));
 }
 
 }
@@ -27,7 +27,7 @@ namespace quicker_sfv::string_conversion {
 
 namespace {
 
-std::byte hex_char_to_nibble(char8_t x) {
+std::optional<std::byte> try_hex_char_to_nibble(char8_t x) noexcept {
     if ((x >= '0') && (x <= '9')) {
         return static_cast<std::byte>(x - u8'0');
     } else if ((x >= 'a') && (x <= 'f')) {
@@ -35,7 +35,7 @@ std::byte hex_char_to_nibble(char8_t x) {
     } else if ((x >= 'A') && (x <= 'F')) {
         return static_cast<std::byte>(x - u8'A' + 10);
     } else {
-        throwException(Error::ParserError);
+        return std::nullopt;
     }
 }
 
@@ -60,13 +60,22 @@ std::byte higher_nibble(std::byte b) {
 } // anonymous namespace
 
 std::byte hex_str_to_byte(char8_t higher, char8_t lower) {
-    return (hex_char_to_nibble(higher) << 4) | hex_char_to_nibble(lower);
+    std::optional<std::byte> const ret = try_hex_str_to_byte(higher, lower);
+    if (!ret) { throwException(Error::ParserError); }
+    return *ret;
 }
 
 std::byte hex_str_to_byte(Nibbles const& nibbles) {
     return hex_str_to_byte(nibbles.higher, nibbles.lower);
 }
 
+std::optional<std::byte> try_hex_str_to_byte(char8_t higher, char8_t lower) noexcept {
+    std::optional<std::byte> const h = try_hex_char_to_nibble(higher);
+    std::optional<std::byte> const l = try_hex_char_to_nibble(lower);
+    if (!h || !l) { return std::nullopt; }
+    return (*h << 4) | *l;
+}
+
 Nibbles byte_to_hex_str(std::byte b) {
     return Nibbles{
         .higher = nibble_to_hex_char(higher_nibble(b)),
@@ -21,6 +21,7 @@
 #define INCLUDE_GUARD_QUICKER_SFV_STRING_CONVERSION_HPP
 
 #include <cstddef>
+#include <optional>
 
 /** Conversion between ASCII hex and byte.
  */
@@ -51,6 +52,13 @@ std::byte hex_str_to_byte(char8_t higher, char8_t lower);
  */
 std::byte hex_str_to_byte(Nibbles const& nibbles);
 
+/** Converts a pair of ASCII hex characters to the corresponding byte without throwing.
+ * @param[in] higher The higher (most-significant) nibble of the byte.
+ * @param[in] lower The lower (least-significant) nibble of the byte.
+ * @return The converted byte value; The empty optional if an input has an invalid value.
+ */
+std::optional<std::byte> try_hex_str_to_byte(char8_t higher, char8_t lower) noexcept;
+
 /** Converts a byte to ASCII hex representation.
  * @param[in] b Byte value to be converted.
  * @return ASCII hex characters of the byte in Nibbles representation.
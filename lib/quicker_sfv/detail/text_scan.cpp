@@ -0,0 +1,222 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/detail/text_scan.hpp>
+
+#ifdef _MSC_VER
+#   include <intrin.h>
+#else
+#   include <cpuid.h>
+#endif
+#include <emmintrin.h>
+
+#include <bit>
+#include <cstdint>
+
+namespace quicker_sfv::text_scan {
+
+namespace {
+
+bool checkAvx2() {
+#ifdef _MSC_VER
+    int data[4];
+    __cpuidex(data, 0, 0);
+    if (data[0] < 7) { return false; }
+    __cpuidex(data, 1, 0);
+    uint32_t const ecx1 = static_cast<uint32_t>(data[2]);
+#else
+    uint32_t eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0, nullptr) < 7) { return false; }
+    __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+    uint32_t const ecx1 = ecx;
+#endif
+    bool const osxsave = (ecx1 & 0x0800'0000) != 0;
+    bool const avx = (ecx1 & 0x1000'0000) != 0;
+    if (!(osxsave && avx)) { return false; }
+    // the operating system has to save the ymm registers on context switch
+#ifdef _MSC_VER
+    uint64_t const xcr0 = _xgetbv(0);
+#else
+    uint32_t xcr0_lo, xcr0_hi;
+    __asm__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    uint64_t const xcr0 = (static_cast<uint64_t>(xcr0_hi) << 32) | xcr0_lo;
+#endif
+    if ((xcr0 & 0x6) != 0x6) { return false; }
+#ifdef _MSC_VER
+    __cpuidex(data, 7, 0);
+    uint32_t const ebx7 = static_cast<uint32_t>(data[1]);
+#else
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    uint32_t const ebx7 = ebx;
+#endif
+    return (ebx7 & 0x0000'0020) != 0;
+}
+
+} // anonymous namespace
+
+bool supportsAvx2() {
+    static bool const has_avx2 = checkAvx2();
+    return has_avx2;
+}
+
+uint64_t Utf8BlockMasks::invalidPositions() const {
+    // one bit per byte for each of the five most significant bits of the byte
+    uint64_t const leading = bit7 & bit6;
+    uint64_t const leading_3 = leading & bit5;
+    uint64_t const leading_4 = leading_3 & bit4;
+    uint64_t const continuation = bit7 & ~bit6;
+    // continuation bytes expected within the block; bits shifted out would be in the next block
+    uint64_t const expected = (leading << 1) | (leading_3 << 2) | (leading_4 << 3);
+    return (continuation ^ expected) | (leading_4 & bit3);
+}
+
+uint64_t Utf8BlockMasks::incompleteTail() const {
+    uint64_t const leading = bit7 & bit6;
+    uint64_t const leading_3 = leading & bit5;
+    uint64_t const leading_4 = leading_3 & bit4;
+    // sequences whose continuation bytes extend past the end of the block
+    return (leading >> 63) | (leading_3 >> 62) | (leading_4 >> 61);
+}
+
+std::size_t Utf8BlockMasks::validPrefix() const {
+    if (invalidPositions() != 0) { return 0; }
+    if (incompleteTail() == 0) { return 64; }
+    // the last leading byte starts the incomplete sequence
+    return 63 - std::countl_zero(bit7 & bit6);
+}
+
+std::size_t findNewline(std::span<std::byte const> range) {
+    return (supportsAvx2()) ? findNewlineAvx2(range) : findNewlineSse2(range);
+}
+
+std::size_t findNewlineSse2(std::span<std::byte const> range) {
+    std::byte const* const data = range.data();
+    std::size_t const size = range.size();
+    __m128i const newline = _mm_set1_epi8('\n');
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i));
+        uint32_t const mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+        if (mask != 0) { return i + std::countr_zero(mask); }
+    }
+    for (; i < size; ++i) {
+        if (data[i] == std::byte{ '\n' }) { return i; }
+    }
+    return size;
+}
+
+std::size_t findNonAscii(std::span<std::byte const> range) {
+    return (supportsAvx2()) ? findNonAsciiAvx2(range) : findNonAsciiSse2(range);
+}
+
+std::size_t skipValidUtf8(std::span<std::byte const> range) {
+    return (supportsAvx2()) ? skipValidUtf8Avx2(range) : skipValidUtf8Sse2(range);
+}
+
+std::size_t skipValidUtf8Sse2(std::span<std::byte const> range) {
+    std::byte const* const data = range.data();
+    std::size_t const size = range.size();
+    std::size_t i = 0;
+    while (i + 64 <= size) {
+        __m128i chunks[4];
+        for (int c = 0; c < 4; ++c) { chunks[c] = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i + 16 * c)); }
+        // the most significant bit of each byte after shifting left by `shift`
+        auto const bits = [&chunks](int shift) -> uint64_t {
+            uint64_t ret = 0;
+            for (int c = 0; c < 4; ++c) {
+                __m128i v = chunks[c];
+                for (int s = 0; s < shift; ++s) { v = _mm_add_epi8(v, v); }
+                ret |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(v))) << (16 * c);
+            }
+            return ret;
+        };
+        uint64_t const bit7 = bits(0);
+        if (bit7 == 0) {
+            i += 64;
+            continue;
+        }
+        std::size_t const valid = Utf8BlockMasks{ .bit7 = bit7, .bit6 = bits(1), .bit5 = bits(2), .bit4 = bits(3), .bit3 = bits(4) }.validPrefix();
+        if (valid == 0) { break; }
+        i += valid;
+    }
+    return i;
+}
+
+std::size_t widenAscii(std::span<std::byte const> range, char16_t* out) {
+    return (supportsAvx2()) ? widenAsciiAvx2(range, out) : widenAsciiSse2(range, out);
+}
+
+std::size_t widenAsciiSse2(std::span<std::byte const> range, char16_t* out) {
+    std::byte const* const data = range.data();
+    std::size_t const size = range.size();
+    __m128i const zero = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i));
+        if (_mm_movemask_epi8(chunk) != 0) { break; }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(chunk, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpackhi_epi8(chunk, zero));
+    }
+    for (; i < size; ++i) {
+        if ((data[i] & std::byte{ 0x80 }) != std::byte{ 0 }) { break; }
+        out[i] = static_cast<char16_t>(data[i]);
+    }
+    return i;
+}
+
+std::size_t narrowAscii(std::span<char16_t const> range, char8_t* out) {
+    return (supportsAvx2()) ? narrowAsciiAvx2(range, out) : narrowAsciiSse2(range, out);
+}
+
+std::size_t narrowAsciiSse2(std::span<char16_t const> range, char8_t* out) {
+    char16_t const* const data = range.data();
+    std::size_t const size = range.size();
+    __m128i const non_ascii = _mm_set1_epi16(static_cast<short>(0xff80));
+    __m128i const zero = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i const chunk0 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i));
+        __m128i const chunk1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i + 8));
+        __m128i const high_bits = _mm_and_si128(_mm_or_si128(chunk0, chunk1), non_ascii);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(high_bits, zero)) != 0xffff) { break; }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(chunk0, chunk1));
+    }
+    for (; i < size; ++i) {
+        if (data[i] >= 0x80) { break; }
+        out[i] = static_cast<char8_t>(data[i]);
+    }
+    return i;
+}
+
+std::size_t findNonAsciiSse2(std::span<std::byte const> range) {
+    std::byte const* const data = range.data();
+    std::size_t const size = range.size();
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i));
+        uint32_t const mask = static_cast<uint32_t>(_mm_movemask_epi8(chunk));
+        if (mask != 0) { return i + std::countr_zero(mask); }
+    }
+    for (; i < size; ++i) {
+        if ((data[i] & std::byte{ 0x80 }) != std::byte{ 0 }) { return i; }
+    }
+    return size;
+}
+
+}
@@ -0,0 +1,112 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_TEXT_SCAN_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_TEXT_SCAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/** Vectorized scanning of text buffers.
+ * The functions without suffix select the fastest implementation supported by
+ * the CPU. The suffixed implementations are exposed for testing.
+ */
+namespace quicker_sfv::text_scan {
+
+/** Classification of a block of 64 bytes for UTF-8 validation.
+ * Each mask holds one bit per byte of the block, with the bit for the first byte
+ * in the least significant position. bitN is the value of bit N of the respective byte.
+ * The block must start at the beginning of a UTF-8 sequence.
+ */
+struct Utf8BlockMasks {
+    uint64_t bit7;
+    uint64_t bit6;
+    uint64_t bit5;
+    uint64_t bit4;
+    uint64_t bit3;
+
+    /** Bytes that violate the structure of UTF-8 within the block.
+     * These are continuation bytes without a preceding leading byte, missing
+     * continuation bytes and invalid leading bytes. Continuation bytes that
+     * are missing only because they would be located in the next block are
+     * not reported.
+     */
+    uint64_t invalidPositions() const;
+    /** Non-zero if the last sequence of the block continues in the next block.
+     */
+    uint64_t incompleteTail() const;
+    /** Number of bytes at the start of the block consisting of complete valid sequences.
+     * 0 if the block contains invalid sequences.
+     */
+    std::size_t validPrefix() const;
+};
+
+/** Checks whether the CPU and operating system support the AVX2 instruction set.
+ */
+bool supportsAvx2();
+
+/** Finds the first linebreak character `'\n'` in a range.
+ * @return Index of the first `'\n'` in range; range.size() if there is none.
+ */
+std::size_t findNewline(std::span<std::byte const> range);
+std::size_t findNewlineSse2(std::span<std::byte const> range);
+std::size_t findNewlineAvx2(std::span<std::byte const> range);
+
+/** Finds the first byte in a range that is not a 7-bit ASCII character.
+ * @return Index of the first byte with the most-significant bit set;
+ *         range.size() if there is none.
+ */
+std::size_t findNonAscii(std::span<std::byte const> range);
+std::size_t findNonAsciiSse2(std::span<std::byte const> range);
+std::size_t findNonAsciiAvx2(std::span<std::byte const> range);
+
+/** Skips a prefix of a range that consists of complete, valid UTF-8 sequences.
+ * Validation follows the rules of checkValidUtf8(). The range is processed in blocks
+ * of 64 bytes, and only blocks that are entirely valid are skipped. The caller is
+ * expected to validate the remainder of the range starting from the returned index.
+ * @pre range starts at the beginning of a UTF-8 sequence.
+ * @return Index one past the last byte of the last complete sequence skipped.
+ */
+std::size_t skipValidUtf8(std::span<std::byte const> range);
+std::size_t skipValidUtf8Sse2(std::span<std::byte const> range);
+std::size_t skipValidUtf8Avx2(std::span<std::byte const> range);
+
+/** Widens the leading 7-bit ASCII characters of a range to UTF-16.
+ * Conversion stops at the first byte that is not a 7-bit ASCII character.
+ * @param[in] range The range to convert.
+ * @param[out] out Receives the converted characters; must have space for range.size() elements.
+ * @return Number of characters converted.
+ */
+std::size_t widenAscii(std::span<std::byte const> range, char16_t* out);
+std::size_t widenAsciiSse2(std::span<std::byte const> range, char16_t* out);
+std::size_t widenAsciiAvx2(std::span<std::byte const> range, char16_t* out);
+
+/** Narrows the leading UTF-16 code units of a range that are 7-bit ASCII characters to UTF-8.
+ * Conversion stops at the first code unit that is not a 7-bit ASCII character.
+ * @param[in] range The range to convert.
+ * @param[out] out Receives the converted characters; must have space for range.size() elements.
+ * @return Number of characters converted.
+ */
+std::size_t narrowAscii(std::span<char16_t const> range, char8_t* out);
+std::size_t narrowAsciiSse2(std::span<char16_t const> range, char8_t* out);
+std::size_t narrowAsciiAvx2(std::span<char16_t const> range, char8_t* out);
+
+}
+#endif
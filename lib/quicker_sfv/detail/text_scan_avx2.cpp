@@ -0,0 +1,136 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+ * AVX2 implementations of the text scanning functions.
+ * This file is compiled with AVX2 code generation enabled. The functions in here
+ * must only be called after checking supportsAvx2().
+ */
+#include <quicker_sfv/detail/text_scan.hpp>
+
+#include <immintrin.h>
+
+#include <bit>
+#include <cstdint>
+
+namespace quicker_sfv::text_scan {
+
+std::size_t findNewlineAvx2(std::span<std::byte const> range) {
+    std::byte const* const data = range.data();
+    std::size_t const size = range.size();
+    __m256i const newline = _mm256_set1_epi8('\n');
+    std::size_t i = 0;
+    // two vectors per iteration, as long lines are the common case
+    for (; i + 64 <= size; i += 64) {
+        __m256i const chunk0 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i));
+        __m256i const chunk1 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i + 32));
+        uint64_t const mask0 = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk0, newline)));
+        uint64_t const mask1 = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk1, newline)));
+        uint64_t const mask = mask0 | (mask1 << 32);
+        if (mask != 0) { return i + std::countr_zero(mask); }
+    }
+    for (; i + 32 <= size; i += 32) {
+        __m256i const chunk = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i));
+        uint32_t const mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)));
+        if (mask != 0) { return i + std::countr_zero(mask); }
+    }
+    return i + findNewlineSse2(range.subspan(i));
+}
+
+std::size_t findNonAsciiAvx2(std::span<std::byte const> range) {
+    std::byte const* const data = range.data();
+    std::size_t const size = range.size();
+    std::size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m256i const chunk0 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i));
+        __m256i const chunk1 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i + 32));
+        if (_mm256_movemask_epi8(_mm256_or_si256(chunk0, chunk1)) != 0) {
+            uint64_t const mask0 = static_cast<uint32_t>(_mm256_movemask_epi8(chunk0));
+            uint64_t const mask1 = static_cast<uint32_t>(_mm256_movemask_epi8(chunk1));
+            return i + std::countr_zero(mask0 | (mask1 << 32));
+        }
+    }
+    for (; i + 32 <= size; i += 32) {
+        __m256i const chunk = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i));
+        uint32_t const mask = static_cast<uint32_t>(_mm256_movemask_epi8(chunk));
+        if (mask != 0) { return i + std::countr_zero(mask); }
+    }
+    return i + findNonAsciiSse2(range.subspan(i));
+}
+
+
+std::size_t skipValidUtf8Avx2(std::span<std::byte const> range) {
+    std::byte const* const data = range.data();
+    std::size_t const size = range.size();
+    std::size_t i = 0;
+    while (i + 64 <= size) {
+        __m256i const chunk0 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i));
+        __m256i const chunk1 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i + 32));
+        if (_mm256_movemask_epi8(_mm256_or_si256(chunk0, chunk1)) == 0) {
+            i += 64;
+            continue;
+        }
+        // the most significant bit of each byte after shifting left by `shift`
+        auto const bits = [chunk0, chunk1](int shift) -> uint64_t {
+            __m256i v0 = chunk0;
+            __m256i v1 = chunk1;
+            for (int s = 0; s < shift; ++s) {
+                v0 = _mm256_add_epi8(v0, v0);
+                v1 = _mm256_add_epi8(v1, v1);
+            }
+            return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(v0))) |
+                   (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(v1))) << 32);
+        };
+        std::size_t const valid = Utf8BlockMasks{ .bit7 = bits(0), .bit6 = bits(1), .bit5 = bits(2), .bit4 = bits(3), .bit3 = bits(4) }.validPrefix();
+        if (valid == 0) { break; }
+        i += valid;
+    }
+    return i;
+}
+
+std::size_t widenAsciiAvx2(std::span<std::byte const> range, char16_t* out) {
+    std::byte const* const data = range.data();
+    std::size_t const size = range.size();
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i const chunk = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i));
+        if (_mm256_movemask_epi8(chunk) != 0) { break; }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(chunk)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(chunk, 1)));
+    }
+    return i + widenAsciiSse2(range.subspan(i), out + i);
+}
+
+std::size_t narrowAsciiAvx2(std::span<char16_t const> range, char8_t* out) {
+    char16_t const* const data = range.data();
+    std::size_t const size = range.size();
+    __m256i const non_ascii = _mm256_set1_epi16(static_cast<short>(0xff80));
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i const chunk0 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i));
+        __m256i const chunk1 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i + 16));
+        if (!_mm256_testz_si256(_mm256_or_si256(chunk0, chunk1), non_ascii)) { break; }
+        // packing operates on 128 bit lanes, so the 64 bit quarters have to be reordered
+        __m256i const packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(chunk0, chunk1), 0b11'01'10'00);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+    }
+    return i + narrowAsciiSse2(range.subspan(i), out + i);
+}
+
+}
@@ -35,7 +35,7 @@ Digest::Digest(Digest const& rhs)
 
 Digest& Digest::operator=(Digest const& rhs) {
     if (this != &rhs) {
-        m_digest = rhs.m_digest->clone();
+        m_digest = rhs.m_digest ? rhs.m_digest->clone() : nullptr;
     }
     return *this;
 }
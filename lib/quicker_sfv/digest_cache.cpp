@@ -0,0 +1,100 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/digest_cache.hpp>
+
+#include <quicker_sfv/detail/byte_order.hpp>
+
+#include <algorithm>
+
+namespace quicker_sfv {
+
+namespace {
+constexpr std::byte const DIGEST_CACHE_VERSION{ 1 };
+constexpr std::size_t const DIGEST_CACHE_HEADER_SIZE = 1 + sizeof(uint64_t) + sizeof(uint64_t);
+constexpr std::size_t const DIGEST_CACHE_MAX_DIGEST_SIZE = 256;
+}
+
+std::vector<std::byte> encodeDigestCacheEntry(DigestCacheEntry const& entry) {
+    std::vector<std::byte> ret(DIGEST_CACHE_HEADER_SIZE + entry.digest.size());
+    ret[0] = DIGEST_CACHE_VERSION;
+    byte_order::storeLittleEndian(ret.data() + 1, entry.stamp.size);
+    byte_order::storeLittleEndian(ret.data() + 9, static_cast<uint64_t>(entry.stamp.modification_time));
+    std::transform(entry.digest.begin(), entry.digest.end(), ret.begin() + DIGEST_CACHE_HEADER_SIZE,
+                   [](char8_t c) { return static_cast<std::byte>(c); });
+    return ret;
+}
+
+std::optional<DigestCacheEntry> decodeDigestCacheEntry(std::span<std::byte const> data) {
+    if ((data.size() <= DIGEST_CACHE_HEADER_SIZE) ||
+        (data.size() > DIGEST_CACHE_HEADER_SIZE + DIGEST_CACHE_MAX_DIGEST_SIZE) ||
+        (data[0] != DIGEST_CACHE_VERSION))
+    {
+        return std::nullopt;
+    }
+    DigestCacheEntry ret;
+    ret.stamp.size = byte_order::loadLittleEndian<uint64_t>(data.data() + 1);
+    ret.stamp.modification_time = static_cast<int64_t>(byte_order::loadLittleEndian<uint64_t>(data.data() + 9));
+    ret.digest.reserve(data.size() - DIGEST_CACHE_HEADER_SIZE);
+    for (std::byte b : data.subspan(DIGEST_CACHE_HEADER_SIZE)) {
+        char8_t const c = static_cast<char8_t>(b);
+        // digests are always printable ascii
+        if ((c < 0x20) || (c > 0x7e)) { return std::nullopt; }
+        ret.digest.push_back(c);
+    }
+    return ret;
+}
+
+std::u8string digestCacheAttributeName(ChecksumProvider const& provider) {
+    std::u8string_view ext = provider.fileExtensions();
+    ext = ext.substr(0, ext.find(u8';'));
+    if (ext.starts_with(u8"*.")) { ext.remove_prefix(2); }
+    std::u8string ret = u8"user.quickersfv.";
+    for (char8_t c : ext) {
+        if ((c >= u8'A') && (c <= u8'Z')) {
+            ret.push_back(static_cast<char8_t>(c - u8'A' + u8'a'));
+        } else if (((c >= u8'a') && (c <= u8'z')) || ((c >= u8'0') && (c <= u8'9'))) {
+            ret.push_back(c);
+        }
+    }
+    return ret;
+}
+
+DigestCache::~DigestCache() = default;
+
+std::optional<std::u8string> DigestCache::lookup(std::u8string_view file, std::u8string_view attribute_name,
+                                                 FileStamp const& current_stamp)
+{
+    std::optional<std::vector<std::byte>> const data = readAttribute(file, attribute_name);
+    if (!data) { return std::nullopt; }
+    std::optional<DigestCacheEntry> entry = decodeDigestCacheEntry(*data);
+    if (!entry || (entry->stamp != current_stamp)) { return std::nullopt; }
+    return std::move(entry->digest);
+}
+
+void DigestCache::store(std::u8string_view file, std::u8string_view attribute_name,
+                        FileStamp const& stamp, std::u8string_view digest)
+{
+    if (digest.empty() || (digest.size() > DIGEST_CACHE_MAX_DIGEST_SIZE)) { return; }
+    std::vector<std::byte> const data =
+        encodeDigestCacheEntry(DigestCacheEntry{ .stamp = stamp, .digest = std::u8string(digest) });
+    writeAttribute(file, attribute_name, data);
+}
+
+}
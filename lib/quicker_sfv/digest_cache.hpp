@@ -0,0 +1,114 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_DIGEST_CACHE_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_DIGEST_CACHE_HPP
+
+#include <quicker_sfv/checksum_provider.hpp>
+#include <quicker_sfv/stamp_file.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace quicker_sfv {
+
+/** A digest remembered in the metadata of the file it was computed for.
+ * The entry is only valid as long as the file's current FileStamp is equal to
+ * the stamp recorded in the entry.
+ */
+struct DigestCacheEntry {
+    FileStamp stamp;            ///< Stamp of the file at the time the digest was computed.
+    std::u8string digest;       ///< String representation of the Digest.
+
+    friend bool operator==(DigestCacheEntry const&, DigestCacheEntry const&) = default;
+};
+
+/** Encodes a DigestCacheEntry into its binary attribute representation.
+ * The encoding is a version byte, followed by the size and modification time as
+ * 64 bit little-endian integers, followed by the digest string.
+ */
+[[nodiscard]] std::vector<std::byte> encodeDigestCacheEntry(DigestCacheEntry const& entry);
+
+/** Decodes the binary attribute representation of a DigestCacheEntry.
+ * @return The decoded entry, or an empty optional if the data is not a valid
+ *         encoding. Invalid data is not an error, as attributes may have been
+ *         written by a different version or tampered with.
+ */
+[[nodiscard]] std::optional<DigestCacheEntry> decodeDigestCacheEntry(std::span<std::byte const> data);
+
+/** Name of the attribute used for caching digests produced by a ChecksumProvider.
+ * The name is of the form `user.quickersfv.<ext>`, where `<ext>` is the first file
+ * extension of the provider.
+ */
+[[nodiscard]] std::u8string digestCacheAttributeName(ChecksumProvider const& provider);
+
+/** Cache of digests stored alongside each file in per-file metadata.
+ * This allows skipping the hashing of files whose contents have not changed since
+ * the last time they were hashed, without requiring any central database.
+ * The storage of the attributes is provided by the client through readAttribute()
+ * and writeAttribute(), typically as an extended attribute or alternate data stream
+ * of the file.
+ */
+class DigestCache {
+public:
+    /** Destructor.
+     */
+    virtual ~DigestCache() = 0;
+
+    /** Retrieves the cached digest for a file.
+     * @param[in] file Path of the file.
+     * @param[in] attribute_name Attribute name as returned by digestCacheAttributeName().
+     * @param[in] current_stamp Current FileStamp of the file.
+     * @return The cached digest string if one is stored and its stamp matches
+     *         current_stamp. An empty optional otherwise.
+     */
+    [[nodiscard]] std::optional<std::u8string> lookup(std::u8string_view file, std::u8string_view attribute_name,
+                                                      FileStamp const& current_stamp);
+
+    /** Stores a digest in the cache.
+     * Failure to store the digest is silently ignored.
+     * @param[in] file Path of the file.
+     * @param[in] attribute_name Attribute name as returned by digestCacheAttributeName().
+     * @param[in] stamp FileStamp of the file at the time before hashing started.
+     * @param[in] digest String representation of the computed Digest.
+     */
+    void store(std::u8string_view file, std::u8string_view attribute_name,
+               FileStamp const& stamp, std::u8string_view digest);
+
+    /** Reads a raw attribute from a file.
+     * @return The attribute contents, or an empty optional if the attribute does not
+     *         exist or cannot be read.
+     */
+    [[nodiscard]] virtual std::optional<std::vector<std::byte>> readAttribute(std::u8string_view file,
+                                                                              std::u8string_view attribute_name) = 0;
+    /** Writes a raw attribute to a file, replacing any previous value.
+     * Implementations must not change the modification time of the file.
+     * @return true on success, false if the attribute could not be written.
+     */
+    virtual bool writeAttribute(std::u8string_view file, std::u8string_view attribute_name,
+                                std::span<std::byte const> data) = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,236 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/directory_digests.hpp>
+
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/line_reader.hpp>
+#include <quicker_sfv/string_utilities.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+namespace quicker_sfv {
+
+namespace {
+
+struct DirectoryNode {
+    struct Child {
+        std::u8string name;
+        bool is_directory;
+        std::u8string digest;
+    };
+    std::vector<Child> children;
+};
+
+std::u8string normalizeSeparators(std::u8string_view path) {
+    std::u8string ret{ path };
+    std::ranges::replace(ret, u8'\\', u8'/');
+    return ret;
+}
+
+std::u8string_view parentPath(std::u8string_view path) {
+    std::size_t const separator = path.rfind(u8'/');
+    if (separator == std::u8string_view::npos) { return {}; }
+    return path.substr(0, separator);
+}
+
+std::u8string_view baseName(std::u8string_view path) {
+    std::size_t const separator = path.rfind(u8'/');
+    if (separator == std::u8string_view::npos) { return path; }
+    return path.substr(separator + 1);
+}
+
+void hashBytes(Hasher& hasher, std::u8string_view str) {
+    hasher.addData(std::span<std::byte const>(reinterpret_cast<std::byte const*>(str.data()), str.size()));
+}
+
+void hashChild(Hasher& hasher, DirectoryNode::Child const& c) {
+    hashBytes(hasher, c.is_directory ? u8"d" : u8"f");
+    hashBytes(hasher, c.name);
+    hashBytes(hasher, std::u8string_view{ u8"\0", 1 });
+    hashBytes(hasher, c.digest);
+    hashBytes(hasher, u8"\n");
+}
+
+constexpr std::u8string_view const ROOT_DIRECTORY_NAME = u8".";
+
+/** Maps each directory path to the paths of its direct subdirectories, in sorted order.
+ */
+std::unordered_map<std::u8string_view, std::vector<std::u8string_view>> buildChildIndex(DirectoryDigests const& d) {
+    std::unordered_map<std::u8string_view, std::vector<std::u8string_view>> ret;
+    for (auto const& dir : d.getDirectories()) {
+        if (dir.path.empty()) { continue; }
+        ret[parentPath(dir.path)].push_back(dir.path);
+    }
+    return ret;
+}
+
+} // anonymous namespace
+
+DirectoryDigests DirectoryDigests::fromChecksumFile(ChecksumFile const& f, Hasher& hasher) {
+    std::map<std::u8string, DirectoryNode, std::less<>> nodes;
+    nodes.try_emplace(std::u8string{});
+    for (auto const& e : f.getEntries()) {
+        std::u8string const path = normalizeSeparators(e.display);
+        std::u8string_view const directory = parentPath(path);
+        nodes[std::u8string{ directory }].children.push_back(DirectoryNode::Child{
+            .name = std::u8string{ baseName(path) },
+            .is_directory = false,
+            .digest = e.digest.toString()
+        });
+        for (std::u8string_view d = parentPath(directory); !d.empty(); d = parentPath(d)) {
+            if (!nodes.try_emplace(std::u8string{ d }).second) { break; }
+        }
+    }
+
+    // a parent path is always a prefix of its children's paths and thus sorts before
+    // them; iterating in reverse guarantees all subdirectories are processed before
+    // their parent.
+    DirectoryDigests ret;
+    ret.m_directories.reserve(nodes.size());
+    for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+        auto& [path, node] = *it;
+        std::ranges::sort(node.children, [](DirectoryNode::Child const& lhs, DirectoryNode::Child const& rhs) {
+            return std::tie(lhs.name, lhs.is_directory) < std::tie(rhs.name, rhs.is_directory);
+        });
+        hasher.reset();
+        for (auto const& c : node.children) {
+            if (!c.is_directory) { hashChild(hasher, c); }
+        }
+        Digest files_digest = hasher.finalize();
+        hasher.reset();
+        for (auto const& c : node.children) { hashChild(hasher, c); }
+        Digest digest = hasher.finalize();
+        if (!path.empty()) {
+            nodes.find(parentPath(path))->second.children.push_back(DirectoryNode::Child{
+                .name = std::u8string{ baseName(path) },
+                .is_directory = true,
+                .digest = digest.toString()
+            });
+        }
+        ret.m_directories.push_back(Directory{
+            .path = path,
+            .digest = std::move(digest),
+            .files_digest = std::move(files_digest)
+        });
+    }
+    std::ranges::reverse(ret.m_directories);
+    return ret;
+}
+
+std::span<DirectoryDigests::Directory const> DirectoryDigests::getDirectories() const {
+    return m_directories;
+}
+
+DirectoryDigests::Directory const* DirectoryDigests::getDirectory(std::u8string_view path) const {
+    auto const it = std::ranges::lower_bound(m_directories, path, std::less<>{}, &Directory::path);
+    if ((it == m_directories.end()) || (it->path != path)) { return nullptr; }
+    return &(*it);
+}
+
+DirectoryDigests DirectoryDigests::readFromFile(FileInput& file_input, ChecksumProvider const& provider) {
+    LineReader reader(file_input);
+    DirectoryDigests ret;
+    for (;;) {
+        auto opt_line = reader.readLineView();
+        if (!opt_line) {
+            if (reader.done()) {
+                break;
+            }
+        }
+        std::u8string_view const line{ *opt_line };
+        if (trim(line).empty()) { continue; }
+        // skip comments
+        if (line.starts_with(u8";")) { continue; }
+        std::size_t const digest_end = line.find(u8' ');
+        if (digest_end == std::u8string_view::npos) { throwException(Error::ParserError); }
+        std::size_t const files_digest_end = line.find(u8' ', digest_end + 1);
+        if (files_digest_end == std::u8string_view::npos) { throwException(Error::ParserError); }
+        std::u8string_view const path = line.substr(files_digest_end + 1);
+        if (path.empty()) { throwException(Error::ParserError); }
+        ret.m_directories.push_back(Directory{
+            .path = (path == ROOT_DIRECTORY_NAME) ? std::u8string{} : std::u8string{ path },
+            .digest = provider.digestFromString(line.substr(0, digest_end)),
+            .files_digest = provider.digestFromString(line.substr(digest_end + 1, files_digest_end - digest_end - 1))
+        });
+    }
+    std::ranges::sort(ret.m_directories, std::less<>{}, &Directory::path);
+    if (std::ranges::adjacent_find(ret.m_directories, std::equal_to<>{}, &Directory::path) != ret.m_directories.end()) {
+        throwException(Error::ParserError);
+    }
+    return ret;
+}
+
+void DirectoryDigests::writeToFile(FileOutput& file_output) const {
+    for (auto const& d : m_directories) {
+        std::u8string out_str = d.digest.toString();
+        out_str.push_back(u8' ');
+        out_str.append(d.files_digest.toString());
+        out_str.push_back(u8' ');
+        out_str.append(d.path.empty() ? ROOT_DIRECTORY_NAME : std::u8string_view{ d.path });
+        out_str.push_back(u8'\n');
+        file_output.write(std::span<std::byte const>(reinterpret_cast<std::byte const*>(out_str.data()), out_str.size()));
+    }
+}
+
+std::vector<DirectoryDifference> compareDirectoryDigests(DirectoryDigests const& first,
+                                                         DirectoryDigests const& second)
+{
+    std::vector<DirectoryDifference> ret;
+    auto const children_first = buildChildIndex(first);
+    auto const children_second = buildChildIndex(second);
+    std::vector<std::u8string_view> const no_children;
+    auto const getChildren = [&no_children](auto const& index, std::u8string_view path) -> std::vector<std::u8string_view> const& {
+        auto const it = index.find(path);
+        return (it == index.end()) ? no_children : it->second;
+    };
+
+    std::vector<std::u8string_view> pending;
+    pending.push_back(std::u8string_view{});
+    while (!pending.empty()) {
+        std::u8string_view const path = pending.back();
+        pending.pop_back();
+        DirectoryDigests::Directory const* const d1 = first.getDirectory(path);
+        DirectoryDigests::Directory const* const d2 = second.getDirectory(path);
+        if (!d1 && !d2) { continue; }
+        if (!d2) {
+            ret.push_back(DirectoryDifference{ .path = std::u8string{ path }, .kind = DirectoryDifference::Kind::OnlyInFirst });
+            continue;
+        }
+        if (!d1) {
+            ret.push_back(DirectoryDifference{ .path = std::u8string{ path }, .kind = DirectoryDifference::Kind::OnlyInSecond });
+            continue;
+        }
+        if (d1->digest == d2->digest) { continue; }
+        if (d1->files_digest != d2->files_digest) {
+            ret.push_back(DirectoryDifference{ .path = std::u8string{ path }, .kind = DirectoryDifference::Kind::Modified });
+        }
+        std::ranges::set_union(getChildren(children_first, path), getChildren(children_second, path),
+                               std::back_inserter(pending));
+    }
+    std::ranges::sort(ret, std::less<>{}, &DirectoryDifference::path);
+    return ret;
+}
+
+}
@@ -0,0 +1,141 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_DIRECTORY_DIGESTS_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_DIRECTORY_DIGESTS_HPP
+
+#include <quicker_sfv/checksum_file.hpp>
+#include <quicker_sfv/checksum_provider.hpp>
+#include <quicker_sfv/digest.hpp>
+#include <quicker_sfv/file_io.hpp>
+#include <quicker_sfv/hasher.hpp>
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace quicker_sfv {
+
+/** Per-directory aggregate digests for the entries of a ChecksumFile.
+ * Each directory that contains entries of the ChecksumFile, directly or through one
+ * of its subdirectories, is assigned two digests:
+ *  - The aggregate digest is a hash over the names and digests of all files and
+ *    subdirectories directly contained in the directory, sorted by name. Since the
+ *    digests of subdirectories are themselves aggregates, two directories have the
+ *    same aggregate digest if and only if (barring collisions) their entire subtrees
+ *    are identical.
+ *  - The files digest is a hash over the names and digests of the files directly
+ *    contained in the directory only.
+ *
+ * This allows comparing two checksum files for replicas of the same tree by only
+ * descending into subtrees whose aggregate digests differ.
+ * The aggregate digests are computed with the same Hasher that was used for
+ * computing the digests of the individual files.
+ *
+ * Directories are identified by their path relative to the checksum file, with
+ * path components separated by `/`. Both `/` and `\` are recognized as separators
+ * in the paths of the ChecksumFile entries. The root directory has the empty path.
+ *
+ * DirectoryDigests are stored in a sidecar file next to the checksum file. The
+ * file format is line based, with one line per directory of the form
+ * `<aggregate digest> <files digest> <path>`, where the root directory is written
+ * as `.`. Lines starting with `;` are comments.
+ * File encoding must be UTF-8. Line endings must be either CRLF or LF on read
+ * and will always be LF on write.
+ */
+class DirectoryDigests {
+public:
+    /** Digests for a single directory.
+     */
+    struct Directory {
+        std::u8string path;     ///< Path of the directory relative to the checksum file.
+        Digest digest;          ///< Aggregate digest over all files and subdirectories.
+        Digest files_digest;    ///< Aggregate digest over the files directly contained
+                                ///  in the directory.
+    };
+private:
+    std::vector<Directory> m_directories;       ///< Sorted by path.
+public:
+    /** Computes the DirectoryDigests for a ChecksumFile.
+     * @param[in] f The ChecksumFile.
+     * @param[in] hasher Hasher used for computing the aggregate digests. This must be
+     *                   of the same type as the one used for computing the digests of
+     *                   the ChecksumFile entries. The hasher will be reset before each
+     *                   use and is left in an unspecified state.
+     */
+    [[nodiscard]] static DirectoryDigests fromChecksumFile(ChecksumFile const& f, Hasher& hasher);
+
+    /** Retrieves all directories, sorted by path.
+     */
+    [[nodiscard]] std::span<Directory const> getDirectories() const;
+
+    /** Retrieves the digests for a single directory.
+     * @param[in] path Path of the directory.
+     * @return A pointer to the Directory, or nullptr if no directory of that path exists.
+     */
+    [[nodiscard]] Directory const* getDirectory(std::u8string_view path) const;
+
+    /** Reads DirectoryDigests from file.
+     * @param[in] file_input A FileInput object providing access to the file data.
+     * @param[in] provider The ChecksumProvider for the checksum file that the
+     *                     DirectoryDigests were created for. Used for parsing digests.
+     * @throws Exception Error::ParserError if the file format is invalid.
+     *                   Error::FileIO if an error occurs while reading the file.
+     */
+    [[nodiscard]] static DirectoryDigests readFromFile(FileInput& file_input, ChecksumProvider const& provider);
+
+    /** Writes the DirectoryDigests out to a file.
+     * @param[in] file_output A FileOutput object providing access to the file.
+     * @throws Exception Error::FileIO if an error occurs while writing the file.
+     */
+    void writeToFile(FileOutput& file_output) const;
+};
+
+/** A difference between two sets of DirectoryDigests.
+ */
+struct DirectoryDifference {
+    enum class Kind {
+        Modified,       ///< The files directly contained in the directory differ.
+        OnlyInFirst,    ///< The directory only exists in the first set.
+        OnlyInSecond,   ///< The directory only exists in the second set.
+    };
+    std::u8string path;     ///< Path of the directory.
+    Kind kind;              ///< Kind of difference.
+
+    friend bool operator==(DirectoryDifference const&, DirectoryDifference const&) = default;
+};
+
+/** Compares two sets of DirectoryDigests.
+ * Comparison starts at the root directory and only descends into subdirectories
+ * whose aggregate digests differ. Subdirectories that only exist on one side are
+ * reported once, without reporting any of their own subdirectories.
+ * Directories that exist on both sides are reported as modified if their files
+ * digests differ. Only the entries of the ChecksumFiles in those directories need
+ * to be compared to find all differing files.
+ * @param[in] first The first set of DirectoryDigests.
+ * @param[in] second The second set of DirectoryDigests.
+ * @return All differences, sorted by path. Empty if the two trees are identical.
+ */
+[[nodiscard]] std::vector<DirectoryDifference> compareDirectoryDigests(DirectoryDigests const& first,
+                                                                     DirectoryDigests const& second);
+
+}
+
+#endif
@@ -23,6 +23,16 @@ namespace quicker_sfv {
 
 FileOutput::~FileOutput() = default;
 
+void FileOutput::writeVectored(std::span<std::span<std::byte const> const> buffers) {
+    for (auto const& b : buffers) {
+        write(b);
+    }
+}
+
 FileInput::~FileInput() = default;
 
+std::optional<std::span<std::byte const>> FileInput::mappedContents() noexcept {
+    return std::nullopt;
+}
+
 }
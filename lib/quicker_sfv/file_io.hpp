@@ -23,6 +23,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <optional>
 #include <span>
 #include <string_view>
 
@@ -39,6 +40,13 @@ public:
      * @throws Exception Error::FileIO on error.
      */
     virtual void write(std::span<std::byte const> bytes_to_write) = 0;
+
+    /** Writes several spans of bytes to a file, in order.
+     * Implementations can override this to issue a single gathering write to the
+     * system. The default implementation calls write() once for each span.
+     * @throws Exception Error::FileIO on error.
+     */
+    virtual void writeVectored(std::span<std::span<std::byte const> const> buffers);
 };
 
 /** Interface for file input operations.
@@ -101,6 +109,19 @@ public:
      * @throws Exception Error::FileIO on error.
      */
     virtual uint64_t file_size() = 0;
+
+    /** Retrieves the remaining contents of the current file, if they are mapped into memory.
+     * Implementations that are able to map the file into memory can provide direct
+     * access to its contents here, which allows parsers to skip copying the data
+     * into their own buffers. Accessing the returned data does not move the file
+     * read pointer.
+     * The default implementation returns the empty optional.
+     * @return A view of the file contents from the current position of the file read
+     *         pointer up to the end of file, which remains valid until the next call
+     *         to open() or until the FileInput is destroyed. An empty optional if the
+     *         contents are only available through read().
+     */
+    virtual std::optional<std::span<std::byte const>> mappedContents() noexcept;
 };
 
 }
@@ -0,0 +1,136 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/hash_checkpoint.hpp>
+
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/line_reader.hpp>
+#include <quicker_sfv/string_utilities.hpp>
+
+#include <quicker_sfv/detail/string_conversion.hpp>
+
+#include <charconv>
+#include <system_error>
+
+namespace quicker_sfv {
+
+namespace {
+
+uint64_t parseLength(std::u8string_view str) {
+    char const* const first = reinterpret_cast<char const*>(str.data());
+    char const* const last = first + str.size();
+    uint64_t ret = 0;
+    auto const [ptr, ec] = std::from_chars(first, last, ret);
+    if ((ec != std::errc{}) || (ptr != last)) { throwException(Error::ParserError); }
+    return ret;
+}
+
+std::vector<std::byte> parseHexBytes(std::u8string_view str) {
+    if ((str.size() % 2) != 0) { throwException(Error::ParserError); }
+    std::vector<std::byte> ret;
+    ret.reserve(str.size() / 2);
+    for (std::size_t i = 0; i < str.size(); i += 2) {
+        ret.push_back(string_conversion::hex_str_to_byte(str[i], str[i + 1]));
+    }
+    return ret;
+}
+
+} // anonymous namespace
+
+std::optional<HashCheckpoint> CheckpointFile::getCheckpoint(std::u8string_view path) const {
+    auto const it = m_checkpoints.find(path);
+    if (it == m_checkpoints.end()) { return std::nullopt; }
+    return it->second;
+}
+
+void CheckpointFile::setCheckpoint(std::u8string_view path, HashCheckpoint checkpoint) {
+    if (auto it = m_checkpoints.find(path); it != m_checkpoints.end()) {
+        it->second = std::move(checkpoint);
+    } else {
+        m_checkpoints.emplace(std::u8string{ path }, std::move(checkpoint));
+    }
+}
+
+std::size_t CheckpointFile::size() const {
+    return m_checkpoints.size();
+}
+
+void CheckpointFile::clear() {
+    m_checkpoints.clear();
+}
+
+CheckpointFile CheckpointFile::readFromFile(FileInput& file_input) {
+    LineReader reader(file_input);
+    CheckpointFile ret;
+    for (;;) {
+        auto opt_line = reader.readLineView();
+        if (!opt_line) {
+            if (reader.done()) {
+                break;
+            }
+        }
+        std::u8string_view const line{ *opt_line };
+        if (trim(line).empty()) { continue; }
+        // skip comments
+        if (line.starts_with(u8";")) { continue; }
+        std::size_t const length_end = line.find(u8' ');
+        if (length_end == std::u8string_view::npos) { throwException(Error::ParserError); }
+        std::size_t const guard_end = line.find(u8' ', length_end + 1);
+        if (guard_end == std::u8string_view::npos) { throwException(Error::ParserError); }
+        std::size_t const state_end = line.find(u8' ', guard_end + 1);
+        if (state_end == std::u8string_view::npos) { throwException(Error::ParserError); }
+        std::u8string_view const path = line.substr(state_end + 1);
+        if (path.empty() || (state_end == guard_end + 1)) { throwException(Error::ParserError); }
+        ret.setCheckpoint(path, HashCheckpoint{
+            .covered_length = parseLength(line.substr(0, length_end)),
+            .prefix_guard = parseHexBytes(line.substr(length_end + 1, guard_end - length_end - 1)),
+            .state = parseHexBytes(line.substr(guard_end + 1, state_end - guard_end - 1))
+        });
+    }
+    return ret;
+}
+
+void CheckpointFile::writeToFile(FileOutput& file_output) const {
+    for (auto const& [path, checkpoint] : m_checkpoints) {
+        std::u8string out_str;
+        out_str.reserve(path.size() + (checkpoint.prefix_guard.size() + checkpoint.state.size()) * 2 + 24);
+        char buffer[24];
+        auto const [ptr, ec] = std::to_chars(std::begin(buffer), std::end(buffer), checkpoint.covered_length);
+        if (ec != std::errc{}) { throwException(Error::Failed); }
+        out_str.append(reinterpret_cast<char8_t const*>(std::begin(buffer)), reinterpret_cast<char8_t const*>(ptr));
+        out_str.push_back(u8' ');
+        for (std::byte b : checkpoint.prefix_guard) {
+            auto const n = string_conversion::byte_to_hex_str(b);
+            out_str.push_back(n.higher);
+            out_str.push_back(n.lower);
+        }
+        out_str.push_back(u8' ');
+        for (std::byte b : checkpoint.state) {
+            auto const n = string_conversion::byte_to_hex_str(b);
+            out_str.push_back(n.higher);
+            out_str.push_back(n.lower);
+        }
+        out_str.push_back(u8' ');
+        out_str.append(path);
+        out_str.push_back(u8'\n');
+        file_output.write(std::span<std::byte const>(reinterpret_cast<std::byte const*>(out_str.data()), out_str.size()));
+    }
+}
+
+}
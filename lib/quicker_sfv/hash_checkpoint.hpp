@@ -0,0 +1,104 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_HASH_CHECKPOINT_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_HASH_CHECKPOINT_HPP
+
+#include <quicker_sfv/file_io.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace quicker_sfv {
+
+/** Saved Hasher state for a prefix of a file.
+ * For files that only ever grow by appending, hashing can continue from the
+ * checkpoint by restoring the state with Hasher::restoreState() and adding only
+ * the data beyond covered_length.
+ * The prefix_guard allows detecting files that were replaced or rewritten instead of
+ * appended to, before resuming from a checkpoint that no longer matches their start.
+ */
+struct HashCheckpoint {
+    uint64_t covered_length;            ///< Number of bytes from the start of the file
+                                        ///  included in the state.
+    std::vector<std::byte> prefix_guard;    ///< Opaque value derived from the data right
+                                            ///  before covered_length. Its contents are
+                                            ///  determined by the client.
+    std::vector<std::byte> state;       ///< State as returned by Hasher::saveState().
+
+    friend bool operator==(HashCheckpoint const&, HashCheckpoint const&) = default;
+};
+
+/** Sidecar file storing a HashCheckpoint for each entry of a ChecksumFile.
+ * The file format is line based, with one line per file of the form
+ * `<covered_length> <prefix_guard> <state> <path>`, where prefix_guard and state are
+ * the hexadecimal representations of the respective bytes. Lines starting with `;` are comments.
+ * File encoding must be UTF-8. Line endings must be either CRLF or LF on read
+ * and will always be LF on write.
+ */
+class CheckpointFile {
+private:
+    std::map<std::u8string, HashCheckpoint, std::less<>> m_checkpoints;
+public:
+    /** Retrieves the checkpoint for a file.
+     * @param[in] path Path of the file as it appears in the ChecksumFile.
+     * @return The recorded HashCheckpoint if the file is part of the CheckpointFile.
+     *         An empty optional otherwise.
+     */
+    [[nodiscard]] std::optional<HashCheckpoint> getCheckpoint(std::u8string_view path) const;
+
+    /** Sets the checkpoint for a file.
+     * If the CheckpointFile already contains a checkpoint for the file, it will be replaced.
+     * @param[in] path Path of the file as it appears in the ChecksumFile.
+     * @param[in] checkpoint Checkpoint of the file.
+     */
+    void setCheckpoint(std::u8string_view path, HashCheckpoint checkpoint);
+
+    /** Retrieves the number of files in the CheckpointFile.
+     */
+    [[nodiscard]] std::size_t size() const;
+
+    /** Clears the checkpoint file, leaving it with no entries.
+     */
+    void clear();
+
+    /** Reads a CheckpointFile from file.
+     * @param[in] file_input A FileInput object providing access to the file data.
+     * @throws Exception Error::ParserError if the file format is invalid.
+     *                   Error::FileIO if an error occurs while reading the file.
+     */
+    [[nodiscard]] static CheckpointFile readFromFile(FileInput& file_input);
+
+    /** Writes the CheckpointFile out to a file.
+     * Entries are written in lexicographical order of their paths.
+     * @param[in] file_output A FileOutput object providing access to the file.
+     * @throws Exception Error::FileIO if an error occurs while writing the file.
+     */
+    void writeToFile(FileOutput& file_output) const;
+};
+
+}
+
+#endif
@@ -19,8 +19,22 @@
  */
 #include <quicker_sfv/hasher.hpp>
 
+#include <quicker_sfv/error.hpp>
+
 namespace quicker_sfv {
 
 Hasher::~Hasher() = default;
 
+bool Hasher::supportsSavedState() const noexcept {
+    return false;
+}
+
+std::vector<std::byte> Hasher::saveState() const {
+    throwException(Error::Failed);
+}
+
+void Hasher::restoreState(std::span<std::byte const>) {
+    throwException(Error::Failed);
+}
+
 }
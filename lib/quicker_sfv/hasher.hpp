@@ -25,6 +25,7 @@
 #include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace quicker_sfv {
 
@@ -43,6 +44,10 @@ struct HasherOptions {
  * function. All provided data will be added to the checksum of the Hasher.
  * Once all data for a single file has been provided, finalize() will provide the
  * checksum Digest of the hashed data.
+ *
+ * Hashers may optionally support exporting their intermediate state with saveState()
+ * and continuing from an exported state with restoreState(). This allows hashing of
+ * files that only ever grow by appending to continue from a previously hashed prefix.
  */
 class Hasher {
 public:
@@ -67,6 +72,28 @@ public:
      * @throw Exception Error::HasherFailure If the operation fails.
      */
     virtual void reset() = 0;
+    /** Whether the Hasher supports saveState() and restoreState().
+     * The default implementation returns false.
+     */
+    [[nodiscard]] virtual bool supportsSavedState() const noexcept;
+    /** Exports the intermediate state for all data added since the last reset().
+     * The returned state is an opaque byte sequence that can only be passed to
+     * restoreState() of a Hasher of the same kind. It is suitable for storing in a
+     * file and contains no pointers or padding.
+     * @pre The Hasher is not in its finalized state.
+     * @throw Exception Error::Failed If the Hasher does not support saving its state.
+     *                  The default implementation always throws.
+     */
+    [[nodiscard]] virtual std::vector<std::byte> saveState() const;
+    /** Replaces the current state of the Hasher with a state previously obtained
+     * from saveState(). Subsequent calls to addData() continue from that state, so
+     * that finalize() yields the Digest over the saved prefix and all new data.
+     * @param[in] state A state obtained from saveState().
+     * @throw Exception Error::Failed If the Hasher does not support restoring its state.
+     *                  The default implementation always throws.
+     *                  Error::HasherFailure If the state is not valid for this Hasher.
+     */
+    virtual void restoreState(std::span<std::byte const> state);
 };
 
 }
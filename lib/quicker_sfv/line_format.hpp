@@ -0,0 +1,291 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_LINE_FORMAT_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_LINE_FORMAT_HPP
+
+#include <quicker_sfv/buffered_file_output.hpp>
+#include <quicker_sfv/checksum_file.hpp>
+#include <quicker_sfv/checksum_provider.hpp>
+#include <quicker_sfv/digest.hpp>
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/file_io.hpp>
+#include <quicker_sfv/line_parser.hpp>
+#include <quicker_sfv/string_utilities.hpp>
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <expected>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace quicker_sfv {
+
+/** Position of the digest within a line of a line-based checksum file.
+ */
+enum class DigestPosition {
+    Leading,    ///< The line starts with the digest, followed by the separator and the path.
+    Trailing,   ///< The line starts with the path, followed by the separator and the digest.
+};
+
+/** Policy describing a line-based checksum file format.
+ * A line consists of an optional fixed prefix, the digest and the file path, with
+ * the digest and path being separated by one of a list of separators. Lines
+ * starting with the comment prefix and empty lines are ignored.
+ *
+ * A policy provides the following static members:
+ *  - `Hasher` - The Hasher type, providing static `digestFromString()` and
+ *              `tryDigestFromString()` functions.
+ *  - `digest_position` - The DigestPosition.
+ *  - `digest_width` - The number of characters in the string representation of a digest.
+ *  - `line_prefix` - Text at the start of each line, before the first field.
+ *  - `separators` - Array of accepted separators; the first one is used for writing.
+ *  - `comment_prefix` - Prefix of comment lines; empty if comments are not supported.
+ *  - `size_comments` - If `true`, comments are checked for file sizes with parseSizeComment().
+ *  - `forbidden_path_characters` - Characters that must not occur in paths.
+ *  - `lenient_whitespace` - If `true`, whitespace around the line and the path is
+ *                           ignored and the whitespace of the separator next to the
+ *                           digest may be of any length greater than the one given.
+ */
+template<typename T>
+concept LineFormat = requires(std::u8string_view sv) {
+    { T::Hasher::digestFromString(sv) } -> std::convertible_to<Digest>;
+    { T::Hasher::tryDigestFromString(sv) } -> std::same_as<std::expected<Digest, Error>>;
+    { T::digest_position } -> std::convertible_to<DigestPosition>;
+    { T::digest_width } -> std::convertible_to<std::size_t>;
+    { T::line_prefix } -> std::convertible_to<std::u8string_view>;
+    { T::separators[0] } -> std::convertible_to<std::u8string_view>;
+    { T::comment_prefix } -> std::convertible_to<std::u8string_view>;
+    { T::size_comments } -> std::convertible_to<bool>;
+    { T::forbidden_path_characters } -> std::convertible_to<std::u8string_view>;
+    { T::lenient_whitespace } -> std::convertible_to<bool>;
+} && (std::size(T::separators) > 0);
+
+namespace detail {
+
+inline constexpr std::u8string_view const LINE_FORMAT_WHITESPACE = u8" \t\n\r\f\v";
+
+/** A separator split into its whitespace next to the digest and the remaining marker.
+ */
+struct SeparatorParts {
+    std::u8string_view marker;
+    std::size_t n_whitespace;
+};
+
+constexpr SeparatorParts splitSeparator(std::u8string_view separator, DigestPosition digest_position) {
+    if (digest_position == DigestPosition::Leading) {
+        std::size_t const marker_begin = std::min(separator.find_first_not_of(LINE_FORMAT_WHITESPACE), separator.size());
+        return SeparatorParts{ .marker = separator.substr(marker_begin), .n_whitespace = marker_begin };
+    } else {
+        std::size_t const last = separator.find_last_not_of(LINE_FORMAT_WHITESPACE);
+        std::size_t const marker_end = (last == std::u8string_view::npos) ? 0 : (last + 1);
+        return SeparatorParts{ .marker = separator.substr(0, marker_end), .n_whitespace = separator.size() - marker_end };
+    }
+}
+
+/** Removes the separator from the side of field that faced the digest.
+ * @return The path with the separator removed; The empty optional if field does not
+ *         contain any of the separators of Format.
+ */
+template<LineFormat Format>
+std::optional<std::u8string_view> stripSeparator(std::u8string_view field) {
+    constexpr bool const is_leading = (Format::digest_position == DigestPosition::Leading);
+    constexpr std::array const separator_parts = []() {
+        std::array<SeparatorParts, std::size(Format::separators)> ret;
+        std::ranges::transform(Format::separators, ret.begin(),
+            [](std::u8string_view s) { return splitSeparator(s, Format::digest_position); });
+        return ret;
+    }();
+    for (std::size_t i = 0; i < separator_parts.size(); ++i) {
+        if constexpr (!Format::lenient_whitespace) {
+            std::u8string_view const separator = Format::separators[i];
+            if (is_leading && field.starts_with(separator)) { return field.substr(separator.size()); }
+            if (!is_leading && field.ends_with(separator)) { return field.substr(0, field.size() - separator.size()); }
+        } else {
+            SeparatorParts const& parts = separator_parts[i];
+            if constexpr (is_leading) {
+                std::size_t const n_whitespace = std::min(field.find_first_not_of(LINE_FORMAT_WHITESPACE), field.size());
+                if ((n_whitespace >= parts.n_whitespace) && field.substr(n_whitespace).starts_with(parts.marker)) {
+                    return field.substr(n_whitespace + parts.marker.size());
+                }
+            } else {
+                std::size_t const last = field.find_last_not_of(LINE_FORMAT_WHITESPACE);
+                std::size_t const field_end = (last == std::u8string_view::npos) ? 0 : (last + 1);
+                if ((field.size() - field_end >= parts.n_whitespace) && field.substr(0, field_end).ends_with(parts.marker)) {
+                    return field.substr(0, field_end - parts.marker.size());
+                }
+            }
+        }
+    }
+    return std::nullopt;
+}
+}
+
+/** Parses a single line of a checksum file in the given format without throwing.
+ * Can be used as a LenientLineParserFunction with parseLinesLenient().
+ * @param[in] line The line to be parsed, without linebreak.
+ * @param[in,out] out Receives the entry for the line, if the line is valid and not
+ *                    empty or a comment.
+ * @return Nothing on success; The reason for rejecting the line if it is not valid
+ *         for the format.
+ * @throw Exception Error::Failed if out already contains the maximum number of entries.
+ */
+template<LineFormat Format>
+std::expected<void, LineError> tryParseFormattedLine(std::u8string_view line, ChecksumFile& out) {
+    if constexpr (Format::lenient_whitespace) { line = trim(line); }
+    if (line.empty()) { return {}; }
+    if constexpr (!std::u8string_view(Format::comment_prefix).empty()) {
+        if (line.starts_with(Format::comment_prefix)) {
+            if constexpr (Format::size_comments) {
+                parseSizeComment(line.substr(std::u8string_view(Format::comment_prefix).size()), out);
+            }
+            return {};
+        }
+    }
+    if (!line.starts_with(Format::line_prefix)) { return std::unexpected(LineError::InvalidFormat); }
+    line.remove_prefix(std::u8string_view(Format::line_prefix).size());
+    if (line.size() < Format::digest_width) { return std::unexpected(LineError::InvalidFormat); }
+    std::u8string_view digest;
+    std::optional<std::u8string_view> path;
+    if constexpr (Format::digest_position == DigestPosition::Leading) {
+        digest = line.substr(0, Format::digest_width);
+        path = detail::stripSeparator<Format>(line.substr(Format::digest_width));
+    } else {
+        digest = line.substr(line.size() - Format::digest_width);
+        path = detail::stripSeparator<Format>(line.substr(0, line.size() - Format::digest_width));
+    }
+    if (!path) { return std::unexpected(LineError::InvalidFormat); }
+    if constexpr (Format::lenient_whitespace) { path = trim(*path); }
+    if (path->empty()) { return std::unexpected(LineError::MissingPath); }
+    if constexpr (!std::u8string_view(Format::forbidden_path_characters).empty()) {
+        if (path->find_first_of(Format::forbidden_path_characters) != std::u8string_view::npos) {
+            return std::unexpected(LineError::InvalidPath);
+        }
+    }
+    std::expected<Digest, Error> parsed_digest = Format::Hasher::tryDigestFromString(digest);
+    if (!parsed_digest) { return std::unexpected(LineError::InvalidDigest); }
+    out.addEntry(*path, std::move(*parsed_digest));
+    return {};
+}
+
+/** Parses a single line of a checksum file in the given format.
+ * Can be used as a LineParserFunction with parseLines() and parseLinesParallel().
+ * @param[in] line The line to be parsed, without linebreak.
+ * @param[in,out] out Receives the entry for the line, if the line is not empty or a comment.
+ * @throw Exception Error::ParserError if the line is not valid for the format.
+ */
+template<LineFormat Format>
+void parseFormattedLine(std::u8string_view line, ChecksumFile& out) {
+    if (!tryParseFormattedLine<Format>(line, out)) { throwException(Error::ParserError); }
+}
+
+/** Writes all entries of a ChecksumFile in the given format.
+ * Lines are terminated by LF and formatted directly into a BufferedFileOutput.
+ * @throw Exception Error::FileIO if an error occurs while writing.
+ */
+template<LineFormat Format>
+void writeFormattedLines(FileOutput& file_output, ChecksumFile const& f) {
+    constexpr std::u8string_view const prefix = Format::line_prefix;
+    constexpr std::u8string_view const separator = Format::separators[0];
+    BufferedFileOutput out(file_output);
+    for (auto const& e : f.getEntries()) {
+        std::u8string_view const path = e.data.front().path;
+        std::u8string const digest = e.digest.toString();
+        std::u8string_view const first = (Format::digest_position == DigestPosition::Leading) ? digest : path;
+        std::u8string_view const second = (Format::digest_position == DigestPosition::Leading) ? path : digest;
+        std::size_t const line_size = prefix.size() + first.size() + separator.size() + second.size() + 1;
+        char8_t* it = reinterpret_cast<char8_t*>(out.reserve(line_size).data());
+        it = std::ranges::copy(prefix, it).out;
+        it = std::ranges::copy(first, it).out;
+        it = std::ranges::copy(separator, it).out;
+        it = std::ranges::copy(second, it).out;
+        *it = u8'\n';
+        out.commit(line_size);
+    }
+    out.flush();
+}
+
+/** ChecksumProvider for a line-based format described by a LineFormat policy.
+ * In addition to the LineFormat requirements, the policy provides the static
+ * members `file_extensions` and `file_description`.
+ */
+template<LineFormat Format>
+class LineFormatProvider : public ChecksumProvider {
+public:
+    ~LineFormatProvider() override = default;
+
+    [[nodiscard]] ProviderCapabilities getCapabilities() const noexcept override {
+        return ProviderCapabilities::Full;
+    }
+
+    [[nodiscard]] std::u8string_view fileExtensions() const noexcept override {
+        return Format::file_extensions;
+    }
+
+    [[nodiscard]] std::u8string_view fileDescription() const noexcept override {
+        return Format::file_description;
+    }
+
+    [[nodiscard]] HasherPtr createHasher(HasherOptions const& hasher_options) const override {
+        using Hasher = typename Format::Hasher;
+        if constexpr (std::is_constructible_v<Hasher, HasherOptions const&>) {
+            return std::make_unique<Hasher>(hasher_options);
+        } else {
+            return std::make_unique<Hasher>();
+        }
+    }
+
+    [[nodiscard]] Digest digestFromString(std::u8string_view str) const override {
+        return Format::Hasher::digestFromString(str);
+    }
+
+    [[nodiscard]] ChecksumFile readFromFile(FileInput& file_input) const override {
+        return parseLines(file_input, parseFormattedLine<Format>);
+    }
+
+    [[nodiscard]] ChecksumFile readFromFileParallel(FileInput& file_input,
+                                                    ParallelParseOptions const& options) const override
+    {
+        return parseLinesParallel(file_input, parseFormattedLine<Format>, options);
+    }
+
+    [[nodiscard]] std::expected<ChecksumFile, LineDiagnostic> tryReadFromFileParallel(FileInput& file_input,
+                                                                                      ParallelParseOptions const& options) const override
+    {
+        return tryParseLinesParallel(file_input, tryParseFormattedLine<Format>, options);
+    }
+
+    [[nodiscard]] LenientParseResult readFromFileLenient(FileInput& file_input) const override {
+        return parseLinesLenient(file_input, tryParseFormattedLine<Format>);
+    }
+
+    void writeNewFile(FileOutput& file_output, ChecksumFile const& f) const override {
+        writeFormattedLines<Format>(file_output, f);
+    }
+};
+
+}
+#endif
@@ -0,0 +1,270 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/line_parser.hpp>
+
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/line_reader.hpp>
+#include <quicker_sfv/string_utilities.hpp>
+#include <quicker_sfv/detail/text_scan.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace quicker_sfv {
+
+namespace {
+
+/// Size of a single read when loading the file into memory.
+constexpr std::size_t const LOAD_READ_SIZE = 16 << 20;
+
+std::vector<std::byte> readEntireFile(FileInput& file_input) {
+    std::vector<std::byte> ret;
+    ret.reserve(static_cast<std::size_t>(file_input.file_size()));
+    for (;;) {
+        std::size_t const offset = ret.size();
+        ret.resize(offset + LOAD_READ_SIZE);
+        std::size_t const bytes_read = file_input.read(std::span<std::byte>(ret).subspan(offset));
+        if (bytes_read == FileInput::RESULT_END_OF_FILE) {
+            ret.resize(offset);
+            break;
+        }
+        ret.resize(offset + bytes_read);
+        if (bytes_read < LOAD_READ_SIZE) { break; }
+    }
+    return ret;
+}
+
+/** Splits contents into chunks of at least min_chunk_size bytes that end after a linebreak.
+ * @return The start offset of each chunk, followed by contents.size().
+ */
+std::vector<std::size_t> splitChunks(std::span<std::byte const> contents, std::size_t n_chunks) {
+    std::size_t const target_size = contents.size() / n_chunks;
+    std::vector<std::size_t> ret{ 0 };
+    while (ret.back() + target_size < contents.size()) {
+        std::size_t const search_start = ret.back() + target_size;
+        std::size_t const newline_index = text_scan::findNewline(contents.subspan(search_start));
+        if (newline_index == contents.size() - search_start) { break; }
+        ret.push_back(search_start + newline_index + 1);
+    }
+    ret.push_back(contents.size());
+    return ret;
+}
+
+/** Result of parsing a single chunk.
+ */
+struct ChunkResult {
+    ChecksumFile entries;
+    uint64_t line_count = 0;                ///< Number of lines parsed from the chunk.
+    std::optional<LineDiagnostic> failure;  ///< First rejected line, numbered from the start of the chunk.
+    std::exception_ptr error;
+};
+
+/** Parses all lines of a chunk, stopping at the first rejected line.
+ * Lines are split and validated in the same way as by LineReader.
+ * @param[in] is_last_chunk The final line of the file does not end on a linebreak.
+ * @param[in] parse_line Callable with the signature of a LenientLineParserFunction.
+ */
+template<typename ParseLine>
+void parseChunk(std::span<std::byte const> chunk, bool is_last_chunk, ParseLine const& parse_line, ChunkResult& out) {
+    for (;;) {
+        std::size_t const newline_index = text_scan::findNewline(chunk);
+        bool const has_newline = (newline_index != chunk.size());
+        if (!has_newline && !is_last_chunk) { break; }
+        std::span<std::byte const> line_range = chunk.subspan(0, newline_index);
+        if (!line_range.empty() && (line_range.back() == std::byte{ '\r' })) {
+            line_range = line_range.subspan(0, line_range.size() - 1);
+        }
+        ++out.line_count;
+        std::expected<void, LineError> const res = checkValidUtf8(line_range) ?
+            parse_line(std::u8string_view(reinterpret_cast<char8_t const*>(line_range.data()), line_range.size()),
+                       out.entries) :
+            std::unexpected(LineError::InvalidUtf8);
+        if (!res) {
+            out.failure = LineDiagnostic{ .line_number = out.line_count, .error = res.error() };
+            return;
+        }
+        if (!has_newline) { break; }
+        chunk = chunk.subspan(newline_index + 1);
+    }
+}
+
+/** Parses a file in chunks on multiple threads, stopping at the first rejected line.
+ * Exceptions raised while parsing a chunk are rethrown, unless an earlier chunk
+ * contains a rejected line.
+ * @return The entries of all chunks; or the diagnostic for the first rejected line
+ *         in file order, with its absolute line number.
+ */
+template<typename ParseLine>
+std::expected<ChecksumFile, LineDiagnostic> parseChunksParallel(FileInput& file_input, ParseLine const& parse_line,
+                                                                ParallelParseOptions const& options)
+{
+    // mapped files are parsed in place
+    std::optional<std::span<std::byte const>> const mapped = file_input.mappedContents();
+    std::vector<std::byte> const loaded = mapped ? std::vector<std::byte>{} : readEntireFile(file_input);
+    std::span<std::byte const> const contents = mapped ? *mapped : std::span<std::byte const>(loaded);
+    std::size_t const min_chunk_size = std::max<std::size_t>(options.min_chunk_size, 1);
+    // several chunks per thread, so that threads finishing early can pick up more work
+    std::size_t const n_chunks = std::clamp<std::size_t>(contents.size() / min_chunk_size,
+                                                         1, std::max<std::size_t>(options.n_threads, 1) * 4);
+    std::vector<std::size_t> const chunk_offsets = splitChunks(contents, n_chunks);
+    std::size_t const chunk_count = chunk_offsets.size() - 1;
+
+    std::vector<ChunkResult> results(chunk_count);
+    std::atomic<std::size_t> next_chunk = 0;
+    std::atomic<std::size_t> first_failed_chunk = std::numeric_limits<std::size_t>::max();
+    auto const worker = [&]() {
+        for (;;) {
+            std::size_t const chunk_index = next_chunk.fetch_add(1);
+            if (chunk_index >= chunk_count) { return; }
+            // errors in later chunks are never reported
+            if (chunk_index > first_failed_chunk.load()) { continue; }
+            ChunkResult& r = results[chunk_index];
+            try {
+                std::span<std::byte const> const chunk = contents.subspan(
+                    chunk_offsets[chunk_index], chunk_offsets[chunk_index + 1] - chunk_offsets[chunk_index]);
+                parseChunk(chunk, (chunk_index == chunk_count - 1), parse_line, r);
+            } catch (...) {
+                r.error = std::current_exception();
+            }
+            if (r.failure || r.error) {
+                std::size_t expected = first_failed_chunk.load();
+                while ((chunk_index < expected) && !first_failed_chunk.compare_exchange_weak(expected, chunk_index)) {}
+            }
+        }
+    };
+    {
+        std::size_t const n_threads = std::min<std::size_t>(std::max<uint32_t>(options.n_threads, 1), chunk_count);
+        std::vector<std::jthread> threads;
+        threads.reserve(n_threads - 1);
+        for (std::size_t i = 1; i < n_threads; ++i) { threads.emplace_back(worker); }
+        worker();
+    }
+
+    // chunks before the first failed one are always parsed in full, so their line counts
+    // give the absolute number of the first line of each chunk
+    ChecksumFile ret;
+    uint64_t chunk_start_line = 0;
+    for (auto& r : results) {
+        if (r.error) { std::rethrow_exception(r.error); }
+        if (r.failure) {
+            return std::unexpected(LineDiagnostic{ .line_number = chunk_start_line + r.failure->line_number,
+                                                   .error = r.failure->error });
+        }
+        ret.append(std::move(r.entries));
+        chunk_start_line += r.line_count;
+    }
+    ret.resolveExpectedSizes();
+    return ret;
+}
+
+} // anonymous namespace
+
+ChecksumFile parseLines(FileInput& file_input, LineParserFunction parse_line) {
+    LineReader reader(file_input);
+    ChecksumFile ret;
+    for (;;) {
+        auto opt_line = reader.readLineView();
+        if (!opt_line) {
+            if (reader.done()) {
+                break;
+            }
+        }
+        parse_line(*opt_line, ret);
+    }
+    ret.resolveExpectedSizes();
+    return ret;
+}
+
+LenientParseResult parseLinesLenient(FileInput& file_input, LenientLineParserFunction parse_line) {
+    LineReader reader(file_input);
+    LenientParseResult ret;
+    for (uint64_t line_number = 1; ; ++line_number) {
+        std::optional<std::span<std::byte const>> const opt_line = reader.readLineBytes();
+        if (!opt_line) { break; }
+        if (!checkValidUtf8(*opt_line)) {
+            ret.diagnostics.push_back(LineDiagnostic{ .line_number = line_number, .error = LineError::InvalidUtf8 });
+            continue;
+        }
+        std::u8string_view const line(reinterpret_cast<char8_t const*>(opt_line->data()), opt_line->size());
+        if (std::expected<void, LineError> const res = parse_line(line, ret.checksum_file); !res) {
+            ret.diagnostics.push_back(LineDiagnostic{ .line_number = line_number, .error = res.error() });
+        }
+    }
+    ret.checksum_file.resolveExpectedSizes();
+    return ret;
+}
+
+ChecksumFile parseLinesParallel(FileInput& file_input, LineParserFunction parse_line,
+                                ParallelParseOptions const& options)
+{
+    auto const parse_line_or_throw = [parse_line](std::u8string_view line,
+                                                  ChecksumFile& out) -> std::expected<void, LineError> {
+        parse_line(line, out);
+        return {};
+    };
+    std::expected<ChecksumFile, LineDiagnostic> ret = parseChunksParallel(file_input, parse_line_or_throw, options);
+    // only invalid UTF-8 is reported as a diagnostic; parse_line throws on its own
+    if (!ret) { throwException(Error::ParserError); }
+    return std::move(*ret);
+}
+
+std::expected<ChecksumFile, LineDiagnostic> tryParseLinesParallel(FileInput& file_input,
+                                                                  LenientLineParserFunction parse_line,
+                                                                  ParallelParseOptions const& options)
+{
+    return parseChunksParallel(file_input, parse_line, options);
+}
+
+bool parseSizeComment(std::u8string_view comment, ChecksumFile& out) {
+    constexpr std::u8string_view const blanks = u8" \t";
+    auto const next_token = [&comment, blanks]() -> std::u8string_view {
+        comment.remove_prefix(std::min(comment.find_first_not_of(blanks), comment.size()));
+        std::size_t const token_end = std::min(comment.find_first_of(blanks), comment.size());
+        std::u8string_view const ret = comment.substr(0, token_end);
+        comment.remove_prefix(token_end);
+        return ret;
+    };
+    auto const is_digit = [](char8_t c) { return (c >= u8'0') && (c <= u8'9'); };
+    std::u8string_view const size_token = next_token();
+    // 18 digits always fit into an int64_t
+    if (size_token.empty() || (size_token.size() > 18) || !std::ranges::all_of(size_token, is_digit)) { return false; }
+    // date and time, in either order and with any of the common delimiters
+    for (int i = 0; i < 2; ++i) {
+        std::u8string_view const token = next_token();
+        if (!std::ranges::any_of(token, is_digit) ||
+            !std::ranges::all_of(token, [is_digit](char8_t c) { return is_digit(c) || (std::u8string_view(u8":.-/").find(c) != std::u8string_view::npos); }))
+        {
+            return false;
+        }
+    }
+    std::u8string_view const path = trim(comment);
+    if (path.empty()) { return false; }
+    int64_t size = 0;
+    for (char8_t const c : size_token) { size = (size * 10) + (c - u8'0'); }
+    out.addExpectedSize(path, size);
+    return true;
+}
+
+}
@@ -0,0 +1,108 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_LINE_PARSER_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_LINE_PARSER_HPP
+
+#include <quicker_sfv/checksum_file.hpp>
+#include <quicker_sfv/checksum_provider.hpp>
+#include <quicker_sfv/file_io.hpp>
+
+#include <expected>
+#include <string_view>
+
+namespace quicker_sfv {
+
+/** Parses a single line of a line-based checksum file format.
+ * Appends the entry for the line, if any, to out.
+ * Must not depend on any state other than its arguments, as it may be invoked
+ * concurrently for lines from different parts of the file.
+ * @throw Exception Error::ParserError if the line is invalid.
+ */
+using LineParserFunction = void(*)(std::u8string_view line, ChecksumFile& out);
+
+/** Parses a single line of a line-based checksum file format without throwing on invalid lines.
+ * Appends the entry for the line, if any, to out.
+ * @return Nothing on success, or if the line does not contain an entry;
+ *         The reason for rejecting the line otherwise.
+ */
+using LenientLineParserFunction = std::expected<void, LineError>(*)(std::u8string_view line, ChecksumFile& out);
+
+/** Parses a text file line by line using a LineReader.
+ * @param[in] file_input The file to be parsed.
+ * @param[in] parse_line Function for parsing a single line.
+ * @throw Exception Error::FileIO if an error occurs while reading the file.
+ *                  Error::ParserError if the file contains invalid UTF-8 or if
+ *                  parse_line fails.
+ */
+[[nodiscard]] ChecksumFile parseLines(FileInput& file_input, LineParserFunction parse_line);
+
+/** Parses a text file line by line on multiple threads.
+ * The entire file is read into memory, unless it is already available through
+ * FileInput::mappedContents(), and split into chunks that end on a linebreak.
+ * Chunks are parsed independently and their entries concatenated in file order.
+ * The result, including the raised error, is the same as that of parseLines().
+ * If several chunks contain errors, the error from the first of them in file order
+ * is raised.
+ * @param[in] file_input The file to be parsed.
+ * @param[in] parse_line Function for parsing a single line.
+ * @param[in] options Options for parallel parsing.
+ * @throw Exception As for parseLines().
+ */
+[[nodiscard]] ChecksumFile parseLinesParallel(FileInput& file_input, LineParserFunction parse_line,
+                                              ParallelParseOptions const& options);
+
+/** Parses a text file line by line on multiple threads, stopping at the first invalid line.
+ * Works like parseLinesParallel(), but instead of raising an error for an invalid
+ * line, the diagnostic for the first line in file order that is not valid UTF-8 or
+ * that is rejected by parse_line is returned.
+ * @param[in] file_input The file to be parsed.
+ * @param[in] parse_line Function for parsing a single line.
+ * @param[in] options Options for parallel parsing.
+ * @return The parsed file; or the diagnostic for the first invalid line, with its
+ *         line number counted from the start of the file.
+ * @throw Exception Error::FileIO if an error occurs while reading the file.
+ */
+[[nodiscard]] std::expected<ChecksumFile, LineDiagnostic> tryParseLinesParallel(FileInput& file_input,
+                                                                                LenientLineParserFunction parse_line,
+                                                                                ParallelParseOptions const& options);
+
+/** Parses a text file line by line, skipping invalid lines.
+ * Lines that are not valid UTF-8 or that are rejected by parse_line are skipped
+ * and reported in the diagnostics of the result.
+ * @param[in] file_input The file to be parsed.
+ * @param[in] parse_line Function for parsing a single line.
+ * @throw Exception Error::FileIO if an error occurs while reading the file.
+ */
+[[nodiscard]] LenientParseResult parseLinesLenient(FileInput& file_input, LenientLineParserFunction parse_line);
+
+/** Parses a file size from a comment line.
+ * Many tools for creating sfv files write a comment of the form
+ * `; <size> <time> <date> <path>` for each file before listing the checksums.
+ * The size is recorded with ChecksumFile::addExpectedSize() and is assigned to the
+ * entry for the path once parsing finishes. All of the parseLines functions take
+ * care of this.
+ * @param[in] comment Text of the comment line following the comment prefix.
+ * @param[in,out] out Receives the expected size, if comment is a size comment.
+ * @return true if comment was a size comment.
+ */
+bool parseSizeComment(std::u8string_view comment, ChecksumFile& out);
+
+}
+#endif
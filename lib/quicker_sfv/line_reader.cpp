@@ -21,98 +21,146 @@
 
 #include <quicker_sfv/error.hpp>
 #include <quicker_sfv/string_utilities.hpp>
+#include <quicker_sfv/detail/text_scan.hpp>
 
 #include <algorithm>
 #include <cassert>
+#include <span>
 
 namespace quicker_sfv {
 
 LineReader::LineReader(quicker_sfv::FileInput& file_input) noexcept
-    :m_fileIn(&file_input), m_bufferOffset(0), m_fileOffset(0), m_eof(false),
-    m_buffers{ .front = std::vector<std::byte>(READ_BUFFER_SIZE), .back = std::vector<std::byte>(READ_BUFFER_SIZE) }
+    :m_fileIn(&file_input), m_mapped(file_input.mappedContents()), m_buffer(m_mapped ? 0 : 2 * READ_BUFFER_SIZE), m_lineBegin(0), m_nextLineBegin(0), m_bufferEnd(0),
+     m_bufferFileOffset(0), m_fileOffset(0), m_utf8Validator(), m_uncheckedEnd(0), m_eof(false), m_done(false)
 {
 }
 
-bool LineReader::read_more() {
-    assert(!m_eof && (m_bufferOffset >= READ_BUFFER_SIZE));
-    m_bufferOffset -= READ_BUFFER_SIZE;
-    std::swap(m_buffers.front, m_buffers.back);
-    size_t const bytes_read = m_fileIn->read(m_buffers.back);
+void LineReader::readChunk() {
+    assert(!m_eof);
+    if (m_bufferEnd + READ_BUFFER_SIZE > m_buffer.size()) {
+        // drop everything before the current line before growing the buffer
+        if (m_lineBegin > 0) {
+            std::copy(begin(m_buffer) + m_lineBegin, begin(m_buffer) + m_bufferEnd, begin(m_buffer));
+            m_bufferFileOffset += m_lineBegin;
+            m_bufferEnd -= m_lineBegin;
+            m_nextLineBegin -= m_lineBegin;
+            m_lineBegin = 0;
+        }
+        if (m_bufferEnd + READ_BUFFER_SIZE > m_buffer.size()) {
+            m_buffer.resize(m_bufferEnd + READ_BUFFER_SIZE);
+        }
+    }
+    size_t const bytes_read = m_fileIn->read(std::span<std::byte>(m_buffer).subspan(m_bufferEnd, READ_BUFFER_SIZE));
     if (bytes_read == quicker_sfv::FileInput::RESULT_END_OF_FILE) {
         m_eof = true;
-        m_buffers.back.resize(0);
-        return true;
+        m_utf8Validator.finish();
+        return;
     }
+    m_utf8Validator.addData(std::span<std::byte const>(m_buffer).subspan(m_bufferEnd, bytes_read));
+    m_bufferEnd += bytes_read;
     m_fileOffset += bytes_read;
     if (bytes_read < READ_BUFFER_SIZE) {
-        m_buffers.back.resize(bytes_read);
         m_eof = true;
+        m_utf8Validator.finish();
+    }
+}
+
+void LineReader::fillReadAhead() {
+    // keep the read containing the start of the next line and the one after it buffered
+    uint64_t const next_line_offset = m_bufferFileOffset + m_nextLineBegin;
+    uint64_t const read_ahead_end = ((next_line_offset / READ_BUFFER_SIZE) + 2) * READ_BUFFER_SIZE;
+    while (!m_eof && (m_fileOffset < read_ahead_end)) {
+        readChunk();
     }
-    return true;
 }
 
-// return conditions: file i/o error, eof, invalid file, invalid utf8, line, empty line
 std::optional<std::u8string> LineReader::readLine() {
+    std::optional<std::u8string_view> const opt_line = readLineView();
+    if (!opt_line) { return std::nullopt; }
+    return std::u8string(*opt_line);
+}
+
+// return conditions: file i/o error, eof, invalid utf8, line, empty line
+std::optional<std::u8string_view> LineReader::readLineView() {
     if (done()) { return std::nullopt; }
-    if (m_fileOffset == 0) {
-        // initial read
-        m_bufferOffset += READ_BUFFER_SIZE;
-        read_more();
-        if (!m_eof) {
-            m_bufferOffset += READ_BUFFER_SIZE;
-            read_more();
-        } else {
-            std::swap(m_buffers.front, m_buffers.back);
-            m_buffers.back.clear();
-        }
-    }
-    constexpr std::byte const newline = static_cast<std::byte>('\n');
-    constexpr std::byte const carriage_return = static_cast<std::byte>('\r');
-    auto it_begin = begin(m_buffers.front) + m_bufferOffset;
-    auto it = std::find(it_begin, end(m_buffers.front), newline);
-    if (it == end(m_buffers.front)) {
-        // read spans buffers
-        it = std::find(begin(m_buffers.back), end(m_buffers.back), newline);
-        if ((it == end(m_buffers.back)) && (!m_eof)) {
-            // no newline in either buffer; assume invalid file
+    std::span<std::byte const> const line_range = nextLine();
+    if (std::optional<uint64_t> const invalid_offset = m_utf8Validator.firstInvalidOffset();
+        invalid_offset && (*invalid_offset < nextLineOffset()))
+    {
+        // the stream validator stops at the first error; if that was in a line returned
+        // by readLineBytes(), the lines after it have to be validated individually
+        if ((*invalid_offset >= m_uncheckedEnd) || !checkValidUtf8(line_range)) {
             throwException(Error::ParserError);
         }
-        std::span<std::byte> front_range(it_begin, end(m_buffers.front));
-        std::span<std::byte> back_range(begin(m_buffers.back), it);
-        std::vector<std::byte> buffer;
-        buffer.reserve(front_range.size() + back_range.size());
-        buffer.insert(end(buffer), begin(front_range), end(front_range));
-        buffer.insert(end(buffer), begin(back_range), end(back_range));
-        m_bufferOffset += buffer.size() + 1;
-        if (!m_eof) {
-            read_more();
-        } else if (!m_buffers.back.empty()) {
-            std::swap(m_buffers.front, m_buffers.back);
-            m_buffers.back.clear();
-            m_bufferOffset -= READ_BUFFER_SIZE;
-        }
-        if (!buffer.empty() && (buffer.back() == carriage_return)) {
-            buffer.pop_back();
-        }
-        if (!quicker_sfv::checkValidUtf8(buffer)) {
-            throwException(Error::ParserError);
+    }
+    return std::u8string_view(reinterpret_cast<char8_t const*>(line_range.data()), line_range.size());
+}
+
+std::optional<std::span<std::byte const>> LineReader::readLineBytes() {
+    if (done()) { return std::nullopt; }
+    std::span<std::byte const> const line_range = nextLine();
+    m_uncheckedEnd = nextLineOffset();
+    return line_range;
+}
+
+std::span<std::byte const> LineReader::nextLine() {
+    std::span<std::byte const> line_range = m_mapped ? nextMappedLine() : nextBufferedLine();
+    if (!line_range.empty() && (line_range.back() == static_cast<std::byte>('\r'))) {
+        line_range = line_range.subspan(0, line_range.size() - 1);
+    }
+    return line_range;
+}
+
+uint64_t LineReader::nextLineOffset() const {
+    return (m_mapped ? 0 : m_bufferFileOffset) + m_nextLineBegin;
+}
+
+std::span<std::byte const> LineReader::nextBufferedLine() {
+    m_lineBegin = m_nextLineBegin;
+    fillReadAhead();
+    size_t line_size = 0;
+    size_t bytes_scanned = 0;
+    for (;;) {
+        std::span<std::byte const> const unscanned =
+            std::span<std::byte const>(m_buffer).subspan(m_lineBegin + bytes_scanned, m_bufferEnd - m_lineBegin - bytes_scanned);
+        if (size_t const newline_index = text_scan::findNewline(unscanned); newline_index != unscanned.size()) {
+            line_size = bytes_scanned + newline_index;
+            m_nextLineBegin = m_lineBegin + line_size + 1;
+            break;
+        } else if (m_eof) {
+            // last line is terminated by the end of file
+            line_size = m_bufferEnd - m_lineBegin;
+            m_nextLineBegin = m_bufferEnd;
+            m_done = true;
+            break;
         }
-        return std::u8string(reinterpret_cast<char8_t const*>(buffer.data()), reinterpret_cast<char8_t const*>(buffer.data() + buffer.size()));
+        bytes_scanned = m_bufferEnd - m_lineBegin;
+        readChunk();
+    }
+    // may move the current line within the buffer, so the span is only formed afterwards
+    fillReadAhead();
+    return std::span<std::byte const>(m_buffer.data() + m_lineBegin, line_size);
+}
+
+std::span<std::byte const> LineReader::nextMappedLine() {
+    // offsets index into the mapped contents; the buffer is unused
+    m_lineBegin = m_nextLineBegin;
+    std::span<std::byte const> const remaining = m_mapped->subspan(m_lineBegin);
+    size_t const line_size = text_scan::findNewline(remaining);
+    if (line_size != remaining.size()) {
+        m_nextLineBegin = m_lineBegin + line_size + 1;
     } else {
-        // line is fully contained within front buffer
-        m_bufferOffset += std::distance(it_begin, it) + 1;
-        std::span<std::byte> line_range{ it_begin, it };
-        if (!line_range.empty() && (line_range.back() == carriage_return)) { line_range = line_range.subspan(0, line_range.size() - 1); }
-        if (!quicker_sfv::checkValidUtf8(line_range)) {
-            throwException(Error::ParserError);
-        }
-        return std::u8string(reinterpret_cast<char8_t const*>(line_range.data()),
-            reinterpret_cast<char8_t const*>(line_range.data() + line_range.size()));
+        m_nextLineBegin = m_mapped->size();
+        m_done = true;
     }
+    // validate lazily, so that errors are attributed to the same line as for buffered reads
+    m_utf8Validator.addData(m_mapped->subspan(m_lineBegin, m_nextLineBegin - m_lineBegin));
+    if (m_done) { m_utf8Validator.finish(); }
+    return remaining.subspan(0, line_size);
 }
 
 bool LineReader::done() const {
-    return m_eof && m_buffers.back.empty() && (m_bufferOffset == m_buffers.front.size() + 1);
+    return m_done;
 }
 
 }
@@ -21,33 +21,42 @@
 #define INCLUDE_GUARD_QUICKER_SFV_LINE_READER_HPP
 
 #include <quicker_sfv/file_io.hpp>
+#include <quicker_sfv/string_utilities.hpp>
 
+#include <cstdint>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace quicker_sfv {
 
 /** Helper class for processing input from text files line by line.
  * This class provides both file read buffering and line splitting facilities.
+ * If the FileInput provides its contents through FileInput::mappedContents(),
+ * lines are split directly from the mapped data and no reads are performed.
  */
 class LineReader {
 public:
-    /** Size of the internal read buffer in bytes.
-     * The class will allocate two buffers of size READ_BUFFER_SIZE to buffer data
-     * from file reads. If a single line exceeds the line length of READ_BUFFER_SIZE
-     * bytes, parsing the file might fail.
+    /** Size of a single read from the file in bytes.
+     * The class keeps at least one read of READ_BUFFER_SIZE bytes buffered ahead
+     * of the current line. The buffer grows as needed to hold lines of any length.
      */
     static constexpr size_t const READ_BUFFER_SIZE = 64 << 10;
 private:
     quicker_sfv::FileInput* m_fileIn;
-    size_t m_bufferOffset;
-    size_t m_fileOffset;
+    std::optional<std::span<std::byte const>> m_mapped;     ///< Mapped file contents, if available.
+    std::vector<std::byte> m_buffer;
+    size_t m_lineBegin;             ///< Buffer offset of the line returned last.
+    size_t m_nextLineBegin;         ///< Buffer offset of the line to be returned next.
+    size_t m_bufferEnd;             ///< Buffer offset one past the last byte read from file.
+    uint64_t m_bufferFileOffset;    ///< File offset of the first byte in the buffer.
+    uint64_t m_fileOffset;          ///< File offset of the next read.
+    Utf8StreamValidator m_utf8Validator;    ///< Validates all data as it is read from file.
+    uint64_t m_uncheckedEnd;        ///< Stream offset one past the last line returned by readLineBytes().
     bool m_eof;
-    struct DoubleBuffer {
-        std::vector<std::byte> front;
-        std::vector<std::byte> back;
-    } m_buffers;
+    bool m_done;
 public:
     /** Constructor.
      * @param[in] file_input FileInput used for reading data from file.
@@ -61,12 +70,34 @@ public:
      *         is no more data available in the file. In the latter case, done() will
      *         also return `true`.
      * @throw Exception Error::FileIO if an error occurs while reading from the file.
-     *                  Error::ParserError if the end of the line could not be found
-     *                  within the available read buffer or if the line is not a
-     *                  valid UTF-8 string.
+     *                  Error::ParserError if the line is not a valid UTF-8 string.
+     *                  Once a line failed validation, all following lines will
+     *                  fail as well.
      */
     std::optional<std::u8string> readLine();
 
+    /** Extracts the next line from the file without copying it.
+     * Behaves like readLine(), except that the returned view refers to the
+     * internal read buffer.
+     * @return A view of the next line from the file, which remains valid until the
+     *         next call to readLine() or readLineView(), or until the LineReader
+     *         is destroyed. An empty optional if there is no more data available.
+     *         If the file is mapped, the view refers to the mapped contents instead
+     *         and remains valid for as long as those.
+     * @throw Exception Error::FileIO if an error occurs while reading from the file.
+     *                  Error::ParserError if the line is not a valid UTF-8 string.
+     */
+    std::optional<std::u8string_view> readLineView();
+
+    /** Extracts the next line from the file without validating its encoding.
+     * Behaves like readLineView(), except that the line is not checked for being
+     * valid UTF-8. Invalid lines do not affect the results of later calls.
+     * @return A view of the raw bytes of the next line, with the same lifetime as
+     *         for readLineView(). An empty optional if there is no more data available.
+     * @throw Exception Error::FileIO if an error occurs while reading from the file.
+     */
+    std::optional<std::span<std::byte const>> readLineBytes();
+
     /** Checks whether the end of file has been reached.
      * If this function returns `true`, all subsequent calls to readLine() will
      * return the empty optional.
@@ -74,7 +105,12 @@ public:
     bool done() const;
 
 private:
-    bool read_more();
+    void readChunk();
+    void fillReadAhead();
+    std::span<std::byte const> nextBufferedLine();
+    std::span<std::byte const> nextMappedLine();
+    std::span<std::byte const> nextLine();
+    uint64_t nextLineOffset() const;
 };
 
 }
@@ -19,16 +19,36 @@
  */
 #include <quicker_sfv/md5_provider.hpp>
 
-#include <quicker_sfv/error.hpp>
-#include <quicker_sfv/line_reader.hpp>
-#include <quicker_sfv/string_utilities.hpp>
+#include <quicker_sfv/line_format.hpp>
+#include <quicker_sfv/line_parser.hpp>
 
 #include <quicker_sfv/detail/md5.hpp>
 
+#include <array>
 #include <memory>
 
 namespace quicker_sfv {
 
+namespace {
+
+/** `*.md5` files as written by `md5sum` in binary mode.
+ * Whitespace is handled leniently and paths must not contain the `*` marker.
+ */
+struct MD5LineFormat {
+    using Hasher = detail::MD5Hasher;
+    static constexpr DigestPosition digest_position = DigestPosition::Leading;
+    static constexpr std::size_t digest_width = 32;
+    static constexpr std::u8string_view line_prefix = u8"";
+    static constexpr std::array<std::u8string_view, 1> separators = { u8" *" };
+    static constexpr std::u8string_view comment_prefix = u8";";
+    static constexpr bool size_comments = true;
+    static constexpr std::u8string_view forbidden_path_characters = u8"*";
+    static constexpr bool lenient_whitespace = true;
+};
+static_assert(LineFormat<MD5LineFormat>);
+
+} // anonymous namespace
+
 ChecksumProviderPtr createMD5Provider() {
     return ChecksumProviderPtr(new MD5Provider);
 }
@@ -57,47 +77,25 @@ Digest MD5Provider::digestFromString(std::u8string_view str) const {
 }
 
 ChecksumFile MD5Provider::readFromFile(FileInput& file_input) const {
-    LineReader reader(file_input);
-    ChecksumFile ret;
-    for (;;) {
-        auto opt_line = reader.readLine();
-        if (!opt_line) {
-            if (reader.done()) {
-                break;
-            }
-        }
-        auto line = std::u8string_view{ *opt_line };
-        if (line.empty()) { continue; }
-        // skip comments
-        if (line.starts_with(u8";")) { continue; }
-        std::size_t const separator_idx = line.find(u8'*');
-        if (separator_idx == std::string::npos) {
-            throwException(Error::ParserError);
-        }
-        if ((separator_idx == 0) || (line[separator_idx - 1] != u8' ')) {
-            throwException(Error::ParserError);
-        }
-        std::u8string_view filepath_sv = trim(line.substr(separator_idx + 1));
-        if (filepath_sv.contains('*')) {
-            throwException(Error::ParserError);
-        }
-        std::u8string_view digest_sv = trim(line.substr(0, separator_idx - 1));
-        ret.addEntry(filepath_sv, detail::MD5Hasher::digestFromString(digest_sv));
-    }
-    return ret;
+    return parseLines(file_input, parseFormattedLine<MD5LineFormat>);
+}
+
+ChecksumFile MD5Provider::readFromFileParallel(FileInput& file_input, ParallelParseOptions const& options) const {
+    return parseLinesParallel(file_input, parseFormattedLine<MD5LineFormat>, options);
+}
+
+std::expected<ChecksumFile, LineDiagnostic> MD5Provider::tryReadFromFileParallel(FileInput& file_input,
+                                                                                ParallelParseOptions const& options) const
+{
+    return tryParseLinesParallel(file_input, tryParseFormattedLine<MD5LineFormat>, options);
+}
+
+LenientParseResult MD5Provider::readFromFileLenient(FileInput& file_input) const {
+    return parseLinesLenient(file_input, tryParseFormattedLine<MD5LineFormat>);
 }
 
 void MD5Provider::writeNewFile(FileOutput& file_output, ChecksumFile const& f) const {
-    for (auto const& e : f.getEntries()) {
-        std::u8string out_str;
-        auto const& path = e.data.front().path;
-        out_str.reserve(path.size() + 36);
-        out_str.append(e.digest.toString());
-        out_str.append(u8" *");
-        out_str.append(path);
-        out_str.push_back(u8'\n');
-        file_output.write(std::span<std::byte const>(reinterpret_cast<std::byte const*>(out_str.data()), out_str.size()));
-    }
+    writeFormattedLines<MD5LineFormat>(file_output, f);
 }
 
 }
@@ -49,6 +49,11 @@ public:
     [[nodiscard]] Digest digestFromString(std::u8string_view str) const override;
 
     [[nodiscard]] ChecksumFile readFromFile(FileInput& file_input) const override;
+    [[nodiscard]] ChecksumFile readFromFileParallel(FileInput& file_input,
+                                                    ParallelParseOptions const& options) const override;
+    [[nodiscard]] std::expected<ChecksumFile, LineDiagnostic> tryReadFromFileParallel(FileInput& file_input,
+                                                                                      ParallelParseOptions const& options) const override;
+    [[nodiscard]] LenientParseResult readFromFileLenient(FileInput& file_input) const override;
     void writeNewFile(FileOutput& file_output, ChecksumFile const& f) const override;
 };
 
@@ -0,0 +1,70 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/md5sum_provider.hpp>
+
+#include <quicker_sfv/line_format.hpp>
+
+#include <quicker_sfv/detail/md5.hpp>
+
+#include <array>
+
+namespace quicker_sfv {
+
+namespace {
+
+struct MD5SumLineFormat {
+    using Hasher = detail::MD5Hasher;
+    static constexpr DigestPosition digest_position = DigestPosition::Leading;
+    static constexpr std::size_t digest_width = 32;
+    static constexpr std::u8string_view line_prefix = u8"";
+    static constexpr std::array<std::u8string_view, 2> separators = { u8"  ", u8" *" };
+    static constexpr std::u8string_view comment_prefix = u8"";
+    static constexpr bool size_comments = false;
+    static constexpr std::u8string_view forbidden_path_characters = u8"";
+    static constexpr bool lenient_whitespace = false;
+    static constexpr std::u8string_view file_extensions = u8"*.md5sum";
+    static constexpr std::u8string_view file_description = u8"md5sum File";
+};
+
+struct BsdTagMD5LineFormat {
+    using Hasher = detail::MD5Hasher;
+    static constexpr DigestPosition digest_position = DigestPosition::Trailing;
+    static constexpr std::size_t digest_width = 32;
+    static constexpr std::u8string_view line_prefix = u8"MD5 (";
+    static constexpr std::array<std::u8string_view, 1> separators = { u8") = " };
+    static constexpr std::u8string_view comment_prefix = u8"";
+    static constexpr bool size_comments = false;
+    static constexpr std::u8string_view forbidden_path_characters = u8"";
+    static constexpr bool lenient_whitespace = false;
+    static constexpr std::u8string_view file_extensions = u8"*.md5tag";
+    static constexpr std::u8string_view file_description = u8"BSD-style MD5 File";
+};
+
+} // anonymous namespace
+
+ChecksumProviderPtr createMD5SumProvider() {
+    return ChecksumProviderPtr(new LineFormatProvider<MD5SumLineFormat>());
+}
+
+ChecksumProviderPtr createBsdTagMD5Provider() {
+    return ChecksumProviderPtr(new LineFormatProvider<BsdTagMD5LineFormat>());
+}
+
+}
@@ -0,0 +1,43 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_MD5SUM_PROVIDER_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_MD5SUM_PROVIDER_HPP
+
+#include <quicker_sfv/checksum_provider.hpp>
+
+namespace quicker_sfv {
+
+/** Creates a provider for `*.md5sum` files in the default output format of GNU `md5sum`.
+ * Each line consists of the 32 character MD5 digest, a space character, a mode
+ * character that is a space for text mode or a `*` for binary mode, and the path
+ * of the file. Paths are taken verbatim, including any leading or trailing spaces.
+ * Files are written in text mode. Paths escaped with backslashes are not supported.
+ */
+ChecksumProviderPtr createMD5SumProvider();
+
+/** Creates a provider for `*.md5tag` files in BSD-style tagged format.
+ * This is the format written by BSD `md5` and by `md5sum --tag`. Each line has the
+ * form `MD5 (<path>) = <digest>`.
+ */
+ChecksumProviderPtr createBsdTagMD5Provider();
+
+}
+
+#endif
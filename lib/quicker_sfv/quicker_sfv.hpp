@@ -20,15 +20,26 @@
 #ifndef INCLUDE_GUARD_QUICKER_SFV_QUICKER_SFV_HPP
 #define INCLUDE_GUARD_QUICKER_SFV_QUICKER_SFV_HPP
 
+#include <quicker_sfv/binary_manifest.hpp>
+#include <quicker_sfv/block_digests.hpp>
+#include <quicker_sfv/buffered_file_output.hpp>
 #include <quicker_sfv/checksum_file.hpp>
+#include <quicker_sfv/checksum_file_update.hpp>
 #include <quicker_sfv/checksum_provider.hpp>
+#include <quicker_sfv/decompressing_file_input.hpp>
 #include <quicker_sfv/digest.hpp>
+#include <quicker_sfv/digest_cache.hpp>
+#include <quicker_sfv/directory_digests.hpp>
 #include <quicker_sfv/error.hpp>
 #include <quicker_sfv/file_io.hpp>
+#include <quicker_sfv/hash_checkpoint.hpp>
 #include <quicker_sfv/hasher.hpp>
 #include <quicker_sfv/md5_provider.hpp>
+#include <quicker_sfv/md5sum_provider.hpp>
 #include <quicker_sfv/sfv_provider.hpp>
+#include <quicker_sfv/stamp_file.hpp>
 #include <quicker_sfv/string_utilities.hpp>
+#include <quicker_sfv/verified_database.hpp>
 #include <quicker_sfv/version.hpp>
 
 /** QuickerSFV library.
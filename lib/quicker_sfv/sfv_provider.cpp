@@ -19,14 +19,35 @@
  */
 #include <quicker_sfv/sfv_provider.hpp>
 
-#include <quicker_sfv/error.hpp>
-#include <quicker_sfv/line_reader.hpp>
-#include <quicker_sfv/string_utilities.hpp>
+#include <quicker_sfv/line_format.hpp>
+#include <quicker_sfv/line_parser.hpp>
 
 #include <quicker_sfv/detail/crc32.hpp>
 
+#include <array>
+
 namespace quicker_sfv {
 
+namespace {
+
+/** `*.sfv` files with the Crc32 at the end of each line.
+ * Whitespace is handled leniently, so paths may contain spaces.
+ */
+struct SfvLineFormat {
+    using Hasher = detail::Crc32Hasher;
+    static constexpr DigestPosition digest_position = DigestPosition::Trailing;
+    static constexpr std::size_t digest_width = 8;
+    static constexpr std::u8string_view line_prefix = u8"";
+    static constexpr std::array<std::u8string_view, 1> separators = { u8" " };
+    static constexpr std::u8string_view comment_prefix = u8";";
+    static constexpr bool size_comments = true;
+    static constexpr std::u8string_view forbidden_path_characters = u8"";
+    static constexpr bool lenient_whitespace = true;
+};
+static_assert(LineFormat<SfvLineFormat>);
+
+} // anonymous namespace
+
 ChecksumProviderPtr createSfvProvider() {
     return ChecksumProviderPtr(new SfvProvider());
 }
@@ -55,41 +76,25 @@ Digest SfvProvider::digestFromString(std::u8string_view str) const {
 }
 
 ChecksumFile SfvProvider::readFromFile(FileInput& file_input) const {
-    LineReader reader(file_input);
-    ChecksumFile ret;
-    for (;;) {
-        auto opt_line = reader.readLine();
-        if (!opt_line) {
-            if (reader.done()) {
-                break;
-            }
-        }
-        auto line = trim(std::u8string_view{ *opt_line });
-        if (line.empty()) { continue; }
-        // skip comments
-        if (line.starts_with(u8";")) { continue; }
-
-        if (line.size() < 10) { throwException(Error::ParserError); }
-        std::size_t const separator_idx = line.size() - 8;
-        if ((line[separator_idx - 1] != u8' ')) { throwException(Error::ParserError); }
-        std::u8string_view filepath_sv = trim(line.substr(0, separator_idx - 1));
-        if (filepath_sv.empty()) { throwException(Error::ParserError); }
-        ret.addEntry(filepath_sv, detail::Crc32Hasher::digestFromString(line.substr(separator_idx)));
-    }
-    return ret;
+    return parseLines(file_input, parseFormattedLine<SfvLineFormat>);
+}
+
+ChecksumFile SfvProvider::readFromFileParallel(FileInput& file_input, ParallelParseOptions const& options) const {
+    return parseLinesParallel(file_input, parseFormattedLine<SfvLineFormat>, options);
+}
+
+std::expected<ChecksumFile, LineDiagnostic> SfvProvider::tryReadFromFileParallel(FileInput& file_input,
+                                                                                ParallelParseOptions const& options) const
+{
+    return tryParseLinesParallel(file_input, tryParseFormattedLine<SfvLineFormat>, options);
+}
+
+LenientParseResult SfvProvider::readFromFileLenient(FileInput& file_input) const {
+    return parseLinesLenient(file_input, tryParseFormattedLine<SfvLineFormat>);
 }
 
 void SfvProvider::writeNewFile(FileOutput& file_output, ChecksumFile const& f) const {
-    for (auto const& e : f.getEntries()) {
-        std::u8string out_str;
-        auto const& path = e.data.front().path;
-        out_str.reserve(path.size() + 11);
-        out_str.append(path);
-        out_str.push_back(u8' ');
-        out_str.append(e.digest.toString());
-        out_str.push_back(u8'\n');
-        file_output.write(std::span<std::byte const>(reinterpret_cast<std::byte const*>(out_str.data()), out_str.size()));
-    }
+    writeFormattedLines<SfvLineFormat>(file_output, f);
 }
 
 }
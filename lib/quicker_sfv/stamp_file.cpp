@@ -0,0 +1,117 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/stamp_file.hpp>
+
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/line_reader.hpp>
+#include <quicker_sfv/string_utilities.hpp>
+
+#include <charconv>
+#include <system_error>
+
+namespace quicker_sfv {
+
+namespace {
+
+template<typename T>
+T parseNumber(std::u8string_view str) {
+    char const* const first = reinterpret_cast<char const*>(str.data());
+    char const* const last = first + str.size();
+    T ret{};
+    auto const [ptr, ec] = std::from_chars(first, last, ret);
+    if ((ec != std::errc{}) || (ptr != last)) { throwException(Error::ParserError); }
+    return ret;
+}
+
+template<typename T>
+void appendNumber(std::u8string& out, T n) {
+    char buffer[24];
+    auto const [ptr, ec] = std::to_chars(std::begin(buffer), std::end(buffer), n);
+    if (ec != std::errc{}) { throwException(Error::Failed); }
+    out.append(reinterpret_cast<char8_t const*>(std::begin(buffer)), reinterpret_cast<char8_t const*>(ptr));
+}
+
+} // anonymous namespace
+
+std::optional<FileStamp> StampFile::getStamp(std::u8string_view path) const {
+    auto const it = m_stamps.find(path);
+    if (it == m_stamps.end()) { return std::nullopt; }
+    return it->second;
+}
+
+void StampFile::setStamp(std::u8string_view path, FileStamp const& stamp) {
+    if (auto it = m_stamps.find(path); it != m_stamps.end()) {
+        it->second = stamp;
+    } else {
+        m_stamps.emplace(std::u8string{ path }, stamp);
+    }
+}
+
+std::size_t StampFile::size() const {
+    return m_stamps.size();
+}
+
+void StampFile::clear() {
+    m_stamps.clear();
+}
+
+StampFile StampFile::readFromFile(FileInput& file_input) {
+    LineReader reader(file_input);
+    StampFile ret;
+    for (;;) {
+        auto opt_line = reader.readLineView();
+        if (!opt_line) {
+            if (reader.done()) {
+                break;
+            }
+        }
+        std::u8string_view const line{ *opt_line };
+        if (trim(line).empty()) { continue; }
+        // skip comments
+        if (line.starts_with(u8";")) { continue; }
+        std::size_t const size_end = line.find(u8' ');
+        if (size_end == std::u8string_view::npos) { throwException(Error::ParserError); }
+        std::size_t const time_end = line.find(u8' ', size_end + 1);
+        if (time_end == std::u8string_view::npos) { throwException(Error::ParserError); }
+        std::u8string_view const path = line.substr(time_end + 1);
+        if (path.empty()) { throwException(Error::ParserError); }
+        ret.setStamp(path, FileStamp{
+            .size = parseNumber<uint64_t>(line.substr(0, size_end)),
+            .modification_time = parseNumber<int64_t>(line.substr(size_end + 1, time_end - size_end - 1))
+        });
+    }
+    return ret;
+}
+
+void StampFile::writeToFile(FileOutput& file_output) const {
+    for (auto const& [path, stamp] : m_stamps) {
+        std::u8string out_str;
+        out_str.reserve(path.size() + 42);
+        appendNumber(out_str, stamp.size);
+        out_str.push_back(u8' ');
+        appendNumber(out_str, stamp.modification_time);
+        out_str.push_back(u8' ');
+        out_str.append(path);
+        out_str.push_back(u8'\n');
+        file_output.write(std::span<std::byte const>(reinterpret_cast<std::byte const*>(out_str.data()), out_str.size()));
+    }
+}
+
+}
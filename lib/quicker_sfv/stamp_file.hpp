@@ -0,0 +1,99 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_STAMP_FILE_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_STAMP_FILE_HPP
+
+#include <quicker_sfv/file_io.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace quicker_sfv {
+
+/** Size and modification time of a file.
+ * A FileStamp allows detecting whether a file has changed since it was last hashed
+ * without reading any of its contents.
+ */
+struct FileStamp {
+    uint64_t size;                  ///< Size of the file in bytes.
+    int64_t modification_time;      ///< Time of the last modification of the file.
+                                    ///  Unit and epoch are determined by the client.
+                                    ///  Stamps are only ever compared for equality.
+
+    friend bool operator==(FileStamp const&, FileStamp const&) noexcept = default;
+};
+
+/** Sidecar file storing a FileStamp for each entry of a ChecksumFile.
+ * A StampFile records the state of each file at the time its checksum was computed.
+ * It is stored next to the checksum file and is used for updating an existing
+ * checksum file incrementally.
+ * The file format is line based, with one line per file of the form
+ * `<size> <modification_time> <path>`. Lines starting with `;` are comments.
+ * File encoding must be UTF-8. Line endings must be either CRLF or LF on read
+ * and will always be LF on write.
+ */
+class StampFile {
+private:
+    std::map<std::u8string, FileStamp, std::less<>> m_stamps;
+public:
+    /** Retrieves the stamp for a file.
+     * @param[in] path Path of the file as it appears in the ChecksumFile.
+     * @return The recorded FileStamp if the file is part of the StampFile.
+     *         An empty optional otherwise.
+     */
+    [[nodiscard]] std::optional<FileStamp> getStamp(std::u8string_view path) const;
+
+    /** Sets the stamp for a file.
+     * If the StampFile already contains a stamp for the file, it will be replaced.
+     * @param[in] path Path of the file as it appears in the ChecksumFile.
+     * @param[in] stamp Stamp of the file.
+     */
+    void setStamp(std::u8string_view path, FileStamp const& stamp);
+
+    /** Retrieves the number of files in the StampFile.
+     */
+    [[nodiscard]] std::size_t size() const;
+
+    /** Clears the stamp file, leaving it with no entries.
+     */
+    void clear();
+
+    /** Reads a StampFile from file.
+     * @param[in] file_input A FileInput object providing access to the file data.
+     * @throws Exception Error::ParserError if the file format is invalid.
+     *                   Error::FileIO if an error occurs while reading the file.
+     */
+    [[nodiscard]] static StampFile readFromFile(FileInput& file_input);
+
+    /** Writes the StampFile out to a file.
+     * Entries are written in lexicographical order of their paths.
+     * @param[in] file_output A FileOutput object providing access to the file.
+     * @throws Exception Error::FileIO if an error occurs while writing the file.
+     */
+    void writeToFile(FileOutput& file_output) const;
+};
+
+}
+
+#endif
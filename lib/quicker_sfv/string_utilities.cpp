@@ -19,6 +19,8 @@
  */
 #include <quicker_sfv/string_utilities.hpp>
 
+#include <quicker_sfv/detail/text_scan.hpp>
+
 #include <cassert>
 #include <span>
 
@@ -211,19 +213,67 @@ Utf8Encode encodeUtf32ToUtf8(char32_t c) {
 }
 
 bool checkValidUtf8(std::span<std::byte const> range) {
-    std::span<char8_t const> u8range(reinterpret_cast<char8_t const*>(range.data()), range.size());
-    while (!u8range.empty()) {
-        DecodeResult const r = decodeUtf8(u8range);
-        if (r.code_units_consumed == 0) { return false; }
-        u8range = u8range.subspan(r.code_units_consumed);
-    }
-    return true;
+    Utf8StreamValidator validator;
+    validator.addData(range);
+    validator.finish();
+    return !validator.firstInvalidOffset();
 }
 
 bool checkValidUtf8(std::string_view str) {
     return checkValidUtf8(std::span<std::byte const>(reinterpret_cast<std::byte const*>(str.data()), str.size()));
 }
 
+Utf8StreamValidator::Utf8StreamValidator() noexcept
+    :m_streamOffset(0), m_sequenceStart(0), m_pendingBytes(0), m_firstInvalid(std::nullopt)
+{}
+
+void Utf8StreamValidator::addData(std::span<std::byte const> data) {
+    std::size_t i = 0;
+    while (!m_firstInvalid && (i < data.size())) {
+        if (m_pendingBytes == 0) {
+            // blocks of complete sequences are validated in bulk; the scalar loop only
+            // handles sequences split between blocks or chunks and locates errors
+            i += text_scan::skipValidUtf8(data.subspan(i));
+            if (i == data.size()) { break; }
+            uint8_t const b = static_cast<uint8_t>(data[i]);
+            if ((b & 0b1000'0000) == 0) {
+                ++i;
+                continue;
+            } else if ((b & 0b1110'0000) == 0b1100'0000) {
+                m_pendingBytes = 1;
+            } else if ((b & 0b1111'0000) == 0b1110'0000) {
+                m_pendingBytes = 2;
+            } else if ((b & 0b1111'1000) == 0b1111'0000) {
+                m_pendingBytes = 3;
+            } else {
+                // multi byte without header or invalid encoding header
+                m_firstInvalid = m_streamOffset + i;
+                break;
+            }
+            m_sequenceStart = m_streamOffset + i;
+        } else {
+            if ((static_cast<uint8_t>(data[i]) & 0b1100'0000) != 0b1000'0000) {
+                m_firstInvalid = m_sequenceStart;
+                break;
+            }
+            --m_pendingBytes;
+        }
+        ++i;
+    }
+    m_streamOffset += data.size();
+}
+
+void Utf8StreamValidator::finish() {
+    if (!m_firstInvalid && (m_pendingBytes != 0)) {
+        m_firstInvalid = m_sequenceStart;
+    }
+    m_pendingBytes = 0;
+}
+
+std::optional<uint64_t> Utf8StreamValidator::firstInvalidOffset() const {
+    return m_firstInvalid;
+}
+
 bool checkValidUtfWideString(std::span<wchar_t const> range) {
     static_assert((sizeof(wchar_t) == 2) || (sizeof(wchar_t) == 4), "Unexpected wchar_t size");
     if constexpr (sizeof(wchar_t) == 4) {
@@ -256,25 +306,87 @@ std::u8string assumeUtf8(std::string_view str) {
 
 std::u8string convertToUtf8(std::u16string_view str) {
     std::u8string ret;
-    while (!str.empty()) {
-        auto const decode_result = decodeUtf16(str);
-        assert(decode_result.code_units_consumed != 0);
-        str = str.substr(decode_result.code_units_consumed);
-        auto const utf8_encode = encodeUtf32ToUtf8(decode_result.code_point);
-        ret.append(utf8_encode.encode, utf8_encode.number_of_code_units);
-    }
+    // each code unit encodes to at most 3 bytes; surrogate pairs encode to 4 bytes
+    ret.resize_and_overwrite(str.size() * 3, [str](char8_t* out, std::size_t) -> std::size_t {
+        char8_t* const out_begin = out;
+        std::size_t i = 0;
+        while (i < str.size()) {
+            std::size_t const n_ascii = text_scan::narrowAscii(str.substr(i), out);
+            i += n_ascii;
+            out += n_ascii;
+            // convert non-ASCII characters one by one until the next ASCII character
+            while ((i < str.size()) && (str[i] >= 0x80)) {
+                char32_t const c = str[i];
+                if (c < 0x800) {
+                    out[0] = static_cast<char8_t>(0b1100'0000 | (c >> 6));
+                    out[1] = static_cast<char8_t>(0b1000'0000 | (c & 0b0011'1111));
+                    out += 2;
+                    ++i;
+                } else if (((c & 0xfc00) == 0xd800) && (i + 1 < str.size()) && ((str[i + 1] & 0xfc00) == 0xdc00)) {
+                    char32_t const cp = (((c & 0x03ff) << 10) | (str[i + 1] & 0x03ff)) + 0x0001'0000;
+                    out[0] = static_cast<char8_t>(0b1111'0000 | (cp >> 18));
+                    out[1] = static_cast<char8_t>(0b1000'0000 | ((cp >> 12) & 0b0011'1111));
+                    out[2] = static_cast<char8_t>(0b1000'0000 | ((cp >> 6) & 0b0011'1111));
+                    out[3] = static_cast<char8_t>(0b1000'0000 | (cp & 0b0011'1111));
+                    out += 4;
+                    i += 2;
+                } else {
+                    // unpaired surrogates violate the precondition and are encoded like any other code unit
+                    assert((c & 0xf800) != 0xd800);
+                    out[0] = static_cast<char8_t>(0b1110'0000 | (c >> 12));
+                    out[1] = static_cast<char8_t>(0b1000'0000 | ((c >> 6) & 0b0011'1111));
+                    out[2] = static_cast<char8_t>(0b1000'0000 | (c & 0b0011'1111));
+                    out += 3;
+                    ++i;
+                }
+            }
+        }
+        return static_cast<std::size_t>(out - out_begin);
+    });
     return ret;
 }
 
 std::u16string convertToUtf16(std::u8string_view str) {
     std::u16string ret;
-    while (!str.empty()) {
-        auto const decode_result = decodeUtf8(str);
-        assert(decode_result.code_units_consumed != 0);
-        str = str.substr(decode_result.code_units_consumed);
-        auto const utf16_encode = encodeUtf32ToUtf16(decode_result.code_point);
-        ret.append(utf16_encode.encode, utf16_encode.number_of_code_units);
-    }
+    // each byte decodes to at most one code unit; 4 byte sequences decode to 2 code units
+    ret.resize_and_overwrite(str.size(), [str](char16_t* out, std::size_t) -> std::size_t {
+        char16_t* const out_begin = out;
+        std::span<std::byte const> const bytes(reinterpret_cast<std::byte const*>(str.data()), str.size());
+        std::size_t i = 0;
+        while (i < str.size()) {
+            std::size_t const n_ascii = text_scan::widenAscii(bytes.subspan(i), out);
+            i += n_ascii;
+            out += n_ascii;
+            // convert non-ASCII characters one by one until the next ASCII character
+            while ((i < str.size()) && (str[i] >= 0x80)) {
+                char32_t const b = str[i];
+                std::size_t const sequence_size = ((b & 0b1110'0000) == 0b1100'0000) ? 2 : (((b & 0b1111'0000) == 0b1110'0000) ? 3 : 4);
+                if (i + sequence_size > str.size()) {
+                    // truncated sequences violate the precondition and are dropped
+                    assert(false);
+                    i = str.size();
+                    break;
+                }
+                if (sequence_size == 2) {
+                    *out++ = static_cast<char16_t>(((b & 0b0001'1111) << 6) | (str[i + 1] & 0b0011'1111));
+                    i += 2;
+                } else if (sequence_size == 3) {
+                    *out++ = static_cast<char16_t>(((b & 0b0000'1111) << 12) | ((str[i + 1] & 0b0011'1111) << 6) |
+                                                   (str[i + 2] & 0b0011'1111));
+                    i += 3;
+                } else {
+                    assert((b & 0b1111'1000) == 0b1111'0000);
+                    char32_t const cp = ((b & 0b0000'0111) << 18) | ((str[i + 1] & 0b0011'1111) << 12) |
+                                        ((str[i + 2] & 0b0011'1111) << 6) | (str[i + 3] & 0b0011'1111);
+                    // code points beyond the unicode range can not be represented
+                    Utf16Encode const encode = encodeUtf32ToUtf16(cp);
+                    for (uint32_t j = 0; j < encode.number_of_code_units; ++j) { *out++ = encode.encode[j]; }
+                    i += 4;
+                }
+            }
+        }
+        return static_cast<std::size_t>(out - out_begin);
+    });
     return ret;
 }
 
@@ -22,6 +22,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
@@ -116,6 +117,36 @@ bool checkValidUtf8(std::span<std::byte const> range);
  */
 bool checkValidUtf8(std::string_view str);
 
+/** Incremental validation of a UTF-8 encoded byte stream.
+ * The stream is passed in consecutive chunks, which may split encoded sequences
+ * at arbitrary positions. Validation follows the same rules as checkValidUtf8().
+ * Runs of ASCII characters are skipped using vector instructions.
+ */
+class Utf8StreamValidator {
+private:
+    uint64_t m_streamOffset;
+    uint64_t m_sequenceStart;
+    uint32_t m_pendingBytes;
+    std::optional<uint64_t> m_firstInvalid;
+public:
+    Utf8StreamValidator() noexcept;
+
+    /** Validates the next chunk of the stream.
+     */
+    void addData(std::span<std::byte const> data);
+
+    /** Marks the end of the stream.
+     * An incomplete sequence at the end of the stream is invalid.
+     */
+    void finish();
+
+    /** Stream offset of the first byte of the first invalid sequence.
+     * An empty optional if no invalid sequence was found so far.
+     * Data following an invalid sequence is not validated.
+     */
+    [[nodiscard]] std::optional<uint64_t> firstInvalidOffset() const;
+};
+
 /** Checks whether a wchar_t range contains a valid UTF-16/UTF-32 encoded string.
  * The empty string is considered valid.
  * @note Depending on the platform, wchar_t can be 2 or 4 bytes in size.
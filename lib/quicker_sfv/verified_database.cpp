@@ -0,0 +1,228 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/verified_database.hpp>
+
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/string_utilities.hpp>
+
+#include <quicker_sfv/detail/byte_order.hpp>
+
+#include <fast_crc32/fast_crc32.hpp>
+
+#include <array>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace quicker_sfv {
+
+namespace {
+
+using byte_order::loadLittleEndian;
+using byte_order::storeLittleEndian;
+
+constexpr std::array<char, 8> const MAGIC = { 'Q', 'S', 'F', 'V', 'V', 'D', 'B', '1' };
+/// Payload size without the variable-length string data.
+constexpr std::size_t const FIXED_PAYLOAD_SIZE = 5 * 8 + 2 * 2;
+/// Upper limit for the size of a single record payload.
+constexpr std::size_t const MAX_PAYLOAD_SIZE = FIXED_PAYLOAD_SIZE + 2 * std::numeric_limits<uint16_t>::max();
+/// Number of superseded records tolerated in the journal before compaction.
+constexpr std::size_t const COMPACTION_THRESHOLD = 4096;
+
+uint32_t checksum(std::span<std::byte const> data) {
+    return crc::crc32(reinterpret_cast<char const*>(data.data()), data.size(), 0, false, false);
+}
+
+class PayloadWriter {
+private:
+    std::vector<std::byte>& m_out;
+public:
+    explicit PayloadWriter(std::vector<std::byte>& out)
+        :m_out(out)
+    {}
+
+    template<std::unsigned_integral T>
+    void write(T v) {
+        std::size_t const offset = m_out.size();
+        m_out.resize(offset + sizeof(T));
+        storeLittleEndian<T>(m_out.data() + offset, v);
+    }
+
+    void write(std::u8string_view str) {
+        if (str.size() > std::numeric_limits<uint16_t>::max()) { throwException(Error::Failed); }
+        write(static_cast<uint16_t>(str.size()));
+        std::byte const* p = reinterpret_cast<std::byte const*>(str.data());
+        m_out.insert(m_out.end(), p, p + str.size());
+    }
+};
+
+class PayloadReader {
+private:
+    std::span<std::byte const> m_data;
+public:
+    explicit PayloadReader(std::span<std::byte const> data)
+        :m_data(data)
+    {}
+
+    template<std::unsigned_integral T>
+    T read() {
+        if (m_data.size() < sizeof(T)) { throwException(Error::ParserError); }
+        T const ret = loadLittleEndian<T>(m_data.data());
+        m_data = m_data.subspan(sizeof(T));
+        return ret;
+    }
+
+    std::u8string readString() {
+        uint16_t const size = read<uint16_t>();
+        if (m_data.size() < size) { throwException(Error::ParserError); }
+        std::span<std::byte const> const str = m_data.first(size);
+        if (!checkValidUtf8(str)) { throwException(Error::ParserError); }
+        m_data = m_data.subspan(size);
+        return std::u8string(reinterpret_cast<char8_t const*>(str.data()), str.size());
+    }
+
+    bool empty() const {
+        return m_data.empty();
+    }
+};
+
+std::vector<std::byte> encodeRecord(VerifiedFileKey const& key, VerifiedRecord const& record) {
+    std::vector<std::byte> ret(4);
+    ret.reserve(4 + FIXED_PAYLOAD_SIZE + key.algorithm.size() + record.digest.size() + 4);
+    PayloadWriter w(ret);
+    w.write(key.device);
+    w.write(key.file_id);
+    w.write(key.size);
+    w.write(static_cast<uint64_t>(key.modification_time));
+    w.write(static_cast<uint64_t>(record.verified_time.time_since_epoch().count()));
+    w.write(key.algorithm);
+    w.write(record.digest);
+    std::size_t const payload_size = ret.size() - 4;
+    storeLittleEndian<uint32_t>(ret.data(), static_cast<uint32_t>(payload_size));
+    w.write(checksum(std::span<std::byte const>(ret).subspan(4, payload_size)));
+    return ret;
+}
+
+} // anonymous namespace
+
+VerifiedDatabase::VerifiedDatabase()
+    :m_journalRecords(0), m_journalDamaged(false)
+{}
+
+std::optional<VerifiedRecord> VerifiedDatabase::lookup(VerifiedFileKey const& key) const {
+    auto const it = m_records.find(key);
+    if (it == m_records.end()) { return std::nullopt; }
+    return it->second;
+}
+
+bool VerifiedDatabase::canSkip(VerifiedFileKey const& key, Digest const& expected_digest,
+                               std::chrono::sys_seconds now, VerifiedDatabasePolicy const& policy) const
+{
+    if (!policy.skip_verified) { return false; }
+    auto const it = m_records.find(key);
+    if (it == m_records.end()) { return false; }
+    VerifiedRecord const& r = it->second;
+    if ((policy.max_age.count() > 0) && (now - r.verified_time >= policy.max_age)) { return false; }
+    return r.digest == expected_digest.toString();
+}
+
+void VerifiedDatabase::insert(VerifiedFileKey key, VerifiedRecord record) {
+    m_records.insert_or_assign(std::move(key), std::move(record));
+}
+
+std::size_t VerifiedDatabase::size() const {
+    return m_records.size();
+}
+
+bool VerifiedDatabase::needsCompaction() const {
+    return m_journalDamaged || (m_journalRecords > m_records.size() + COMPACTION_THRESHOLD);
+}
+
+VerifiedDatabase VerifiedDatabase::readFromFile(FileInput& file_input) {
+    uint64_t const file_size = file_input.file_size();
+    if (file_size > std::numeric_limits<std::size_t>::max()) { throwException(Error::ParserError); }
+    std::vector<std::byte> contents(static_cast<std::size_t>(file_size));
+    std::size_t bytes_read = 0;
+    while (bytes_read < contents.size()) {
+        std::size_t const res = file_input.read(std::span<std::byte>(contents).subspan(bytes_read));
+        if (res == FileInput::RESULT_END_OF_FILE) { break; }
+        bytes_read += res;
+    }
+    if (bytes_read != contents.size()) { throwException(Error::FileIO); }
+
+    VerifiedDatabase ret;
+    if (contents.empty()) { return ret; }
+    if ((contents.size() < MAGIC.size()) || (std::memcmp(contents.data(), MAGIC.data(), MAGIC.size()) != 0)) {
+        throwException(Error::ParserError);
+    }
+    std::span<std::byte const> remaining = std::span<std::byte const>(contents).subspan(MAGIC.size());
+    while (!remaining.empty()) {
+        if (remaining.size() < 4) { ret.m_journalDamaged = true; break; }
+        uint32_t const payload_size = loadLittleEndian<uint32_t>(remaining.data());
+        if ((payload_size < FIXED_PAYLOAD_SIZE) || (payload_size > MAX_PAYLOAD_SIZE) ||
+            (remaining.size() - 4 < static_cast<std::size_t>(payload_size) + 4))
+        {
+            ret.m_journalDamaged = true;
+            break;
+        }
+        std::span<std::byte const> const payload = remaining.subspan(4, payload_size);
+        if (loadLittleEndian<uint32_t>(payload.data() + payload_size) != checksum(payload)) {
+            ret.m_journalDamaged = true;
+            break;
+        }
+        remaining = remaining.subspan(4 + payload_size + 4);
+
+        PayloadReader r(payload);
+        VerifiedFileKey key;
+        key.device = r.read<uint64_t>();
+        key.file_id = r.read<uint64_t>();
+        key.size = r.read<uint64_t>();
+        key.modification_time = static_cast<int64_t>(r.read<uint64_t>());
+        VerifiedRecord record;
+        record.verified_time = std::chrono::sys_seconds(std::chrono::seconds(static_cast<int64_t>(r.read<uint64_t>())));
+        key.algorithm = r.readString();
+        record.digest = r.readString();
+        if (!r.empty()) { throwException(Error::ParserError); }
+        ret.insert(std::move(key), std::move(record));
+        ++ret.m_journalRecords;
+    }
+    return ret;
+}
+
+void VerifiedDatabase::writeToFile(FileOutput& file_output) const {
+    std::vector<std::byte> out(MAGIC.size());
+    std::memcpy(out.data(), MAGIC.data(), MAGIC.size());
+    for (auto const& [key, record] : m_records) {
+        std::vector<std::byte> const r = encodeRecord(key, record);
+        out.insert(out.end(), r.begin(), r.end());
+    }
+    file_output.write(out);
+}
+
+void VerifiedDatabase::writeHeader(FileOutput& file_output) {
+    file_output.write(std::span<std::byte const>(reinterpret_cast<std::byte const*>(MAGIC.data()), MAGIC.size()));
+}
+
+void VerifiedDatabase::appendRecord(FileOutput& file_output, VerifiedFileKey const& key, VerifiedRecord const& record) {
+    file_output.write(encodeRecord(key, record));
+}
+
+}
@@ -0,0 +1,169 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_VERIFIED_DATABASE_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_VERIFIED_DATABASE_HPP
+
+#include <quicker_sfv/digest.hpp>
+#include <quicker_sfv/file_io.hpp>
+
+#include <chrono>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace quicker_sfv {
+
+/** Identity and state of a file on disk.
+ * Two files with the same key are considered to have identical contents.
+ */
+struct VerifiedFileKey {
+    uint64_t device;                ///< Identifier of the volume containing the file.
+    uint64_t file_id;               ///< Identifier of the file on the volume
+                                    ///  (e.g. the inode number).
+    uint64_t size;                  ///< Size of the file in bytes.
+    int64_t modification_time;      ///< Time of the last modification of the file.
+                                    ///  Unit and epoch are determined by the client.
+    std::u8string algorithm;        ///< Identifier for the checksum algorithm.
+
+    friend auto operator<=>(VerifiedFileKey const&, VerifiedFileKey const&) = default;
+};
+
+/** Result of a previous successful verification.
+ */
+struct VerifiedRecord {
+    std::u8string digest;                       ///< String representation of the
+                                                ///  verified Digest.
+    std::chrono::sys_seconds verified_time;     ///< Time of the verification.
+
+    friend bool operator==(VerifiedRecord const&, VerifiedRecord const&) = default;
+};
+
+/** Policy for consulting the VerifiedDatabase during verification.
+ */
+struct VerifiedDatabasePolicy {
+    bool skip_verified;             ///< If true, files with an up-to-date record
+                                    ///  matching the expected digest will be skipped.
+                                    ///  If false, all files are re-checked and only
+                                    ///  the records are refreshed.
+    std::chrono::days max_age;      ///< Records older than this will not be used for
+                                    ///  skipping. A value of 0 means records never
+                                    ///  expire.
+};
+
+/** Database of previously verified files.
+ * The database remembers which files have been verified successfully, so that files
+ * that have not changed since do not have to be read again.
+ *
+ * On disk the database is an append-only journal. The file starts with the 8 byte
+ * magic `QSFVVDB1`, followed by any number of records. Each record consists of a
+ * little-endian uint32 payload size, the payload, and a little-endian uint32 CRC32 of
+ * the payload. The payload holds the fields of the VerifiedFileKey and the
+ * VerifiedRecord, with strings stored as uint16 length followed by UTF-8 data.
+ * Later records for the same key replace earlier ones.
+ *
+ * New results are appended to the journal with appendRecord(). An interrupted write
+ * can only ever damage the last record, which will be detected by its size or
+ * checksum and dropped on the next read. Since appending after such a damaged record
+ * would render the new records unreachable, the journal must be rewritten with
+ * writeToFile() whenever needsCompaction() returns true after reading. The client is
+ * responsible for replacing the old file atomically.
+ */
+class VerifiedDatabase {
+private:
+    std::map<VerifiedFileKey, VerifiedRecord, std::less<>> m_records;
+    std::size_t m_journalRecords;
+    bool m_journalDamaged;
+public:
+    /** Constructor.
+     * Constructs an empty database.
+     */
+    VerifiedDatabase();
+
+    /** Retrieves the record for a file.
+     * @return The record for key or an empty optional if the file was not verified.
+     */
+    [[nodiscard]] std::optional<VerifiedRecord> lookup(VerifiedFileKey const& key) const;
+
+    /** Checks whether verification of a file can be skipped.
+     * @param[in] key Key of the file on disk.
+     * @param[in] expected_digest Digest the file is expected to have.
+     * @param[in] now Current time.
+     * @param[in] policy Policy for skipping.
+     * @return True if policy allows skipping, the database contains a record for key
+     *         with a digest equal to expected_digest, and the record is not older
+     *         than the maximum age from the policy.
+     */
+    [[nodiscard]] bool canSkip(VerifiedFileKey const& key, Digest const& expected_digest,
+                               std::chrono::sys_seconds now, VerifiedDatabasePolicy const& policy) const;
+
+    /** Adds or replaces the record for a file.
+     * This only changes the in-memory state. Use appendRecord() to persist the change.
+     */
+    void insert(VerifiedFileKey key, VerifiedRecord record);
+
+    /** Retrieves the number of files in the database.
+     */
+    [[nodiscard]] std::size_t size() const;
+
+    /** Checks whether the journal should be rewritten before appending to it.
+     * This is the case if the journal read with readFromFile() ended in a damaged
+     * record or contains a large number of superseded records.
+     */
+    [[nodiscard]] bool needsCompaction() const;
+
+    /** Reads a database journal.
+     * A damaged record at the end of the journal is ignored.
+     * @param[in] file_input A FileInput object providing access to the file data.
+     *                       An empty file is treated as an empty database.
+     * @throws Exception Error::ParserError if the file is not a database journal.
+     *                   Error::FileIO if an error occurs while reading the file.
+     */
+    [[nodiscard]] static VerifiedDatabase readFromFile(FileInput& file_input);
+
+    /** Writes a compacted journal containing the current state of the database.
+     * @param[in] file_output A FileOutput object providing access to an empty file.
+     * @throws Exception Error::FileIO if an error occurs while writing the file.
+     */
+    void writeToFile(FileOutput& file_output) const;
+
+    /** Writes the header for a new, empty journal.
+     * @param[in] file_output A FileOutput object providing access to an empty file.
+     * @throws Exception Error::FileIO if an error occurs while writing the file.
+     */
+    static void writeHeader(FileOutput& file_output);
+
+    /** Appends a single record to a journal.
+     * The record is written with a single call to FileOutput::write().
+     * @param[in] file_output A FileOutput object positioned at the end of a journal.
+     * @param[in] key Key of the verified file.
+     * @param[in] record Verification result.
+     * @throws Exception Error::Failed if a string field exceeds the maximum length.
+     *                   Error::FileIO if an error occurs while writing the file.
+     */
+    static void appendRecord(FileOutput& file_output, VerifiedFileKey const& key, VerifiedRecord const& record);
+};
+
+}
+
+#endif
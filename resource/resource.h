@@ -35,13 +35,20 @@
 #define ID_CONTEXTMENU_MOVEALLFILESTOCHILDDIRECTORY 40027
 #define ID_ACCELERATOR_SELECT_ALL       40028
 #define ID_OPTIONS_SAVECONFIGURATION    40030
+#define ID_CREATE_UPDATE_EXISTING       40031
+#define ID_OPTIONS_CREATEDIRECTORYDIGESTS 40032
+#define ID_OPTIONS_RECHECKVERIFIEDFILES 40033
+#define ID_OPTIONS_USEDIGESTCACHE       40034
+#define ID_OPTIONS_RESUMEAPPENDEDFILES  40035
+#define ID_OPTIONS_CREATEBLOCKDIGESTS   40036
+#define ID_OPTIONS_QUICKAUDIT           40037
 
 // Next default values for new objects
 // 
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        113
-#define _APS_NEXT_COMMAND_VALUE         40031
+#define _APS_NEXT_COMMAND_VALUE         40038
 #define _APS_NEXT_CONTROL_VALUE         1006
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
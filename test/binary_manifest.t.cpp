@@ -0,0 +1,261 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/binary_manifest.hpp>
+
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/md5_provider.hpp>
+#include <quicker_sfv/sfv_provider.hpp>
+#include <quicker_sfv/detail/crc32.hpp>
+#include <quicker_sfv/detail/md5.hpp>
+
+#include <test_file_io.hpp>
+
+#include <catch.hpp>
+
+#include <cstring>
+
+namespace {
+std::span<std::byte const> asBytes(std::vector<char> const& v) {
+    return std::span<std::byte const>(reinterpret_cast<std::byte const*>(v.data()), v.size());
+}
+}
+
+TEST_CASE("Binary Manifest")
+{
+    using quicker_sfv::BinaryManifestAlgorithm;
+    using quicker_sfv::BinaryManifestView;
+    using quicker_sfv::ChecksumFile;
+    using quicker_sfv::FileStamp;
+    using quicker_sfv::StampFile;
+
+    auto p = quicker_sfv::createBinarySfvProvider();
+    REQUIRE(p);
+    auto p_md5 = quicker_sfv::createBinaryMD5Provider();
+    REQUIRE(p_md5);
+
+    ChecksumFile f;
+    f.addEntry(u8"some/example/path", p->digestFromString(u8"a1b2c3d4"));
+    f.addEntry(u8"some_file.rar", p->digestFromString(u8"0000ffff"));
+    f.addEntry(u8"another_file.txt", p->digestFromString(u8"12345678"));
+
+    SECTION("Capabilities") {
+        CHECK(p->getCapabilities() == quicker_sfv::ProviderCapabilities::Full);
+        CHECK(p_md5->getCapabilities() == quicker_sfv::ProviderCapabilities::Full);
+    }
+    SECTION("Extension and Description") {
+        CHECK(p->fileExtensions() == u8"*.sfvbin");
+        CHECK(p->fileDescription() == u8"Binary Sfv Manifest");
+        CHECK(p_md5->fileExtensions() == u8"*.md5bin");
+        CHECK(p_md5->fileDescription() == u8"Binary MD5 Manifest");
+    }
+    SECTION("Create Hasher") {
+        auto h = p->createHasher(quicker_sfv::HasherOptions{ .has_sse42 = false, .has_avx512 = false });
+        CHECK(dynamic_cast<quicker_sfv::detail::Crc32Hasher*>(h.get()));
+        auto h_md5 = p_md5->createHasher(quicker_sfv::HasherOptions{ .has_sse42 = false, .has_avx512 = false });
+        CHECK(dynamic_cast<quicker_sfv::detail::MD5Hasher*>(h_md5.get()));
+    }
+    SECTION("Write and query in place") {
+        TestOutput out;
+        p->writeNewFile(out, f);
+        CHECK(out.write_calls == 1);
+        BinaryManifestView const v(asBytes(out.contents));
+        CHECK(v.algorithm() == BinaryManifestAlgorithm::Crc32);
+        REQUIRE(v.size() == 3);
+        CHECK(!v.hasStamps());
+        CHECK(v.path(0) == u8"some/example/path");
+        CHECK(v.path(1) == u8"some_file.rar");
+        CHECK(v.path(2) == u8"another_file.txt");
+        CHECK(v.digestBytes(0).size() == 4);
+        CHECK(v.digestBytes(0)[0] == std::byte{ 0xa1 });
+        CHECK(v.digestBytes(0)[3] == std::byte{ 0xd4 });
+        CHECK((v.digest(1) == p->digestFromString(u8"0000ffff")));
+        CHECK(!v.stamp(0));
+        CHECK(!v.hasExpectedSizes());
+        CHECK(v.expectedSize(0) == -1);
+        CHECK(v.find(u8"some/example/path") == 0);
+        CHECK(v.find(u8"some_file.rar") == 1);
+        CHECK(v.find(u8"another_file.txt") == 2);
+        CHECK(!v.find(u8"missing_file"));
+        CHECK(!v.find(u8""));
+        CHECK(!v.find(u8"zzz"));
+    }
+    SECTION("Stamps") {
+        StampFile stamps;
+        stamps.setStamp(u8"some_file.rar", FileStamp{ .size = 42, .modification_time = -5 });
+        TestOutput out;
+        quicker_sfv::writeBinaryManifest(out, f, BinaryManifestAlgorithm::Crc32, &stamps);
+        BinaryManifestView const v(asBytes(out.contents));
+        CHECK(v.hasStamps());
+        CHECK(!v.stamp(0));
+        CHECK(v.stamp(1) == FileStamp{ .size = 42, .modification_time = -5 });
+        CHECK(!v.stamp(2));
+    }
+    SECTION("Expected sizes") {
+        f.addExpectedSize(u8"some/example/path", 4096);
+        f.addExpectedSize(u8"another_file.txt", 0);
+        f.resolveExpectedSizes();
+        TestOutput out;
+        p->writeNewFile(out, f);
+        BinaryManifestView const v(asBytes(out.contents));
+        CHECK(v.hasExpectedSizes());
+        CHECK(v.expectedSize(0) == 4096);
+        CHECK(v.expectedSize(1) == -1);
+        CHECK(v.expectedSize(2) == 0);
+        TestInput in;
+        in.contents = out.contents;
+        ChecksumFile const f_bin = p->readFromFile(in);
+        REQUIRE(f_bin.getEntries().size() == 3);
+        CHECK(f_bin.getEntries()[0].expected_size == 4096);
+        CHECK(f_bin.getEntries()[1].expected_size == -1);
+        CHECK(f_bin.getEntries()[2].expected_size == 0);
+        SECTION("Together with stamps") {
+            StampFile stamps;
+            stamps.setStamp(u8"some_file.rar", FileStamp{ .size = 42, .modification_time = -5 });
+            TestOutput stamped_out;
+            quicker_sfv::writeBinaryManifest(stamped_out, f, BinaryManifestAlgorithm::Crc32, &stamps);
+            BinaryManifestView const v_stamped(asBytes(stamped_out.contents));
+            CHECK(v_stamped.stamp(1) == FileStamp{ .size = 42, .modification_time = -5 });
+            CHECK(v_stamped.expectedSize(0) == 4096);
+            CHECK(v_stamped.expectedSize(1) == -1);
+            CHECK(v_stamped.path(2) == u8"another_file.txt");
+        }
+        SECTION("Out of range") {
+            std::vector<char> data = out.contents;
+            // most significant byte of the first expected size
+            uint64_t offset = 0;
+            std::memcpy(&offset, data.data() + 64, sizeof(offset));
+            data[offset + 7] = static_cast<char>(0x80);
+            BinaryManifestView const v_corrupt(asBytes(data));
+            CHECK_THROWS_AS(v_corrupt.expectedSize(0), quicker_sfv::Exception);
+        }
+    }
+    SECTION("Version 1 manifests") {
+        TestOutput out;
+        p->writeNewFile(out, f);
+        // drop the expected size table offset from the header and shift all offsets accordingly
+        std::vector<char> data = out.contents;
+        data.erase(data.begin() + 64, data.begin() + 72);
+        data[8] = 1;
+        for (std::size_t field : { 32, 40, 48, 64 }) {
+            uint64_t offset = 0;
+            std::memcpy(&offset, data.data() + field, sizeof(offset));
+            offset -= 8;
+            std::memcpy(data.data() + field, &offset, sizeof(offset));
+        }
+        BinaryManifestView const v(asBytes(data));
+        REQUIRE(v.size() == 3);
+        CHECK(!v.hasExpectedSizes());
+        CHECK(v.path(1) == u8"some_file.rar");
+        CHECK((v.digest(1) == p->digestFromString(u8"0000ffff")));
+        CHECK(v.find(u8"another_file.txt") == 2);
+        SECTION("Expected size flag is unknown") {
+            data[20] = 0x02;
+            CHECK_THROWS_AS(BinaryManifestView(asBytes(data)), quicker_sfv::Exception);
+        }
+    }
+    SECTION("Lossless conversion from and to sfv") {
+        auto p_sfv = quicker_sfv::createSfvProvider();
+        TestInput sfv_in;
+        sfv_in = "some/example/path a1b2c3d4"  "\n"
+                 "some_file.rar 0000ffff"      "\n"
+                 "another_file.txt 12345678"   "\n";
+        ChecksumFile const f_sfv = p_sfv->readFromFile(sfv_in);
+        TestOutput bin_out;
+        p->writeNewFile(bin_out, f_sfv);
+        TestInput bin_in;
+        bin_in.contents = bin_out.contents;
+        ChecksumFile const f_bin = p->readFromFile(bin_in);
+        TestOutput sfv_out;
+        p_sfv->writeNewFile(sfv_out, f_bin);
+        CHECK(sfv_out.contents == sfv_in.contents);
+    }
+    SECTION("Lossless conversion from and to md5") {
+        auto p_md5_text = quicker_sfv::createMD5Provider();
+        TestInput md5_in;
+        md5_in = "14d739518e715e6e61c19eb05f58a8da *some/example/path" "\n"
+                 "93b885adfe0da089cdf634904fd59f71 *some_file.rar"     "\n";
+        ChecksumFile const f_md5 = p_md5_text->readFromFile(md5_in);
+        TestOutput bin_out;
+        p_md5->writeNewFile(bin_out, f_md5);
+        TestInput bin_in;
+        bin_in.contents = bin_out.contents;
+        ChecksumFile const f_bin = p_md5->readFromFile(bin_in);
+        TestOutput md5_out;
+        p_md5_text->writeNewFile(md5_out, f_bin);
+        CHECK(md5_out.contents == md5_in.contents);
+        SECTION("Algorithm mismatch") {
+            TestInput mismatch_in;
+            mismatch_in.contents = bin_out.contents;
+            CHECK_THROWS_AS(p->readFromFile(mismatch_in), quicker_sfv::Exception);
+        }
+    }
+    SECTION("Empty manifest") {
+        TestOutput out;
+        p->writeNewFile(out, ChecksumFile{});
+        BinaryManifestView const v(asBytes(out.contents));
+        CHECK(v.size() == 0);
+        CHECK(!v.find(u8"a"));
+    }
+    SECTION("Unrepresentable checksum files") {
+        TestOutput out;
+        SECTION("Partial file") {
+            ChecksumFile f_partial;
+            f_partial.addEntry(p->digestFromString(u8"a1b2c3d4"), u8"a",
+                               { ChecksumFile::DataPortion{ .path = u8"a", .data_offset = 0, .data_size = 5 } });
+            CHECK_THROWS_AS(p->writeNewFile(out, f_partial), quicker_sfv::Exception);
+        }
+        SECTION("Digest of wrong algorithm") {
+            CHECK_THROWS_AS(p_md5->writeNewFile(out, f), quicker_sfv::Exception);
+        }
+    }
+    SECTION("Invalid manifests") {
+        TestOutput out;
+        p->writeNewFile(out, f);
+        std::vector<char> data = out.contents;
+        SECTION("Truncated header") {
+            data.resize(40);
+            CHECK_THROWS_AS(BinaryManifestView(asBytes(data)), quicker_sfv::Exception);
+        }
+        SECTION("Truncated tables") {
+            data.resize(100);
+            CHECK_THROWS_AS(BinaryManifestView(asBytes(data)), quicker_sfv::Exception);
+        }
+        SECTION("Bad magic") {
+            data[0] = 'X';
+            CHECK_THROWS_AS(BinaryManifestView(asBytes(data)), quicker_sfv::Exception);
+        }
+        SECTION("Unknown version") {
+            data[8] = 3;
+            CHECK_THROWS_AS(BinaryManifestView(asBytes(data)), quicker_sfv::Exception);
+        }
+        SECTION("Path out of bounds") {
+            // length of the first path table entry
+            data[88 + 8] = 100;
+            BinaryManifestView const v(asBytes(data));
+            CHECK_THROWS_AS(v.path(0), quicker_sfv::Exception);
+        }
+        SECTION("Corrupt sorted index") {
+            // first entry of the sorted index
+            data[136] = 7;
+            BinaryManifestView const v(asBytes(data));
+            CHECK_THROWS_AS(v.find(u8"some/example/path"), quicker_sfv::Exception);
+        }
+    }
+}
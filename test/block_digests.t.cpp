@@ -0,0 +1,183 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/block_digests.hpp>
+
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/sfv_provider.hpp>
+
+#include <test_file_io.hpp>
+
+#include <catch.hpp>
+
+#include <string_view>
+
+namespace {
+std::vector<char> vecFromString(char const* str) {
+    std::vector<char> ret;
+    ret.insert(ret.end(), str, str + strlen(str));
+    return ret;
+}
+
+std::span<std::byte const> bytes(std::string_view str) {
+    return std::span<std::byte const>(reinterpret_cast<std::byte const*>(str.data()), str.size());
+}
+
+std::vector<std::u8string> toStrings(std::span<quicker_sfv::Digest const> digests) {
+    std::vector<std::u8string> ret;
+    for (auto const& d : digests) { ret.push_back(d.toString()); }
+    return ret;
+}
+}
+
+TEST_CASE("Block Digests")
+{
+    using quicker_sfv::BlockDigestBuilder;
+    using quicker_sfv::BlockDigests;
+    using quicker_sfv::BlockRange;
+    using quicker_sfv::Digest;
+
+    auto const provider = quicker_sfv::createSfvProvider();
+    auto const hasher = provider->createHasher(quicker_sfv::HasherOptions{});
+    auto const crc = [&provider](std::u8string_view str) { return provider->digestFromString(str); };
+
+    SECTION("Block digest builder") {
+        CHECK_THROWS_AS(BlockDigestBuilder(*hasher, 0), quicker_sfv::Exception);
+        BlockDigestBuilder builder(*hasher, 9);
+        SECTION("Empty input has no blocks") {
+            CHECK(builder.finalize().empty());
+        }
+        SECTION("Chunks are split at block boundaries") {
+            builder.addData(bytes("1234"));
+            builder.addData(bytes("56789123"));
+            builder.addData(bytes("456789abc"));
+            auto const blocks = builder.finalize();
+            CHECK(toStrings(blocks) == std::vector<std::u8string>{ u8"cbf43926", u8"cbf43926", u8"352441c2" });
+            SECTION("Builder can be reused after finalize") {
+                builder.addData(bytes("123456789"));
+                CHECK(toStrings(builder.finalize()) == std::vector<std::u8string>{ u8"cbf43926" });
+            }
+        }
+    }
+    SECTION("Block geometry") {
+        CHECK_THROWS_AS(BlockDigests(0), quicker_sfv::Exception);
+        BlockDigests b(10);
+        CHECK(b.getBlockSize() == 10);
+        CHECK(BlockDigests{}.getBlockSize() == 64ull * 1024 * 1024);
+        CHECK(b.blockCount(0) == 0);
+        CHECK(b.blockCount(1) == 1);
+        CHECK(b.blockCount(10) == 1);
+        CHECK(b.blockCount(11) == 2);
+        CHECK(b.blockRange(25, 0) == BlockRange{ .offset = 0, .size = 10 });
+        CHECK(b.blockRange(25, 2) == BlockRange{ .offset = 20, .size = 5 });
+        uint64_t const indices[] = { 0, 2, 3, 5 };
+        CHECK(b.toRanges(55, indices) == std::vector<BlockRange>{ { 0, 10 }, { 20, 20 }, { 50, 5 } });
+    }
+    SECTION("Setting files") {
+        BlockDigests b(10);
+        b.setFile(u8"a", 15, { crc(u8"00000001"), crc(u8"00000002") });
+        b.setFile(u8"empty", 0, {});
+        CHECK_THROWS_AS(b.setFile(u8"b", 15, { crc(u8"00000001") }), quicker_sfv::Exception);
+        CHECK(b.size() == 2);
+        REQUIRE(b.getFile(u8"a"));
+        CHECK(b.getFile(u8"a")->file_size == 15);
+        CHECK(toStrings(b.getFile(u8"a")->blocks) == std::vector<std::u8string>{ u8"00000001", u8"00000002" });
+        CHECK(!b.getFile(u8"b"));
+    }
+    SECTION("Damaged ranges") {
+        BlockDigests b(10);
+        BlockDigests::File const expected{
+            .file_size = 35,
+            .blocks = { crc(u8"00000001"), crc(u8"00000002"), crc(u8"00000003"), crc(u8"00000004") }
+        };
+        std::vector<Digest> actual = expected.blocks;
+        CHECK(b.findDamagedRanges(expected, actual).empty());
+        actual[1] = crc(u8"ffffffff");
+        actual[2] = crc(u8"ffffffff");
+        CHECK(b.findDamagedRanges(expected, actual) == std::vector<BlockRange>{ { 10, 20 } });
+        actual.pop_back();
+        CHECK(b.findDamagedRanges(expected, actual) == std::vector<BlockRange>{ { 10, 25 } });
+        actual = expected.blocks;
+        actual.push_back(crc(u8"00000005"));
+        CHECK(b.findDamagedRanges(expected, actual) == std::vector<BlockRange>{ { 35, 0 } });
+    }
+    SECTION("Audit sampling") {
+        CHECK(quicker_sfv::selectAuditBlocks(4, 10, 42) == std::vector<uint64_t>{ 0, 1, 2, 3 });
+        CHECK(quicker_sfv::selectAuditBlocks(0, 10, 42).empty());
+        auto const sample = quicker_sfv::selectAuditBlocks(1000, 16, 42);
+        CHECK(sample.size() == 16);
+        CHECK(std::ranges::is_sorted(sample));
+        CHECK(std::ranges::adjacent_find(sample) == sample.end());
+        CHECK(sample.back() < 1000);
+        CHECK(quicker_sfv::selectAuditBlocks(1000, 16, 42) == sample);
+        CHECK(quicker_sfv::selectAuditBlocks(1000, 16, 43) != sample);
+    }
+    SECTION("Write Block Digests") {
+        BlockDigests b(10);
+        b.setFile(u8"some/example path", 15, { crc(u8"0000000a"), crc(u8"0000000b") });
+        b.setFile(u8"empty file", 0, {});
+        TestOutput out;
+        SECTION("Normal Output") {
+            b.writeToFile(out);
+            CHECK(out.contents == vecFromString(
+                "blocksize 10"                              "\n"
+                "0 - empty file"                            "\n"
+                "15 0000000a,0000000b some/example path"    "\n"));
+        }
+        SECTION("Fault during write") {
+            out.fault_after = 20;
+            CHECK_THROWS_AS(b.writeToFile(out), quicker_sfv::Exception);
+        }
+    }
+    SECTION("Read Block Digests") {
+        TestInput in;
+        SECTION("Valid file") {
+            in.contents = vecFromString(
+                "; comment\r\n"
+                "blocksize 10\r\n"
+                "0 - empty file\r\n"
+                "\r\n"
+                "15 0000000A,0000000b some/example path\n");
+            BlockDigests const b = BlockDigests::readFromFile(in, *provider);
+            CHECK(b.getBlockSize() == 10);
+            CHECK(b.size() == 2);
+            REQUIRE(b.getFile(u8"empty file"));
+            CHECK(b.getFile(u8"empty file")->blocks.empty());
+            REQUIRE(b.getFile(u8"some/example path"));
+            CHECK(toStrings(b.getFile(u8"some/example path")->blocks) ==
+                  std::vector<std::u8string>{ u8"0000000a", u8"0000000b" });
+        }
+        SECTION("Missing block size") {
+            in.contents = vecFromString("15 0000000a,0000000b file\n");
+            CHECK_THROWS_AS(BlockDigests::readFromFile(in, *provider), quicker_sfv::Exception);
+        }
+        SECTION("Empty file") {
+            in.contents = vecFromString("; nothing\n");
+            CHECK_THROWS_AS(BlockDigests::readFromFile(in, *provider), quicker_sfv::Exception);
+        }
+        SECTION("Wrong number of blocks") {
+            in.contents = vecFromString("blocksize 10\n25 0000000a,0000000b file\n");
+            CHECK_THROWS_AS(BlockDigests::readFromFile(in, *provider), quicker_sfv::Exception);
+        }
+        SECTION("Invalid digest") {
+            in.contents = vecFromString("blocksize 10\n15 0000000a,xyz file\n");
+            CHECK_THROWS_AS(BlockDigests::readFromFile(in, *provider), quicker_sfv::Exception);
+        }
+    }
+}
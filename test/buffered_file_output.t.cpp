@@ -0,0 +1,133 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/buffered_file_output.hpp>
+
+#include <quicker_sfv/checksum_file.hpp>
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/sfv_provider.hpp>
+
+#include <test_file_io.hpp>
+
+#include <catch.hpp>
+
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace {
+std::span<std::byte const> asBytes(std::string_view s) {
+    return std::as_bytes(std::span<char const>(s));
+}
+
+struct VectoredTestOutput : public TestOutput {
+    size_t vectored_write_calls = 0;
+
+    void writeVectored(std::span<std::span<std::byte const> const> buffers) override {
+        ++vectored_write_calls;
+        for (auto const& b : buffers) { TestOutput::write(b); }
+    }
+};
+
+std::string toString(std::vector<char> const& v) {
+    return std::string(v.begin(), v.end());
+}
+}
+
+TEST_CASE("Buffered File Output")
+{
+    using quicker_sfv::BufferedFileOutput;
+
+    VectoredTestOutput out;
+
+    SECTION("Small writes are coalesced") {
+        BufferedFileOutput b(out, 16);
+        b.write(asBytes("abc"));
+        b.write(asBytes("defgh"));
+        CHECK(out.write_calls == 0);
+        b.flush();
+        CHECK(out.write_calls == 1);
+        CHECK(toString(out.contents) == "abcdefgh");
+        b.flush();
+        CHECK(out.write_calls == 1);
+    }
+    SECTION("Full buffer is flushed") {
+        BufferedFileOutput b(out, 8);
+        b.write(asBytes("abcde"));
+        b.write(asBytes("fghij"));
+        CHECK(out.write_calls == 1);
+        CHECK(toString(out.contents) == "abcde");
+        b.flush();
+        CHECK(toString(out.contents) == "abcdefghij");
+    }
+    SECTION("Large writes are passed on together with buffered data") {
+        BufferedFileOutput b(out, 8);
+        b.write(asBytes("ab"));
+        b.write(asBytes("0123456789"));
+        CHECK(out.vectored_write_calls == 1);
+        CHECK(toString(out.contents) == "ab0123456789");
+        b.write(asBytes("ABCDEFGHIJ"));
+        CHECK(out.vectored_write_calls == 2);
+        CHECK(out.write_calls == 3);
+        CHECK(toString(out.contents) == "ab0123456789ABCDEFGHIJ");
+        b.flush();
+        CHECK(out.write_calls == 3);
+    }
+    SECTION("Reserve and commit") {
+        BufferedFileOutput b(out, 8);
+        std::span<std::byte> space = b.reserve(3);
+        REQUIRE(space.size() >= 3);
+        std::memcpy(space.data(), "xyz", 3);
+        b.commit(3);
+        space = b.reserve(6);
+        CHECK(out.write_calls == 1);
+        REQUIRE(space.size() >= 6);
+        std::memcpy(space.data(), "123456", 6);
+        b.commit(6);
+        space = b.reserve(20);
+        REQUIRE(space.size() >= 20);
+        std::memcpy(space.data(), "a", 1);
+        b.commit(1);
+        b.flush();
+        CHECK(toString(out.contents) == "xyz123456a");
+    }
+    SECTION("Write errors are propagated") {
+        out.fault_after = 4;
+        BufferedFileOutput b(out, 8);
+        b.write(asBytes("abcde"));
+        CHECK_THROWS_AS(b.flush(), quicker_sfv::Exception);
+    }
+}
+
+TEST_CASE("Large manifests are written with few writes")
+{
+    quicker_sfv::ChecksumFile f;
+    auto const sfv = quicker_sfv::createSfvProvider();
+    for (int i = 0; i < 200'000; ++i) {
+        std::u8string const path = u8"some/directory/file_" + std::u8string(reinterpret_cast<char8_t const*>(std::to_string(i).c_str()));
+        f.addEntry(path, sfv->digestFromString(u8"b0c3bbc7"));
+    }
+    TestOutput out;
+    sfv->writeNewFile(out, f);
+    CHECK(out.write_idx > 6 * quicker_sfv::BufferedFileOutput::DEFAULT_BUFFER_SIZE / 4);
+    CHECK(out.write_calls <= 3);
+    std::string_view const contents(out.contents.data(), out.contents.size());
+    CHECK(contents.starts_with("some/directory/file_0 b0c3bbc7\nsome/directory/file_1 b0c3bbc7\n"));
+    CHECK(contents.ends_with("some/directory/file_199999 b0c3bbc7\n"));
+}
@@ -23,6 +23,8 @@
 
 #include <catch.hpp>
 
+#include <vector>
+
 TEST_CASE("Checksum File")
 {
     using quicker_sfv::ChecksumFile;
@@ -99,4 +101,47 @@ TEST_CASE("Checksum File")
         CHECK(f.getEntries()[0].data[2].data_offset == 102);
         CHECK(f.getEntries()[0].data[2].data_size == 333);
     }
+    SECTION("Expected sizes")
+    {
+        ChecksumFile f;
+        f.addExpectedSize(u8"c", 5);
+        f.addEntry(u8"a", TestDigest{ u8"123456" });
+        f.addEntry(u8"b", TestDigest{ u8"7890ab" });
+        f.addEntry(u8"c", TestDigest{ u8"cdef01" });
+        f.addEntry(TestDigest{ u8"23456789" }, u8"d", { ChecksumFile::DataPortion{ u8"d", 0, 10 } });
+        f.addEntry(u8"e", TestDigest{ u8"abcdef" });
+        f.addExpectedSize(u8"a", 42);
+        f.addExpectedSize(u8"d", 10);
+        f.addExpectedSize(u8"x", 99);
+        f.addExpectedSize(u8"e", 7);
+        f.addExpectedSize(u8"e", 5);
+        CHECK(f.getEntries()[0].expected_size == -1);
+        f.resolveExpectedSizes();
+        REQUIRE(f.getEntries().size() == 5);
+        CHECK(f.getEntries()[0].expected_size == 42);
+        CHECK(f.getEntries()[1].expected_size == -1);
+        CHECK(f.getEntries()[2].expected_size == 5);
+        // only entries hashing an entire file get a size
+        CHECK(f.getEntries()[3].expected_size == -1);
+        CHECK(f.getEntries()[4].expected_size == 5);
+
+        CHECK(f.getEntryOrderByExpectedSize() == std::vector<std::size_t>{ 2, 4, 0, 1, 3 });
+        // the entries themselves keep their order
+        CHECK(f.getEntries()[0].display == u8"a");
+        CHECK(f.getEntries()[4].display == u8"e");
+    }
+    SECTION("Expected sizes are kept when appending")
+    {
+        ChecksumFile f1;
+        f1.addExpectedSize(u8"b", 12);
+        f1.addEntry(u8"a", TestDigest{ u8"123456" });
+        ChecksumFile f2;
+        f2.addEntry(u8"b", TestDigest{ u8"7890ab" });
+        f2.addExpectedSize(u8"a", 34);
+        f1.append(std::move(f2));
+        f1.resolveExpectedSizes();
+        REQUIRE(f1.getEntries().size() == 2);
+        CHECK(f1.getEntries()[0].expected_size == 34);
+        CHECK(f1.getEntries()[1].expected_size == 12);
+    }
 }
@@ -0,0 +1,104 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/checksum_file_update.hpp>
+
+#include <test_digest.hpp>
+
+#include <catch.hpp>
+
+TEST_CASE("Checksum File Update")
+{
+    using quicker_sfv::ChecksumFile;
+    using quicker_sfv::ChecksumFileUpdate;
+    using quicker_sfv::Digest;
+    using quicker_sfv::FileStamp;
+    using quicker_sfv::StampFile;
+
+    ChecksumFile previous;
+    previous.addEntry(u8"a", TestDigest{ u8"123456" });
+    previous.addEntry(u8"b", TestDigest{ u8"7890ab" });
+    previous.addEntry(u8"c", TestDigest{ u8"cdef01" });
+    previous.addEntry(TestDigest{ u8"234567" }, u8"d", { ChecksumFile::DataPortion{ u8"d", 0, 100 } });
+    StampFile previous_stamps;
+    previous_stamps.setStamp(u8"a", FileStamp{ .size = 1, .modification_time = 10 });
+    previous_stamps.setStamp(u8"b", FileStamp{ .size = 2, .modification_time = 20 });
+    previous_stamps.setStamp(u8"d", FileStamp{ .size = 4, .modification_time = 40 });
+
+    SECTION("Unchanged files") {
+        ChecksumFileUpdate u(previous, previous_stamps);
+        Digest const* d = u.findUnchanged(u8"a", FileStamp{ .size = 1, .modification_time = 10 });
+        REQUIRE(d);
+        CHECK((*d == Digest{ TestDigest{ u8"123456" } }));
+        d = u.findUnchanged(u8"b", FileStamp{ .size = 2, .modification_time = 20 });
+        REQUIRE(d);
+        CHECK((*d == Digest{ TestDigest{ u8"7890ab" } }));
+    }
+    SECTION("Changed files") {
+        ChecksumFileUpdate u(previous, previous_stamps);
+        CHECK(!u.findUnchanged(u8"a", FileStamp{ .size = 2, .modification_time = 10 }));
+        CHECK(!u.findUnchanged(u8"a", FileStamp{ .size = 1, .modification_time = 11 }));
+    }
+    SECTION("Files without stamps are always hashed") {
+        ChecksumFileUpdate u(previous, previous_stamps);
+        CHECK(!u.findUnchanged(u8"c", FileStamp{ .size = 3, .modification_time = 30 }));
+        ChecksumFileUpdate u_no_stamps(previous, StampFile{});
+        CHECK(!u_no_stamps.findUnchanged(u8"a", FileStamp{ .size = 1, .modification_time = 10 }));
+    }
+    SECTION("New files are always hashed") {
+        ChecksumFileUpdate u(previous, previous_stamps);
+        CHECK(!u.findUnchanged(u8"e", FileStamp{ .size = 1, .modification_time = 10 }));
+    }
+    SECTION("Partial entries are never carried over") {
+        ChecksumFileUpdate u(previous, previous_stamps);
+        CHECK(!u.findUnchanged(u8"d", FileStamp{ .size = 4, .modification_time = 40 }));
+    }
+    SECTION("Merging results") {
+        ChecksumFileUpdate u(previous, previous_stamps);
+        FileStamp const stamp_a{ .size = 1, .modification_time = 10 };
+        FileStamp const stamp_b{ .size = 5, .modification_time = 50 };
+        FileStamp const stamp_e{ .size = 6, .modification_time = 60 };
+        Digest const* d = u.findUnchanged(u8"a", stamp_a);
+        REQUIRE(d);
+        u.addEntry(u8"a", stamp_a, *d);
+        u.addEntry(u8"b", stamp_b, TestDigest{ u8"ffffff" });
+        u.addEntry(u8"e", stamp_e, TestDigest{ u8"eeeeee" });
+
+        ChecksumFile const& f = u.getChecksumFile();
+        REQUIRE(f.getEntries().size() == 3);
+        CHECK(f.getEntries()[0].display == u8"a");
+        CHECK((f.getEntries()[0].digest == Digest{ TestDigest{ u8"123456" } }));
+        CHECK(f.getEntries()[1].display == u8"b");
+        CHECK((f.getEntries()[1].digest == Digest{ TestDigest{ u8"ffffff" } }));
+        CHECK(f.getEntries()[2].display == u8"e");
+        CHECK((f.getEntries()[2].digest == Digest{ TestDigest{ u8"eeeeee" } }));
+
+        StampFile const& s = u.getStampFile();
+        CHECK(s.size() == 3);
+        CHECK(s.getStamp(u8"a") == stamp_a);
+        CHECK(s.getStamp(u8"b") == stamp_b);
+        CHECK(s.getStamp(u8"e") == stamp_e);
+
+        ChecksumFileUpdate::Statistics const stats = u.getStatistics();
+        CHECK(stats.unchanged == 1);
+        CHECK(stats.modified == 1);
+        CHECK(stats.added == 1);
+        CHECK(stats.removed == 2);
+    }
+}
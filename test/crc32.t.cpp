@@ -52,6 +52,45 @@ TEST_CASE("CRC32")
         CHECK(hasher.finalize().toString() == u8"b0c3bbc7");
     }
 
+    SECTION("Copying digests") {
+        Crc32Hasher hasher{ quicker_sfv::HasherOptions{} };
+        quicker_sfv::Digest d = hasher.finalize();
+        quicker_sfv::Digest const empty;
+        quicker_sfv::Digest copy = d;
+        CHECK((copy == d));
+        d = empty;
+        CHECK((d == empty));
+        CHECK(d.toString().empty());
+        d = copy;
+        CHECK(d.toString() == u8"00000000");
+    }
+
+    SECTION("Saved state") {
+        std::byte const data[] = {
+            std::byte{ 0x1a }, std::byte{ 0x2b }, std::byte{ 0x3c },
+            std::byte{ 0x4f }, std::byte{ 0x5a }, std::byte{ 0x6b },
+            std::byte{ 0x7c }, std::byte{ 0x8d }, std::byte{ 0x9e }
+        };
+        Crc32Hasher hasher{ quicker_sfv::HasherOptions{} };
+        CHECK(hasher.supportsSavedState());
+        hasher.addData(std::span<std::byte const>(data, data + 5));
+        std::vector<std::byte> const state = hasher.saveState();
+        CHECK(state.size() == 8);
+        CHECK(hasher.finalize().toString() == u8"4a6fa7d5");
+
+        Crc32Hasher resumed{ quicker_sfv::HasherOptions{} };
+        resumed.restoreState(state);
+        resumed.addData(std::span<std::byte const>(data + 5, data + sizeof(data)));
+        CHECK(resumed.finalize().toString() == u8"b0c3bbc7");
+
+        resumed.reset();
+        CHECK_THROWS_AS(resumed.restoreState(std::span<std::byte const>(state).first(7)), quicker_sfv::Exception);
+        std::vector<std::byte> bad_tag = state;
+        bad_tag[0] = std::byte{ 'X' };
+        CHECK_THROWS_AS(resumed.restoreState(bad_tag), quicker_sfv::Exception);
+        CHECK(resumed.finalize().toString() == u8"00000000");
+    }
+
     SECTION("Digest from string") {
         CHECK(Crc32Hasher::digestFromString(u8"b0c3bbc7").toString() == u8"b0c3bbc7");
         CHECK(Crc32Hasher::digestFromString(u8"01234567").toString() == u8"01234567");
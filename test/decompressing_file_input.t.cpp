@@ -0,0 +1,269 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/decompressing_file_input.hpp>
+
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/line_reader.hpp>
+#include <quicker_sfv/sfv_provider.hpp>
+
+#include <test_file_io.hpp>
+
+#include <catch.hpp>
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace {
+/// "a.bin 01234567\nb.bin 89abcdef\n" repeated 12000 times, compressed with gzip.
+unsigned char const GZIP_SFV[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xed, 0xc9, 0xb9, 0x09, 0x80, 0x40,
+    0x10, 0x00, 0xc0, 0xfc, 0xaa, 0xb0, 0x02, 0xf1, 0x7f, 0xca, 0xd9, 0x3d, 0x15, 0x4c, 0xec, 0x3f,
+    0x14, 0x6c, 0xc1, 0x74, 0xc2, 0x61, 0xa2, 0xcd, 0xfb, 0x69, 0xba, 0x7e, 0x18, 0xa7, 0x79, 0x59,
+    0x4b, 0x7e, 0xdc, 0xf6, 0xc8, 0x7a, 0x9c, 0x57, 0x09, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad,
+    0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5,
+    0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6,
+    0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a,
+    0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b,
+    0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad,
+    0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5,
+    0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6,
+    0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a,
+    0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b,
+    0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad,
+    0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5,
+    0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6,
+    0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a,
+    0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b,
+    0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad,
+    0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5,
+    0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6,
+    0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a,
+    0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b,
+    0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad,
+    0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5,
+    0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6,
+    0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a,
+    0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b,
+    0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad,
+    0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5,
+    0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6,
+    0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a,
+    0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b,
+    0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad,
+    0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5,
+    0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6,
+    0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a,
+    0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b,
+    0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad,
+    0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5,
+    0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6,
+    0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a,
+    0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b,
+    0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad,
+    0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5,
+    0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6,
+    0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a,
+    0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b,
+    0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad,
+    0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5,
+    0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6,
+    0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a,
+    0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b,
+    0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad,
+    0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5,
+    0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6,
+    0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a,
+    0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b, 0xad, 0xb5, 0xd6, 0x5a, 0x6b,
+    0xed, 0x8f, 0x7d, 0x01, 0x0c, 0xa2, 0xa7, 0xd4, 0x40, 0x7e, 0x05, 0x00,
+};
+/// Two concatenated gzip members with the contents "part one\n" and "part two\n".
+unsigned char const GZIP_MULTI_MEMBER[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x2b, 0x48, 0x2c, 0x2a, 0x51, 0xc8,
+    0xcf, 0x4b, 0xe5, 0x02, 0x00, 0x0c, 0xa1, 0x3d, 0xf9, 0x09, 0x00, 0x00, 0x00, 0x1f, 0x8b, 0x08,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x2b, 0x48, 0x2c, 0x2a, 0x51, 0x28, 0x29, 0xcf, 0xe7,
+    0x02, 0x00, 0xe7, 0x01, 0x3d, 0x97, 0x09, 0x00, 0x00, 0x00,
+};
+/// A single zstd frame with the contents "hello zstd\n", stored in a raw block.
+unsigned char const ZSTD_RAW_FRAME[] = {
+    0x28, 0xb5, 0x2f, 0xfd, 0x20, 0x0b, 0x59, 0x00, 0x00,
+    'h', 'e', 'l', 'l', 'o', ' ', 'z', 's', 't', 'd', '\n',
+};
+
+template<std::size_t N>
+void setContents(TestInput& in, unsigned char const (&data)[N]) {
+    in.contents.assign(reinterpret_cast<char const*>(data), reinterpret_cast<char const*>(data) + N);
+}
+
+std::string readAll(quicker_sfv::FileInput& in, std::size_t read_size) {
+    std::string ret;
+    std::vector<std::byte> buffer(read_size);
+    for (;;) {
+        std::size_t const bytes_read = in.read(buffer);
+        if (bytes_read == quicker_sfv::FileInput::RESULT_END_OF_FILE) { break; }
+        ret.append(reinterpret_cast<char const*>(buffer.data()), bytes_read);
+        if (bytes_read < read_size) { break; }
+    }
+    return ret;
+}
+
+std::string readSome(quicker_sfv::FileInput& in, std::size_t read_size) {
+    std::vector<std::byte> buffer(read_size);
+    std::size_t const bytes_read = in.read(buffer);
+    if (bytes_read == quicker_sfv::FileInput::RESULT_END_OF_FILE) { return {}; }
+    return std::string(reinterpret_cast<char const*>(buffer.data()), bytes_read);
+}
+
+std::string repeatedSfv() {
+    std::string ret;
+    for (int i = 0; i < 12000; ++i) { ret += "a.bin 01234567\nb.bin 89abcdef\n"; }
+    return ret;
+}
+}
+
+TEST_CASE("Decompressing File Input")
+{
+    using quicker_sfv::Compression;
+    using quicker_sfv::DecompressingFileInput;
+    using quicker_sfv::FileInput;
+
+    SECTION("Compression detection") {
+        using quicker_sfv::detectCompression;
+        auto const bytes = [](std::initializer_list<unsigned char> l) {
+            std::vector<std::byte> ret;
+            for (unsigned char const c : l) { ret.push_back(std::byte{ c }); }
+            return ret;
+        };
+        CHECK(detectCompression({}) == Compression::None);
+        CHECK(detectCompression(bytes({ 0x1f })) == Compression::None);
+        CHECK(detectCompression(bytes({ 0x1f, 0x8b })) == Compression::Gzip);
+        CHECK(detectCompression(bytes({ 0x1f, 0x8b, 0x08, 0x00 })) == Compression::Gzip);
+        CHECK(detectCompression(bytes({ 0x28, 0xb5, 0x2f })) == Compression::None);
+        CHECK(detectCompression(bytes({ 0x28, 0xb5, 0x2f, 0xfd })) == Compression::Zstd);
+        CHECK(detectCompression(bytes({ 'a', '.', 'b', 'i', 'n' })) == Compression::None);
+        CHECK(quicker_sfv::isCompressionSupported(Compression::None));
+    }
+    SECTION("Compression extensions") {
+        using quicker_sfv::stripCompressionExtension;
+        CHECK(stripCompressionExtension(u8"files.sfv.gz") == u8"files.sfv");
+        CHECK(stripCompressionExtension(u8"files.md5.zst") == u8"files.md5");
+        CHECK(stripCompressionExtension(u8"files.sfv") == u8"files.sfv");
+        CHECK(stripCompressionExtension(u8"gz") == u8"gz");
+    }
+    SECTION("Uncompressed files are passed through") {
+        for (bool const mapped : { false, true }) {
+            TestInput in;
+            in = "some_file.rar 4a6fa7d5\n";
+            in.mapped = mapped;
+            DecompressingFileInput d(in);
+            CHECK(d.compression() == Compression::None);
+            CHECK(d.current_file() == in.file_name);
+            CHECK(d.file_size() == in.contents.size());
+            CHECK(d.tell() == 0);
+            CHECK(d.mappedContents().has_value() == mapped);
+            CHECK(readAll(d, 5) == "some_file.rar 4a6fa7d5\n");
+            CHECK(d.seek(5, FileInput::SeekStart::FileStart) == 5);
+            CHECK(readAll(d, 100) == "file.rar 4a6fa7d5\n");
+        }
+    }
+    SECTION("Short uncompressed files") {
+        TestInput in;
+        in = "a";
+        DecompressingFileInput d(in);
+        CHECK(d.compression() == Compression::None);
+        CHECK(readAll(d, 16) == "a");
+        TestInput empty;
+        DecompressingFileInput d_empty(empty);
+        CHECK(d_empty.compression() == Compression::None);
+        std::array<std::byte, 4> buffer;
+        CHECK(d_empty.read(buffer) == FileInput::RESULT_END_OF_FILE);
+    }
+    SECTION("Gzip") {
+        TestInput in;
+        setContents(in, GZIP_SFV);
+        if (!quicker_sfv::isCompressionSupported(Compression::Gzip)) {
+            CHECK_THROWS_MATCHES(DecompressingFileInput(in), quicker_sfv::Exception,
+                                 Catch::Predicate<quicker_sfv::Exception>([](quicker_sfv::Exception const& e) {
+                                     return e.code() == quicker_sfv::Error::Failed; }));
+            return;
+        }
+        std::string const expected = repeatedSfv();
+        SECTION("Streaming reads") {
+            for (bool const mapped : { false, true }) {
+                for (std::size_t const read_size : { 1000, 65536, 1 << 20 }) {
+                    in.read_idx = 0;
+                    in.mapped = mapped;
+                    DecompressingFileInput d(in);
+                    CHECK(d.compression() == Compression::Gzip);
+                    CHECK(!d.mappedContents());
+                    CHECK(d.file_size() == sizeof(GZIP_SFV));
+                    CHECK(readAll(d, read_size) == expected);
+                    CHECK(d.tell() == static_cast<int64_t>(expected.size()));
+                }
+            }
+        }
+        SECTION("Parsing") {
+            DecompressingFileInput d(in);
+            quicker_sfv::ChecksumFile const f = quicker_sfv::createSfvProvider()->readFromFile(d);
+            REQUIRE(f.getEntries().size() == 24000);
+            CHECK(f.getEntries()[0].display == u8"a.bin");
+            CHECK(f.getEntries()[23999].display == u8"b.bin");
+        }
+        SECTION("Seeking") {
+            DecompressingFileInput d(in);
+            CHECK(d.seek(100'000, FileInput::SeekStart::FileStart) == 100'000);
+            CHECK(readSome(d, 15) == expected.substr(100'000, 15));
+            CHECK(d.seek(-50'000, FileInput::SeekStart::CurrentPosition) == 50'015);
+            CHECK(readSome(d, 15) == expected.substr(50'015, 15));
+            CHECK(d.seek(1'000'000, FileInput::SeekStart::FileStart) == static_cast<int64_t>(expected.size()));
+            CHECK_THROWS_AS(d.seek(0, FileInput::SeekStart::FileEnd), quicker_sfv::Exception);
+        }
+        SECTION("Concatenated members") {
+            setContents(in, GZIP_MULTI_MEMBER);
+            DecompressingFileInput d(in);
+            CHECK(readAll(d, 4) == "part one\npart two\n");
+        }
+        SECTION("Truncated data") {
+            in.contents.resize(in.contents.size() / 2);
+            DecompressingFileInput d(in);
+            CHECK_THROWS_MATCHES(readAll(d, 4096), quicker_sfv::Exception,
+                                 Catch::Predicate<quicker_sfv::Exception>([](quicker_sfv::Exception const& e) {
+                                     return e.code() == quicker_sfv::Error::FileIO; }));
+        }
+        SECTION("Corrupted data") {
+            in.contents[20] = static_cast<char>(~in.contents[20]);
+            in.contents[21] = static_cast<char>(~in.contents[21]);
+            DecompressingFileInput d(in);
+            CHECK_THROWS_AS(readAll(d, 1 << 20), quicker_sfv::Exception);
+        }
+    }
+    SECTION("Zstd") {
+        TestInput in;
+        setContents(in, ZSTD_RAW_FRAME);
+        if (!quicker_sfv::isCompressionSupported(Compression::Zstd)) {
+            CHECK_THROWS_AS(DecompressingFileInput(in), quicker_sfv::Exception);
+            return;
+        }
+        DecompressingFileInput d(in);
+        CHECK(d.compression() == Compression::Zstd);
+        CHECK(readAll(d, 4) == "hello zstd\n");
+    }
+}
@@ -0,0 +1,115 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/digest_cache.hpp>
+
+#include <quicker_sfv/md5_provider.hpp>
+#include <quicker_sfv/sfv_provider.hpp>
+
+#include <catch.hpp>
+
+#include <map>
+#include <utility>
+
+namespace {
+class TestDigestCache : public quicker_sfv::DigestCache {
+public:
+    std::map<std::pair<std::u8string, std::u8string>, std::vector<std::byte>> attributes;
+    bool fail_writes = false;
+
+    std::optional<std::vector<std::byte>> readAttribute(std::u8string_view file,
+                                                        std::u8string_view attribute_name) override {
+        auto const it = attributes.find(std::make_pair(std::u8string(file), std::u8string(attribute_name)));
+        if (it == attributes.end()) { return std::nullopt; }
+        return it->second;
+    }
+
+    bool writeAttribute(std::u8string_view file, std::u8string_view attribute_name,
+                        std::span<std::byte const> data) override {
+        if (fail_writes) { return false; }
+        attributes[std::make_pair(std::u8string(file), std::u8string(attribute_name))].assign(data.begin(), data.end());
+        return true;
+    }
+};
+}
+
+TEST_CASE("Digest Cache")
+{
+    using quicker_sfv::DigestCacheEntry;
+    using quicker_sfv::FileStamp;
+
+    SECTION("Encoding round-trip") {
+        DigestCacheEntry const entry{
+            .stamp = FileStamp{ .size = 0x0102030405060708ull, .modification_time = -42 },
+            .digest = u8"d41d8cd98f00b204e9800998ecf8427e"
+        };
+        std::vector<std::byte> const data = quicker_sfv::encodeDigestCacheEntry(entry);
+        CHECK(data.size() == 17 + 32);
+        CHECK(data[0] == std::byte{ 1 });
+        CHECK(data[1] == std::byte{ 0x08 });
+        CHECK(data[8] == std::byte{ 0x01 });
+        auto const decoded = quicker_sfv::decodeDigestCacheEntry(data);
+        REQUIRE(decoded);
+        CHECK(*decoded == entry);
+    }
+    SECTION("Decoding invalid data") {
+        std::vector<std::byte> data = quicker_sfv::encodeDigestCacheEntry(
+            DigestCacheEntry{ .stamp = FileStamp{ .size = 1, .modification_time = 2 }, .digest = u8"abcd1234" });
+        CHECK(quicker_sfv::decodeDigestCacheEntry(std::span<std::byte const>(data).first(17)) == std::nullopt);
+        CHECK(quicker_sfv::decodeDigestCacheEntry({}) == std::nullopt);
+        SECTION("Wrong version") {
+            data[0] = std::byte{ 2 };
+            CHECK(quicker_sfv::decodeDigestCacheEntry(data) == std::nullopt);
+        }
+        SECTION("Non-printable digest") {
+            data.back() = std::byte{ 0 };
+            CHECK(quicker_sfv::decodeDigestCacheEntry(data) == std::nullopt);
+        }
+    }
+    SECTION("Attribute name") {
+        CHECK(quicker_sfv::digestCacheAttributeName(*quicker_sfv::createSfvProvider()) == u8"user.quickersfv.sfv");
+        CHECK(quicker_sfv::digestCacheAttributeName(*quicker_sfv::createMD5Provider()) == u8"user.quickersfv.md5");
+    }
+    SECTION("Lookup and store") {
+        TestDigestCache cache;
+        FileStamp const stamp{ .size = 1234, .modification_time = 5678 };
+        CHECK(!cache.lookup(u8"file.bin", u8"user.quickersfv.sfv", stamp));
+        cache.store(u8"file.bin", u8"user.quickersfv.sfv", stamp, u8"CBF43926");
+        CHECK(cache.lookup(u8"file.bin", u8"user.quickersfv.sfv", stamp) == u8"CBF43926");
+        CHECK(!cache.lookup(u8"file.bin", u8"user.quickersfv.md5", stamp));
+        CHECK(!cache.lookup(u8"other.bin", u8"user.quickersfv.sfv", stamp));
+        CHECK(!cache.lookup(u8"file.bin", u8"user.quickersfv.sfv", FileStamp{ .size = 1234, .modification_time = 5679 }));
+        CHECK(!cache.lookup(u8"file.bin", u8"user.quickersfv.sfv", FileStamp{ .size = 1235, .modification_time = 5678 }));
+        SECTION("Store replaces existing entry") {
+            FileStamp const new_stamp{ .size = 1234, .modification_time = 9999 };
+            cache.store(u8"file.bin", u8"user.quickersfv.sfv", new_stamp, u8"00000000");
+            CHECK(!cache.lookup(u8"file.bin", u8"user.quickersfv.sfv", stamp));
+            CHECK(cache.lookup(u8"file.bin", u8"user.quickersfv.sfv", new_stamp) == u8"00000000");
+        }
+        SECTION("Corrupt attribute is ignored") {
+            cache.attributes.begin()->second.resize(3);
+            CHECK(!cache.lookup(u8"file.bin", u8"user.quickersfv.sfv", stamp));
+        }
+        SECTION("Failed writes are ignored") {
+            cache.fail_writes = true;
+            cache.store(u8"new.bin", u8"user.quickersfv.sfv", stamp, u8"CBF43926");
+            CHECK(!cache.lookup(u8"new.bin", u8"user.quickersfv.sfv", stamp));
+        }
+    }
+}
@@ -0,0 +1,161 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/directory_digests.hpp>
+
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/sfv_provider.hpp>
+
+#include <test_file_io.hpp>
+
+#include <catch.hpp>
+
+TEST_CASE("Directory Digests")
+{
+    using quicker_sfv::ChecksumFile;
+    using quicker_sfv::DirectoryDifference;
+    using quicker_sfv::DirectoryDigests;
+    auto p = quicker_sfv::createSfvProvider();
+    REQUIRE(p);
+    auto h = p->createHasher(quicker_sfv::HasherOptions{ .has_sse42 = false, .has_avx512 = false });
+    REQUIRE(h);
+
+    ChecksumFile f;
+    f.addEntry(u8"root_file", p->digestFromString(u8"00000001"));
+    f.addEntry(u8"a/file1", p->digestFromString(u8"00000002"));
+    f.addEntry(u8"a/file2", p->digestFromString(u8"00000003"));
+    f.addEntry(u8"a/b/file3", p->digestFromString(u8"00000004"));
+    f.addEntry(u8"c\\d\\file4", p->digestFromString(u8"00000005"));
+
+    SECTION("Directories from checksum file") {
+        DirectoryDigests const d = DirectoryDigests::fromChecksumFile(f, *h);
+        auto const dirs = d.getDirectories();
+        REQUIRE(dirs.size() == 5);
+        CHECK(dirs[0].path == u8"");
+        CHECK(dirs[1].path == u8"a");
+        CHECK(dirs[2].path == u8"a/b");
+        CHECK(dirs[3].path == u8"c");
+        CHECK(dirs[4].path == u8"c/d");
+        REQUIRE(d.getDirectory(u8"a/b"));
+        CHECK(d.getDirectory(u8"a/b")->path == u8"a/b");
+        CHECK(!d.getDirectory(u8"b"));
+        CHECK(!d.getDirectory(u8"a/b/file3"));
+        // c only contains a subdirectory
+        CHECK((d.getDirectory(u8"c")->digest != d.getDirectory(u8"c")->files_digest));
+    }
+    SECTION("Order of entries does not matter") {
+        ChecksumFile f2;
+        for (auto it = f.getEntries().rbegin(); it != f.getEntries().rend(); ++it) {
+            f2.addEntry(it->display, it->digest);
+        }
+        DirectoryDigests const d1 = DirectoryDigests::fromChecksumFile(f, *h);
+        DirectoryDigests const d2 = DirectoryDigests::fromChecksumFile(f2, *h);
+        REQUIRE(d1.getDirectories().size() == d2.getDirectories().size());
+        for (std::size_t i = 0; i < d1.getDirectories().size(); ++i) {
+            CHECK(d1.getDirectories()[i].path == d2.getDirectories()[i].path);
+            CHECK((d1.getDirectories()[i].digest == d2.getDirectories()[i].digest));
+            CHECK((d1.getDirectories()[i].files_digest == d2.getDirectories()[i].files_digest));
+        }
+        CHECK(compareDirectoryDigests(d1, d2).empty());
+    }
+    SECTION("Empty checksum file") {
+        DirectoryDigests const d = DirectoryDigests::fromChecksumFile(ChecksumFile{}, *h);
+        REQUIRE(d.getDirectories().size() == 1);
+        CHECK(d.getDirectories()[0].path == u8"");
+    }
+    SECTION("Comparison") {
+        DirectoryDigests const d1 = DirectoryDigests::fromChecksumFile(f, *h);
+        SECTION("Modified file in subdirectory") {
+            ChecksumFile f2;
+            f2.addEntry(u8"root_file", p->digestFromString(u8"00000001"));
+            f2.addEntry(u8"a/file1", p->digestFromString(u8"00000002"));
+            f2.addEntry(u8"a/file2", p->digestFromString(u8"00000003"));
+            f2.addEntry(u8"a/b/file3", p->digestFromString(u8"ffffffff"));
+            f2.addEntry(u8"c/d/file4", p->digestFromString(u8"00000005"));
+            DirectoryDigests const d2 = DirectoryDigests::fromChecksumFile(f2, *h);
+            CHECK((d1.getDirectory(u8"")->files_digest == d2.getDirectory(u8"")->files_digest));
+            CHECK((d1.getDirectory(u8"")->digest != d2.getDirectory(u8"")->digest));
+            CHECK((d1.getDirectory(u8"c")->digest == d2.getDirectory(u8"c")->digest));
+            CHECK(compareDirectoryDigests(d1, d2) == std::vector<DirectoryDifference>{
+                DirectoryDifference{ .path = u8"a/b", .kind = DirectoryDifference::Kind::Modified }
+            });
+        }
+        SECTION("Renamed file") {
+            ChecksumFile f2;
+            f2.addEntry(u8"root_file_renamed", p->digestFromString(u8"00000001"));
+            f2.addEntry(u8"a/file1", p->digestFromString(u8"00000002"));
+            f2.addEntry(u8"a/file2", p->digestFromString(u8"00000003"));
+            f2.addEntry(u8"a/b/file3", p->digestFromString(u8"00000004"));
+            f2.addEntry(u8"c/d/file4", p->digestFromString(u8"00000005"));
+            DirectoryDigests const d2 = DirectoryDigests::fromChecksumFile(f2, *h);
+            CHECK(compareDirectoryDigests(d1, d2) == std::vector<DirectoryDifference>{
+                DirectoryDifference{ .path = u8"", .kind = DirectoryDifference::Kind::Modified }
+            });
+        }
+        SECTION("Added and removed directories") {
+            ChecksumFile f2;
+            f2.addEntry(u8"root_file", p->digestFromString(u8"00000001"));
+            f2.addEntry(u8"a/file1", p->digestFromString(u8"00000002"));
+            f2.addEntry(u8"a/file2", p->digestFromString(u8"00000003"));
+            f2.addEntry(u8"a/e/file3", p->digestFromString(u8"00000004"));
+            f2.addEntry(u8"c/d/file4", p->digestFromString(u8"00000005"));
+            DirectoryDigests const d2 = DirectoryDigests::fromChecksumFile(f2, *h);
+            CHECK(compareDirectoryDigests(d1, d2) == std::vector<DirectoryDifference>{
+                DirectoryDifference{ .path = u8"a/b", .kind = DirectoryDifference::Kind::OnlyInFirst },
+                DirectoryDifference{ .path = u8"a/e", .kind = DirectoryDifference::Kind::OnlyInSecond },
+            });
+        }
+    }
+    SECTION("Write and read back") {
+        DirectoryDigests const d = DirectoryDigests::fromChecksumFile(f, *h);
+        TestOutput out;
+        d.writeToFile(out);
+        std::string_view const out_str(out.contents.data(), out.contents.size());
+        CHECK(out_str.ends_with(" c/d\n"));
+        REQUIRE(out_str.find(" .\n") != std::string_view::npos);
+        TestInput in;
+        in = out_str;
+        DirectoryDigests const d2 = DirectoryDigests::readFromFile(in, *p);
+        REQUIRE(d2.getDirectories().size() == d.getDirectories().size());
+        for (std::size_t i = 0; i < d.getDirectories().size(); ++i) {
+            CHECK(d.getDirectories()[i].path == d2.getDirectories()[i].path);
+            CHECK((d.getDirectories()[i].digest == d2.getDirectories()[i].digest));
+            CHECK((d.getDirectories()[i].files_digest == d2.getDirectories()[i].files_digest));
+        }
+        SECTION("Fault during write") {
+            TestOutput faulty_out;
+            faulty_out.fault_after = 10;
+            CHECK_THROWS_AS(d.writeToFile(faulty_out), quicker_sfv::Exception);
+        }
+    }
+    SECTION("Invalid file formats") {
+        TestInput in;
+        SECTION("Missing path") {
+            in = "01234567 89abcdef" "\n";
+        }
+        SECTION("Invalid digest") {
+            in = "0123456x 89abcdef a" "\n";
+        }
+        SECTION("Duplicate directory") {
+            in = "01234567 89abcdef a" "\n"
+                 "01234567 89abcdef a" "\n";
+        }
+        CHECK_THROWS_AS(DirectoryDigests::readFromFile(in, *p), quicker_sfv::Exception);
+    }
+}
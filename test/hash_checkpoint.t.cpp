@@ -0,0 +1,127 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/hash_checkpoint.hpp>
+
+#include <quicker_sfv/error.hpp>
+
+#include <test_file_io.hpp>
+
+#include <catch.hpp>
+
+namespace {
+std::vector<char> vecFromString(char const* str) {
+    std::vector<char> ret;
+    ret.insert(ret.end(), str, str + strlen(str));
+    return ret;
+}
+}
+
+TEST_CASE("Hash Checkpoint")
+{
+    using quicker_sfv::CheckpointFile;
+    using quicker_sfv::HashCheckpoint;
+
+    HashCheckpoint const c1{ .covered_length = 4096, .prefix_guard = { std::byte{ 0x12 }, std::byte{ 0x9f } },
+                             .state = { std::byte{ 0x43 }, std::byte{ 0xab }, std::byte{ 0x00 } } };
+    HashCheckpoint const c2{ .covered_length = 0, .prefix_guard = {}, .state = { std::byte{ 0xff } } };
+
+    SECTION("Construction") {
+        CheckpointFile f;
+        CHECK(f.size() == 0);
+        CHECK(!f.getCheckpoint(u8"a"));
+    }
+    SECTION("Setting checkpoints") {
+        CheckpointFile f;
+        f.setCheckpoint(u8"a", c1);
+        f.setCheckpoint(u8"b", c2);
+        REQUIRE(f.size() == 2);
+        CHECK(f.getCheckpoint(u8"a") == c1);
+        CHECK(f.getCheckpoint(u8"b") == c2);
+        CHECK(!f.getCheckpoint(u8"c"));
+        SECTION("Replacing checkpoints") {
+            f.setCheckpoint(u8"a", c2);
+            CHECK(f.size() == 2);
+            CHECK(f.getCheckpoint(u8"a") == c2);
+        }
+        SECTION("Clear") {
+            f.clear();
+            CHECK(f.size() == 0);
+            CHECK(!f.getCheckpoint(u8"a"));
+        }
+    }
+    SECTION("Write Checkpoint File") {
+        CheckpointFile f;
+        f.setCheckpoint(u8"logs/server log.txt", c1);
+        f.setCheckpoint(u8"archive.tar", c2);
+        TestOutput out;
+        SECTION("Normal Output") {
+            f.writeToFile(out);
+            CHECK(out.contents == vecFromString(
+                "0  ff archive.tar"                         "\n"
+                "4096 129f 43ab00 logs/server log.txt"      "\n"));
+        }
+        SECTION("Fault during write") {
+            out.fault_after = 5;
+            CHECK_THROWS_AS(f.writeToFile(out), quicker_sfv::Exception);
+        }
+    }
+    SECTION("Read Checkpoint File") {
+        TestInput in;
+        SECTION("Valid file") {
+            in.contents = vecFromString(
+                "; comment\r\n"
+                "0  FF archive.tar\r\n"
+                "\r\n"
+                "4096 129F 43ab00 logs/server log.txt\n");
+            CheckpointFile const f = CheckpointFile::readFromFile(in);
+            REQUIRE(f.size() == 2);
+            CHECK(f.getCheckpoint(u8"archive.tar") == c2);
+            CHECK(f.getCheckpoint(u8"logs/server log.txt") == c1);
+        }
+        SECTION("Missing path") {
+            in.contents = vecFromString("4096 129f 43ab00\n");
+            CHECK_THROWS_AS(CheckpointFile::readFromFile(in), quicker_sfv::Exception);
+        }
+        SECTION("Missing guard") {
+            in.contents = vecFromString("4096 43ab00 logs/server log.txt\n");
+            CHECK_THROWS_AS(CheckpointFile::readFromFile(in), quicker_sfv::Exception);
+        }
+        SECTION("Empty state") {
+            in.contents = vecFromString("4096 129f  file\n");
+            CHECK_THROWS_AS(CheckpointFile::readFromFile(in), quicker_sfv::Exception);
+        }
+        SECTION("Odd length guard") {
+            in.contents = vecFromString("4096 129 43ab00 file\n");
+            CHECK_THROWS_AS(CheckpointFile::readFromFile(in), quicker_sfv::Exception);
+        }
+        SECTION("Odd length state") {
+            in.contents = vecFromString("4096 129f 43ab0 file\n");
+            CHECK_THROWS_AS(CheckpointFile::readFromFile(in), quicker_sfv::Exception);
+        }
+        SECTION("Invalid state") {
+            in.contents = vecFromString("4096 129f 43xb00 file\n");
+            CHECK_THROWS_AS(CheckpointFile::readFromFile(in), quicker_sfv::Exception);
+        }
+        SECTION("Invalid length") {
+            in.contents = vecFromString("-1 129f 43ab00 file\n");
+            CHECK_THROWS_AS(CheckpointFile::readFromFile(in), quicker_sfv::Exception);
+        }
+    }
+}
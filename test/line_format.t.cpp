@@ -0,0 +1,172 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/line_format.hpp>
+
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/md5sum_provider.hpp>
+#include <quicker_sfv/detail/crc32.hpp>
+#include <quicker_sfv/detail/md5.hpp>
+
+#include <test_file_io.hpp>
+
+#include <catch.hpp>
+
+#include <array>
+#include <string>
+
+namespace {
+struct TestLineFormat {
+    using Hasher = quicker_sfv::detail::Crc32Hasher;
+    static constexpr quicker_sfv::DigestPosition digest_position = quicker_sfv::DigestPosition::Leading;
+    static constexpr std::size_t digest_width = 8;
+    static constexpr std::u8string_view line_prefix = u8"CRC:";
+    static constexpr std::array<std::u8string_view, 2> separators = { u8" -> ", u8" => " };
+    static constexpr std::u8string_view comment_prefix = u8"#";
+    static constexpr bool size_comments = false;
+    static constexpr std::u8string_view forbidden_path_characters = u8"|";
+    static constexpr bool lenient_whitespace = false;
+};
+static_assert(quicker_sfv::LineFormat<TestLineFormat>);
+
+std::string toString(std::vector<char> const& v) {
+    return std::string(v.begin(), v.end());
+}
+
+quicker_sfv::Digest md5Digest(std::u8string_view str) {
+    return quicker_sfv::detail::MD5Hasher::digestFromString(str);
+}
+}
+
+TEST_CASE("Line Format")
+{
+    using quicker_sfv::ChecksumFile;
+    using quicker_sfv::parseFormattedLine;
+
+    SECTION("Separator splitting") {
+        using quicker_sfv::DigestPosition;
+        using quicker_sfv::detail::splitSeparator;
+        static_assert(splitSeparator(u8" *", DigestPosition::Leading).marker == u8"*");
+        static_assert(splitSeparator(u8" *", DigestPosition::Leading).n_whitespace == 1);
+        static_assert(splitSeparator(u8") = ", DigestPosition::Trailing).marker == u8") =");
+        static_assert(splitSeparator(u8") = ", DigestPosition::Trailing).n_whitespace == 1);
+        static_assert(splitSeparator(u8"  ", DigestPosition::Leading).marker.empty());
+        static_assert(splitSeparator(u8"  ", DigestPosition::Trailing).n_whitespace == 2);
+    }
+    SECTION("Custom format") {
+        ChecksumFile f;
+        parseFormattedLine<TestLineFormat>(u8"CRC:b0c3bbc7 -> some/path", f);
+        parseFormattedLine<TestLineFormat>(u8"CRC:4a6fa7d5 => other path ", f);
+        parseFormattedLine<TestLineFormat>(u8"# comment", f);
+        parseFormattedLine<TestLineFormat>(u8"", f);
+        REQUIRE(f.getEntries().size() == 2);
+        CHECK(f.getEntries()[0].display == u8"some/path");
+        CHECK((f.getEntries()[0].digest == quicker_sfv::detail::Crc32Hasher::digestFromString(u8"b0c3bbc7")));
+        CHECK(f.getEntries()[1].display == u8"other path ");
+        CHECK_THROWS_AS(parseFormattedLine<TestLineFormat>(u8"b0c3bbc7 -> some/path", f), quicker_sfv::Exception);
+        CHECK_THROWS_AS(parseFormattedLine<TestLineFormat>(u8"CRC:b0c3bbc7 - some/path", f), quicker_sfv::Exception);
+        CHECK_THROWS_AS(parseFormattedLine<TestLineFormat>(u8"CRC:b0c3bbc7  -> some/path", f), quicker_sfv::Exception);
+        CHECK_THROWS_AS(parseFormattedLine<TestLineFormat>(u8"CRC:b0c3bbc7 -> ", f), quicker_sfv::Exception);
+        CHECK_THROWS_AS(parseFormattedLine<TestLineFormat>(u8"CRC:b0c3bbc7 -> a|b", f), quicker_sfv::Exception);
+        CHECK_THROWS_AS(parseFormattedLine<TestLineFormat>(u8"CRC:b0c3", f), quicker_sfv::Exception);
+        CHECK(f.getEntries().size() == 2);
+
+        TestOutput out;
+        quicker_sfv::writeFormattedLines<TestLineFormat>(out, f);
+        CHECK(toString(out.contents) == "CRC:b0c3bbc7 -> some/path\nCRC:4a6fa7d5 -> other path \n");
+    }
+}
+
+TEST_CASE("md5sum Provider")
+{
+    using quicker_sfv::ChecksumFile;
+    auto const p = quicker_sfv::createMD5SumProvider();
+    REQUIRE(p);
+    CHECK(p->fileExtensions() == u8"*.md5sum");
+    CHECK(p->getCapabilities() == quicker_sfv::ProviderCapabilities::Full);
+    CHECK(dynamic_cast<quicker_sfv::detail::MD5Hasher*>(p->createHasher(quicker_sfv::HasherOptions{}).get()));
+
+    SECTION("Text and binary mode") {
+        TestInput in;
+        in = "14d739518e715e6e61c19eb05f58a8da  some/example/path\n"
+             "93b885adfe0da089cdf634904fd59f71 *some_file.rar\r\n"
+             "a6e25eeaf4af08b6baf6b2e31ceccfdb  *leading star and trailing space \n";
+        ChecksumFile const f = p->readFromFile(in);
+        REQUIRE(f.getEntries().size() == 3);
+        CHECK(f.getEntries()[0].display == u8"some/example/path");
+        CHECK((f.getEntries()[0].digest == md5Digest(u8"14d739518e715e6e61c19eb05f58a8da")));
+        CHECK(f.getEntries()[1].display == u8"some_file.rar");
+        CHECK(f.getEntries()[2].display == u8"*leading star and trailing space ");
+    }
+    SECTION("Invalid lines") {
+        TestInput in;
+        SECTION("Single space") { in = "14d739518e715e6e61c19eb05f58a8da some/example/path\n"; }
+        SECTION("Missing path") { in = "14d739518e715e6e61c19eb05f58a8da  \n"; }
+        SECTION("Invalid digest") { in = "14d739518e715e6e61c19eb05f58a8dz  some/example/path\n"; }
+        SECTION("Comments") { in = "; comment\n"; }
+        CHECK_THROWS_AS(p->readFromFile(in), quicker_sfv::Exception);
+    }
+    SECTION("Write") {
+        ChecksumFile f;
+        f.addEntry(u8"some/example/path", md5Digest(u8"14d739518e715e6e61c19eb05f58a8da"));
+        TestOutput out;
+        p->writeNewFile(out, f);
+        CHECK(toString(out.contents) == "14d739518e715e6e61c19eb05f58a8da  some/example/path\n");
+    }
+}
+
+TEST_CASE("BSD-style MD5 Provider")
+{
+    using quicker_sfv::ChecksumFile;
+    auto const p = quicker_sfv::createBsdTagMD5Provider();
+    REQUIRE(p);
+    CHECK(p->fileExtensions() == u8"*.md5tag");
+
+    SECTION("Read") {
+        TestInput in;
+        in = "MD5 (some/example/path) = 14d739518e715e6e61c19eb05f58a8da\n"
+             "MD5 (weird) = name) = 93b885adfe0da089cdf634904fd59f71\n";
+        ChecksumFile const f = p->readFromFile(in);
+        REQUIRE(f.getEntries().size() == 2);
+        CHECK(f.getEntries()[0].display == u8"some/example/path");
+        CHECK((f.getEntries()[0].digest == md5Digest(u8"14d739518e715e6e61c19eb05f58a8da")));
+        CHECK(f.getEntries()[1].display == u8"weird) = name");
+    }
+    SECTION("Invalid lines") {
+        TestInput in;
+        SECTION("Wrong algorithm") { in = "SHA1 (some/example/path) = 14d739518e715e6e61c19eb05f58a8da\n"; }
+        SECTION("Missing separator") { in = "MD5 (some/example/path) 14d739518e715e6e61c19eb05f58a8da\n"; }
+        SECTION("Missing path") { in = "MD5 () = 14d739518e715e6e61c19eb05f58a8da\n"; }
+        CHECK_THROWS_AS(p->readFromFile(in), quicker_sfv::Exception);
+    }
+    SECTION("Round trip") {
+        ChecksumFile f;
+        f.addEntry(u8"some/example/path", md5Digest(u8"14d739518e715e6e61c19eb05f58a8da"));
+        f.addEntry(u8"another file.txt", md5Digest(u8"a6e25eeaf4af08b6baf6b2e31ceccfdb"));
+        TestOutput out;
+        p->writeNewFile(out, f);
+        CHECK(toString(out.contents) == "MD5 (some/example/path) = 14d739518e715e6e61c19eb05f58a8da\n"
+                                        "MD5 (another file.txt) = a6e25eeaf4af08b6baf6b2e31ceccfdb\n");
+        TestInput in;
+        in.contents = out.contents;
+        ChecksumFile const g = p->readFromFile(in);
+        REQUIRE(g.getEntries().size() == 2);
+        CHECK(g.getEntries()[1].display == u8"another file.txt");
+    }
+}
@@ -0,0 +1,313 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/line_parser.hpp>
+
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/md5_provider.hpp>
+#include <quicker_sfv/md5sum_provider.hpp>
+#include <quicker_sfv/sfv_provider.hpp>
+
+#include <test_file_io.hpp>
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+void checkSameEntries(quicker_sfv::ChecksumFile const& lhs, quicker_sfv::ChecksumFile const& rhs) {
+    auto const l = lhs.getEntries();
+    auto const r = rhs.getEntries();
+    REQUIRE(l.size() == r.size());
+    for (std::size_t i = 0; i < l.size(); ++i) {
+        CHECK((l[i].display == r[i].display));
+        CHECK((l[i].digest == r[i].digest));
+    }
+}
+
+std::string hexString(uint32_t v, int n_digits) {
+    std::string ret(n_digits, '0');
+    for (int i = n_digits - 1; (i >= 0) && (v != 0); --i, v >>= 4) {
+        ret[i] = "0123456789abcdef"[v & 0xf];
+    }
+    return ret;
+}
+
+std::string generateSfv(int n_lines, char const* newline) {
+    std::string ret = std::string{ "; Generated by test" } + newline;
+    for (int i = 0; i < n_lines; ++i) {
+        ret += "dir/file_" + std::to_string(i) + ".bin " + hexString(static_cast<uint32_t>(i) * 2654435761u, 8) + newline;
+        if (i % 97 == 0) { ret += newline; }
+    }
+    return ret;
+}
+}
+
+TEST_CASE("Line Parser")
+{
+    using quicker_sfv::ChecksumFile;
+    using quicker_sfv::ParallelParseOptions;
+    auto const sfv = quicker_sfv::createSfvProvider();
+    auto const md5 = quicker_sfv::createMD5Provider();
+    ParallelParseOptions const opts{ .n_threads = 4, .min_chunk_size = 64 };
+
+    SECTION("Parallel parsing yields the same result as sequential parsing") {
+        for (char const* newline : { "\n", "\r\n" }) {
+            TestInput in;
+            in = generateSfv(2000, newline);
+            ChecksumFile const seq = sfv->readFromFile(in);
+            CHECK(seq.getEntries().size() == 2000);
+            in.read_idx = 0;
+            ChecksumFile const par = sfv->readFromFileParallel(in, opts);
+            checkSameEntries(seq, par);
+            in.read_idx = 0;
+            in.mapped = true;
+            checkSameEntries(seq, sfv->readFromFileParallel(in, opts));
+            checkSameEntries(seq, sfv->readFromFile(in));
+            CHECK(in.read_idx == 0);
+        }
+    }
+    SECTION("Single thread and small files") {
+        TestInput in;
+        in = generateSfv(10, "\n");
+        ChecksumFile const seq = sfv->readFromFile(in);
+        in.read_idx = 0;
+        checkSameEntries(seq, sfv->readFromFileParallel(in, ParallelParseOptions{ .n_threads = 1, .min_chunk_size = 64 }));
+        in.read_idx = 0;
+        checkSameEntries(seq, sfv->readFromFileParallel(in, ParallelParseOptions{
+            .n_threads = 4, .min_chunk_size = ParallelParseOptions::DEFAULT_MIN_CHUNK_SIZE }));
+    }
+    SECTION("Empty file") {
+        TestInput in;
+        CHECK(sfv->readFromFileParallel(in, opts).getEntries().empty());
+    }
+    SECTION("Missing trailing newline") {
+        TestInput in;
+        std::string contents = generateSfv(500, "\n");
+        contents += "last_file.bin 01234567";
+        in = contents;
+        ChecksumFile const par = sfv->readFromFileParallel(in, opts);
+        REQUIRE(par.getEntries().size() == 501);
+        CHECK(par.getEntries().back().display == u8"last_file.bin");
+        in.read_idx = 0;
+        checkSameEntries(sfv->readFromFile(in), par);
+    }
+    SECTION("Md5 files") {
+        TestInput in;
+        std::string contents;
+        for (int i = 0; i < 1000; ++i) {
+            contents += hexString(i, 32) + " *file_" + std::to_string(i) + ".bin\r\n";
+        }
+        in = contents;
+        ChecksumFile const seq = md5->readFromFile(in);
+        CHECK(seq.getEntries().size() == 1000);
+        in.read_idx = 0;
+        checkSameEntries(seq, md5->readFromFileParallel(in, opts));
+    }
+    SECTION("Errors are raised from any chunk") {
+        for (int const error_line : { 3, 1000, 1999 }) {
+            std::string contents;
+            for (int i = 0; i < 2000; ++i) {
+                contents += (i == error_line) ? std::string{ "invalid\n" } : ("file_" + std::to_string(i) + ".bin 01234567\n");
+            }
+            TestInput in;
+            in = contents;
+            CHECK_THROWS_MATCHES(sfv->readFromFileParallel(in, opts), quicker_sfv::Exception,
+                                 Catch::Predicate<quicker_sfv::Exception>([](quicker_sfv::Exception const& e) {
+                                     return e.code() == quicker_sfv::Error::ParserError; }));
+        }
+    }
+    SECTION("Errors report the line number of the first invalid line") {
+        using quicker_sfv::LineDiagnostic;
+        using quicker_sfv::LineError;
+        for (bool const mapped : { false, true }) {
+            for (int const error_line : { 3, 1000, 1999 }) {
+                // blank lines and CRLF linebreaks must be counted like any other line
+                std::string contents;
+                for (int i = 0; i < 2000; ++i) {
+                    if (i == error_line) {
+                        contents += "invalid\r\n";
+                    } else if (i == error_line + 10) {
+                        contents += "bad_digest.bin 0123456x\r\n";
+                    } else if (i % 7 == 0) {
+                        contents += "\r\n";
+                    } else {
+                        contents += "file_" + std::to_string(i) + ".bin 01234567\r\n";
+                    }
+                }
+                TestInput in;
+                in = contents;
+                in.mapped = mapped;
+                auto const res = sfv->tryReadFromFileParallel(in, opts);
+                REQUIRE(!res);
+                CHECK(res.error() == LineDiagnostic{ .line_number = static_cast<uint64_t>(error_line) + 1,
+                                                     .error = LineError::InvalidFormat });
+            }
+        }
+        std::string contents = generateSfv(1000, "\n");
+        std::size_t const error_offset = contents.find("file_900.bin");
+        contents[error_offset] = '\xff';
+        TestInput in;
+        in = contents;
+        auto const res = sfv->tryReadFromFileParallel(in, opts);
+        REQUIRE(!res);
+        uint64_t const expected_line = std::count(contents.begin(), contents.begin() + error_offset, '\n') + 1;
+        CHECK(res.error() == LineDiagnostic{ .line_number = expected_line, .error = LineError::InvalidUtf8 });
+        in.read_idx = 0;
+        contents = generateSfv(1000, "\n");
+        in = contents;
+        auto const valid = sfv->tryReadFromFileParallel(in, opts);
+        REQUIRE(valid);
+        in.read_idx = 0;
+        checkSameEntries(sfv->readFromFile(in), *valid);
+    }
+    SECTION("Invalid utf-8 is rejected") {
+        std::string contents = generateSfv(1000, "\n");
+        contents[contents.size() / 2] = '\xff';
+        TestInput in;
+        in = contents;
+        CHECK_THROWS_AS(sfv->readFromFileParallel(in, opts), quicker_sfv::Exception);
+    }
+    SECTION("Read errors are propagated") {
+        TestInput in;
+        in = generateSfv(1000, "\n");
+        in.fault_after = 100;
+        CHECK_THROWS_MATCHES(sfv->readFromFileParallel(in, opts), quicker_sfv::Exception,
+                             Catch::Predicate<quicker_sfv::Exception>([](quicker_sfv::Exception const& e) {
+                                 return e.code() == quicker_sfv::Error::FileIO; }));
+    }
+}
+
+TEST_CASE("Size Comments")
+{
+    using quicker_sfv::ChecksumFile;
+    using quicker_sfv::Digest;
+    using quicker_sfv::parseSizeComment;
+    ChecksumFile f;
+    f.addEntry(u8"file.bin", Digest{});
+    f.addEntry(u8"file 2.bin", Digest{});
+    SECTION("Valid size comments") {
+        CHECK(parseSizeComment(u8"   4096  12:34.56 2003-08-01 file.bin", f));
+        CHECK(parseSizeComment(u8" 0 2003/08/01 12:34:56  file 2.bin ", f));
+        f.resolveExpectedSizes();
+        CHECK(f.getEntries()[0].expected_size == 4096);
+        CHECK(f.getEntries()[1].expected_size == 0);
+    }
+    SECTION("Other comments") {
+        CHECK(!parseSizeComment(u8"", f));
+        CHECK(!parseSizeComment(u8" Generated by some tool", f));
+        CHECK(!parseSizeComment(u8" 4096 12:34.56 2003-08-01", f));
+        CHECK(!parseSizeComment(u8" 4096 file.bin", f));
+        CHECK(!parseSizeComment(u8" 4096 12:34.56 today file.bin", f));
+        CHECK(!parseSizeComment(u8" -4096 12:34.56 2003-08-01 file.bin", f));
+        CHECK(!parseSizeComment(u8" 1234567890123456789 12:34.56 2003-08-01 file.bin", f));
+        f.resolveExpectedSizes();
+        CHECK(f.getEntries()[0].expected_size == -1);
+    }
+    SECTION("Sizes are assigned across chunks") {
+        std::string contents;
+        for (int i = 0; i < 500; ++i) {
+            contents += "; " + std::to_string(i) + " 12:00.00 2020-01-01 file_" + std::to_string(i) + ".bin\n";
+        }
+        for (int i = 0; i < 500; ++i) {
+            contents += "file_" + std::to_string(i) + ".bin " + hexString(i, 8) + "\n";
+        }
+        TestInput in;
+        in = contents;
+        auto const sfv = quicker_sfv::createSfvProvider();
+        ChecksumFile const par = sfv->readFromFileParallel(in, quicker_sfv::ParallelParseOptions{ .n_threads = 4, .min_chunk_size = 64 });
+        REQUIRE(par.getEntries().size() == 500);
+        for (int i = 0; i < 500; ++i) {
+            CHECK(par.getEntries()[i].expected_size == i);
+        }
+    }
+}
+
+TEST_CASE("Lenient Line Parser")
+{
+    using quicker_sfv::LenientParseResult;
+    using quicker_sfv::LineDiagnostic;
+    using quicker_sfv::LineError;
+
+    SECTION("Sfv files collect diagnostics for bad lines") {
+        std::string contents = "; comment\r\n"
+                               "good_1.bin 01234567\r\n"
+                               "invalid\r\n"
+                               "bad_digest.bin 0123456x\r\n"
+                               "\r\n"
+                               "bad_\xff.bin 01234567\r\n"
+                               "good_2.bin 89abcdef";
+        auto const sfv = quicker_sfv::createSfvProvider();
+        for (bool const mapped : { false, true }) {
+            TestInput in;
+            in = contents;
+            in.mapped = mapped;
+            LenientParseResult const res = sfv->readFromFileLenient(in);
+            auto const entries = res.checksum_file.getEntries();
+            REQUIRE(entries.size() == 2);
+            CHECK(entries[0].display == u8"good_1.bin");
+            CHECK(entries[1].display == u8"good_2.bin");
+            CHECK(res.diagnostics == std::vector<LineDiagnostic>{
+                LineDiagnostic{ .line_number = 3, .error = LineError::InvalidFormat },
+                LineDiagnostic{ .line_number = 4, .error = LineError::InvalidDigest },
+                LineDiagnostic{ .line_number = 6, .error = LineError::InvalidUtf8 },
+            });
+        }
+    }
+    SECTION("Clean files produce no diagnostics") {
+        auto const sfv = quicker_sfv::createSfvProvider();
+        TestInput in;
+        in = generateSfv(100, "\n");
+        LenientParseResult const res = sfv->readFromFileLenient(in);
+        CHECK(res.diagnostics.empty());
+        in.read_idx = 0;
+        checkSameEntries(sfv->readFromFile(in), res.checksum_file);
+    }
+    SECTION("Md5 files") {
+        auto const md5 = quicker_sfv::createMD5Provider();
+        TestInput in;
+        in = hexString(1, 32) + " *file.bin\n" + hexString(2, 32) + " *a*b.bin\n" + hexString(3, 32) + " *\n";
+        LenientParseResult const res = md5->readFromFileLenient(in);
+        REQUIRE(res.checksum_file.getEntries().size() == 1);
+        CHECK(res.checksum_file.getEntries()[0].display == u8"file.bin");
+        CHECK(res.diagnostics == std::vector<LineDiagnostic>{
+            LineDiagnostic{ .line_number = 2, .error = LineError::InvalidPath },
+            LineDiagnostic{ .line_number = 3, .error = LineError::MissingPath },
+        });
+    }
+    SECTION("Line format providers") {
+        auto const md5sum = quicker_sfv::createMD5SumProvider();
+        TestInput in;
+        in = hexString(1, 32) + "  file.bin\n" + hexString(2, 32) + " file.bin\n";
+        LenientParseResult const res = md5sum->readFromFileLenient(in);
+        CHECK(res.checksum_file.getEntries().size() == 1);
+        CHECK(res.diagnostics == std::vector<LineDiagnostic>{
+            LineDiagnostic{ .line_number = 2, .error = LineError::InvalidFormat },
+        });
+    }
+    SECTION("Read errors are still raised") {
+        auto const sfv = quicker_sfv::createSfvProvider();
+        TestInput in;
+        in = generateSfv(1000, "\n");
+        in.fault_after = 100;
+        CHECK_THROWS_AS(sfv->readFromFileLenient(in), quicker_sfv::Exception);
+    }
+}
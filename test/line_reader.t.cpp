@@ -222,16 +222,43 @@ TEST_CASE("Line Reader")
         CHECK_THROWS_AS(r.readLine(), quicker_sfv::Exception);
         CHECK(input.read_calls == 4);
     }
-    SECTION("Line longer than single buffer may not be read") {
+    SECTION("Lines longer than the read buffer") {
         input = repeat('A', 2 * LineReader::READ_BUFFER_SIZE - 3) + "\n" +
-            repeat('B', LineReader::READ_BUFFER_SIZE + 20) + "\n";
+            repeat('B', 5 * LineReader::READ_BUFFER_SIZE + 20) + "\r\n" + "CCC";
         CHECK(!r.done());
         line = r.readLine();
         REQUIRE(line);
         CHECK(line->size() == 2 * LineReader::READ_BUFFER_SIZE - 3);
         CHECK(std::ranges::all_of(*line, [](char c) { return c == 'A'; }));
         CHECK(!r.done());
-        CHECK_THROWS_AS(r.readLine(), quicker_sfv::Exception);
+        line = r.readLine();
+        REQUIRE(line);
+        CHECK(line->size() == 5 * LineReader::READ_BUFFER_SIZE + 20);
+        CHECK(std::ranges::all_of(*line, [](char c) { return c == 'B'; }));
+        CHECK(!r.done());
+        line = r.readLine();
+        REQUIRE(line);
+        CHECK(*line == u8"CCC");
+        CHECK(r.done());
+    }
+    SECTION("Reading lines as views") {
+        input = "First line\r\n" + repeat('B', 3 * LineReader::READ_BUFFER_SIZE) + "\n\nLast";
+        std::optional<std::u8string_view> view = r.readLineView();
+        REQUIRE(view);
+        CHECK(*view == u8"First line");
+        view = r.readLineView();
+        REQUIRE(view);
+        CHECK(view->size() == 3 * LineReader::READ_BUFFER_SIZE);
+        CHECK(std::ranges::all_of(*view, [](char8_t c) { return c == u8'B'; }));
+        view = r.readLineView();
+        REQUIRE(view);
+        CHECK(view->empty());
+        CHECK(!r.done());
+        view = r.readLineView();
+        REQUIRE(view);
+        CHECK(*view == u8"Last");
+        CHECK(r.done());
+        CHECK(!r.readLineView());
     }
     SECTION("Invalid UTF-8 in line") {
         input = "AAAAAA\nBB";
@@ -258,3 +285,99 @@ TEST_CASE("Line Reader")
         CHECK_THROWS_AS(r.readLine(), quicker_sfv::Exception);
     }
 }
+
+TEST_CASE("Line Reader raw lines")
+{
+    using quicker_sfv::LineReader;
+
+    for (bool const mapped : { false, true }) {
+        TestInput input;
+        input.mapped = mapped;
+        input = "AAA\r\nB";
+        input.contents.push_back(static_cast<char>(128));
+        input.contents.push_back('\n');
+        input.contents.push_back('C');
+        LineReader r{ input };
+        std::optional<std::span<std::byte const>> line = r.readLineBytes();
+        REQUIRE(line);
+        CHECK(line->size() == 3);
+        line = r.readLineBytes();
+        REQUIRE(line);
+        REQUIRE(line->size() == 2);
+        CHECK((*line)[1] == std::byte{ 128 });
+        // invalid lines read as raw bytes do not affect following lines
+        std::optional<std::u8string_view> const view = r.readLineView();
+        REQUIRE(view);
+        CHECK(*view == u8"C");
+        CHECK(r.done());
+    }
+}
+
+TEST_CASE("Line Reader on mapped input")
+{
+    using quicker_sfv::LineReader;
+
+    TestInput input;
+    input.mapped = true;
+
+    SECTION("Lines are split from the mapped contents") {
+        input = "First line\r\n" + std::string(3 * LineReader::READ_BUFFER_SIZE, 'B') + "\n\nLast";
+        LineReader r{ input };
+        std::optional<std::u8string_view> view = r.readLineView();
+        REQUIRE(view);
+        CHECK(*view == u8"First line");
+        CHECK(reinterpret_cast<char const*>(view->data()) == input.contents.data());
+        view = r.readLineView();
+        REQUIRE(view);
+        CHECK(view->size() == 3 * LineReader::READ_BUFFER_SIZE);
+        view = r.readLineView();
+        REQUIRE(view);
+        CHECK(view->empty());
+        CHECK(!r.done());
+        view = r.readLineView();
+        REQUIRE(view);
+        CHECK(*view == u8"Last");
+        CHECK(r.done());
+        CHECK(!r.readLineView());
+        CHECK(input.read_calls == 0);
+    }
+    SECTION("Empty file") {
+        LineReader r{ input };
+        std::optional<std::u8string> const line = r.readLine();
+        REQUIRE(line);
+        CHECK(line->empty());
+        CHECK(r.done());
+    }
+    SECTION("Reading starts at the current file position") {
+        input = "AAA\nBBB\n";
+        input.read_idx = 4;
+        LineReader r{ input };
+        std::optional<std::u8string> line = r.readLine();
+        REQUIRE(line);
+        CHECK(*line == u8"BBB");
+        line = r.readLine();
+        REQUIRE(line);
+        CHECK(line->empty());
+        CHECK(r.done());
+    }
+    SECTION("Invalid UTF-8 in line") {
+        input = "AAAAAA\nBB";
+        input.contents.push_back(static_cast<char>(128));
+        input.contents.push_back('B');
+        input.contents.push_back('\n');
+        input.contents.push_back('C');
+        LineReader r{ input };
+        std::optional<std::u8string> const line = r.readLine();
+        REQUIRE(line);
+        CHECK(*line == u8"AAAAAA");
+        CHECK_THROWS_AS(r.readLine(), quicker_sfv::Exception);
+        CHECK_THROWS_AS(r.readLine(), quicker_sfv::Exception);
+    }
+    SECTION("Truncated UTF-8 sequence at end of file") {
+        input = "AAAAAA\nBB";
+        input.contents.push_back(static_cast<char>(0xc3));
+        LineReader r{ input };
+        CHECK(r.readLine());
+        CHECK_THROWS_AS(r.readLine(), quicker_sfv::Exception);
+    }
+}
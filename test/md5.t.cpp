@@ -23,6 +23,8 @@
 
 #include <catch.hpp>
 
+#include <algorithm>
+
 TEST_CASE("MD5")
 {
     using quicker_sfv::detail::MD5Hasher;
@@ -63,6 +65,56 @@ TEST_CASE("MD5")
         CHECK(hasher.finalize().toString() == u8"14d739518e715e6e61c19eb05f58a8da");
     }
 
+    SECTION("Saved state")
+    {
+        std::byte data[] = {
+            std::byte{ 0x1a }, std::byte{ 0x2b }, std::byte{ 0x3c },
+            std::byte{ 0x4f }, std::byte{ 0x5a }, std::byte{ 0x6b },
+            std::byte{ 0x7c }, std::byte{ 0x8d }, std::byte{ 0x9e },
+            std::byte{ 0xa9 }, std::byte{ 0xb5 }, std::byte{ 0xc3 },
+            std::byte{ 0xd9 }, std::byte{ 0xe1 }, std::byte{ 0xff },
+            std::byte{ 0x89 }, std::byte{ 0x51 }, std::byte{ 0x4a },
+            std::byte{ 0xaa }, std::byte{ 0x55 }, std::byte{ 0xcc }
+        };
+        CHECK(hasher.supportsSavedState());
+        hasher.addData(std::span<std::byte const>(data, data + 5));
+        std::vector<std::byte> const state = hasher.saveState();
+        // only the buffered input bytes are stored after the fixed fields
+        CHECK(state.size() == 32 + 5);
+        CHECK(std::equal(state.end() - 5, state.end(), data));
+        CHECK(hasher.finalize().toString() == u8"a6e25eeaf4af08b6baf6b2e31ceccfdb");
+
+        MD5Hasher resumed;
+        resumed.restoreState(state);
+        resumed.addData(std::span<std::byte const>(data + 5, data + sizeof(data)));
+        CHECK(resumed.finalize().toString() == u8"14d739518e715e6e61c19eb05f58a8da");
+
+        // state spanning more than one block
+        std::vector<std::byte> large(1000);
+        for (std::size_t i = 0; i < large.size(); ++i) { large[i] = static_cast<std::byte>(i * 7); }
+        hasher.reset();
+        hasher.addData(large);
+        std::u8string const expected = hasher.finalize().toString();
+        hasher.reset();
+        hasher.addData(std::span<std::byte const>(large).first(333));
+        resumed.reset();
+        resumed.restoreState(hasher.saveState());
+        resumed.addData(std::span<std::byte const>(large).subspan(333));
+        CHECK(resumed.finalize().toString() == expected);
+
+        resumed.reset();
+        CHECK_THROWS_AS(resumed.restoreState(std::span<std::byte const>(state).first(8)), quicker_sfv::Exception);
+        std::vector<std::byte> bad_tag = state;
+        bad_tag[0] = std::byte{ 'X' };
+        CHECK_THROWS_AS(resumed.restoreState(bad_tag), quicker_sfv::Exception);
+        std::vector<std::byte> bad_num = state;
+        bad_num[28] = std::byte{ 64 };
+        CHECK_THROWS_AS(resumed.restoreState(bad_num), quicker_sfv::Exception);
+        std::vector<std::byte> truncated = state;
+        truncated.pop_back();
+        CHECK_THROWS_AS(resumed.restoreState(truncated), quicker_sfv::Exception);
+    }
+
     SECTION("Digest from string")
     {
         CHECK(MD5Hasher::digestFromString(u8"14d739518e715e6e61c19eb05f58a8da").toString() ==
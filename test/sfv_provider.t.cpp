@@ -96,6 +96,24 @@ TEST_CASE("Sfv Provider")
             CHECK((f.getEntries()[2].digest == p->digestFromString(u8"9abcdef0")));
             CHECK(f.getEntries()[2].display == u8"another_file.txt");
         }
+        SECTION("Sizes from comments") {
+            TestInput in;
+            in = "; Generated by WIN-SFV32 v1.1a on 2003-08-01 at 12:34.56"  "\r\n"
+                 ";"                                                          "\r\n"
+                 ";     1048576  12:34.56 2003-08-01 some_file.rar"          "\r\n"
+                 ";          17  08:00.00 2003-07-30 dir/with spaces.txt"    "\r\n"
+                 "; 123 not a size comment"                                   "\r\n"
+                 "dir/with spaces.txt 9abcdef0"                               "\r\n"
+                 "some_file.rar 4a6fa7d5"                                     "\r\n"
+                 "another_file.txt 9abcdef0"                                  "\r\n";
+            ChecksumFile const f = p->readFromFile(in);
+            REQUIRE(f.getEntries().size() == 3);
+            CHECK(f.getEntries()[0].display == u8"dir/with spaces.txt");
+            CHECK(f.getEntries()[0].expected_size == 17);
+            CHECK(f.getEntries()[1].display == u8"some_file.rar");
+            CHECK(f.getEntries()[1].expected_size == 1048576);
+            CHECK(f.getEntries()[2].expected_size == -1);
+        }
         SECTION("Windows Line Endings (CRLF)") {
             TestInput in;
             in = "some/example/path b0c3bbc7" "\r\n"
@@ -0,0 +1,111 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/stamp_file.hpp>
+
+#include <quicker_sfv/error.hpp>
+
+#include <test_file_io.hpp>
+
+#include <catch.hpp>
+
+namespace {
+std::vector<char> vecFromString(char const* str) {
+    std::vector<char> ret;
+    ret.insert(ret.end(), str, str + strlen(str));
+    return ret;
+}
+}
+
+TEST_CASE("Stamp File")
+{
+    using quicker_sfv::FileStamp;
+    using quicker_sfv::StampFile;
+
+    SECTION("Construction") {
+        StampFile f;
+        CHECK(f.size() == 0);
+        CHECK(!f.getStamp(u8"a"));
+    }
+    SECTION("Setting stamps") {
+        StampFile f;
+        f.setStamp(u8"a", FileStamp{ .size = 1, .modification_time = 2 });
+        f.setStamp(u8"b", FileStamp{ .size = 3, .modification_time = 4 });
+        REQUIRE(f.size() == 2);
+        CHECK(f.getStamp(u8"a") == FileStamp{ .size = 1, .modification_time = 2 });
+        CHECK(f.getStamp(u8"b") == FileStamp{ .size = 3, .modification_time = 4 });
+        CHECK(!f.getStamp(u8"c"));
+        SECTION("Replacing stamps") {
+            f.setStamp(u8"a", FileStamp{ .size = 5, .modification_time = 6 });
+            CHECK(f.size() == 2);
+            CHECK(f.getStamp(u8"a") == FileStamp{ .size = 5, .modification_time = 6 });
+        }
+        SECTION("Clear") {
+            f.clear();
+            CHECK(f.size() == 0);
+            CHECK(!f.getStamp(u8"a"));
+        }
+    }
+    SECTION("Write Stamp File") {
+        StampFile f;
+        f.setStamp(u8"some_file.rar", FileStamp{ .size = 12345, .modification_time = 133'000'000'000'000'000 });
+        f.setStamp(u8"some/example path", FileStamp{ .size = 0, .modification_time = -42 });
+        TestOutput out;
+        SECTION("Normal Output") {
+            f.writeToFile(out);
+            CHECK(out.contents == vecFromString(
+                "0 -42 some/example path"                     "\n"
+                "12345 133000000000000000 some_file.rar"      "\n"));
+        }
+        SECTION("Fault during write") {
+            out.fault_after = 10;
+            CHECK_THROWS_AS(f.writeToFile(out), quicker_sfv::Exception);
+        }
+    }
+    SECTION("Read Stamp File") {
+        TestInput in;
+        in = "12345 133000000000000000 some_file.rar"  "\r\n"
+             "; comments are ignored"                  "\r\n"
+             ""                                        "\r\n"
+             "0 -42 some/example path"                 "\r\n";
+        StampFile const f = StampFile::readFromFile(in);
+        REQUIRE(f.size() == 2);
+        CHECK(f.getStamp(u8"some_file.rar") == FileStamp{ .size = 12345, .modification_time = 133'000'000'000'000'000 });
+        CHECK(f.getStamp(u8"some/example path") == FileStamp{ .size = 0, .modification_time = -42 });
+    }
+    SECTION("Invalid file formats") {
+        TestInput in;
+        SECTION("Missing path") {
+            in = "12345 133000000000000000" "\n";
+        }
+        SECTION("Empty path") {
+            in = "12345 133000000000000000 " "\n";
+        }
+        SECTION("Invalid size") {
+            in = "-12345 133000000000000000 some_file.rar" "\n";
+        }
+        SECTION("Invalid time") {
+            in = "12345 13300000000000000x some_file.rar" "\n";
+        }
+        SECTION("Size out of range") {
+            in = "123456789012345678901234567890 0 some_file.rar" "\n";
+        }
+        CHECK_THROWS_AS(StampFile::readFromFile(in), quicker_sfv::Exception);
+    }
+}
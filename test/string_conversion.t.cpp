@@ -62,4 +62,13 @@ TEST_CASE("String Conversion")
         CHECK_THROWS_AS(hex_str_to_byte(Nibbles{ .higher = '=', .lower = '0' }), quicker_sfv::Exception);
         CHECK_THROWS_AS(hex_str_to_byte(Nibbles{ .higher = 'j', .lower = '`' }), quicker_sfv::Exception);
     }
+
+    SECTION("Hex to byte without exceptions") {
+        using quicker_sfv::string_conversion::try_hex_str_to_byte;
+        CHECK(try_hex_str_to_byte('a', 'B') == std::byte{ 0xab });
+        CHECK(try_hex_str_to_byte('0', '9') == std::byte{ 0x09 });
+        CHECK(!try_hex_str_to_byte('0', 'G'));
+        CHECK(!try_hex_str_to_byte('K', '0'));
+        CHECK(!try_hex_str_to_byte('\0', '\0'));
+    }
 }
@@ -331,6 +331,24 @@ TEST_CASE("String Utilities")
         CHECK(convertToUtf16(u8"A¡ࠀ🍫嶲Z") == u"A¡ࠀ🍫嶲Z");
     }
 
+    SECTION("Convert long strings") {
+        using quicker_sfv::convertToUtf8;
+        using quicker_sfv::convertToUtf16;
+        // long ASCII runs are converted in bulk, with non-ASCII characters at every offset
+        std::u8string const utf8_characters[] = { u8"¡", u8"߿", u8"⁈", u8"\uffff", u8"🍫", u8"嶲" };
+        std::u16string const utf16_characters[] = { u"¡", u"߿", u"⁈", u"\uffff", u"🍫", u"嶲" };
+        for (std::size_t i = 0; i < std::size(utf8_characters); ++i) {
+            for (std::size_t pos = 0; pos < 80; ++pos) {
+                std::u8string const utf8 = std::u8string(pos, u8'x') + utf8_characters[i] + std::u8string(70, u8'y') +
+                    utf8_characters[(i + 1) % std::size(utf8_characters)] + utf8_characters[i];
+                std::u16string const utf16 = std::u16string(pos, u'x') + utf16_characters[i] + std::u16string(70, u'y') +
+                    utf16_characters[(i + 1) % std::size(utf16_characters)] + utf16_characters[i];
+                CHECK(convertToUtf16(utf8) == utf16);
+                CHECK(convertToUtf8(utf16) == utf8);
+            }
+        }
+    }
+
     SECTION("Trim") {
         using quicker_sfv::trim;
         CHECK(trim(u8"") == u8"");
@@ -375,5 +393,62 @@ TEST_CASE("String Utilities")
             d(0x2004) + d(0x2005) + d(0x2006) + d(0x2007) + d(0x2008) + d(0x2009) + d(0x200A) + d(0x2028) + d(0x2029) +
             d(0x202F) + d(0x205F) + d(0x3000) + d(0x2000) + d(0x2001)) == u8"🍫 \t\r\n\v\fabc");
     }
+    SECTION("Utf8 stream validation") {
+        using quicker_sfv::Utf8StreamValidator;
+        auto const bytes = [](std::u8string_view s) {
+            return std::span<std::byte const>(reinterpret_cast<std::byte const*>(s.data()), s.size());
+        };
+        std::u8string const valid = std::u8string(100, u8'a') + u8"¡⁈🍫" + std::u8string(40, u8'b') + u8"߿";
+        SECTION("Valid stream split at every position") {
+            for (size_t split = 0; split <= valid.size(); ++split) {
+                Utf8StreamValidator v;
+                v.addData(bytes(valid).subspan(0, split));
+                v.addData(bytes(valid).subspan(split));
+                v.finish();
+                CHECK(!v.firstInvalidOffset());
+            }
+        }
+        SECTION("Truncated sequence at end of stream") {
+            Utf8StreamValidator v;
+            v.addData(bytes(valid).subspan(0, 101));
+            CHECK(!v.firstInvalidOffset());
+            v.finish();
+            REQUIRE(v.firstInvalidOffset());
+            CHECK(*v.firstInvalidOffset() == 100);
+        }
+        SECTION("Invalid sequences report offset of the sequence start") {
+            std::u8string invalid = valid;
+            invalid[104] = u8'x';
+            for (size_t split = 0; split <= invalid.size(); ++split) {
+                Utf8StreamValidator v;
+                v.addData(bytes(invalid).subspan(0, split));
+                v.addData(bytes(invalid).subspan(split));
+                v.finish();
+                REQUIRE(v.firstInvalidOffset());
+                CHECK(*v.firstInvalidOffset() == 102);
+            }
+            invalid = valid;
+            invalid[70] = static_cast<char8_t>(0x80);
+            Utf8StreamValidator v;
+            v.addData(bytes(invalid));
+            REQUIRE(v.firstInvalidOffset());
+            CHECK(*v.firstInvalidOffset() == 70);
+            invalid[70] = static_cast<char8_t>(0xf8);
+            v = Utf8StreamValidator{};
+            v.addData(bytes(invalid));
+            REQUIRE(v.firstInvalidOffset());
+            CHECK(*v.firstInvalidOffset() == 70);
+        }
+        SECTION("Agrees with decodeUtf8") {
+            using quicker_sfv::checkValidUtf8;
+            CHECK(checkValidUtf8(std::string_view{}));
+            CHECK(checkValidUtf8(std::string_view{ "\xc0\x80" }));
+            CHECK(checkValidUtf8(std::string_view{ "\xf7\xbf\xbf\xbf" }));
+            CHECK(!checkValidUtf8(std::string_view{ "\xe0\x80" }));
+            CHECK(!checkValidUtf8(std::string_view{ "\xe0\x80\x41" }));
+            CHECK(!checkValidUtf8(std::string_view{ "\xbf" }));
+            CHECK(!checkValidUtf8(std::string_view{ "\xff" }));
+        }
+    }
 }
 
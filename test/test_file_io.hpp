@@ -35,6 +35,7 @@ struct TestInput : public quicker_sfv::FileInput {
     size_t read_idx = 0;
     size_t fault_after = 0;
     size_t read_calls = 0;
+    bool mapped = false;
     std::u8string file_name = u8"testfile.bin";
 
     TestInput& operator=(std::string_view t) {
@@ -87,6 +88,11 @@ struct TestInput : public quicker_sfv::FileInput {
     uint64_t file_size() override {
         return contents.size();
     }
+
+    std::optional<std::span<std::byte const>> mappedContents() noexcept override {
+        if (!mapped) { return std::nullopt; }
+        return std::as_bytes(std::span<char const>(contents)).subspan(read_idx);
+    }
 };
 
 struct TestOutput : public quicker_sfv::FileOutput {
@@ -0,0 +1,171 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/detail/text_scan.hpp>
+
+#include <quicker_sfv/string_utilities.hpp>
+
+#include <catch.hpp>
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+/** Length of the prefix of range consisting of complete sequences accepted by decodeUtf8().
+ */
+std::size_t validUtf8Prefix(std::span<std::byte const> range) {
+    std::span<char8_t const> str(reinterpret_cast<char8_t const*>(range.data()), range.size());
+    std::size_t ret = 0;
+    while (ret < str.size()) {
+        quicker_sfv::DecodeResult const d = quicker_sfv::decodeUtf8(str.subspan(ret));
+        if (d.code_units_consumed == 0) { break; }
+        ret += d.code_units_consumed;
+    }
+    return ret;
+}
+}
+
+TEST_CASE("Text Scan")
+{
+    using namespace quicker_sfv::text_scan;
+    using FindFn = std::size_t(*)(std::span<std::byte const>);
+    std::vector<std::byte> buffer(300, std::byte{ 'a' });
+    auto check_all_positions = [&buffer](FindFn fn, std::byte marker) {
+        for (std::size_t offset = 0; offset < 8; ++offset) {
+            for (std::size_t size = 0; size + offset <= buffer.size(); size += 7) {
+                std::span<std::byte const> const range = std::span<std::byte const>(buffer).subspan(offset, size);
+                CHECK(fn(range) == size);
+                for (std::size_t pos = 0; pos < size; ++pos) {
+                    buffer[offset + pos] = marker;
+                    CHECK(fn(range) == pos);
+                    buffer[offset + size - 1] = marker;
+                    CHECK(fn(range) == pos);
+                    buffer[offset + pos] = std::byte{ 'a' };
+                    buffer[offset + size - 1] = std::byte{ 'a' };
+                }
+            }
+        }
+    };
+    SECTION("Find newline") {
+        check_all_positions(findNewlineSse2, std::byte{ '\n' });
+        check_all_positions(findNewline, std::byte{ '\n' });
+        if (supportsAvx2()) {
+            check_all_positions(findNewlineAvx2, std::byte{ '\n' });
+        }
+        buffer[5] = std::byte{ 0x8a };
+        CHECK(findNewline(buffer) == buffer.size());
+    }
+    SECTION("Find non-ASCII") {
+        check_all_positions(findNonAsciiSse2, std::byte{ 0xc3 });
+        check_all_positions(findNonAscii, std::byte{ 0x80 });
+        if (supportsAvx2()) {
+            check_all_positions(findNonAsciiAvx2, std::byte{ 0xff });
+        }
+        buffer[5] = std::byte{ 0x7f };
+        CHECK(findNonAscii(buffer) == buffer.size());
+    }
+    SECTION("Skip valid UTF-8") {
+        using SkipFn = std::size_t(*)(std::span<std::byte const>);
+        std::vector<SkipFn> fns = { skipValidUtf8Sse2, skipValidUtf8 };
+        if (supportsAvx2()) { fns.push_back(skipValidUtf8Avx2); }
+        std::u8string const characters[] = { u8"a", u8"\n", u8"¡", u8"߿", u8"⁈", u8"🍫", u8"嶲" };
+        std::mt19937 rng(42);
+        for (int iteration = 0; iteration < 2000; ++iteration) {
+            std::u8string text;
+            std::size_t const n_characters = rng() % 150;
+            // mostly ASCII, like typical file paths
+            for (std::size_t i = 0; i < n_characters; ++i) {
+                text += characters[((rng() % 4) == 0) ? (rng() % std::size(characters)) : 0];
+            }
+            std::vector<std::byte> bytes(reinterpret_cast<std::byte const*>(text.data()),
+                                         reinterpret_cast<std::byte const*>(text.data() + text.size()));
+            if (!bytes.empty() && ((iteration % 2) == 1)) {
+                // corrupt a random byte
+                bytes[rng() % bytes.size()] = static_cast<std::byte>(rng() % 256);
+            }
+            std::size_t const valid_prefix = validUtf8Prefix(bytes);
+            for (SkipFn const fn : fns) {
+                std::size_t const skipped = fn(bytes);
+                CHECK(skipped <= valid_prefix);
+                // all complete blocks up to the first error are skipped
+                CHECK(skipped + 64 + 3 > (valid_prefix / 64) * 64);
+                CHECK(validUtf8Prefix(std::span<std::byte const>(bytes).subspan(0, skipped)) == skipped);
+            }
+        }
+    }
+    SECTION("Skip valid UTF-8 rejects invalid structure") {
+        for (auto const fn : { skipValidUtf8Sse2, skipValidUtf8Avx2 }) {
+            if ((fn == skipValidUtf8Avx2) && !supportsAvx2()) { continue; }
+            std::vector<std::byte> bytes(128, std::byte{ 'a' });
+            CHECK(fn(bytes) == 128);
+            bytes[70] = std::byte{ 0x80 };
+            CHECK(fn(bytes) == 64);
+            bytes[70] = std::byte{ 0xf8 };
+            CHECK(fn(bytes) == 64);
+            bytes[70] = std::byte{ 0xe0 };
+            bytes[71] = std::byte{ 0x80 };
+            CHECK(fn(bytes) == 64);
+            bytes[72] = std::byte{ 0x80 };
+            CHECK(fn(bytes) == 128);
+            // sequence crossing the block boundary
+            bytes[63] = std::byte{ 0xf0 };
+            bytes[64] = std::byte{ 0x80 };
+            bytes[65] = std::byte{ 0x80 };
+            bytes[66] = std::byte{ 0x80 };
+            CHECK(fn(bytes) == 127);
+            bytes[66] = std::byte{ 'a' };
+            CHECK(fn(bytes) == 63);
+        }
+    }
+    SECTION("Widen and narrow ASCII") {
+        std::u16string const wide_text = u"The quick brown fox jumps over the lazy dog; 0123456789 ~!";
+        std::u8string const narrow_text = u8"The quick brown fox jumps over the lazy dog; 0123456789 ~!";
+        using WidenFn = std::size_t(*)(std::span<std::byte const>, char16_t*);
+        using NarrowFn = std::size_t(*)(std::span<char16_t const>, char8_t*);
+        std::vector<std::pair<WidenFn, NarrowFn>> fns = { { widenAsciiSse2, narrowAsciiSse2 }, { widenAscii, narrowAscii } };
+        if (supportsAvx2()) { fns.emplace_back(widenAsciiAvx2, narrowAsciiAvx2); }
+        for (auto const& [widen, narrow] : fns) {
+            for (std::size_t size = 0; size < 150; ++size) {
+                std::u8string narrow_in;
+                std::u16string wide_in;
+                for (std::size_t i = 0; i < size; ++i) {
+                    narrow_in += narrow_text[i % narrow_text.size()];
+                    wide_in += wide_text[i % wide_text.size()];
+                }
+                std::u16string wide_out(size, u'\0');
+                std::span<std::byte const> const narrow_bytes(reinterpret_cast<std::byte const*>(narrow_in.data()), size);
+                CHECK(widen(narrow_bytes, wide_out.data()) == size);
+                CHECK(wide_out == wide_in);
+                std::u8string narrow_out(size, u8'\0');
+                CHECK(narrow(wide_in, narrow_out.data()) == size);
+                CHECK(narrow_out == narrow_in);
+                for (std::size_t pos = 0; pos < size; pos += 5) {
+                    std::u8string narrow_stop = narrow_in;
+                    narrow_stop[pos] = static_cast<char8_t>(0xc3);
+                    CHECK(widen(std::span<std::byte const>(reinterpret_cast<std::byte const*>(narrow_stop.data()), size), wide_out.data()) == pos);
+                    std::u16string wide_stop = wide_in;
+                    wide_stop[pos] = (pos % 2 == 0) ? u'\u00e4' : u'\u0100';
+                    CHECK(narrow(wide_stop, narrow_out.data()) == pos);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/aligned_buffer_pool.hpp>
+
+#include <quicker_sfv/error.hpp>
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+
+TEST_CASE("Aligned Buffer Pool")
+{
+    using quicker_sfv::gui::AlignedBufferPool;
+
+    SECTION("Alignment helpers") {
+        static_assert(AlignedBufferPool::alignDown(0) == 0);
+        static_assert(AlignedBufferPool::alignDown(4095) == 0);
+        static_assert(AlignedBufferPool::alignDown(4096) == 4096);
+        static_assert(AlignedBufferPool::alignDown(10000) == 8192);
+        static_assert(AlignedBufferPool::alignUp(0) == 0);
+        static_assert(AlignedBufferPool::alignUp(1) == 4096);
+        static_assert(AlignedBufferPool::alignUp(4096) == 4096);
+        static_assert(AlignedBufferPool::alignUp(4097) == 8192);
+    }
+    SECTION("Buffers are aligned") {
+        AlignedBufferPool pool(3, 10000);
+        CHECK(pool.numberOfBuffers() == 3);
+        CHECK(pool.bufferSize() == 12288);
+        for (uint32_t i = 0; i < pool.numberOfBuffers(); ++i) {
+            std::span<std::byte> const b = pool.buffer(i);
+            CHECK(b.size() == pool.bufferSize());
+            CHECK(reinterpret_cast<std::uintptr_t>(b.data()) % AlignedBufferPool::ALIGNMENT == 0);
+            // buffers must be usable and must not overlap
+            std::ranges::fill(b, std::byte{ static_cast<unsigned char>(i) });
+        }
+        for (uint32_t i = 0; i < pool.numberOfBuffers(); ++i) {
+            CHECK(pool.buffer(i).front() == std::byte{ static_cast<unsigned char>(i) });
+            CHECK(pool.buffer(i).back() == std::byte{ static_cast<unsigned char>(i) });
+        }
+    }
+    SECTION("Invalid arguments") {
+        CHECK_THROWS_AS(AlignedBufferPool(0, 4096), quicker_sfv::Exception);
+        CHECK_THROWS_AS(AlignedBufferPool(1, 0), quicker_sfv::Exception);
+    }
+}
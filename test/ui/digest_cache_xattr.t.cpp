@@ -0,0 +1,69 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/digest_cache_xattr.hpp>
+
+#include <test_temporary_file.hpp>
+
+#include <catch.hpp>
+
+#include <filesystem>
+
+#include <sys/stat.h>
+#include <sys/xattr.h>
+
+namespace {
+bool supportsUserXattrs(std::filesystem::path const& p) {
+    char const probe = 'x';
+    if (setxattr(p.c_str(), "user.quickersfv.probe", &probe, 1, 0) != 0) { return false; }
+    removexattr(p.c_str(), "user.quickersfv.probe");
+    return true;
+}
+}
+
+TEST_CASE("Digest Cache Xattr")
+{
+    using quicker_sfv::FileStamp;
+    using quicker_sfv::gui::DigestCacheXattr;
+
+    TemporaryFile const f("quicker_sfv_digest_cache_xattr.t.bin", "123456789");
+    if (!supportsUserXattrs(f.path)) {
+        WARN("Skipping test: temporary directory does not support user extended attributes");
+        return;
+    }
+    DigestCacheXattr cache;
+    FileStamp const stamp{ .size = 9, .modification_time = 42 };
+
+    CHECK(!cache.readAttribute(f.u8path(), u8"user.quickersfv.sfv"));
+    CHECK(!cache.lookup(f.u8path(), u8"user.quickersfv.sfv", stamp));
+
+    struct stat st_before;
+    REQUIRE(stat(f.path.c_str(), &st_before) == 0);
+    cache.store(f.u8path(), u8"user.quickersfv.sfv", stamp, u8"CBF43926");
+    struct stat st_after;
+    REQUIRE(stat(f.path.c_str(), &st_after) == 0);
+    CHECK(st_before.st_mtim.tv_sec == st_after.st_mtim.tv_sec);
+    CHECK(st_before.st_mtim.tv_nsec == st_after.st_mtim.tv_nsec);
+
+    CHECK(cache.lookup(f.u8path(), u8"user.quickersfv.sfv", stamp) == u8"CBF43926");
+    CHECK(!cache.lookup(f.u8path(), u8"user.quickersfv.md5", stamp));
+    CHECK(!cache.lookup(f.u8path(), u8"user.quickersfv.sfv", FileStamp{ .size = 9, .modification_time = 43 }));
+    CHECK(!cache.lookup(u8"/nonexistent/quicker_sfv/file", u8"user.quickersfv.sfv", stamp));
+    CHECK(!cache.writeAttribute(u8"/nonexistent/quicker_sfv/file", u8"user.quickersfv.sfv", {}));
+}
@@ -0,0 +1,127 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/file_input_posix.hpp>
+
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/line_reader.hpp>
+#include <quicker_sfv/sfv_provider.hpp>
+
+#include <test_temporary_file.hpp>
+
+#include <catch.hpp>
+
+#include <array>
+#include <string>
+
+#include <unistd.h>
+
+namespace {
+std::string toString(std::span<std::byte const> bytes) {
+    return std::string(reinterpret_cast<char const*>(bytes.data()), bytes.size());
+}
+}
+
+TEST_CASE("File Input Posix")
+{
+    using quicker_sfv::FileInput;
+    using quicker_sfv::gui::FileInputPosix;
+
+    TemporaryFile const f("quicker_sfv_file_input_posix.t.sfv", "a.bin 01234567\r\nb.bin 89abcdef\n");
+
+    SECTION("Regular files are mapped") {
+        FileInputPosix in(f.u8path());
+        CHECK(in.isMapped());
+        CHECK(in.current_file() == u8"quicker_sfv_file_input_posix.t.sfv");
+        CHECK(in.file_size() == 31);
+        auto const mapped = in.mappedContents();
+        REQUIRE(mapped);
+        CHECK(toString(*mapped) == "a.bin 01234567\r\nb.bin 89abcdef\n");
+    }
+    SECTION("Read and seek") {
+        FileInputPosix in(f.u8path());
+        std::array<std::byte, 5> buffer;
+        CHECK(in.read(buffer) == 5);
+        CHECK(toString(buffer) == "a.bin");
+        CHECK(in.tell() == 5);
+        CHECK(toString(*in.mappedContents()) == " 01234567\r\nb.bin 89abcdef\n");
+        CHECK(in.seek(-6, FileInput::SeekStart::FileEnd) == 25);
+        std::array<std::byte, 16> large_buffer;
+        CHECK(in.read(large_buffer) == 6);
+        CHECK(in.read(large_buffer) == FileInput::RESULT_END_OF_FILE);
+        CHECK(in.mappedContents()->empty());
+        CHECK(in.seek(0, FileInput::SeekStart::FileStart) == 0);
+        CHECK_THROWS_AS(in.seek(-1, FileInput::SeekStart::FileStart), quicker_sfv::Exception);
+        CHECK_THROWS_AS(in.seek(32, FileInput::SeekStart::FileStart), quicker_sfv::Exception);
+    }
+    SECTION("Parsing from mapped file") {
+        FileInputPosix in(f.u8path());
+        auto const provider = quicker_sfv::createSfvProvider();
+        quicker_sfv::ChecksumFile const cf = provider->readFromFile(in);
+        REQUIRE(cf.getEntries().size() == 2);
+        CHECK(cf.getEntries()[0].display == u8"a.bin");
+        CHECK(cf.getEntries()[1].display == u8"b.bin");
+        CHECK(in.tell() == 0);
+        quicker_sfv::ChecksumFile const cf_parallel = provider->readFromFileParallel(in,
+            quicker_sfv::ParallelParseOptions{ .n_threads = 2, .min_chunk_size = 1 });
+        CHECK(cf_parallel.getEntries().size() == 2);
+    }
+    SECTION("Empty files") {
+        TemporaryFile const empty("quicker_sfv_file_input_posix_empty.t.sfv", "");
+        FileInputPosix in(empty.u8path());
+        CHECK(in.isMapped());
+        REQUIRE(in.mappedContents());
+        CHECK(in.mappedContents()->empty());
+        std::array<std::byte, 4> buffer;
+        CHECK(in.read(buffer) == FileInput::RESULT_END_OF_FILE);
+    }
+    SECTION("Opening other files") {
+        TemporaryFile const other("quicker_sfv_file_input_posix_other.t.bin", "other");
+        FileInputPosix in(f.u8path());
+        CHECK(!in.open(u8"quicker_sfv_file_input_posix_nonexistent.t.bin"));
+        CHECK(in.current_file() == u8"quicker_sfv_file_input_posix.t.sfv");
+        REQUIRE(in.open(u8"quicker_sfv_file_input_posix_other.t.bin"));
+        CHECK(in.current_file() == u8"quicker_sfv_file_input_posix_other.t.bin");
+        CHECK(in.file_size() == 5);
+        CHECK(toString(*in.mappedContents()) == "other");
+    }
+    SECTION("Nonexistent file") {
+        CHECK_THROWS_AS(FileInputPosix(u8"/nonexistent/quicker_sfv_file_input_posix.t.sfv"), quicker_sfv::Exception);
+    }
+    SECTION("Pipes fall back to reading") {
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+        std::string const contents = "line 1\nline 2\n";
+        REQUIRE(write(fds[1], contents.data(), contents.size()) == static_cast<ssize_t>(contents.size()));
+        close(fds[1]);
+        {
+            FileInputPosix in(std::u8string(u8"/proc/self/fd/") + reinterpret_cast<char8_t const*>(std::to_string(fds[0]).c_str()));
+            CHECK(!in.isMapped());
+            CHECK(!in.mappedContents());
+            CHECK_THROWS_AS(in.seek(0, FileInput::SeekStart::FileStart), quicker_sfv::Exception);
+            quicker_sfv::LineReader reader(in);
+            CHECK(reader.readLine() == u8"line 1");
+            CHECK(reader.readLine() == u8"line 2");
+            CHECK(reader.readLine() == u8"");
+            CHECK(reader.done());
+            CHECK(in.tell() == static_cast<int64_t>(contents.size()));
+        }
+        close(fds[0]);
+    }
+}
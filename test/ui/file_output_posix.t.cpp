@@ -0,0 +1,96 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/file_output_posix.hpp>
+
+#include <quicker_sfv/buffered_file_output.hpp>
+#include <quicker_sfv/error.hpp>
+
+#include <catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+std::span<std::byte const> asBytes(std::string_view s) {
+    return std::as_bytes(std::span<char const>(s));
+}
+
+std::string readFile(std::filesystem::path const& p) {
+    std::ifstream fin(p, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+}
+}
+
+TEST_CASE("File Output Posix")
+{
+    using quicker_sfv::gui::FileOutputPosix;
+
+    std::filesystem::path const path = std::filesystem::temp_directory_path() / "quicker_sfv_file_output_posix.t.bin";
+    std::u8string const u8path = path.u8string();
+
+    SECTION("Write") {
+        {
+            FileOutputPosix out(u8path);
+            out.write(asBytes("Hello "));
+            out.write(asBytes("World"));
+        }
+        CHECK(readFile(path) == "Hello World");
+        {
+            FileOutputPosix out(u8path);
+            out.write(asBytes("truncated"));
+        }
+        CHECK(readFile(path) == "truncated");
+    }
+    SECTION("Vectored write") {
+        std::vector<std::string> strings;
+        std::string expected;
+        for (int i = 0; i < 100; ++i) {
+            strings.push_back(std::to_string(i) + ((i % 10 == 0) ? std::string(70000, 'x') : std::string{}) + ",");
+            expected += strings.back();
+        }
+        strings.push_back("");
+        std::vector<std::span<std::byte const>> buffers;
+        for (auto const& s : strings) { buffers.push_back(asBytes(s)); }
+        {
+            FileOutputPosix out(u8path);
+            out.writeVectored(buffers);
+        }
+        CHECK(readFile(path) == expected);
+    }
+    SECTION("Buffered output") {
+        {
+            FileOutputPosix out(u8path);
+            quicker_sfv::BufferedFileOutput b(out, 4);
+            b.write(asBytes("ab"));
+            b.write(asBytes("cdefgh"));
+            b.write(asBytes("i"));
+            b.flush();
+        }
+        CHECK(readFile(path) == "abcdefghi");
+    }
+    SECTION("Invalid path") {
+        CHECK_THROWS_AS(FileOutputPosix(u8"/nonexistent/quicker_sfv_file_output_posix.t.bin"), quicker_sfv::Exception);
+    }
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
@@ -0,0 +1,322 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/hash_scheduler_linux.hpp>
+
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/sfv_provider.hpp>
+
+#include <test_temporary_file.hpp>
+
+#include <catch.hpp>
+
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+std::string generateContents(std::size_t size, uint32_t seed) {
+    std::string ret(size, '\0');
+    uint32_t x = seed;
+    for (char& c : ret) {
+        x = x * 1664525u + 1013904223u;
+        c = static_cast<char>(x >> 24);
+    }
+    return ret;
+}
+
+/** Drops the cached pages of a file.
+ * @return true if the file was evicted from the page cache.
+ */
+bool evictFromPageCache(std::filesystem::path const& p) {
+    int const fd = ::open(p.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) { return false; }
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    bool const ret = quicker_sfv::gui::probeResidency(fd, 0, static_cast<int64_t>(std::filesystem::file_size(p))) ==
+                     quicker_sfv::gui::CacheResidency::Cold;
+    close(fd);
+    return ret;
+}
+}
+
+TEST_CASE("Linux Hash Scheduler")
+{
+    using quicker_sfv::ChecksumFile;
+    using quicker_sfv::gui::CacheResidency;
+    using quicker_sfv::gui::CancelEvent;
+    using quicker_sfv::gui::HashJobResult;
+    using quicker_sfv::gui::HashScheduler;
+    using quicker_sfv::gui::HashSchedulerOptions;
+    using quicker_sfv::gui::IoUringOptions;
+    using quicker_sfv::gui::MmapHasherOptions;
+
+    auto const provider = quicker_sfv::createSfvProvider();
+    quicker_sfv::HasherOptions const hasher_options{ .has_sse42 = false, .has_avx512 = false };
+    auto const reference_hasher = provider->createHasher(hasher_options);
+    auto const hashDirectly = [&reference_hasher](std::string_view data) {
+        reference_hasher->reset();
+        reference_hasher->addData(std::as_bytes(std::span<char const>(data.data(), data.size())));
+        return reference_hasher->finalize();
+    };
+
+    std::vector<std::string> contents;
+    std::vector<std::unique_ptr<TemporaryFile>> files;
+    for (uint32_t i = 0; i < 12; ++i) {
+        contents.push_back(generateContents((i * 777777) % 3'000'000, i));
+        files.push_back(std::make_unique<TemporaryFile>("quicker_sfv_hash_scheduler_linux.t." + std::to_string(i) + ".bin",
+                                                        contents.back()));
+    }
+    std::vector<ChecksumFile::DataPortion> jobs;
+    std::vector<quicker_sfv::Digest> expected;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        jobs.push_back(ChecksumFile::DataPortion{ .path = files[i]->u8path(), .data_offset = 0, .data_size = -1 });
+        expected.push_back(hashDirectly(contents[i]));
+    }
+    // data segments
+    jobs.push_back(ChecksumFile::DataPortion{ .path = files[5]->u8path(), .data_offset = 1000, .data_size = 5000 });
+    expected.push_back(hashDirectly(std::string_view(contents[5]).substr(1000, 5000)));
+    jobs.push_back(ChecksumFile::DataPortion{ .path = files[7]->u8path(), .data_offset = 12345, .data_size = -1 });
+    expected.push_back(hashDirectly(std::string_view(contents[7]).substr(12345)));
+    std::size_t const missing_index = jobs.size();
+    jobs.push_back(ChecksumFile::DataPortion{ .path = u8"/nonexistent/quicker_sfv_hash_scheduler_linux.t.bin",
+                                              .data_offset = 0, .data_size = -1 });
+    expected.push_back(quicker_sfv::Digest{});
+
+    CancelEvent cancel;
+    std::map<std::size_t, HashJobResult> results;
+    HashScheduler::ResultCallback const collect = [&results](std::size_t job_index, HashJobResult const& r) {
+        CHECK(results.find(job_index) == results.end());
+        results[job_index] = r;
+    };
+    auto const checkResults = [&]() {
+        REQUIRE(results.size() == jobs.size());
+        for (auto const& [i, r] : results) {
+            CAPTURE(i);
+            if (i == missing_index) {
+                CHECK(r.status == HashJobResult::Status::Missing);
+            } else {
+                CHECK(r.status == HashJobResult::Status::DigestReady);
+                CHECK((r.digest == expected[i]));
+            }
+        }
+    };
+
+    SECTION("Hashing with and without residency probing") {
+        for (auto const& [probe, map] : { std::pair{ false, false }, std::pair{ true, false }, std::pair{ true, true } }) {
+            for (uint32_t const n_threads : { 0u, 1u, 4u }) {
+                results.clear();
+                HashScheduler s(*provider, hasher_options, HashSchedulerOptions{
+                    .n_cpu_threads = n_threads,
+                    .io = IoUringOptions{ .queue_depth = 4, .chunk_size = 64 << 10, .direct_io = false, .autotune = std::nullopt },
+                    .max_device_readers = n_threads,
+                    .order_by_location = (n_threads != 1),
+                    .ordered_results = false,
+                    .probe_residency = probe,
+                    .map_resident_data = map,
+                    .mmap = MmapHasherOptions{ .window_size = 256 << 10, .populate = map } });
+                s.run(jobs, cancel, collect);
+                checkResults();
+                if (!probe) {
+                    CHECK(std::ranges::all_of(results, [](auto const& p) { return p.second.residency == CacheResidency::Cold; }));
+                }
+            }
+        }
+    }
+    SECTION("Resident and cold files") {
+        std::vector<bool> evicted(files.size());
+        for (std::size_t i = 0; i < files.size(); i += 2) { evicted[i] = evictFromPageCache(files[i]->path); }
+        HashScheduler s(*provider, hasher_options, HashSchedulerOptions{
+            .n_cpu_threads = 2,
+            .io = IoUringOptions{ .queue_depth = 4, .chunk_size = 64 << 10, .direct_io = true, .autotune = std::nullopt },
+            .max_device_readers = 2,
+            .order_by_location = true,
+            .ordered_results = false,
+            .probe_residency = true,
+            .map_resident_data = true,
+            .mmap = MmapHasherOptions{ .window_size = MmapHasherOptions::DEFAULT_WINDOW_SIZE, .populate = false } });
+        s.run(jobs, cancel, collect);
+        checkResults();
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            CAPTURE(i);
+            if (evicted[i]) {
+                CHECK(results[i].residency == CacheResidency::Cold);
+            } else if ((i % 2) == 1) {
+                CHECK(results[i].residency == CacheResidency::Resident);
+            }
+        }
+    }
+    SECTION("Files on multiple devices") {
+        // tmpfs is usually mounted on a device separate from the temp directory
+        std::filesystem::path const other_directory = "/dev/shm";
+        struct stat st_tmp;
+        struct stat st_other;
+        if ((stat(std::filesystem::temp_directory_path().c_str(), &st_tmp) != 0) ||
+            (stat(other_directory.c_str(), &st_other) != 0) || (st_tmp.st_dev == st_other.st_dev) ||
+            (access(other_directory.c_str(), W_OK) != 0))
+        {
+            WARN("No second device available; skipping multi-device tests");
+            return;
+        }
+        std::vector<std::unique_ptr<TemporaryFile>> other_files;
+        for (uint32_t i = 0; i < 6; ++i) {
+            contents.push_back(generateContents((i * 555555) % 2'000'000, 100 + i));
+            other_files.push_back(std::make_unique<TemporaryFile>(other_directory,
+                "quicker_sfv_hash_scheduler_linux.t.other." + std::to_string(i) + ".bin", contents.back()));
+            // interleave the devices in the manifest
+            jobs.insert(jobs.begin() + 2 * i, ChecksumFile::DataPortion{ .path = other_files.back()->u8path(),
+                                                                         .data_offset = 0, .data_size = -1 });
+            expected.insert(expected.begin() + 2 * i, hashDirectly(contents.back()));
+        }
+        std::size_t const shifted_missing_index = jobs.size() - 1;
+        for (uint32_t const n_readers : { 1u, 2u, 8u }) {
+            for (bool const autotune : { false, true }) {
+                CAPTURE(n_readers, autotune);
+                results.clear();
+                std::optional<quicker_sfv::gui::IoAutotunerOptions> autotune_bounds;
+                if (autotune) {
+                    autotune_bounds = quicker_sfv::gui::IoAutotunerOptions{ .min_chunk_size = 4096, .max_chunk_size = 1 << 20,
+                                                                            .min_queue_depth = 1, .max_queue_depth = 8,
+                                                                            .max_bytes_in_flight = 2 << 20 };
+                }
+                HashScheduler s(*provider, hasher_options, HashSchedulerOptions{
+                    .n_cpu_threads = 2,
+                    .io = IoUringOptions{ .queue_depth = 4, .chunk_size = 64 << 10, .direct_io = false,
+                                          .autotune = autotune_bounds },
+                    .max_device_readers = n_readers,
+                    .order_by_location = autotune,
+                    .ordered_results = false,
+                    .probe_residency = false,
+                    .map_resident_data = false,
+                    .mmap = MmapHasherOptions{ .window_size = MmapHasherOptions::DEFAULT_WINDOW_SIZE, .populate = false } });
+                s.run(jobs, cancel, collect);
+                REQUIRE(results.size() == jobs.size());
+                for (auto const& [i, r] : results) {
+                    CAPTURE(i);
+                    if (i == shifted_missing_index) {
+                        CHECK(r.status == HashJobResult::Status::Missing);
+                    } else {
+                        CHECK(r.status == HashJobResult::Status::DigestReady);
+                        CHECK((r.digest == expected[i]));
+                    }
+                }
+            }
+        }
+    }
+    SECTION("Files are read in the order of their physical location") {
+        // settle the allocation of the files, so that their locations do not change anymore
+        std::vector<std::size_t> expected_order;
+        std::vector<quicker_sfv::gui::PhysicalLocation> locations;
+        for (std::size_t i = 0; i < jobs.size(); ++i) {
+            if (i == missing_index) { continue; }
+            int const fd = ::open(reinterpret_cast<char const*>(jobs[i].path.c_str()), O_RDONLY | O_CLOEXEC);
+            REQUIRE(fd >= 0);
+            fsync(fd);
+            locations.push_back(quicker_sfv::gui::queryPhysicalLocation(fd, jobs[i].data_offset));
+            close(fd);
+            expected_order.push_back(i);
+        }
+        std::ranges::stable_sort(expected_order, {}, [&](std::size_t i) {
+            return locations[(i < missing_index) ? i : (i - 1)];
+        });
+        std::vector<std::size_t> order;
+        HashScheduler::ResultCallback const record_order = [&](std::size_t job_index, HashJobResult const& r) {
+            if (job_index == missing_index) { return; }
+            CHECK(r.status == HashJobResult::Status::DigestReady);
+            CHECK((r.digest == expected[job_index]));
+            order.push_back(job_index);
+        };
+        // a single reader without CPU threads hashes everything in order on the calling thread
+        HashScheduler s(*provider, hasher_options, HashSchedulerOptions{
+            .n_cpu_threads = 0,
+            .io = IoUringOptions{ .queue_depth = 4, .chunk_size = 64 << 10, .direct_io = false, .autotune = std::nullopt },
+            .max_device_readers = 1,
+            .order_by_location = true,
+            .ordered_results = false,
+            .probe_residency = false,
+            .map_resident_data = false,
+            .mmap = MmapHasherOptions{ .window_size = MmapHasherOptions::DEFAULT_WINDOW_SIZE, .populate = false } });
+        s.run(jobs, cancel, record_order);
+        CHECK(order == expected_order);
+    }
+    SECTION("Ordered results") {
+        // cold files are read in the order of their location, while resident ones are
+        // hashed concurrently; the results still have to arrive in job order
+        for (std::size_t i = 0; i < files.size(); i += 3) { evictFromPageCache(files[i]->path); }
+        std::vector<std::size_t> order;
+        HashScheduler::ResultCallback const record_order = [&](std::size_t job_index, HashJobResult const& r) {
+            order.push_back(job_index);
+            collect(job_index, r);
+        };
+        for (uint32_t const n_threads : { 0u, 4u }) {
+            CAPTURE(n_threads);
+            results.clear();
+            order.clear();
+            HashScheduler s(*provider, hasher_options, HashSchedulerOptions{
+                .n_cpu_threads = n_threads,
+                .io = IoUringOptions{ .queue_depth = 4, .chunk_size = 64 << 10, .direct_io = false, .autotune = std::nullopt },
+                .max_device_readers = 2,
+                .order_by_location = true,
+                .ordered_results = true,
+                .probe_residency = true,
+                .map_resident_data = true,
+                .mmap = MmapHasherOptions{ .window_size = MmapHasherOptions::DEFAULT_WINDOW_SIZE, .populate = false } });
+            s.run(jobs, cancel, record_order);
+            checkResults();
+            REQUIRE(order.size() == jobs.size());
+            for (std::size_t i = 0; i < order.size(); ++i) {
+                CHECK(order[i] == i);
+            }
+        }
+    }
+    SECTION("Cancellation") {
+        cancel.signal();
+        HashScheduler s(*provider, hasher_options, HashSchedulerOptions{
+            .n_cpu_threads = 2,
+            .io = IoUringOptions{ .queue_depth = 4, .chunk_size = 64 << 10, .direct_io = false, .autotune = std::nullopt },
+            .max_device_readers = 2,
+            .order_by_location = true,
+            .ordered_results = false,
+            .probe_residency = true,
+            .map_resident_data = true,
+            .mmap = MmapHasherOptions{ .window_size = MmapHasherOptions::DEFAULT_WINDOW_SIZE, .populate = false } });
+        s.run(jobs, cancel, collect);
+        CHECK(results.empty());
+    }
+    SECTION("Empty job list") {
+        HashScheduler s(*provider, hasher_options, HashSchedulerOptions{
+            .n_cpu_threads = 2,
+            .io = IoUringOptions{ .queue_depth = 4, .chunk_size = 64 << 10, .direct_io = false, .autotune = std::nullopt },
+            .max_device_readers = 2,
+            .order_by_location = true,
+            .ordered_results = false,
+            .probe_residency = true,
+            .map_resident_data = true,
+            .mmap = MmapHasherOptions{ .window_size = MmapHasherOptions::DEFAULT_WINDOW_SIZE, .populate = false } });
+        s.run({}, cancel, collect);
+        CHECK(results.empty());
+    }
+}
@@ -0,0 +1,214 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/io_autotuner.hpp>
+
+#include <quicker_sfv/error.hpp>
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+namespace {
+/** Simulated storage device.
+ * @return Throughput in bytes per second when reading chunks of the given size with
+ *         the given number of reads in flight.
+ */
+using DeviceModel = std::function<double(std::size_t chunk_size, uint32_t queue_depth)>;
+
+/** Storage with a fixed cost per request, a bandwidth limit per request stream, a
+ * limit on the number of requests served in parallel, and an overall bandwidth limit.
+ */
+DeviceModel makeDevice(double request_overhead_s, double stream_bandwidth, uint32_t max_parallel, double max_bandwidth) {
+    return [=](std::size_t chunk_size, uint32_t queue_depth) {
+        double const chunk = static_cast<double>(chunk_size);
+        double const per_stream = chunk / (request_overhead_s + chunk / stream_bandwidth);
+        return std::min(per_stream * std::min(queue_depth, max_parallel), max_bandwidth);
+    };
+}
+
+struct SimulationResult {
+    double throughput;
+    bool stayed_in_bounds;
+};
+
+/** Feeds completions from the simulated device to the autotuner.
+ * @return Throughput achieved by the final setting of the autotuner.
+ */
+SimulationResult simulate(quicker_sfv::gui::IoAutotuner& tuner, quicker_sfv::gui::IoAutotunerOptions const& bounds,
+                          DeviceModel const& device, int n_completions) {
+    auto t = quicker_sfv::gui::IoAutotuner::Clock::time_point{};
+    bool stayed_in_bounds = true;
+    for (int i = 0; i < n_completions; ++i) {
+        std::size_t const chunk_size = tuner.chunkSize();
+        uint32_t const queue_depth = tuner.queueDepth();
+        stayed_in_bounds = stayed_in_bounds &&
+            (chunk_size >= bounds.min_chunk_size) && (chunk_size <= bounds.max_chunk_size) &&
+            (queue_depth >= bounds.min_queue_depth) && (queue_depth <= bounds.max_queue_depth) &&
+            (chunk_size * queue_depth <= bounds.max_bytes_in_flight);
+        // in steady state, one chunk completes per chunk_size / throughput, and by Little's
+        // law each read spends queue_depth times that in flight
+        std::chrono::duration<double> const interval(static_cast<double>(chunk_size) / device(chunk_size, queue_depth));
+        auto const step = std::chrono::duration_cast<std::chrono::nanoseconds>(interval);
+        t += step;
+        tuner.addCompletion(chunk_size, step * queue_depth, t);
+    }
+    return SimulationResult{ .throughput = device(tuner.chunkSize(), tuner.queueDepth()),
+                             .stayed_in_bounds = stayed_in_bounds };
+}
+
+/** Best throughput the device can achieve within the bounds, stepping through powers of 2.
+ */
+double bestThroughput(quicker_sfv::gui::IoAutotunerOptions const& bounds, DeviceModel const& device) {
+    double ret = 0.0;
+    for (std::size_t c = bounds.min_chunk_size; c <= bounds.max_chunk_size; c *= 2) {
+        for (uint32_t d = bounds.min_queue_depth; (d <= bounds.max_queue_depth) && (c * d <= bounds.max_bytes_in_flight); d *= 2) {
+            ret = std::max(ret, device(c, d));
+        }
+    }
+    return ret;
+}
+}
+
+TEST_CASE("I/O Autotuner")
+{
+    using quicker_sfv::gui::IoAutotuner;
+    using quicker_sfv::gui::IoAutotunerOptions;
+
+    IoAutotunerOptions const bounds{
+        .min_chunk_size = IoAutotunerOptions::DEFAULT_MIN_CHUNK_SIZE,
+        .max_chunk_size = IoAutotunerOptions::DEFAULT_MAX_CHUNK_SIZE,
+        .min_queue_depth = IoAutotunerOptions::DEFAULT_MIN_QUEUE_DEPTH,
+        .max_queue_depth = IoAutotunerOptions::DEFAULT_MAX_QUEUE_DEPTH,
+        .max_bytes_in_flight = IoAutotunerOptions::DEFAULT_MAX_BYTES_IN_FLIGHT,
+    };
+
+    SECTION("Invalid bounds") {
+        CHECK_THROWS_AS(IoAutotuner(IoAutotunerOptions{ .min_chunk_size = 0, .max_chunk_size = 4096,
+                                                        .min_queue_depth = 1, .max_queue_depth = 2,
+                                                        .max_bytes_in_flight = 8192 }, 4096, 1),
+                        quicker_sfv::Exception);
+        CHECK_THROWS_AS(IoAutotuner(IoAutotunerOptions{ .min_chunk_size = 8192, .max_chunk_size = 4096,
+                                                        .min_queue_depth = 1, .max_queue_depth = 2,
+                                                        .max_bytes_in_flight = 8192 }, 4096, 1),
+                        quicker_sfv::Exception);
+        CHECK_THROWS_AS(IoAutotuner(IoAutotunerOptions{ .min_chunk_size = 4096, .max_chunk_size = 4096,
+                                                        .min_queue_depth = 0, .max_queue_depth = 2,
+                                                        .max_bytes_in_flight = 8192 }, 4096, 1),
+                        quicker_sfv::Exception);
+        CHECK_THROWS_AS(IoAutotuner(IoAutotunerOptions{ .min_chunk_size = 4096, .max_chunk_size = 4096,
+                                                        .min_queue_depth = 3, .max_queue_depth = 2,
+                                                        .max_bytes_in_flight = 8192 }, 4096, 1),
+                        quicker_sfv::Exception);
+        CHECK_THROWS_AS(IoAutotuner(IoAutotunerOptions{ .min_chunk_size = 4096, .max_chunk_size = 4096,
+                                                        .min_queue_depth = 2, .max_queue_depth = 2,
+                                                        .max_bytes_in_flight = 8191 }, 4096, 1),
+                        quicker_sfv::Exception);
+    }
+    SECTION("Initial setting is clamped to the bounds") {
+        IoAutotuner const t1(bounds, 1, 1000);
+        CHECK(t1.chunkSize() == IoAutotunerOptions::DEFAULT_MIN_CHUNK_SIZE);
+        CHECK(t1.queueDepth() == IoAutotunerOptions::DEFAULT_MAX_QUEUE_DEPTH);
+        IoAutotuner const t2(bounds, 1 << 20, 4);
+        CHECK(t2.chunkSize() == (1 << 20));
+        CHECK(t2.queueDepth() == 4);
+        CHECK(t2.bandwidthMiBs() == 0);
+        // the queue depth gives way first when the setting does not fit the budget
+        IoAutotuner const t3(bounds, IoAutotunerOptions::DEFAULT_MAX_CHUNK_SIZE, IoAutotunerOptions::DEFAULT_MAX_QUEUE_DEPTH);
+        CHECK(t3.chunkSize() == IoAutotunerOptions::DEFAULT_MAX_CHUNK_SIZE);
+        CHECK(t3.queueDepth() == 4);
+        IoAutotuner const t4(IoAutotunerOptions{ .min_chunk_size = 4096, .max_chunk_size = 1 << 20,
+                                                 .min_queue_depth = 2, .max_queue_depth = 8,
+                                                 .max_bytes_in_flight = 64 << 10 }, 1 << 20, 8);
+        CHECK(t4.chunkSize() == (32 << 10));
+        CHECK(t4.queueDepth() == 2);
+    }
+    SECTION("Fixed setting") {
+        IoAutotuner t(IoAutotunerOptions{ .min_chunk_size = 1 << 20, .max_chunk_size = 1 << 20,
+                                          .min_queue_depth = 4, .max_queue_depth = 4,
+                                          .max_bytes_in_flight = 4 << 20 }, 1 << 20, 4);
+        SimulationResult const res = simulate(t, bounds, makeDevice(0.0001, 1e9, 64, 3e9), 1000);
+        CHECK(res.stayed_in_bounds);
+        CHECK(t.chunkSize() == (1 << 20));
+        CHECK(t.queueDepth() == 4);
+        // 4 streams of 1 MiB chunks exceed the device limit of 3 GB/s
+        CHECK(t.bandwidthMiBs() >= 2850);
+        CHECK(t.bandwidthMiBs() <= 2862);
+    }
+    SECTION("Convergence") {
+        struct Scenario {
+            char const* name;
+            DeviceModel device;
+        };
+        for (Scenario const& s : { Scenario{ "Hard disk", makeDevice(0.008, 150e6, 1, 150e6) },
+                                   Scenario{ "NVMe", makeDevice(0.0001, 1e9, 64, 3e9) },
+                                   Scenario{ "NVMe RAID", makeDevice(0.0001, 1e9, 64, 12e9) },
+                                   Scenario{ "Network share", makeDevice(0.02, 50e6, 64, 400e6) } })
+        {
+            CAPTURE(s.name);
+            for (auto const& [chunk_size, queue_depth] : { std::pair<std::size_t, uint32_t>{ 4 << 20, 2 },
+                                                         std::pair<std::size_t, uint32_t>{ 64 << 10, 1 },
+                                                         std::pair<std::size_t, uint32_t>{ 8 << 20, 16 } })
+            {
+                CAPTURE(chunk_size, queue_depth);
+                IoAutotuner t(bounds, chunk_size, queue_depth);
+                SimulationResult const res = simulate(t, bounds, s.device, 20'000);
+                CHECK(res.stayed_in_bounds);
+                CHECK(res.throughput >= 0.85 * bestThroughput(bounds, s.device));
+            }
+        }
+    }
+    SECTION("Hard disks get few reads in flight") {
+        IoAutotuner t(bounds, 1 << 20, 8);
+        simulate(t, bounds, makeDevice(0.008, 150e6, 1, 150e6), 20'000);
+        CHECK(t.queueDepth() <= 2);
+    }
+    SECTION("Latency is kept in check") {
+        DeviceModel const slow_device = makeDevice(0.001, 1e6, 1, 1e6);
+        IoAutotuner t(bounds, IoAutotunerOptions::DEFAULT_MAX_CHUNK_SIZE, 4);
+        simulate(t, bounds, slow_device, 2'000);
+        CHECK(t.averageLatency() <= std::chrono::milliseconds(200));
+        CHECK(t.chunkSize() * t.queueDepth() <= 200'000);
+    }
+    SECTION("Memory budget limits the reads in flight") {
+        IoAutotunerOptions const tight_bounds{
+            .min_chunk_size = IoAutotunerOptions::DEFAULT_MIN_CHUNK_SIZE,
+            .max_chunk_size = IoAutotunerOptions::DEFAULT_MAX_CHUNK_SIZE,
+            .min_queue_depth = IoAutotunerOptions::DEFAULT_MIN_QUEUE_DEPTH,
+            .max_queue_depth = IoAutotunerOptions::DEFAULT_MAX_QUEUE_DEPTH,
+            .max_bytes_in_flight = 4 << 20,
+        };
+        // the RAID would take every read in flight it can get
+        DeviceModel const fast_device = makeDevice(0.0001, 1e9, 64, 12e9);
+        IoAutotuner t(tight_bounds, 1 << 20, 4);
+        SimulationResult const res = simulate(t, tight_bounds, fast_device, 20'000);
+        CHECK(res.stayed_in_bounds);
+        CHECK(res.throughput >= 0.85 * bestThroughput(tight_bounds, fast_device));
+    }
+    SECTION("Adapting to a change of storage") {
+        IoAutotuner t(bounds, 1 << 20, 4);
+        DeviceModel const fast_device = makeDevice(0.0001, 1e9, 64, 12e9);
+        DeviceModel const network_share = makeDevice(0.02, 50e6, 64, 400e6);
+        simulate(t, bounds, fast_device, 20'000);
+        SimulationResult const res = simulate(t, bounds, network_share, 20'000);
+        CHECK(res.throughput >= 0.85 * bestThroughput(bounds, network_share));
+    }
+}
@@ -0,0 +1,259 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/io_uring_hasher.hpp>
+
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/md5_provider.hpp>
+
+#include <test_temporary_file.hpp>
+
+#include <catch.hpp>
+
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+std::string generateContents(std::size_t size) {
+    std::string ret(size, '\0');
+    uint32_t x = 0x12345678u;
+    for (char& c : ret) {
+        x = x * 1664525u + 1013904223u;
+        c = static_cast<char>(x >> 24);
+    }
+    return ret;
+}
+
+std::span<std::byte const> asBytes(std::string_view str) {
+    return std::as_bytes(std::span<char const>(str.data(), str.size()));
+}
+
+quicker_sfv::Digest hashDirectly(quicker_sfv::Hasher& hasher, std::string_view data) {
+    hasher.reset();
+    hasher.addData(asBytes(data));
+    return hasher.finalize();
+}
+}
+
+TEST_CASE("io_uring Hasher")
+{
+    using quicker_sfv::gui::CancelEvent;
+    using quicker_sfv::gui::HashResult;
+    using quicker_sfv::gui::IoUringHasher;
+    using quicker_sfv::gui::IoUringOptions;
+
+    SECTION("Cancel event") {
+        CancelEvent e;
+        CHECK(!e.isSignaled());
+        e.signal();
+        CHECK(e.isSignaled());
+        e.signal();
+        CHECK(e.isSignaled());
+        e.reset();
+        CHECK(!e.isSignaled());
+        e.reset();
+        CHECK(!e.isSignaled());
+    }
+
+    if (!IoUringHasher::isSupported()) {
+        WARN("io_uring is not available; skipping io_uring hashing tests");
+        return;
+    }
+
+    std::string const contents = generateContents((5 << 20) + 12345);
+    TemporaryFile const f("quicker_sfv_io_uring_hasher.t.bin", contents);
+    FileDescriptor const fin(f.path, O_RDONLY);
+    REQUIRE(fin.fd >= 0);
+    auto const provider = quicker_sfv::createMD5Provider();
+    auto const hasher = provider->createHasher(quicker_sfv::HasherOptions{ .has_sse42 = false, .has_avx512 = false });
+    auto const reference_hasher = provider->createHasher(quicker_sfv::HasherOptions{ .has_sse42 = false, .has_avx512 = false });
+    quicker_sfv::Digest const expected = hashDirectly(*reference_hasher, contents);
+    CancelEvent cancel;
+    quicker_sfv::gui::HashProgressCallback const no_progress;
+
+    SECTION("Invalid options") {
+        CHECK_THROWS_AS(IoUringHasher(IoUringOptions{ .queue_depth = 0, .chunk_size = 4096, .direct_io = false, .autotune = std::nullopt }), quicker_sfv::Exception);
+        CHECK_THROWS_AS(IoUringHasher(IoUringOptions{ .queue_depth = IoUringOptions::MAX_QUEUE_DEPTH + 1, .chunk_size = 4096, .direct_io = false, .autotune = std::nullopt }),
+                        quicker_sfv::Exception);
+        CHECK_THROWS_AS(IoUringHasher(IoUringOptions{ .queue_depth = 4, .chunk_size = 0, .direct_io = false, .autotune = std::nullopt }), quicker_sfv::Exception);
+    }
+    SECTION("Hashing whole files") {
+        for (IoUringOptions const opts : { IoUringOptions{ .queue_depth = 1, .chunk_size = 4096, .direct_io = false, .autotune = std::nullopt },
+                                           IoUringOptions{ .queue_depth = 3, .chunk_size = 65536 + 7, .direct_io = false, .autotune = std::nullopt },
+                                           IoUringOptions{ .queue_depth = IoUringOptions::DEFAULT_QUEUE_DEPTH,
+                                                           .chunk_size = IoUringOptions::DEFAULT_CHUNK_SIZE,
+                                                           .direct_io = false, .autotune = std::nullopt },
+                                           IoUringOptions{ .queue_depth = 64, .chunk_size = 1 << 16, .direct_io = false, .autotune = std::nullopt },
+                                           IoUringOptions{ .queue_depth = 3, .chunk_size = 65536 + 7, .direct_io = true, .autotune = std::nullopt },
+                                           IoUringOptions{ .queue_depth = 8, .chunk_size = 1 << 20, .direct_io = true, .autotune = std::nullopt } })
+        {
+            IoUringHasher h(opts);
+            CHECK(h.hashFile(no_progress, *hasher, fin.fd, 0, static_cast<int64_t>(contents.size()), cancel) ==
+                  HashResult::DigestReady);
+            CHECK((hasher->finalize() == expected));
+        }
+    }
+    IoUringHasher h(IoUringOptions{ .queue_depth = 4, .chunk_size = 1 << 20, .direct_io = false, .autotune = std::nullopt });
+    SECTION("Hashing a data segment") {
+        CHECK(h.hashFile(no_progress, *hasher, fin.fd, 1000, 3'000'000, cancel) == HashResult::DigestReady);
+        CHECK((hasher->finalize() == hashDirectly(*reference_hasher, std::string_view(contents).substr(1000, 3'000'000))));
+        CHECK(h.hashFile(no_progress, *hasher, fin.fd, 17, 0, cancel) == HashResult::DigestReady);
+        CHECK((hasher->finalize() == hashDirectly(*reference_hasher, "")));
+    }
+    SECTION("Direct I/O") {
+        IoUringHasher direct(IoUringOptions{ .queue_depth = 4, .chunk_size = 256 << 10, .direct_io = true, .autotune = std::nullopt });
+        struct Segment {
+            int64_t offset;
+            int64_t size;
+        };
+        int64_t const file_size = static_cast<int64_t>(contents.size());
+        for (Segment const seg : { Segment{ 0, file_size }, Segment{ 1000, 3'000'000 }, Segment{ 4096, 8192 },
+                                   Segment{ 4095, 2 }, Segment{ 5000, 100 }, Segment{ file_size - 10, 10 },
+                                   Segment{ 8192, file_size }, Segment{ 0, 1 << 20 } })
+        {
+            CAPTURE(seg.offset, seg.size);
+            CHECK(direct.hashFile(no_progress, *hasher, fin.fd, seg.offset, seg.size, cancel) == HashResult::DigestReady);
+            std::string_view const expected_data = std::string_view(contents).substr(seg.offset, seg.size);
+            CHECK((hasher->finalize() == hashDirectly(*reference_hasher, expected_data)));
+            // the direct flag must not leak out of the call
+            CHECK((fcntl(fin.fd, F_GETFL) & O_DIRECT) == 0);
+        }
+        // segments within a single block are read through the page cache
+        CHECK(direct.hashFile(no_progress, *hasher, fin.fd, 5000, 100, cancel) == HashResult::DigestReady);
+        CHECK(!direct.usedDirectIo());
+        CHECK(!h.usedDirectIo());
+        // cancellation while reading directly
+        cancel.signal();
+        CHECK(direct.hashFile(no_progress, *hasher, fin.fd, 0, file_size, cancel) == HashResult::Canceled);
+        CHECK((fcntl(fin.fd, F_GETFL) & O_DIRECT) == 0);
+        cancel.reset();
+    }
+    SECTION("Autotuning") {
+        using quicker_sfv::gui::IoAutotunerOptions;
+        IoAutotunerOptions const bounds{ .min_chunk_size = 4096, .max_chunk_size = 256 << 10,
+                                         .min_queue_depth = 1, .max_queue_depth = 8,
+                                         .max_bytes_in_flight = 1 << 20 };
+        CHECK_THROWS_AS(IoUringHasher(IoUringOptions{ .queue_depth = 4, .chunk_size = 4096, .direct_io = false,
+                                                      .autotune = IoAutotunerOptions{ .min_chunk_size = 4096,
+                                                          .max_chunk_size = 4096, .min_queue_depth = 1,
+                                                          .max_queue_depth = IoUringOptions::MAX_QUEUE_DEPTH + 1,
+                                                          .max_bytes_in_flight = 4096 * (IoUringOptions::MAX_QUEUE_DEPTH + 1) } }),
+                        quicker_sfv::Exception);
+        CHECK_THROWS_AS(IoUringHasher(IoUringOptions{ .queue_depth = 4, .chunk_size = 4096, .direct_io = false,
+                                                      .autotune = IoAutotunerOptions{ .min_chunk_size = 8192,
+                                                          .max_chunk_size = 4096, .min_queue_depth = 1,
+                                                          .max_queue_depth = 4, .max_bytes_in_flight = 32768 } }),
+                        quicker_sfv::Exception);
+        CHECK(h.autotuner() == nullptr);
+        int64_t const file_size = static_cast<int64_t>(contents.size());
+        for (bool const direct_io : { false, true }) {
+            IoUringHasher tuned(IoUringOptions{ .queue_depth = 2, .chunk_size = 64 << 10, .direct_io = direct_io,
+                                                .autotune = bounds });
+            REQUIRE(tuned.autotuner() != nullptr);
+            CHECK(tuned.autotuner()->chunkSize() == (64 << 10));
+            CHECK(tuned.autotuner()->queueDepth() == 2);
+            // hash repeatedly, so that the setting changes while reading
+            for (int i = 0; i < 8; ++i) {
+                CHECK(tuned.hashFile(no_progress, *hasher, fin.fd, 0, file_size, cancel) == HashResult::DigestReady);
+                CHECK((hasher->finalize() == expected));
+                CHECK(tuned.hashFile(no_progress, *hasher, fin.fd, 1000, 3'000'000, cancel) == HashResult::DigestReady);
+                CHECK((hasher->finalize() == hashDirectly(*reference_hasher, std::string_view(contents).substr(1000, 3'000'000))));
+                CHECK(tuned.autotuner()->chunkSize() >= bounds.min_chunk_size);
+                CHECK(tuned.autotuner()->chunkSize() <= bounds.max_chunk_size);
+                CHECK(tuned.autotuner()->queueDepth() >= bounds.min_queue_depth);
+                CHECK(tuned.autotuner()->queueDepth() <= bounds.max_queue_depth);
+            }
+            CHECK(tuned.autotuner()->bandwidthMiBs() > 0);
+        }
+    }
+    SECTION("Files shorter than the data segment are hashed to their end") {
+        CHECK(h.hashFile(no_progress, *hasher, fin.fd, 0, static_cast<int64_t>(contents.size()) + 5000, cancel) ==
+              HashResult::DigestReady);
+        CHECK((hasher->finalize() == expected));
+    }
+    SECTION("Progress") {
+        std::vector<uint32_t> percentages;
+        quicker_sfv::gui::HashProgressCallback const on_progress = [&percentages](uint32_t percentage, uint32_t) {
+            percentages.push_back(percentage);
+        };
+        CHECK(h.hashFile(on_progress, *hasher, fin.fd, 0, static_cast<int64_t>(contents.size()), cancel) ==
+              HashResult::DigestReady);
+        CHECK((hasher->finalize() == expected));
+        REQUIRE(!percentages.empty());
+        CHECK(std::ranges::is_sorted(percentages));
+        CHECK(std::ranges::adjacent_find(percentages) == percentages.end());
+        CHECK(percentages.back() < 100);
+    }
+    SECTION("Cancellation") {
+        cancel.signal();
+        CHECK(h.hashFile(no_progress, *hasher, fin.fd, 0, static_cast<int64_t>(contents.size()), cancel) ==
+              HashResult::Canceled);
+        cancel.reset();
+        // cancel from within the hashing
+        quicker_sfv::gui::HashProgressCallback const cancel_on_progress = [&cancel](uint32_t, uint32_t) {
+            cancel.signal();
+        };
+        CHECK(h.hashFile(cancel_on_progress, *hasher, fin.fd, 0, static_cast<int64_t>(contents.size()), cancel) ==
+              HashResult::Canceled);
+        cancel.reset();
+        // the hasher remains usable after cancellation
+        CHECK(h.hashFile(no_progress, *hasher, fin.fd, 0, static_cast<int64_t>(contents.size()), cancel) ==
+              HashResult::DigestReady);
+        CHECK((hasher->finalize() == expected));
+    }
+    SECTION("Read errors") {
+        FileDescriptor const write_only(f.path, O_WRONLY);
+        REQUIRE(write_only.fd >= 0);
+        CHECK(h.hashFile(no_progress, *hasher, write_only.fd, 0, static_cast<int64_t>(contents.size()), cancel) ==
+              HashResult::Error);
+        CHECK(h.hashFile(no_progress, *hasher, fin.fd, 0, static_cast<int64_t>(contents.size()), cancel) ==
+              HashResult::DigestReady);
+        CHECK((hasher->finalize() == expected));
+    }
+    SECTION("Invalid resume state") {
+        CHECK_THROWS_AS(h.hashFile(no_progress, *hasher, fin.fd, 0, 10, cancel, asBytes("invalid state")),
+                        quicker_sfv::Exception);
+        CHECK(h.hashFile(no_progress, *hasher, fin.fd, 0, static_cast<int64_t>(contents.size()), cancel) ==
+              HashResult::DigestReady);
+        CHECK((hasher->finalize() == expected));
+    }
+    SECTION("Resuming from a saved state") {
+        REQUIRE(hasher->supportsSavedState());
+        std::size_t const prefix_size = 2'000'000;
+        reference_hasher->reset();
+        reference_hasher->addData(asBytes(std::string_view(contents).substr(0, prefix_size)));
+        std::vector<std::byte> const state = reference_hasher->saveState();
+        CHECK(h.hashFile(no_progress, *hasher, fin.fd, prefix_size, static_cast<int64_t>(contents.size() - prefix_size),
+                         cancel, state) == HashResult::DigestReady);
+        CHECK((hasher->finalize() == expected));
+    }
+    SECTION("Block digests") {
+        auto const block_hasher = provider->createHasher(quicker_sfv::HasherOptions{ .has_sse42 = false, .has_avx512 = false });
+        quicker_sfv::BlockDigestBuilder builder(*block_hasher, 1 << 20);
+        CHECK(h.hashFile(no_progress, *hasher, fin.fd, 0, static_cast<int64_t>(contents.size()), cancel, {}, &builder) ==
+              HashResult::DigestReady);
+        CHECK((hasher->finalize() == expected));
+        std::vector<quicker_sfv::Digest> const blocks = builder.finalize();
+        REQUIRE(blocks.size() == 6);
+        CHECK((blocks[5] == hashDirectly(*reference_hasher, std::string_view(contents).substr(5 << 20))));
+    }
+}
@@ -0,0 +1,186 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/mmap_hasher.hpp>
+
+#include <quicker_sfv/error.hpp>
+#include <quicker_sfv/md5_provider.hpp>
+
+#include <test_temporary_file.hpp>
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+std::string generateContents(std::size_t size) {
+    std::string ret(size, '\0');
+    uint32_t x = 0x12345678u;
+    for (char& c : ret) {
+        x = x * 1664525u + 1013904223u;
+        c = static_cast<char>(x >> 24);
+    }
+    return ret;
+}
+
+std::span<std::byte const> asBytes(std::string_view str) {
+    return std::as_bytes(std::span<char const>(str.data(), str.size()));
+}
+
+quicker_sfv::Digest hashDirectly(quicker_sfv::Hasher& hasher, std::string_view data) {
+    hasher.reset();
+    hasher.addData(asBytes(data));
+    return hasher.finalize();
+}
+}
+
+TEST_CASE("mmap Hasher")
+{
+    using quicker_sfv::gui::CancelEvent;
+    using quicker_sfv::gui::HashResult;
+    using quicker_sfv::gui::MmapHasher;
+    using quicker_sfv::gui::MmapHasherOptions;
+
+    std::string const contents = generateContents((5 << 20) + 12345);
+    TemporaryFile const f("quicker_sfv_mmap_hasher.t.bin", contents);
+    FileDescriptor const fin(f.path, O_RDONLY);
+    REQUIRE(fin.fd >= 0);
+    auto const provider = quicker_sfv::createMD5Provider();
+    auto const hasher = provider->createHasher(quicker_sfv::HasherOptions{ .has_sse42 = false, .has_avx512 = false });
+    auto const reference_hasher = provider->createHasher(quicker_sfv::HasherOptions{ .has_sse42 = false, .has_avx512 = false });
+    quicker_sfv::Digest const expected = hashDirectly(*reference_hasher, contents);
+    CancelEvent cancel;
+    quicker_sfv::gui::HashProgressCallback const no_progress;
+    int64_t const file_size = static_cast<int64_t>(contents.size());
+
+    SECTION("Invalid options") {
+        CHECK_THROWS_AS(MmapHasher(MmapHasherOptions{ .window_size = 0, .populate = false }), quicker_sfv::Exception);
+    }
+    SECTION("Hashing whole files") {
+        for (MmapHasherOptions const opts : { MmapHasherOptions{ .window_size = 1, .populate = false },
+                                              MmapHasherOptions{ .window_size = 65536 + 7, .populate = true },
+                                              MmapHasherOptions{ .window_size = 4 << 20, .populate = false },
+                                              MmapHasherOptions{ .window_size = MmapHasherOptions::DEFAULT_WINDOW_SIZE,
+                                                                 .populate = false },
+                                              MmapHasherOptions{ .window_size = MmapHasherOptions::DEFAULT_WINDOW_SIZE,
+                                                                 .populate = true } })
+        {
+            MmapHasher h(opts);
+            CHECK(h.hashFile(no_progress, *hasher, fin.fd, 0, file_size, cancel) == HashResult::DigestReady);
+            CHECK((hasher->finalize() == expected));
+        }
+    }
+    MmapHasher h(MmapHasherOptions{ .window_size = 2 << 20, .populate = false });
+    SECTION("Hashing data segments") {
+        struct Segment {
+            int64_t offset;
+            int64_t size;
+        };
+        for (Segment const seg : { Segment{ 1000, 3'000'000 }, Segment{ 4096, 8192 }, Segment{ 4095, 2 },
+                                   Segment{ (2 << 20) - 1, 2 }, Segment{ file_size - 10, 10 }, Segment{ 17, 0 } })
+        {
+            CAPTURE(seg.offset, seg.size);
+            CHECK(h.hashFile(no_progress, *hasher, fin.fd, seg.offset, seg.size, cancel) == HashResult::DigestReady);
+            std::string_view const expected_data = std::string_view(contents).substr(seg.offset, seg.size);
+            CHECK((hasher->finalize() == hashDirectly(*reference_hasher, expected_data)));
+        }
+    }
+    SECTION("Files shorter than the data segment are hashed to their end") {
+        CHECK(h.hashFile(no_progress, *hasher, fin.fd, 0, file_size + 5000, cancel) == HashResult::DigestReady);
+        CHECK((hasher->finalize() == expected));
+        CHECK(h.hashFile(no_progress, *hasher, fin.fd, file_size + 5000, 10, cancel) == HashResult::DigestReady);
+        CHECK((hasher->finalize() == hashDirectly(*reference_hasher, "")));
+    }
+    SECTION("Progress") {
+        std::vector<uint32_t> percentages;
+        quicker_sfv::gui::HashProgressCallback const on_progress = [&percentages](uint32_t percentage, uint32_t) {
+            percentages.push_back(percentage);
+        };
+        CHECK(h.hashFile(on_progress, *hasher, fin.fd, 0, file_size, cancel) == HashResult::DigestReady);
+        CHECK((hasher->finalize() == expected));
+        REQUIRE(!percentages.empty());
+        CHECK(std::ranges::is_sorted(percentages));
+        CHECK(percentages.back() < 100);
+    }
+    SECTION("Cancellation") {
+        cancel.signal();
+        CHECK(h.hashFile(no_progress, *hasher, fin.fd, 0, file_size, cancel) == HashResult::Canceled);
+        cancel.reset();
+        quicker_sfv::gui::HashProgressCallback const cancel_on_progress = [&cancel](uint32_t, uint32_t) {
+            cancel.signal();
+        };
+        CHECK(h.hashFile(cancel_on_progress, *hasher, fin.fd, 0, file_size, cancel) == HashResult::Canceled);
+        cancel.reset();
+        CHECK(h.hashFile(no_progress, *hasher, fin.fd, 0, file_size, cancel) == HashResult::DigestReady);
+        CHECK((hasher->finalize() == expected));
+    }
+    SECTION("Unmappable files") {
+        FileDescriptor const write_only(f.path, O_WRONLY);
+        REQUIRE(write_only.fd >= 0);
+        CHECK(h.hashFile(no_progress, *hasher, write_only.fd, 0, file_size, cancel) == HashResult::Error);
+        CHECK(h.hashFile(no_progress, *hasher, fin.fd, 0, file_size, cancel) == HashResult::DigestReady);
+        CHECK((hasher->finalize() == expected));
+    }
+    SECTION("Files truncated while hashing") {
+        TemporaryFile const truncated("quicker_sfv_mmap_hasher_truncated.t.bin", contents);
+        FileDescriptor const truncated_fd(truncated.path, O_RDWR);
+        REQUIRE(truncated_fd.fd >= 0);
+        // progress is reported between slices, so the truncation happens before the
+        // next slice of the mapping is accessed
+        bool is_truncated = false;
+        int truncate_result = 0;
+        quicker_sfv::gui::HashProgressCallback const truncate_on_progress = [&](uint32_t, uint32_t) {
+            if (!is_truncated) {
+                is_truncated = true;
+                truncate_result = ::ftruncate(truncated_fd.fd, 100);
+            }
+        };
+        // hashing falls back to reads and hashes the file up to its new end
+        CHECK(h.hashFile(truncate_on_progress, *hasher, truncated_fd.fd, 0, file_size, cancel) == HashResult::DigestReady);
+        REQUIRE(is_truncated);
+        CHECK(truncate_result == 0);
+        CHECK((hasher->finalize() == hashDirectly(*reference_hasher, std::string_view(contents).substr(0, 100))));
+        CHECK(h.hashFile(no_progress, *hasher, fin.fd, 0, file_size, cancel) == HashResult::DigestReady);
+        CHECK((hasher->finalize() == expected));
+    }
+    SECTION("Resuming from a saved state") {
+        REQUIRE(hasher->supportsSavedState());
+        std::size_t const prefix_size = 2'000'000;
+        reference_hasher->reset();
+        reference_hasher->addData(asBytes(std::string_view(contents).substr(0, prefix_size)));
+        std::vector<std::byte> const state = reference_hasher->saveState();
+        CHECK(h.hashFile(no_progress, *hasher, fin.fd, prefix_size, file_size - static_cast<int64_t>(prefix_size),
+                         cancel, state) == HashResult::DigestReady);
+        CHECK((hasher->finalize() == expected));
+    }
+    SECTION("Block digests") {
+        auto const block_hasher = provider->createHasher(quicker_sfv::HasherOptions{ .has_sse42 = false, .has_avx512 = false });
+        quicker_sfv::BlockDigestBuilder builder(*block_hasher, 1 << 20);
+        CHECK(h.hashFile(no_progress, *hasher, fin.fd, 0, file_size, cancel, {}, &builder) == HashResult::DigestReady);
+        CHECK((hasher->finalize() == expected));
+        std::vector<quicker_sfv::Digest> const blocks = builder.finalize();
+        REQUIRE(blocks.size() == 6);
+        CHECK((blocks[5] == hashDirectly(*reference_hasher, std::string_view(contents).substr(5 << 20))));
+    }
+}
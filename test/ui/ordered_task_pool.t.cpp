@@ -0,0 +1,147 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/ordered_task_pool.hpp>
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <latch>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Ordered Task Pool")
+{
+    using quicker_sfv::gui::OrderedTaskPool;
+
+    std::vector<std::size_t> delivered;
+    auto const sink = [&delivered](std::size_t&& r) { delivered.push_back(r); };
+    std::vector<std::size_t> expected(32);
+    std::iota(begin(expected), end(expected), std::size_t{ 0 });
+
+    SECTION("Results are delivered in order of submission") {
+        OrderedTaskPool<std::size_t> pool(4, 8, sink);
+        CHECK(pool.workerCount() == 4);
+        std::atomic<uint32_t> max_worker_index = 0;
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            pool.submit([&max_worker_index, i](uint32_t worker_index) {
+                uint32_t m = max_worker_index;
+                while ((worker_index > m) && !max_worker_index.compare_exchange_weak(m, worker_index)) {}
+                // later tasks complete first
+                std::this_thread::sleep_for(std::chrono::microseconds((8 - (i % 8)) * 500));
+                return i;
+            });
+        }
+        pool.finish();
+        CHECK(delivered == expected);
+        CHECK(max_worker_index < 4);
+    }
+    SECTION("Tasks run concurrently") {
+        OrderedTaskPool<std::size_t> pool(4, 4, sink);
+        // blocks forever unless all four tasks are running at the same time
+        std::latch all_running(4);
+        std::vector<std::atomic<bool>> worker_busy(4);
+        std::atomic<bool> worker_shared = false;
+        for (std::size_t i = 0; i < 4; ++i) {
+            pool.submit([&, i](uint32_t worker_index) {
+                if (worker_busy[worker_index].exchange(true)) { worker_shared = true; }
+                all_running.arrive_and_wait();
+                return i;
+            });
+        }
+        pool.finish();
+        CHECK(delivered == std::vector<std::size_t>{ 0, 1, 2, 3 });
+        CHECK(!worker_shared);
+    }
+    SECTION("Number of tasks in flight is bounded") {
+        std::size_t const max_in_flight = 3;
+        std::atomic<std::size_t> n_started = 0;
+        std::size_t n_submitted = 0;
+        OrderedTaskPool<std::size_t> pool(2, max_in_flight, [&](std::size_t&& r) {
+            CHECK(r == delivered.size());
+            delivered.push_back(r);
+            CHECK(n_submitted - delivered.size() < max_in_flight);
+        });
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            pool.submit([&, i](uint32_t) {
+                ++n_started;
+                // the first task is slow, so that all later ones pile up behind it
+                if (i == 0) { std::this_thread::sleep_for(std::chrono::milliseconds(20)); }
+                return i;
+            });
+            ++n_submitted;
+            CHECK(n_submitted - delivered.size() <= max_in_flight);
+            CHECK(n_started <= delivered.size() + max_in_flight);
+        }
+        pool.finish();
+        CHECK(delivered == expected);
+    }
+    SECTION("Without workers, tasks run on the submitting thread") {
+        OrderedTaskPool<std::size_t> pool(0, 0, sink);
+        CHECK(pool.workerCount() == 0);
+        auto const this_thread = std::this_thread::get_id();
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            pool.submit([&, i](uint32_t worker_index) {
+                CHECK(worker_index == 0);
+                CHECK(std::this_thread::get_id() == this_thread);
+                return i;
+            });
+            // delivered right away
+            CHECK(delivered.size() == i + 1);
+        }
+        pool.finish();
+        CHECK(delivered == expected);
+    }
+    SECTION("Exceptions from tasks are rethrown on the submitting thread") {
+        OrderedTaskPool<std::size_t> pool(3, 6, sink);
+        auto const submitAll = [&]() {
+            for (std::size_t i = 0; i < expected.size(); ++i) {
+                pool.submit([i](uint32_t) -> std::size_t {
+                    if (i == 5) { throw std::runtime_error("task failed"); }
+                    return i;
+                });
+            }
+            pool.finish();
+        };
+        CHECK_THROWS_AS(submitAll(), std::runtime_error);
+        // nothing after the failed task is delivered
+        CHECK(delivered.size() <= 5);
+        CHECK(std::ranges::equal(delivered, std::span(expected).first(delivered.size())));
+    }
+    SECTION("Destruction discards tasks that were not started") {
+        std::atomic<std::size_t> n_started = 0;
+        {
+            OrderedTaskPool<std::size_t> pool(1, expected.size(), sink);
+            for (std::size_t i = 0; i < expected.size(); ++i) {
+                pool.submit([&, i](uint32_t) {
+                    ++n_started;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    return i;
+                });
+            }
+        }
+        CHECK(n_started < expected.size());
+        CHECK(delivered.empty());
+    }
+}
@@ -0,0 +1,99 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/page_cache_residency.hpp>
+
+#include <test_temporary_file.hpp>
+
+#include <catch.hpp>
+
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+/** Writes back and drops the cached pages of a file.
+ * @return true if none of the pages are resident afterwards.
+ */
+bool evictFromPageCache(int fd, int64_t size) {
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    auto const r = quicker_sfv::gui::queryPageResidency(fd, 0, size);
+    return r && (r->resident_pages == 0);
+}
+}
+
+TEST_CASE("Page Cache Residency")
+{
+    using quicker_sfv::gui::CacheResidency;
+    using quicker_sfv::gui::probeNoWaitReads;
+    using quicker_sfv::gui::probeResidency;
+    using quicker_sfv::gui::queryPageResidency;
+
+    int64_t const page_size = sysconf(_SC_PAGESIZE);
+    std::string const contents(10 * page_size + 123, 'x');
+    TemporaryFile const f("quicker_sfv_page_cache_residency.t.bin", contents);
+    int const fd = ::open(f.path.c_str(), O_RDONLY | O_CLOEXEC);
+    REQUIRE(fd >= 0);
+    int64_t const file_size = static_cast<int64_t>(contents.size());
+
+    SECTION("Freshly written files are resident") {
+        auto const r = queryPageResidency(fd, 0, file_size);
+        REQUIRE(r);
+        CHECK(r->total_pages == 11);
+        CHECK(r->resident_pages == 11);
+        auto const r_partial = queryPageResidency(fd, page_size + 1, 2 * page_size);
+        REQUIRE(r_partial);
+        CHECK(r_partial->total_pages == 3);
+        CHECK(probeNoWaitReads(fd, 0, file_size) != std::optional<bool>(false));
+        CHECK(probeResidency(fd, 0, file_size) == CacheResidency::Resident);
+        CHECK(probeResidency(fd, 17, 100) == CacheResidency::Resident);
+    }
+    SECTION("Empty ranges are resident") {
+        auto const r = queryPageResidency(fd, 0, 0);
+        REQUIRE(r);
+        CHECK(r->total_pages == 0);
+        CHECK(probeNoWaitReads(fd, 0, 0) == std::optional<bool>(true));
+        CHECK(probeResidency(fd, 0, 0) == CacheResidency::Resident);
+    }
+    SECTION("Ranges past the end of the file are cold") {
+        CHECK(probeResidency(fd, 0, file_size + 4 * page_size) == CacheResidency::Cold);
+    }
+    SECTION("Evicted files are cold") {
+        if (!evictFromPageCache(fd, file_size)) {
+            WARN("Unable to evict test file from the page cache");
+            return;
+        }
+        CHECK(probeResidency(fd, 0, file_size) == CacheResidency::Cold);
+        // reading a page brings it back into the cache
+        char c;
+        REQUIRE(pread(fd, &c, 1, 3 * page_size) == 1);
+        CHECK(probeResidency(fd, 3 * page_size, 1) == CacheResidency::Resident);
+    }
+    SECTION("Pipes can not be probed") {
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+        CHECK(!queryPageResidency(fds[0], 0, 10));
+        CHECK(probeResidency(fds[0], 0, 10) == CacheResidency::Cold);
+        close(fds[0]);
+        close(fds[1]);
+    }
+    close(fd);
+}
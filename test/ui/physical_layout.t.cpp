@@ -0,0 +1,98 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/physical_layout.hpp>
+
+#include <test_temporary_file.hpp>
+
+#include <catch.hpp>
+
+#include <filesystem>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+uint64_t inodeNumber(int fd) {
+    struct stat st;
+    REQUIRE(fstat(fd, &st) == 0);
+    return static_cast<uint64_t>(st.st_ino);
+}
+}
+
+TEST_CASE("Physical Layout")
+{
+    using quicker_sfv::gui::PhysicalLocation;
+    using quicker_sfv::gui::queryPhysicalLocation;
+
+    SECTION("Ordering") {
+        PhysicalLocation const e1{ .source = PhysicalLocation::Source::Extent, .position = 100 };
+        PhysicalLocation const e2{ .source = PhysicalLocation::Source::Extent, .position = 5000 };
+        PhysicalLocation const i1{ .source = PhysicalLocation::Source::Inode, .position = 7 };
+        PhysicalLocation const i2{ .source = PhysicalLocation::Source::Inode, .position = 12 };
+        CHECK(e1 < e2);
+        CHECK(e2 < i1);
+        CHECK(i1 < i2);
+        CHECK(!(e2 < e1));
+        CHECK(e1 == PhysicalLocation{ .source = PhysicalLocation::Source::Extent, .position = 100 });
+    }
+    SECTION("Files with allocated data") {
+        TemporaryFile const f(std::filesystem::temp_directory_path(), "quicker_sfv_physical_layout.t.bin",
+                              std::string(256 << 10, 'x'));
+        FileDescriptor const fin(f.path, O_RDONLY);
+        REQUIRE(fin.fd >= 0);
+        // write back the data, so that it has a physical location
+        fsync(fin.fd);
+        PhysicalLocation const start = queryPhysicalLocation(fin.fd, 0);
+        if (start.source == PhysicalLocation::Source::Inode) {
+            WARN("The file system of the temp directory does not support FIEMAP");
+            CHECK(start.position == inodeNumber(fin.fd));
+        } else {
+            CHECK(queryPhysicalLocation(fin.fd, 128 << 10).source == PhysicalLocation::Source::Extent);
+        }
+        // there is no data past the end of the file
+        PhysicalLocation const past_end = queryPhysicalLocation(fin.fd, 1 << 20);
+        CHECK(past_end.source == PhysicalLocation::Source::Inode);
+        CHECK(past_end.position == inodeNumber(fin.fd));
+    }
+    SECTION("Empty files") {
+        TemporaryFile const f(std::filesystem::temp_directory_path(), "quicker_sfv_physical_layout.t.empty.bin", "");
+        FileDescriptor const fin(f.path, O_RDONLY);
+        REQUIRE(fin.fd >= 0);
+        PhysicalLocation const l = queryPhysicalLocation(fin.fd, 0);
+        CHECK(l.source == PhysicalLocation::Source::Inode);
+        CHECK(l.position == inodeNumber(fin.fd));
+    }
+    SECTION("File systems without FIEMAP") {
+        // tmpfs has no physical layout
+        std::filesystem::path const shm = "/dev/shm";
+        if (access(shm.c_str(), W_OK) != 0) {
+            WARN("/dev/shm not available; skipping tmpfs test");
+            return;
+        }
+        TemporaryFile const f(shm, "quicker_sfv_physical_layout.t.bin", "some data");
+        FileDescriptor const fin(f.path, O_RDONLY);
+        REQUIRE(fin.fd >= 0);
+        PhysicalLocation const l = queryPhysicalLocation(fin.fd, 0);
+        CHECK(l.source == PhysicalLocation::Source::Inode);
+        CHECK(l.position == inodeNumber(fin.fd));
+    }
+}
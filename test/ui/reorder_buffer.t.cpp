@@ -0,0 +1,89 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/ui/reorder_buffer.hpp>
+
+#include <catch.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+TEST_CASE("Reorder Buffer")
+{
+    using quicker_sfv::gui::ReorderBuffer;
+
+    SECTION("Items inserted in order are released immediately") {
+        ReorderBuffer<int> b;
+        CHECK(b.empty());
+        CHECK(!b.pop());
+        for (int i = 0; i < 5; ++i) {
+            b.insert(i, i * 10);
+            CHECK(b.size() == 1);
+            auto const item = b.pop();
+            REQUIRE(item);
+            CHECK(*item == i * 10);
+            CHECK(b.nextIndex() == static_cast<std::size_t>(i + 1));
+            CHECK(b.empty());
+        }
+    }
+    SECTION("Items are held back until all earlier items arrived") {
+        ReorderBuffer<std::string> b;
+        b.insert(2, "c");
+        b.insert(4, "e");
+        CHECK(b.size() == 2);
+        CHECK(!b.pop());
+        b.insert(1, "b");
+        CHECK(!b.pop());
+        b.insert(0, "a");
+        std::vector<std::string> released;
+        while (auto item = b.pop()) { released.push_back(std::move(*item)); }
+        CHECK(released == std::vector<std::string>{ "a", "b", "c" });
+        CHECK(b.nextIndex() == 3);
+        CHECK(b.size() == 1);
+        b.insert(3, "d");
+        CHECK(b.pop() == "d");
+        CHECK(b.pop() == "e");
+        CHECK(b.empty());
+        CHECK(b.nextIndex() == 5);
+    }
+    SECTION("Draining skips missing items") {
+        ReorderBuffer<int> b;
+        b.insert(1, 1);
+        b.insert(3, 3);
+        b.insert(4, 4);
+        CHECK(!b.pop());
+        CHECK(b.popSkippingGaps() == 1);
+        CHECK(b.popSkippingGaps() == 3);
+        CHECK(b.popSkippingGaps() == 4);
+        CHECK(!b.popSkippingGaps());
+        CHECK(b.nextIndex() == 5);
+    }
+    SECTION("Move-only items") {
+        ReorderBuffer<std::unique_ptr<int>> b;
+        b.insert(1, std::make_unique<int>(42));
+        b.insert(0, std::make_unique<int>(23));
+        auto first = b.pop();
+        REQUIRE(first);
+        CHECK(**first == 23);
+        auto second = b.pop();
+        REQUIRE(second);
+        CHECK(**second == 42);
+    }
+}
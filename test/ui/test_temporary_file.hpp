@@ -0,0 +1,67 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef INCLUDE_GUARD_QUICKER_SFV_TESTING_TEST_TEMPORARY_FILE_HPP
+#define INCLUDE_GUARD_QUICKER_SFV_TESTING_TEST_TEMPORARY_FILE_HPP
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/** File with the given contents that is deleted again at the end of the test.
+ */
+struct TemporaryFile {
+    std::filesystem::path path;
+    TemporaryFile(std::string const& name, std::string_view contents)
+        :TemporaryFile(std::filesystem::temp_directory_path(), name, contents)
+    {}
+    TemporaryFile(std::filesystem::path const& directory, std::string const& name, std::string_view contents)
+        :path(directory / name)
+    {
+        std::ofstream(path, std::ios::binary) << contents;
+    }
+    ~TemporaryFile() {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+    TemporaryFile& operator=(TemporaryFile&&) = delete;
+
+    std::u8string u8path() const { return path.u8string(); }
+};
+
+/** POSIX file descriptor that is closed on destruction.
+ * fd is -1 if the file could not be opened.
+ */
+struct FileDescriptor {
+    int fd;
+    FileDescriptor(std::filesystem::path const& p, int flags)
+        :fd(::open(p.c_str(), flags | O_CLOEXEC))
+    {}
+    ~FileDescriptor() {
+        if (fd >= 0) { ::close(fd); }
+    }
+    FileDescriptor& operator=(FileDescriptor&&) = delete;
+};
+
+#endif
@@ -0,0 +1,132 @@
+/*
+ *   QuickerSFV - A fast checksum verifier
+ *   Copyright (C) 2025  Andreas Weis (quickersfv@andreas-weis.net)
+ *
+ *   This file is part of QuickerSFV.
+ *
+ *   QuickerSFV is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   QuickerSFV is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <quicker_sfv/verified_database.hpp>
+
+#include <quicker_sfv/error.hpp>
+
+#include <test_digest.hpp>
+#include <test_file_io.hpp>
+
+#include <catch.hpp>
+
+TEST_CASE("Verified Database")
+{
+    using quicker_sfv::VerifiedDatabase;
+    using quicker_sfv::VerifiedDatabasePolicy;
+    using quicker_sfv::VerifiedFileKey;
+    using quicker_sfv::VerifiedRecord;
+    using namespace std::chrono_literals;
+
+    VerifiedFileKey const key1{ .device = 1, .file_id = 100, .size = 4096, .modification_time = 12345, .algorithm = u8"CRC32" };
+    VerifiedFileKey const key2{ .device = 1, .file_id = 101, .size = 0, .modification_time = -1, .algorithm = u8"MD5" };
+    std::chrono::sys_seconds const t0{ std::chrono::sys_days{ std::chrono::year{ 2025 } / 1 / 1 } };
+    VerifiedRecord const record1{ .digest = u8"abcdef01", .verified_time = t0 };
+    VerifiedRecord const record2{ .digest = u8"0123456789abcdef0123456789abcdef", .verified_time = t0 + 10s };
+
+    SECTION("Construction") {
+        VerifiedDatabase db;
+        CHECK(db.size() == 0);
+        CHECK(!db.lookup(key1));
+        CHECK(!db.needsCompaction());
+    }
+    SECTION("Insert and lookup") {
+        VerifiedDatabase db;
+        db.insert(key1, record1);
+        db.insert(key2, record2);
+        CHECK(db.size() == 2);
+        CHECK(db.lookup(key1) == record1);
+        CHECK(db.lookup(key2) == record2);
+        VerifiedFileKey modified_key = key1;
+        modified_key.modification_time += 1;
+        CHECK(!db.lookup(modified_key));
+        VerifiedFileKey other_algorithm = key1;
+        other_algorithm.algorithm = u8"MD5";
+        CHECK(!db.lookup(other_algorithm));
+        db.insert(key1, record2);
+        CHECK(db.size() == 2);
+        CHECK(db.lookup(key1) == record2);
+    }
+    SECTION("Skip policy") {
+        VerifiedDatabase db;
+        db.insert(key1, record1);
+        VerifiedDatabasePolicy const skip_30_days{ .skip_verified = true, .max_age = std::chrono::days{ 30 } };
+        VerifiedDatabasePolicy const skip_forever{ .skip_verified = true, .max_age = std::chrono::days{ 0 } };
+        VerifiedDatabasePolicy const recheck{ .skip_verified = false, .max_age = std::chrono::days{ 0 } };
+        quicker_sfv::Digest const expected = TestDigest{ u8"abcdef01" };
+        CHECK(db.canSkip(key1, expected, t0 + 24h, skip_30_days));
+        CHECK(!db.canSkip(key1, expected, t0 + std::chrono::days{ 30 }, skip_30_days));
+        CHECK(db.canSkip(key1, expected, t0 + std::chrono::days{ 3000 }, skip_forever));
+        CHECK(!db.canSkip(key1, expected, t0 + 24h, recheck));
+        CHECK(!db.canSkip(key1, TestDigest{ u8"abcdef02" }, t0 + 24h, skip_30_days));
+        CHECK(!db.canSkip(key2, expected, t0 + 24h, skip_30_days));
+    }
+    SECTION("Journal") {
+        TestOutput out;
+        VerifiedDatabase::writeHeader(out);
+        VerifiedDatabase::appendRecord(out, key1, record1);
+        VerifiedDatabase::appendRecord(out, key2, record2);
+        VerifiedDatabase::appendRecord(out, key1, record2);
+        CHECK(out.write_calls == 4);
+        TestInput in;
+        in.contents = out.contents;
+        SECTION("Replay") {
+            VerifiedDatabase const db = VerifiedDatabase::readFromFile(in);
+            CHECK(db.size() == 2);
+            CHECK(db.lookup(key1) == record2);
+            CHECK(db.lookup(key2) == record2);
+            CHECK(!db.needsCompaction());
+        }
+        SECTION("Torn write") {
+            in.contents.resize(in.contents.size() - 3);
+            VerifiedDatabase const db = VerifiedDatabase::readFromFile(in);
+            CHECK(db.size() == 2);
+            CHECK(db.lookup(key1) == record1);
+            CHECK(db.needsCompaction());
+        }
+        SECTION("Corrupt record") {
+            in.contents.back() = static_cast<char>(in.contents.back() ^ 0x01);
+            VerifiedDatabase const db = VerifiedDatabase::readFromFile(in);
+            CHECK(db.lookup(key1) == record1);
+            CHECK(db.needsCompaction());
+        }
+        SECTION("Compaction") {
+            VerifiedDatabase const db = VerifiedDatabase::readFromFile(in);
+            TestOutput compacted;
+            db.writeToFile(compacted);
+            CHECK(compacted.contents.size() < out.contents.size());
+            TestInput compacted_in;
+            compacted_in.contents = compacted.contents;
+            VerifiedDatabase const db2 = VerifiedDatabase::readFromFile(compacted_in);
+            CHECK(db2.size() == 2);
+            CHECK(db2.lookup(key1) == record2);
+            CHECK(db2.lookup(key2) == record2);
+        }
+    }
+    SECTION("Empty file") {
+        TestInput in;
+        VerifiedDatabase const db = VerifiedDatabase::readFromFile(in);
+        CHECK(db.size() == 0);
+    }
+    SECTION("Invalid file") {
+        TestInput in;
+        in = "QSFVXXX1";
+        CHECK_THROWS_AS(VerifiedDatabase::readFromFile(in), quicker_sfv::Exception);
+    }
+}